@@ -7,6 +7,8 @@
 #include "Game.h"
 #include "Camera.h"
 #include "LoadMenu.h"
+#include "Log.h"
+#include "Memory.h"
 
 /* *************************************
  *  Defines
@@ -83,11 +85,11 @@ static bool AircraftCheckPath(TYPE_AIRCRAFT_DATA* ptrAicraft, TYPE_AIRCRAFT_DATA
 
 void AircraftInit(void)
 {
-    static bool initialised;
-
     bzero(AircraftData, GAME_MAX_AIRCRAFT * sizeof (TYPE_AIRCRAFT_DATA));
     aircraftIndex = 0;
 
+    MEMORY_REGISTER("Aircraft", AircraftData);
+
     AircraftSpr.x = 0;
     AircraftSpr.y = 0;
 
@@ -109,7 +111,6 @@ void AircraftInit(void)
 
     memset(flightDataIdxTable, AIRCRAFT_INVALID_IDX, sizeof (flightDataIdxTable));
 
-    if (initialised == false)
     {
         static const char* const GameFileList[] =
         {
@@ -123,8 +124,7 @@ void AircraftInit(void)
             &LeftRightArrowSpr
         };
 
-        initialised = true;
-
+        // Files which are still resident are not loaded again.
         LOAD_FILES(GameFileList, GameFileDest);
     }
 }
@@ -145,7 +145,7 @@ bool AircraftAddNew(    TYPE_FLIGHT_DATA* const ptrFlightData,
 
         ptrAircraft->FlightDataIdx = FlightDataIndex;
 
-        Serial_printf("ptrAircraft->FlightDataIdx = %d, FlightDataIndex = %d\n", ptrAircraft->FlightDataIdx, FlightDataIndex);
+        LOG_DEBUG("ptrAircraft->FlightDataIdx = %d, FlightDataIndex = %d\n", ptrAircraft->FlightDataIdx, FlightDataIndex);
 
         if (ptrFlightData->FlightDirection[FlightDataIndex] == ARRIVAL)
         {
@@ -184,7 +184,7 @@ bool AircraftAddNew(    TYPE_FLIGHT_DATA* const ptrFlightData,
                 case NO_DIRECTION:
                     // Fall through
                 default:
-                    Serial_printf("Invalid runway direction %d for inbound flight.\n", direction);
+                    LOG_ERROR("Invalid runway direction %d for inbound flight.\n", direction);
                 return false;
             }
         }
@@ -192,7 +192,7 @@ bool AircraftAddNew(    TYPE_FLIGHT_DATA* const ptrFlightData,
         {
             if (direction == NO_DIRECTION)
             {
-                Serial_printf("Invalid direction for outbound flight.\n");
+                LOG_ERROR("Invalid direction for outbound flight.\n");
                 return false;
             }
 
@@ -206,8 +206,8 @@ bool AircraftAddNew(    TYPE_FLIGHT_DATA* const ptrFlightData,
         ptrAircraft->State = ptrFlightData->State[FlightDataIndex];
         flightDataIdxTable[FlightDataIndex] = aircraftIndex;
 
-        Serial_printf("\nAircraft Data:\n");
-        Serial_printf("\tTargets:");
+        LOG_DEBUG("\nAircraft Data:\n");
+        LOG_DEBUG("\tTargets:");
 
         {
             uint8_t i;
@@ -219,26 +219,28 @@ bool AircraftAddNew(    TYPE_FLIGHT_DATA* const ptrFlightData,
                     break;
                 }
 
-                Serial_printf(" %d", ptrAircraft->Target[i]);
+                LOG_DEBUG(" %d", ptrAircraft->Target[i]);
             }
         }
 
-        Serial_printf("\n\tDirection: %d\n", ptrAircraft->Direction);
+        LOG_DEBUG("\n\tDirection: %d\n", ptrAircraft->Direction);
 
-        Serial_printf("\nLivery: %d\n", ptrAircraft->Livery );
+        LOG_DEBUG("\nLivery: %d\n", ptrAircraft->Livery );
 
-        Serial_printf("Aircraft position: {%d, %d, %d}\n",
+        LOG_DEBUG("Aircraft position: {%d, %d, %d}\n",
                 fix16_to_int(ptrAircraft->IsoPos.x),
                 fix16_to_int(ptrAircraft->IsoPos.y),
                 fix16_to_int(ptrAircraft->IsoPos.z) );
 
         aircraftIndex++;
 
+        MEMORY_USAGE(AircraftData, aircraftIndex * sizeof (TYPE_AIRCRAFT_DATA));
+
         return true;
     }
     else
     {
-        Serial_printf("Exceeded maximum aircraft capacity!\n");
+        LOG_ERROR("Exceeded maximum aircraft capacity!\n");
     }
 
     return false;
@@ -280,7 +282,7 @@ bool AircraftRemove(uint8_t aircraftIdx)
             if (ptrAircraft->FlightDataIdx == aircraftIdx)
             {
                 ptrAircraft->State = STATE_IDLE;
-                Serial_printf("Flight %d removed\n", ptrAircraft->FlightDataIdx);
+                LOG_INFO("Flight %d removed\n", ptrAircraft->FlightDataIdx);
                 return true;
             }
         }
@@ -384,7 +386,7 @@ static bool AircraftCheckPath(TYPE_AIRCRAFT_DATA* const ptrAircraft, TYPE_AIRCRA
         case NO_DIRECTION:
             // Fall through
         default:
-            Serial_printf("AircraftCheckPath: Undefined direction\n");
+            LOG_WARNING("AircraftCheckPath: Undefined direction\n");
         return false;
     }
 
@@ -691,9 +693,9 @@ static void AircraftDirection(TYPE_AIRCRAFT_DATA* const ptrAircraft)
 
             if (ptrAircraft->Target[++ptrAircraft->TargetIdx] == 0)
             {
-                Serial_printf("All targets reached!\n");
+                LOG_INFO("All targets reached!\n");
                 ptrAircraft->State = GameTargetsReached(ptrAircraft->Target[0], ptrAircraft->FlightDataIdx);
-                memset(ptrAircraft->Target, 0, AIRCRAFT_MAX_TARGETS);
+                memset(ptrAircraft->Target, 0, sizeof (ptrAircraft->Target));
             }
         }
     }
@@ -748,7 +750,7 @@ static void AircraftUpdateSpriteFromData(TYPE_AIRCRAFT_DATA* const ptrAircraft)
         case AIRCRAFT_LIVERY_UNKNOWN:
             // Fall through
         default:
-            Serial_printf("Unknown livery %d!\n", ptrAircraft->Livery);
+            LOG_WARNING("Unknown livery %d!\n", ptrAircraft->Livery);
         break;
     }
 
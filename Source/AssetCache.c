@@ -0,0 +1,293 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "AssetCache.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define ASSET_CACHE_MAX_ENTRIES 48
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_vramRect
+{
+	short x;
+	short y;
+	short w;
+	short h;
+}TYPE_VRAM_RECT;
+
+typedef struct t_assetCacheEntry
+{
+	bool used;
+	uint32_t hash;
+	const void* dest;
+	ASSET_RESIDENCY residency;
+	// Only used for ASSET_RESIDENCY_VRAM entries.
+	TYPE_VRAM_RECT image;
+	TYPE_VRAM_RECT clut;
+}TYPE_ASSET_CACHE_ENTRY;
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static uint32_t AssetCacheHash(const char* strPath);
+static TYPE_ASSET_CACHE_ENTRY* AssetCacheNewEntry(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency);
+static bool AssetCacheRectOverlap(const TYPE_VRAM_RECT* const rect, short x, short y, short w, short h);
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static TYPE_ASSET_CACHE_ENTRY AssetCacheEntries[ASSET_CACHE_MAX_ENTRIES];
+
+/* *******************************************************************************************
+ *
+ * @name: uint32_t AssetCacheHash(const char* strPath)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Calculates a 32-bit hash (djb2) from a file path.
+ *
+ * @remarks:
+ *  Assets are identified by their path hash instead of their contents,
+ *  since reading file contents from CD-ROM is exactly what is meant
+ *  to be avoided.
+ *
+ * *******************************************************************************************/
+static uint32_t AssetCacheHash(const char* strPath)
+{
+	uint32_t hash = 5381;
+	char c;
+
+	while ((c = *strPath++) != '\0')
+	{
+		hash = ((hash << 5) + hash) + (uint8_t)c;
+	}
+
+	return hash;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool AssetCacheIsResident(const char* strPath, const void* const dest)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @param:
+ *  const char* strPath:
+ *      File path, as passed to LoadMenu().
+ *
+ *  const void* const dest:
+ *      Destination structure (GsSprite, SsVag, TYPE_FONT...).
+ *
+ * @return:
+ *  true if file has already been loaded into dest and its contents
+ *  have not been invalidated since then, false otherwise.
+ *
+ * *******************************************************************************************/
+bool AssetCacheIsResident(const char* strPath, const void* const dest)
+{
+	uint32_t hash;
+	uint8_t i;
+
+	if (strPath == NULL)
+	{
+		return false;
+	}
+
+	hash = AssetCacheHash(strPath);
+
+	for (i = 0; i < ASSET_CACHE_MAX_ENTRIES; i++)
+	{
+		const TYPE_ASSET_CACHE_ENTRY* const ptrEntry = &AssetCacheEntries[i];
+
+		if ((ptrEntry->used != false)
+					&&
+			(ptrEntry->hash == hash)
+					&&
+			(ptrEntry->dest == dest)	)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: TYPE_ASSET_CACHE_ENTRY* AssetCacheNewEntry(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Removes any entry linked to dest, since its contents have been
+ *  overwritten, and fills a free entry with input parameters.
+ *  dest can be NULL for data without a destination structure
+ *  (i.e.: *.CLT files).
+ *
+ * @return:
+ *  Pointer to new entry, or NULL if no free entries are available.
+ *
+ * *******************************************************************************************/
+static TYPE_ASSET_CACHE_ENTRY* AssetCacheNewEntry(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency)
+{
+	uint8_t i;
+
+	if (strPath == NULL)
+	{
+		return NULL;
+	}
+
+	if (dest != NULL)
+	{
+		// Previous contents from dest have been overwritten.
+		AssetCacheRemove(dest);
+	}
+
+	for (i = 0; i < ASSET_CACHE_MAX_ENTRIES; i++)
+	{
+		TYPE_ASSET_CACHE_ENTRY* const ptrEntry = &AssetCacheEntries[i];
+
+		if (ptrEntry->used == false)
+		{
+			bzero(ptrEntry, sizeof (TYPE_ASSET_CACHE_ENTRY));
+
+			ptrEntry->used = true;
+			ptrEntry->hash = AssetCacheHash(strPath);
+			ptrEntry->dest = dest;
+			ptrEntry->residency = residency;
+
+			return ptrEntry;
+		}
+	}
+
+	// Not critical: asset will be loaded again next time.
+	Serial_printf("AssetCache: no free entries for %s\n", strPath);
+
+	return NULL;
+}
+
+void AssetCacheAdd(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency)
+{
+	AssetCacheNewEntry(strPath, dest, residency);
+}
+
+void AssetCacheAddImage(const char* strPath, const void* const dest, const GsImage* const gsi)
+{
+	TYPE_ASSET_CACHE_ENTRY* const ptrEntry = AssetCacheNewEntry(strPath, dest, ASSET_RESIDENCY_VRAM);
+
+	if (ptrEntry != NULL)
+	{
+		ptrEntry->image.x = gsi->x;
+		ptrEntry->image.y = gsi->y;
+		ptrEntry->image.w = gsi->w;
+		ptrEntry->image.h = gsi->h;
+
+		if (gsi->has_clut)
+		{
+			ptrEntry->clut.x = gsi->clut_x;
+			ptrEntry->clut.y = gsi->clut_y;
+			ptrEntry->clut.w = gsi->clut_w;
+			ptrEntry->clut.h = gsi->clut_h;
+		}
+	}
+}
+
+void AssetCacheRemove(const void* const dest)
+{
+	uint8_t i;
+
+	for (i = 0; i < ASSET_CACHE_MAX_ENTRIES; i++)
+	{
+		TYPE_ASSET_CACHE_ENTRY* const ptrEntry = &AssetCacheEntries[i];
+
+		if ((ptrEntry->used != false) && (ptrEntry->dest == dest))
+		{
+			ptrEntry->used = false;
+		}
+	}
+}
+
+static bool AssetCacheRectOverlap(const TYPE_VRAM_RECT* const rect, short x, short y, short w, short h)
+{
+	if ((rect->w == 0) || (rect->h == 0))
+	{
+		return false;
+	}
+
+	return !(	(rect->x >= (x + w))
+					||
+				(x >= (rect->x + rect->w))
+					||
+				(rect->y >= (y + h))
+					||
+				(y >= (rect->y + rect->h))	);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void AssetCacheEvictVRAM(short x, short y, short w, short h)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Invalidates VRAM entries whose image or CLUT data overlap given
+ *  rectangle, since it is about to be overwritten.
+ *
+ * @remarks:
+ *  Coordinates and dimensions are expressed in VRAM (16-bit) units.
+ *
+ * *******************************************************************************************/
+void AssetCacheEvictVRAM(short x, short y, short w, short h)
+{
+	uint8_t i;
+
+	for (i = 0; i < ASSET_CACHE_MAX_ENTRIES; i++)
+	{
+		TYPE_ASSET_CACHE_ENTRY* const ptrEntry = &AssetCacheEntries[i];
+
+		if ((ptrEntry->used != false) && (ptrEntry->residency == ASSET_RESIDENCY_VRAM))
+		{
+			if (	AssetCacheRectOverlap(&ptrEntry->image, x, y, w, h)
+								||
+					AssetCacheRectOverlap(&ptrEntry->clut, x, y, w, h)	)
+			{
+				ptrEntry->used = false;
+			}
+		}
+	}
+}
+
+void AssetCacheEvictImage(const GsImage* const gsi)
+{
+	AssetCacheEvictVRAM(gsi->x, gsi->y, gsi->w, gsi->h);
+
+	if (gsi->has_clut)
+	{
+		AssetCacheEvictVRAM(gsi->clut_x, gsi->clut_y, gsi->clut_w, gsi->clut_h);
+	}
+}
+
+void AssetCacheFlush(const ASSET_RESIDENCY residency)
+{
+	uint8_t i;
+
+	for (i = 0; i < ASSET_CACHE_MAX_ENTRIES; i++)
+	{
+		TYPE_ASSET_CACHE_ENTRY* const ptrEntry = &AssetCacheEntries[i];
+
+		if (ptrEntry->residency == residency)
+		{
+			ptrEntry->used = false;
+		}
+	}
+}
@@ -0,0 +1,55 @@
+#ifndef ASSET_CACHE_HEADER__
+#define ASSET_CACHE_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef enum t_assetResidency
+{
+	ASSET_RESIDENCY_RAM,
+	ASSET_RESIDENCY_VRAM,
+	ASSET_RESIDENCY_SPU,
+
+	MAX_ASSET_RESIDENCY
+}ASSET_RESIDENCY;
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+// Returns true if file pointed to by strPath has already been loaded
+// into dest and its contents are still valid.
+bool AssetCacheIsResident(const char* strPath, const void* const dest);
+
+// Registers file pointed to by strPath as loaded into dest.
+// Any other entry previously linked to dest is replaced.
+void AssetCacheAdd(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency);
+
+// Same as AssetCacheAdd(), but also keeps track of VRAM
+// areas (image and CLUT) used by a GsImage instance.
+void AssetCacheAddImage(const char* strPath, const void* const dest, const GsImage* const gsi);
+
+// Removes entry linked to dest, if any.
+void AssetCacheRemove(const void* const dest);
+
+// Invalidates all VRAM entries overlapping given rectangle.
+void AssetCacheEvictVRAM(short x, short y, short w, short h);
+
+// Invalidates all VRAM entries overlapping image and CLUT data from a GsImage instance.
+void AssetCacheEvictImage(const GsImage* const gsi);
+
+// Invalidates all entries for a given residency type.
+void AssetCacheFlush(const ASSET_RESIDENCY residency);
+
+#endif // ASSET_CACHE_HEADER__
@@ -0,0 +1,882 @@
+/* *************************************************************************
+ *
+ * Bench: host-side benchmarks for game logic and rendering preparation.
+ *
+ * Game, Aircraft, PltParser, Timer, Font, Camera and Gfx modules are
+ * built for Linux against the headers found in stub/. Hardware access
+ * (GPU, SPU, CD-ROM, pads) and modules which are not benchmarked are
+ * replaced by BenchStubs.c. GPU primitives are still written into the
+ * primitive list, so ordering table and budget code runs as on target.
+ *
+ * Game.c is included below, so its static functions and data can be
+ * driven directly without modifying the module.
+ *
+ * Build (see CMakeLists.txt in this directory):
+ *  cmake -S Source/Bench -B build-bench
+ *  cmake --build build-bench --target bench
+ *
+ * Usage:
+ *  bench [options] [name filter]
+ *
+ *  --levels DIR        Directory containing *.PLT files.
+ *  --baseline FILE     Baseline file. Default: baseline.txt from this directory.
+ *  --threshold PCT     Maximum allowed slowdown against baseline. Default: 15.
+ *  --update-baseline   Writes measured values into baseline file.
+ *  --verbose           Prints messages from game modules.
+ *
+ * Each benchmark is run BENCH_SAMPLES times, and time per operation
+ * from the fastest sample is reported, as it is the least affected by
+ * other processes. Benchmarks found to be slower than their baseline
+ * value by more than the threshold are measured again up to
+ * BENCH_RETRIES times before being reported as a regression, and then
+ * exit status is 1. Baseline values
+ * depend on host CPU and compiler, so baseline file should be updated
+ * on the machine where comparisons are done.
+ *
+ * *************************************************************************/
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "../Game.c"
+#include "Bench.h"
+#include "PltParser.h"
+#include <time.h>
+#include <errno.h>
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#ifndef BENCH_LEVELS_DIR
+#define BENCH_LEVELS_DIR			"Levels"
+#endif // BENCH_LEVELS_DIR
+
+#ifndef BENCH_BASELINE_FILE
+#define BENCH_BASELINE_FILE			"baseline.txt"
+#endif // BENCH_BASELINE_FILE
+
+#define BENCH_SAMPLES				21
+#define BENCH_RETRIES				2
+#define BENCH_DEFAULT_THRESHOLD		15.0
+#define BENCH_MAX_NAME				32
+#define BENCH_MAX_PLT_SIZE			0x4000
+#define BENCH_LEVEL_PATH			"DATA\\LEVELS\\BENCH.LVL"
+#define BENCH_PLT_PATH				"DATA\\LEVELS\\BENCH.PLT"
+#define BENCH_AIRCRAFT_COLUMNS		16
+#define BENCH_GENERATED_PATH		"DATA\\LEVELS\\GENERATE.LVL"
+#define BENCH_GENERATED_SEED		1
+#define BENCH_GENERATED_RUNWAYS		8
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_bench
+{
+	const char* name;
+	// Called before each sample. Not timed.
+	void (*Setup)(void);
+	// Called opsPerSample times per sample.
+	void (*Run)(void);
+	uint32_t opsPerSample;
+	// Map size used by Setup(), if needed.
+	uint8_t columns;
+}TYPE_BENCH;
+
+typedef struct t_benchResult
+{
+	char name[BENCH_MAX_NAME];
+	double nsPerOp;
+}TYPE_BENCH_RESULT;
+
+/* *************************************
+ * 	Local prototypes
+ * *************************************/
+
+static void BenchSetupPlt(void);
+static void BenchRunPlt(void);
+static void BenchSetupPltGenerate(void);
+static void BenchRunPltGenerate(void);
+static void BenchCheckPltArrivalsOnly(void);
+static void BenchSetupAircraft(void);
+static void BenchRunAircraft(void);
+static void BenchSetupTerrain(void);
+static void BenchRunTerrain(void);
+static void BenchSetupDepthPass(void);
+static void BenchRunDepthPass(void);
+static void BenchSetupFont(void);
+static void BenchRunFontShort(void);
+static void BenchRunFontWrapped(void);
+
+/* *************************************
+ * 	Local variables
+ * *************************************/
+
+static const TYPE_BENCH BenchTable[] =
+{
+	{ "plt_parse",				BenchSetupPlt,			BenchRunPlt,			512,	0	},
+	{ "plt_generate",			BenchSetupPltGenerate,	BenchRunPltGenerate,	1024,	32	},
+	{ "aircraft_frame_32",		BenchSetupAircraft,		BenchRunAircraft,		256,	0	},
+	{ "terrain_precalc_8",		BenchSetupTerrain,		BenchRunTerrain,		2048,	8	},
+	{ "terrain_precalc_16",		BenchSetupTerrain,		BenchRunTerrain,		512,	16	},
+	{ "terrain_precalc_24",		BenchSetupTerrain,		BenchRunTerrain,		256,	24	},
+	{ "terrain_precalc_32",		BenchSetupTerrain,		BenchRunTerrain,		128,	32	},
+	{ "depth_pass_32",			BenchSetupDepthPass,	BenchRunDepthPass,		1024,	0	},
+	{ "font_print_short",		BenchSetupFont,			BenchRunFontShort,		8192,	0	},
+	{ "font_print_wrapped",		BenchSetupFont,			BenchRunFontWrapped,	2048,	0	}
+};
+
+static const TYPE_BENCH* BenchCurrent;
+static uint8_t BenchLevelData[LEVEL_HEADER_SIZE + (GAME_MAX_MAP_SIZE * sizeof (uint16_t))];
+static uint8_t BenchPltData[BENCH_MAX_PLT_SIZE];
+static TYPE_PLT_CONFIG BenchPltConfig;
+static uint32_t BenchCounter;
+
+/* *******************************************************************
+ *
+ * @name: void BenchEndFrame(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Does the same as GfxDrawScene() once GPU and VBlank waits are
+ *  over, so primitive list and per-frame budget are reset.
+ *
+ * *******************************************************************/
+static void BenchEndFrame(void)
+{
+	GfxDrawScene_Fast();
+	GfxSetDefaultPrimitiveList();
+}
+
+/* *******************************************************************
+ *
+ * @name: void BenchGenerateLevel(const uint8_t columns)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Writes a synthetic *.LVL file with columns x columns tiles and
+ *  loads it by calling GameLoadLevel(). Layout resembles levels
+ *  made with MapEditor: a runway on the first rows, taxiways,
+ *  parking rows with gates and a mix of grass, water and buildings.
+ *
+ * *******************************************************************/
+static void BenchGenerateLevel(const uint8_t columns)
+{
+	static const uint8_t Buildings[] =
+	{
+		BUILDING_HANGAR,
+		BUILDING_ATC_TOWER,
+		BUILDING_TERMINAL,
+		BUILDING_TERMINAL_2,
+		BUILDING_ATC_LOC,
+		BUILDING_ILS
+	};
+
+	const uint16_t size = columns * columns;
+	uint8_t* const ptrTiles = &BenchLevelData[LEVEL_HEADER_SIZE];
+	uint16_t tileNr;
+
+	memset(BenchLevelData, 0, sizeof (BenchLevelData));
+	memcpy(BenchLevelData, LEVEL_MAGIC_NUMBER_STRING, LEVEL_MAGIC_NUMBER_SIZE);
+	BenchLevelData[LEVEL_MAGIC_NUMBER_SIZE] = columns;
+	snprintf((char*)&BenchLevelData[LEVEL_MAGIC_NUMBER_SIZE + 1], LEVEL_TITLE_SIZE, "Bench %dx%d", columns, columns);
+
+	for (tileNr = 0; tileNr < size; tileNr++)
+	{
+		const uint8_t row = tileNr / columns;
+		const uint8_t column = tileNr % columns;
+		uint8_t tile = TILE_GRASS;
+		uint8_t building = BUILDING_NONE;
+
+		if (row == 1)
+		{
+			if (column == 1)
+			{
+				tile = TILE_RWY_START_1;
+			}
+			else if (column == (columns - 2))
+			{
+				tile = TILE_RWY_START_2;
+			}
+			else if ((column > 1) && (column < (columns - 2)))
+			{
+				tile = TILE_RWY_MID;
+			}
+		}
+		else if (row == 2)
+		{
+			tile = (column & 3)? TILE_TAXIWAY_GRASS : TILE_RWY_HOLDING_POINT;
+		}
+		else if (row == (columns - 1))
+		{
+			tile = TILE_WATER;
+		}
+		else if ((row % 4) == 3)
+		{
+			tile = TILE_TAXIWAY_GRASS | TILE_MIRROR_FLAG;
+		}
+		else if ((row % 4) == 0)
+		{
+			tile = (column & 1)? TILE_PARKING : TILE_ASPHALT;
+			building = (column & 1)? BUILDING_GATE : BUILDING_NONE;
+		}
+		else if (((row + column) % 5) == 0)
+		{
+			building = Buildings[(row + column) % sizeof (Buildings)];
+		}
+
+		// Tile data is stored as big-endian.
+		ptrTiles[tileNr << 1] = building;
+		ptrTiles[(tileNr << 1) + 1] = tile;
+	}
+
+	BenchRegisterFile(	BENCH_LEVEL_PATH,
+						BenchLevelData,
+						LEVEL_HEADER_SIZE + (size * sizeof (uint16_t))	);
+
+	GameLoadLevel(BENCH_LEVEL_PATH);
+
+	if (GameLevelSize != size)
+	{
+		fprintf(stderr, "Could not load synthetic level with %d columns!\n", columns);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/* *******************************************************************
+ *
+ * @name: void BenchInitPlayer(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Sets up player one as GameInit() does on single player mode.
+ *
+ * *******************************************************************/
+static void BenchInitPlayer(void)
+{
+	TYPE_PLAYER* const ptrPlayer = &PlayerData[PLAYER_ONE];
+
+	ptrPlayer->Active = true;
+	ptrPlayer->FlightDirection = DEPARTURE | ARRIVAL;
+	memset(ptrPlayer->TileData, 0, sizeof (ptrPlayer->TileData));
+
+	CameraInit(ptrPlayer);
+
+	GfxSetLayer(GFX_LAYER_TERRAIN);
+}
+
+/* *******************************************************************
+ *
+ * @name: void BenchInitAircraft(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Creates GAME_MAX_AIRCRAFT taxiing departures on a map with
+ *  BENCH_AIRCRAFT_COLUMNS columns. Aircraft on even and odd
+ *  parking positions of a row move towards each other, so
+ *  collisions are detected during the first frames.
+ *
+ * *******************************************************************/
+static void BenchInitAircraft(void)
+{
+	uint8_t i;
+
+	AircraftInit();
+
+	memset(&FlightData, 0, sizeof (FlightData));
+
+	FlightData.nAircraft = GAME_MAX_AIRCRAFT;
+
+	for (i = 0; i < GAME_MAX_AIRCRAFT; i++)
+	{
+		const uint8_t row = (i >> 1) % (BENCH_AIRCRAFT_COLUMNS - 1);
+		const uint8_t column = (i & 1)? BENCH_AIRCRAFT_COLUMNS - 2 : 1;
+		uint16_t targets[AIRCRAFT_MAX_TARGETS] = {0};
+
+		FlightData.FlightDirection[i] = DEPARTURE;
+		snprintf(FlightData.strFlightNumber[i], GAME_MAX_CHARACTERS, "PHX%04d", i);
+		FlightData.Passengers[i] = 100;
+		FlightData.Parking[i] = (row * BENCH_AIRCRAFT_COLUMNS) + column;
+		FlightData.State[i] = STATE_TAXIING;
+
+		// Head to the opposite side of the row.
+		targets[0] = (row * BENCH_AIRCRAFT_COLUMNS) + (BENCH_AIRCRAFT_COLUMNS - 1) - column;
+
+		if (AircraftAddNew(&FlightData, i, targets, (i & 1)? DIR_WEST : DIR_EAST) == false)
+		{
+			fprintf(stderr, "Could not create aircraft %d!\n", i);
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		GameGetAircraftTilemap(i);
+	}
+}
+
+/* *************************************
+ * 	Benchmarks
+ * *************************************/
+
+static void BenchSetupPlt(void)
+{
+}
+
+static void BenchRunPlt(void)
+{
+	if (PltParserLoadFile(BENCH_PLT_PATH, &FlightData) == false)
+	{
+		fprintf(stderr, "Could not parse " BENCH_PLT_PATH "!\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void BenchSetupPltGenerate(void)
+{
+	// Worst case: maximum number of runways, parking tiles and aircraft.
+	const TYPE_LEVEL_CONFIG levelConfig =
+	{
+		.Columns = BenchCurrent->columns,
+		.nRunway = BENCH_GENERATED_RUNWAYS,
+		.nParking = GAME_MAX_PARKING
+	};
+
+	const uint32_t size = GameGenerateLevel(&levelConfig, BenchLevelData, sizeof (BenchLevelData));
+	uint8_t nRwy = 0;
+
+	memset(&BenchPltConfig, 0, sizeof (BenchPltConfig));
+
+	BenchPltConfig.nParking = GameGetParkingTiles(	BenchLevelData,
+													size,
+													BenchPltConfig.ParkingArray,
+													GAME_MAX_PARKING	);
+
+	BenchRegisterFile(BENCH_GENERATED_PATH, BenchLevelData, size);
+	GameLoadLevel(BENCH_GENERATED_PATH);
+
+	while ((nRwy < GAME_MAX_RUNWAYS) && (GameRwy[nRwy] != 0))
+	{
+		nRwy++;
+	}
+
+	if (	(size == 0)
+				||
+			(GameLevelColumns != levelConfig.Columns)
+				||
+			(nRwy != levelConfig.nRunway)
+				||
+			(BenchPltConfig.nParking != levelConfig.nParking)	)
+	{
+		fprintf(stderr, "Generated level is not valid!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	BenchPltConfig.Level = LEVEL_DIFFICULTY_HARD;
+	BenchPltConfig.nAircraft = GAME_MAX_AIRCRAFT;
+	BenchPltConfig.DeparturePercentage = 50;
+	BenchPltConfig.ParkingDistribution = PLT_PARKING_RANDOM;
+	BenchPltConfig.Seed = BENCH_GENERATED_SEED;
+
+	BenchCheckPltArrivalsOnly();
+}
+
+// DeparturePercentage = 0 must not be replaced by a default value.
+static void BenchCheckPltArrivalsOnly(void)
+{
+	TYPE_PLT_CONFIG config = BenchPltConfig;
+	const uint8_t* ptrPlt;
+	uint8_t i;
+
+	config.DeparturePercentage = 0;
+
+	ptrPlt = PltParserGenerateFile(&config);
+
+	if (	(ptrPlt == NULL)
+				||
+			(PltParserLoadBuffer((const char*)ptrPlt, &FlightData) == false)
+				||
+			(FlightData.nAircraft != config.nAircraft)	)
+	{
+		fprintf(stderr, "Could not generate an arrivals-only PLT file!\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		if (FlightData.FlightDirection[i] != ARRIVAL)
+		{
+			fprintf(stderr, "Departure found on an arrivals-only PLT file!\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+}
+
+static void BenchRunPltGenerate(void)
+{
+	const uint8_t* const ptrPlt = PltParserGenerateFile(&BenchPltConfig);
+
+	if (	(ptrPlt == NULL)
+				||
+			(PltParserLoadBuffer((const char*)ptrPlt, &FlightData) == false)
+				||
+			(FlightData.nAircraft != BenchPltConfig.nAircraft)	)
+	{
+		fprintf(stderr, "Could not generate a valid PLT file!\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void BenchSetupAircraft(void)
+{
+	BenchGenerateLevel(BENCH_AIRCRAFT_COLUMNS);
+	BenchInitAircraft();
+}
+
+static void BenchRunAircraft(void)
+{
+	uint8_t i;
+
+	// Same steps executed by GameCalculations() for each aircraft.
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		GameGetAircraftTilemap(i);
+	}
+
+	AircraftHandler();
+}
+
+static void BenchSetupTerrain(void)
+{
+	TYPE_PLAYER* const ptrPlayer = &PlayerData[PLAYER_ONE];
+
+	BenchGenerateLevel(BenchCurrent->columns);
+	BenchInitAircraft();
+	BenchInitPlayer();
+
+	// Selecting a parking position is the most expensive case,
+	// as parked aircraft must be looked up for each parking tile.
+	ptrPlayer->SelectTaxiwayParking = true;
+	ptrPlayer->SelectedTile = GAME_INVALID_TILE_SELECTION;
+	ptrPlayer->WaypointIdx = 0;
+}
+
+static void BenchRunTerrain(void)
+{
+	GameRenderTerrainPrecalculations(&PlayerData[PLAYER_ONE], &FlightData);
+}
+
+static void BenchSetupDepthPass(void)
+{
+	BenchGenerateLevel(BENCH_AIRCRAFT_COLUMNS);
+	BenchInitAircraft();
+	BenchInitPlayer();
+
+	GameBuildingSpr.w = GameBuildingSpr.h = TILE_SIZE;
+	BenchEndFrame();
+}
+
+static void BenchRunDepthPass(void)
+{
+	GfxOTBegin();
+	GameRenderBuildingAircraft(&PlayerData[PLAYER_ONE]);
+	GfxOTEnd();
+
+	BenchEndFrame();
+}
+
+static void BenchSetupFont(void)
+{
+	TYPE_FONT* const ptrFont = &SmallFont;
+
+	// Same values as set by FontLoadImage() for FONT_2.TIM.
+	memset(ptrFont, 0, sizeof (*ptrFont));
+	ptrFont->spr_w = 128;
+	ptrFont->spr_h = 48;
+	ptrFont->spr.attribute = COLORMODE(COLORMODE_4BPP);
+	ptrFont->spr.r = NORMAL_LUMINANCE;
+	ptrFont->spr.g = NORMAL_LUMINANCE;
+	ptrFont->spr.b = NORMAL_LUMINANCE;
+	ptrFont->init_ch = '!';
+
+	FontSetSize(ptrFont, 8);
+	FontSetSpacing(ptrFont, 6);
+
+	BenchCounter = 0;
+	BenchEndFrame();
+}
+
+static void BenchRunFontShort(void)
+{
+	// Aircraft list entry, as printed by GameGui.
+	FontPrintText(&SmallFont, 16, 48, "PHX%04d %d pax %02d:%02d", BenchCounter & 0xFF, 100, 12, BenchCounter % 60);
+
+	if ((++BenchCounter & 0x3F) == 0)
+	{
+		BenchEndFrame();
+	}
+}
+
+static void BenchRunFontWrapped(void)
+{
+	FontSetFlags(&SmallFont, FONT_WRAP_LINE);
+	FontSetMaxCharPerLine(&SmallFont, 24);
+
+	// Tutorial message, as printed by Message module.
+	FontPrintText(	&SmallFont, 32, 96,
+					"Welcome to Airport! Use the directional pad to move the cursor. "
+					"Press %c to select an aircraft and follow the instructions "
+					"shown on screen. Flight %d is waiting for you.",
+					'X', BenchCounter	);
+
+	FontSetMaxCharPerLine(&SmallFont, 0);
+
+	if ((++BenchCounter & 0x0F) == 0)
+	{
+		BenchEndFrame();
+	}
+}
+
+/* *************************************
+ * 	Measurement
+ * *************************************/
+
+static double BenchNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+/* *******************************************************************
+ *
+ * @name: double BenchMeasure(const TYPE_BENCH* const ptrBench)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Time per operation from the fastest sample, in nanoseconds,
+ *  after BENCH_SAMPLES samples have been taken. An extra sample
+ *  is executed first and discarded, so caches are warm.
+ *
+ * *******************************************************************/
+static double BenchMeasure(const TYPE_BENCH* const ptrBench)
+{
+	double fastest = 0.0;
+	size_t i;
+
+	BenchCurrent = ptrBench;
+
+	for (i = 0; i < (BENCH_SAMPLES + 1); i++)
+	{
+		double start;
+		double nsPerOp;
+		uint32_t op;
+
+		ptrBench->Setup();
+
+		start = BenchNow();
+
+		for (op = 0; op < ptrBench->opsPerSample; op++)
+		{
+			ptrBench->Run();
+		}
+
+		nsPerOp = (BenchNow() - start) / ptrBench->opsPerSample;
+
+		if ((i == 1) || ((i > 1) && (nsPerOp < fastest)))
+		{
+			fastest = nsPerOp;
+		}
+	}
+
+	return fastest;
+}
+
+/* *************************************
+ * 	Baseline
+ * *************************************/
+
+static size_t BenchReadBaseline(const char* const path, TYPE_BENCH_RESULT* const results, const size_t maxResults)
+{
+	FILE* const f = fopen(path, "r");
+	char line[128];
+	size_t n = 0;
+
+	if (f == NULL)
+	{
+		return 0;
+	}
+
+	while ((n < maxResults) && (fgets(line, sizeof (line), f) != NULL))
+	{
+		TYPE_BENCH_RESULT* const ptrResult = &results[n];
+
+		if (line[0] == '#')
+		{
+			continue;
+		}
+
+		if (sscanf(line, "%31s %lf", ptrResult->name, &ptrResult->nsPerOp) == 2)
+		{
+			n++;
+		}
+	}
+
+	fclose(f);
+
+	return n;
+}
+
+static bool BenchWriteBaseline(const char* const path, const TYPE_BENCH_RESULT* const results, const size_t n)
+{
+	FILE* const f = fopen(path, "w");
+	size_t i;
+
+	if (f == NULL)
+	{
+		fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	fprintf(f, "# Generated by bench --update-baseline. Values in ns/op.\n");
+
+	for (i = 0; i < n; i++)
+	{
+		fprintf(f, "%s %.1f\n", results[i].name, results[i].nsPerOp);
+	}
+
+	fclose(f);
+
+	return true;
+}
+
+static const TYPE_BENCH_RESULT* BenchFindResult(const char* const name, const TYPE_BENCH_RESULT* const results, const size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		if (strcmp(results[i].name, name) == 0)
+		{
+			return &results[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* *************************************
+ * 	Setup
+ * *************************************/
+
+static bool BenchLoadPlt(const char* const levelsDir)
+{
+	static const char* const PltFiles[] =
+	{
+		// Longest file shipped with the game.
+		"TUTORIA1.PLT",
+		"tutoria1.plt"
+	};
+
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(PltFiles); i++)
+	{
+		char path[512];
+		FILE* f;
+		size_t size;
+
+		snprintf(path, sizeof (path), "%s/%s", levelsDir, PltFiles[i]);
+
+		f = fopen(path, "rb");
+
+		if (f == NULL)
+		{
+			continue;
+		}
+
+		size = fread(BenchPltData, sizeof (uint8_t), sizeof (BenchPltData), f);
+
+		fclose(f);
+
+		BenchRegisterFile(BENCH_PLT_PATH, BenchPltData, size);
+
+		return true;
+	}
+
+	fprintf(stderr, "Could not find %s inside %s\n", PltFiles[0], levelsDir);
+
+	return false;
+}
+
+static void BenchUsage(const char* const argv0)
+{
+	fprintf(stderr,	"Usage: %s [--levels DIR] [--baseline FILE] [--threshold PCT]\n"
+					"          [--update-baseline] [--verbose] [name filter]\n", argv0);
+}
+
+int main(int argc, char* argv[])
+{
+	TYPE_BENCH_RESULT baseline[ARRAY_SIZE(BenchTable)];
+	TYPE_BENCH_RESULT results[ARRAY_SIZE(BenchTable)];
+	const char* levelsDir = BENCH_LEVELS_DIR;
+	const char* baselinePath = BENCH_BASELINE_FILE;
+	const char* filter = NULL;
+	double threshold = BENCH_DEFAULT_THRESHOLD;
+	bool updateBaseline = false;
+	size_t nBaseline;
+	size_t nResults = 0;
+	size_t nRegressions = 0;
+	int i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--levels") == 0) && ((i + 1) < argc))
+		{
+			levelsDir = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--baseline") == 0) && ((i + 1) < argc))
+		{
+			baselinePath = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--threshold") == 0) && ((i + 1) < argc))
+		{
+			threshold = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--update-baseline") == 0)
+		{
+			updateBaseline = true;
+		}
+		else if (strcmp(argv[i], "--verbose") == 0)
+		{
+			BenchVerbose = true;
+		}
+		else if (argv[i][0] != '-')
+		{
+			filter = argv[i];
+		}
+		else
+		{
+			BenchUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (BenchLoadPlt(levelsDir) == false)
+	{
+		return EXIT_FAILURE;
+	}
+
+	// PltParser and Gfx do not depend on random values here,
+	// but keep any other caller of SystemRand() reproducible.
+	srand(1);
+
+	GfxInitDrawEnv();
+	GfxInitDispEnv();
+	GfxSetDefaultPrimitiveList();
+
+	nBaseline = BenchReadBaseline(baselinePath, baseline, ARRAY_SIZE(baseline));
+
+	printf("%-24s %12s %12s %9s\n", "benchmark", "ns/op", "baseline", "delta");
+
+	for (i = 0; i < (int)ARRAY_SIZE(BenchTable); i++)
+	{
+		const TYPE_BENCH* const ptrBench = &BenchTable[i];
+		TYPE_BENCH_RESULT* const ptrResult = &results[nResults];
+		const TYPE_BENCH_RESULT* ptrBaseline;
+
+		if ((filter != NULL) && (strstr(ptrBench->name, filter) == NULL))
+		{
+			continue;
+		}
+
+		snprintf(ptrResult->name, sizeof (ptrResult->name), "%s", ptrBench->name);
+		ptrResult->nsPerOp = BenchMeasure(ptrBench);
+		nResults++;
+
+		ptrBaseline = BenchFindResult(ptrBench->name, baseline, nBaseline);
+
+		if (ptrBaseline == NULL)
+		{
+			printf("%-24s %12.1f %12s %9s\n", ptrResult->name, ptrResult->nsPerOp, "-", "new");
+		}
+		else
+		{
+			const double limit = ptrBaseline->nsPerOp * (1.0 + (threshold / 100.0));
+			double delta;
+			bool regression;
+			int retry;
+
+			for (retry = 0; (retry < BENCH_RETRIES) && (updateBaseline == false) && (ptrResult->nsPerOp > limit); retry++)
+			{
+				const double nsPerOp = BenchMeasure(ptrBench);
+
+				if (nsPerOp < ptrResult->nsPerOp)
+				{
+					ptrResult->nsPerOp = nsPerOp;
+				}
+			}
+
+			delta = ((ptrResult->nsPerOp / ptrBaseline->nsPerOp) - 1.0) * 100.0;
+			regression = (updateBaseline == false) && (ptrResult->nsPerOp > limit);
+
+			printf(	"%-24s %12.1f %12.1f %+8.1f%%%s\n",
+					ptrResult->name,
+					ptrResult->nsPerOp,
+					ptrBaseline->nsPerOp,
+					delta,
+					regression? " REGRESSION" : "");
+
+			if (regression)
+			{
+				nRegressions++;
+			}
+		}
+	}
+
+	if (updateBaseline)
+	{
+		if (filter != NULL)
+		{
+			size_t j;
+
+			// Keep baseline values for benchmarks which were not run.
+			for (j = 0; j < nBaseline; j++)
+			{
+				if (	(BenchFindResult(baseline[j].name, results, nResults) == NULL)
+							&&
+						(nResults < ARRAY_SIZE(results))	)
+				{
+					results[nResults++] = baseline[j];
+				}
+			}
+		}
+
+		if (BenchWriteBaseline(baselinePath, results, nResults) == false)
+		{
+			return EXIT_FAILURE;
+		}
+
+		printf("Baseline written to %s\n", baselinePath);
+	}
+	else if (nBaseline == 0)
+	{
+		printf("No baseline found at %s. Run with --update-baseline to create it.\n", baselinePath);
+	}
+	else if (nRegressions != 0)
+	{
+		printf("%d benchmark(s) slower than baseline by more than %.1f%%\n", (int)nRegressions, threshold);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,36 @@
+#ifndef BENCH_HEADER__
+#define BENCH_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+// Makes data available to SystemOpenFile(), SystemReadFileChunk()
+// and SystemLoadFile() stubs under the given CD-ROM path
+// (e.g.: "DATA\\LEVELS\\LEVEL1.PLT"). Data is not copied, so
+// it must remain valid while file can be accessed.
+void BenchRegisterFile(const char* const path, const uint8_t* const data, const uint32_t size);
+
+// Reports key (PAD_CROSS, PAD_LEFT...) as pressed on pad one
+// during current frame. Released by SystemCyclicHandler(),
+// which is called by GfxDrawScene() on each frame.
+void BenchPressKey(const unsigned short key);
+
+// Restarts frame count used by System1SecondTick(), System100msTick()
+// and System500msTick() stubs, so consecutive runs are reproducible.
+void BenchResetTicks(void);
+
+/* *************************************
+ * 	Global variables
+ * *************************************/
+
+// When true, Serial_printf() messages from game modules are printed.
+extern bool BenchVerbose;
+
+#endif // BENCH_HEADER__
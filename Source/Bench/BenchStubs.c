@@ -0,0 +1,532 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Bench.h"
+#include "AssetCache.h"
+#include "Dialog.h"
+#include "EndAnimation.h"
+#include "GameGui.h"
+#include "LoadMenu.h"
+#include "Message.h"
+#include "Pad.h"
+#include "PltParser.h"
+#include "Sfx.h"
+#include "System.h"
+#include "Timer.h"
+#include "Vram.h"
+#include <stdarg.h>
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define BENCH_MAX_FILES			16
+#define BENCH_FILE_BUFFER_SIZE	0x20000
+
+// Number of data words written by PSXSDK for each primitive,
+// so Gfx ordering table code walks a realistic packet list.
+#define BENCH_SPRITE_WORDS		5
+#define BENCH_RECTANGLE_WORDS	3
+#define BENCH_GPOLY4_WORDS		8
+#define BENCH_TPOLY4_WORDS		9
+#define BENCH_LINE_WORDS		3
+#define BENCH_CLS_WORDS			3
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_benchFile
+{
+	const char* path;
+	const uint8_t* data;
+	uint32_t size;
+}TYPE_BENCH_FILE;
+
+/* *************************************
+ * 	Global variables
+ * *************************************/
+
+bool BenchVerbose;
+volatile unsigned int BenchStubD2_CHCR;
+
+/* *************************************
+ * 	Local variables
+ * *************************************/
+
+static TYPE_BENCH_FILE BenchFiles[BENCH_MAX_FILES];
+static const TYPE_BENCH_FILE* BenchOpenedFile;
+static uint32_t BenchFileOffset;
+static uint8_t BenchFileBuffer[BENCH_FILE_BUFFER_SIZE];
+static unsigned int* BenchPrimList;
+static int BenchPrimListPos;
+// Number of times SystemCyclicHandler() has been called.
+static uint64_t BenchFrames;
+static bool BenchOneSecondTick;
+static bool BenchHundredMsTick;
+static bool BenchFiveHundredMsTick;
+// Key pressed on pad one during current frame, or 0.
+static unsigned short BenchPadOneKey;
+
+/* *******************************************************************
+ *
+ * @name: void BenchRegisterFile(const char* const path, const uint8_t* const data, const uint32_t size)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds a file to the table used by file access stubs, or replaces
+ *  data for an already registered path.
+ *
+ * *******************************************************************/
+void BenchRegisterFile(const char* const path, const uint8_t* const data, const uint32_t size)
+{
+	size_t i;
+
+	for (i = 0; i < BENCH_MAX_FILES; i++)
+	{
+		TYPE_BENCH_FILE* const ptrFile = &BenchFiles[i];
+
+		if ((ptrFile->path == NULL) || (strcmp(ptrFile->path, path) == 0))
+		{
+			ptrFile->path = path;
+			ptrFile->data = data;
+			ptrFile->size = size;
+			return;
+		}
+	}
+
+	fprintf(stderr, "Too many files registered! Maximum: %d\n", BENCH_MAX_FILES);
+	exit(EXIT_FAILURE);
+}
+
+static const TYPE_BENCH_FILE* BenchFindFile(const char* const path)
+{
+	size_t i;
+
+	for (i = 0; (i < BENCH_MAX_FILES) && (BenchFiles[i].path != NULL); i++)
+	{
+		if (strcmp(BenchFiles[i].path, path) == 0)
+		{
+			return &BenchFiles[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* *******************************************************************
+ *
+ * @name: void BenchPressKey(const unsigned short key)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Reports key as pressed on pad one until next call to
+ *  SystemCyclicHandler(), as done by UpdatePads() on target.
+ *
+ * *******************************************************************/
+void BenchPressKey(const unsigned short key)
+{
+	BenchPadOneKey = key;
+}
+
+/* *******************************************************************
+ *
+ * @name: void BenchResetTicks(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Restarts frame count and releases pad one, so every run
+ *  sees ticks on the same frames.
+ *
+ * *******************************************************************/
+void BenchResetTicks(void)
+{
+	BenchFrames = 0;
+	BenchPadOneKey = 0;
+	BenchOneSecondTick = false;
+	BenchHundredMsTick = false;
+	BenchFiveHundredMsTick = false;
+}
+
+/* *************************************
+ * 	Serial
+ * *************************************/
+
+void Serial_printf(const char* str, ...)
+{
+	if (BenchVerbose)
+	{
+		va_list ap;
+
+		va_start(ap, str);
+		vprintf(str, ap);
+		va_end(ap);
+	}
+}
+
+/* *************************************
+ * 	System
+ * *************************************/
+
+bool SystemOpenFile(const char* fname, uint32_t* const ptrSize)
+{
+	BenchOpenedFile = BenchFindFile(fname);
+	BenchFileOffset = 0;
+
+	if (BenchOpenedFile == NULL)
+	{
+		Serial_printf("SystemOpenFile: file could not be found!\n");
+		return false;
+	}
+
+	if (ptrSize != NULL)
+	{
+		*ptrSize = BenchOpenedFile->size;
+	}
+
+	return true;
+}
+
+uint32_t SystemReadFileChunk(uint8_t* const buffer, const uint32_t szBuffer)
+{
+	uint32_t bytes_to_read;
+
+	if (BenchOpenedFile == NULL)
+	{
+		return 0;
+	}
+
+	bytes_to_read = BenchOpenedFile->size - BenchFileOffset;
+
+	if (bytes_to_read > szBuffer)
+	{
+		bytes_to_read = szBuffer;
+	}
+
+	memcpy(buffer, &BenchOpenedFile->data[BenchFileOffset], bytes_to_read);
+	BenchFileOffset += bytes_to_read;
+
+	return bytes_to_read;
+}
+
+void SystemCloseFile(void)
+{
+	BenchOpenedFile = NULL;
+}
+
+bool SystemLoadFile(const char* fname)
+{
+	const TYPE_BENCH_FILE* const ptrFile = BenchFindFile(fname);
+
+	if ((ptrFile == NULL) || (ptrFile->size > sizeof (BenchFileBuffer)))
+	{
+		return false;
+	}
+
+	memcpy(BenchFileBuffer, ptrFile->data, ptrFile->size);
+
+	return true;
+}
+
+uint8_t* SystemGetBufferAddress(void)
+{
+	return BenchFileBuffer;
+}
+
+void SystemClearFileBuffer(void)
+{
+	memset(BenchFileBuffer, 0, sizeof (BenchFileBuffer));
+}
+
+uint32_t SystemRand(uint32_t min, uint32_t max)
+{
+	return rand() % (max - min + 1) + min;
+}
+
+bool SystemContains_u8(const uint8_t value, const uint8_t* const buffer, const size_t sz)
+{
+	size_t i;
+
+	for (i = 0; i < sz; i++)
+	{
+		if (buffer[i] == value)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool SystemContains_u16(const uint16_t value, const uint16_t* const buffer, const size_t sz)
+{
+	size_t i;
+
+	for (i = 0; i < sz; i++)
+	{
+		if (buffer[i] == value)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int32_t SystemIndexOfStringArray(const char* str, const char* const* array)
+{
+	int32_t i;
+
+	for (i = 0; array[i] != NULL; i++)
+	{
+		if (strcmp(str, array[i]) == 0)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+int32_t SystemIndexOf_U16(const uint16_t value, const uint16_t* const array, const uint32_t sz)
+{
+	uint32_t i;
+
+	for (i = 0; i < sz; i++)
+	{
+		if (value == array[i])
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+/* *******************************************************************
+ *
+ * @name: void SystemCyclicHandler(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Called by GfxDrawScene() once per frame. Ticks are derived from
+ *  the number of frames drawn instead of VBlank interrupts, using
+ *  the same periods as SystemRunTimers(), so game time does not
+ *  depend on host speed.
+ *
+ * @remarks:
+ *  Benchmarks never call GfxDrawScene(), so ticks remain disabled
+ *  and every run executes the same code paths.
+ *
+ * *******************************************************************/
+void SystemCyclicHandler(void)
+{
+	BenchPadOneKey = 0;
+	BenchFrames++;
+
+	BenchOneSecondTick = (BenchFrames % REFRESH_FREQUENCY) == 0;
+#ifdef _PAL_MODE_
+	BenchHundredMsTick = (BenchFrames % 2) == 0;
+	BenchFiveHundredMsTick = (BenchFrames % 10) == 0;
+#else // _PAL_MODE_
+	BenchHundredMsTick = (BenchFrames % 3) == 0;
+#endif // _PAL_MODE_
+
+	TimerHandler();
+}
+
+unsigned char SystemGetSineValue(void)				{ return 0; }
+bool System100msTick(void)							{ return BenchHundredMsTick; }
+bool System500msTick(void)							{ return BenchFiveHundredMsTick; }
+bool System1SecondTick(void)						{ return BenchOneSecondTick; }
+bool SystemRefreshNeeded(void)						{ return true; }
+void SystemDevMenu(void)							{ }
+bool SystemIsDevMenuEnabled(void)					{ return false; }
+bool SystemGetEmergencyMode(void)					{ return false; }
+void SystemSetEmergencyMode(bool value)				{ (void)value; }
+
+/* *************************************
+ * 	PSXSDK GPU
+ * *************************************/
+
+static void BenchSortPacket(const unsigned int nWords)
+{
+	if (BenchPrimList == NULL)
+	{
+		return;
+	}
+
+	BenchPrimList[BenchPrimListPos] = nWords << 24;
+	memset(&BenchPrimList[BenchPrimListPos + 1], 0, nWords * sizeof (unsigned int));
+	BenchPrimListPos += 1 + nWords;
+}
+
+void GsSetList(unsigned int* listptr)
+{
+	BenchPrimList = listptr;
+	BenchPrimListPos = 0;
+}
+
+int GsListPos(void)									{ return BenchPrimListPos; }
+void GsDrawList(void)								{ }
+int GsIsDrawing(void)								{ return 0; }
+void GsSortSprite(GsSprite* spr)					{ (void)spr; BenchSortPacket(BENCH_SPRITE_WORDS); }
+void GsSortRectangle(GsRectangle* rect)				{ (void)rect; BenchSortPacket(BENCH_RECTANGLE_WORDS); }
+void GsSortGPoly4(GsGPoly4* poly)					{ (void)poly; BenchSortPacket(BENCH_GPOLY4_WORDS); }
+void GsSortTPoly4(GsTPoly4* poly)					{ (void)poly; BenchSortPacket(BENCH_TPOLY4_WORDS); }
+void GsSortLine(GsLine* line)						{ (void)line; BenchSortPacket(BENCH_LINE_WORDS); }
+void GsSortCls(int r, int g, int b)					{ (void)r; (void)g; (void)b; BenchSortPacket(BENCH_CLS_WORDS); }
+void GsSetDrawEnv(GsDrawEnv* env)					{ (void)env; }
+void GsSetDrawEnv_DMA(GsDrawEnv* env)				{ (void)env; }
+void GsSetDispEnv(GsDispEnv* env)					{ (void)env; }
+int GsImageFromTim(GsImage* image, void* timdata)	{ (void)timdata; memset(image, 0, sizeof (*image)); return 0; }
+void GsUploadCLUT(GsImage* image)					{ (void)image; }
+
+int GsSpriteFromImage(GsSprite* sprite, GsImage* image, int do_upload)
+{
+	(void)do_upload;
+
+	memset(sprite, 0, sizeof (*sprite));
+	sprite->w = image->w;
+	sprite->h = image->h;
+
+	return 0;
+}
+
+/* *************************************
+ * 	LoadMenu
+ * *************************************/
+
+/* *******************************************************************
+ *
+ * @name: void LoadMenu(const char* const fileList[], void* const dest[], uint8_t szFileList, uint8_t szDestList)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Only *.PLT files are parsed, as done by LoadMenuLoadFileList().
+ *  Images and sounds have no use on host builds.
+ *
+ * *******************************************************************/
+void LoadMenu(	const char*	const fileList[],
+				void* const dest[],
+				uint8_t szFileList	, uint8_t szDestList)
+{
+	uint8_t i;
+
+	for (i = 0; (i < szFileList) && (i < szDestList); i++)
+	{
+		const char* const extension = strrchr(fileList[i], '.');
+
+		if ((extension != NULL) && (strcmp(extension, ".PLT") == 0))
+		{
+			if (PltParserLoadFile(fileList[i], dest[i]) == false)
+			{
+				Serial_printf("Could not load pilots file \"%s\"!\n", fileList[i]);
+			}
+		}
+	}
+}
+
+/* *************************************
+ * 	GameGui
+ * *************************************/
+
+static bool BenchPauseDialogHandler(TYPE_DIALOG* const ptrDialog)
+{
+	return (ptrDialog->PadKeySinglePress_Callback(PAD_START) == false);
+}
+
+static void BenchPauseDialogRender(const TYPE_DIALOG* const ptrDialog)
+{
+	(void)ptrDialog;
+}
+
+static TYPE_DIALOG BenchPauseDialog =
+{
+	.Policy = DIALOG_POLICY_PAUSE,
+	.Handler = BenchPauseDialogHandler,
+	.Render = BenchPauseDialogRender
+};
+
+/* *******************************************************************
+ *
+ * @name: void GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Opens a pause dialog which is closed by PAD_START, as done by
+ *  GameGui, so pause/resume goes through Dialog.c as on target.
+ *
+ * *******************************************************************/
+void GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
+{
+	BenchPauseDialog.PadKeySinglePress_Callback = ptrPlayer->PadKeySinglePress_Callback;
+	DialogOpen(&BenchPauseDialog);
+}
+
+/* *************************************
+ * 	Other modules
+ * *************************************/
+
+// Game modules which are not benchmarked. They are replaced
+// by no-ops, so they do not pull any hardware access.
+
+void AssetCacheAdd(const char* strPath, const void* const dest, const ASSET_RESIDENCY residency)	{ (void)strPath; (void)dest; (void)residency; }
+void AssetCacheAddImage(const char* strPath, const void* const dest, const GsImage* const gsi)		{ (void)strPath; (void)dest; (void)gsi; }
+bool AssetCacheIsResident(const char* strPath, const void* const dest)								{ (void)strPath; (void)dest; return false; }
+void AssetCacheRemove(const void* const dest)														{ (void)dest; }
+
+void EndAnimation(void)																				{ }
+
+void GameGuiInit(void)																				{ }
+void GameGuiActiveAircraftPage(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)	{ (void)ptrPlayer; (void)ptrFlightData; }
+void GameGuiAircraftCollision(TYPE_PLAYER* const ptrPlayer)											{ (void)ptrPlayer; }
+void GameGuiAircraftList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)		{ (void)ptrPlayer; (void)ptrFlightData; }
+void GameGuiBubble(TYPE_FLIGHT_DATA* const ptrFlightData)											{ (void)ptrFlightData; }
+void GameGuiBubbleShow(void)																		{ }
+void GameGuiCalculateNextAircraftTime(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)	{ (void)ptrPlayer; (void)ptrFlightData; }
+void GameGuiCalculateSlowScore(void)																{ }
+void GameGuiClock(uint8_t hour, uint8_t min)														{ (void)hour; (void)min; }
+bool GameGuiDialogExit(void)																		{ return false; }
+void GameGuiDrawUnboardingSequence(TYPE_PLAYER* const ptrPlayer)									{ (void)ptrPlayer; }
+void GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)											{ (void)ptrPlayer; }
+bool GameGuiShowAircraftDataSpecialConditions(TYPE_PLAYER* const ptrPlayer)							{ (void)ptrPlayer; return false; }
+void GameGuiShowPassengersLeft(TYPE_PLAYER* const ptrPlayer)										{ (void)ptrPlayer; }
+void GameGuiShowScore(void)																			{ }
+
+void LoadMenuEnd(void)																				{ }
+
+void MessageInit(void)																				{ }
+void MessageHandler(void)																			{ }
+bool MessageCreate(TYPE_MESSAGE_DATA* ptrMessage)													{ (void)ptrMessage; return true; }
+
+bool PadOneConnected(void)																			{ return true; }
+bool PadOneDirectionKeyPressed(void)																{ return BenchPadOneKey & (PAD_UP | PAD_DOWN | PAD_LEFT | PAD_RIGHT); }
+unsigned short PadOneGetLastKeySinglePressed(void)													{ return BenchPadOneKey; }
+bool PadOneKeyPressed(unsigned short key)															{ return BenchPadOneKey == key; }
+bool PadOneKeyReleased(unsigned short key)															{ (void)key; return false; }
+bool PadOneKeySinglePress(unsigned short key)														{ return BenchPadOneKey == key; }
+bool PadTwoConnected(void)																			{ return true; }
+bool PadTwoDirectionKeyPressed(void)																{ return false; }
+unsigned short PadTwoGetLastKeySinglePressed(void)													{ return 0; }
+bool PadTwoKeyPressed(unsigned short key)															{ (void)key; return false; }
+bool PadTwoKeyReleased(unsigned short key)															{ (void)key; return false; }
+bool PadTwoKeySinglePress(unsigned short key)														{ (void)key; return false; }
+
+void SfxPlaySound(SsVag* sound)																		{ (void)sound; }
+void SfxPlaySound_Ex(SsVag* sound, const SFX_PRIORITY priority)										{ (void)sound; (void)priority; }
+void SfxPlayTrack(MUSIC_TRACKS track)																{ (void)track; }
+
+bool VramPlaceImage(GsImage* const gsi)																{ (void)gsi; return true; }
+bool VramPlaceCLUT(GsImage* const gsi)																{ (void)gsi; return true; }
+bool VramReserve(short x, short y, short w, short h, const VRAM_OWNER owner)						{ (void)x; (void)y; (void)w; (void)h; (void)owner; return true; }
+VRAM_OWNER VramSetOwner(const VRAM_OWNER owner)														{ return owner; }
+void VramFree(short x, short y)																		{ (void)x; (void)y; }
+void VramPrintStats(void)																			{ }
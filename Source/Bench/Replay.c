@@ -0,0 +1,1392 @@
+/* *************************************************************************
+ *
+ * Replay: host-side runner which plays every level shipped with the game.
+ *
+ * Each LVL/PLT combination listed on LevelList.h (the same tables used
+ * by main menu) is loaded through GameInit() and played from start to
+ * end, using the same modules and stubs as Bench (see BenchStubs.c).
+ * Game time is derived from the number of frames drawn, so results do
+ * not depend on host speed.
+ *
+ * Pad input is generated by a deterministic autopilot, which presses
+ * the same keys a player would (one key per frame, followed by a frame
+ * without any key, so every press is seen as a single press):
+ *  - Arrivals: clearance to land on a free runway, taxi to a free
+ *    parking and key sequences for unboarding.
+ *  - Departures: taxi to a runway holding point, clearance to enter
+ *    the runway and takeoff clearance.
+ * Aircraft list navigation and cursor movement are done by setting
+ * TYPE_PLAYER::SelectedAircraft and camera position directly, as
+ * GameGui and pad direction keys are not available. Taxi paths are
+ * built by pressing PAD_CROSS on each corner, as done by the player,
+ * so GamePathToTile() validates them as usual.
+ *
+ * Before levels are played, PAD_START is pressed twice on LEVEL1 to
+ * check the pause dialog halts the simulation and lets it resume.
+ *
+ * Game.c is included below, so its static functions and data can be
+ * read by the autopilot without modifying the module.
+ *
+ * Build (see CMakeLists.txt in this directory):
+ *  cmake -S Source/Bench -B build-bench
+ *  cmake --build build-bench --target replay
+ *
+ * Usage:
+ *  replay [options] [name filter]
+ *
+ *  --levels DIR        Directory containing *.LVL and *.PLT files.
+ *  --baseline FILE     Baseline file. Default: replay_baseline.txt from this directory.
+ *  --threshold PCT     Also fails levels whose cost per frame is PCT% above
+ *                      baseline. Disabled by default.
+ *  --update-baseline   Writes measured values into baseline file.
+ *  --trace             Prints keys pressed by the autopilot.
+ *  --verbose           Prints messages from game modules.
+ *
+ * End-of-level invariants are checked for each level:
+ *  - All flights must be finished before REPLAY_MAX_FRAMES.
+ *  - No aircraft collisions.
+ *  - Number of frames, score returned by GameGetScore() and number
+ *    of lost flights must match the baseline, so optimisations can
+ *    be verified not to change game behaviour. They must also match
+ *    between samples, or replay is not deterministic.
+ * Exit status is 1 if any of these checks fails.
+ *
+ * Simulation (GameCalculations()) and rendering (GameGraphics()) cost
+ * per frame is measured REPLAY_SAMPLES times, and the fastest sample is
+ * printed next to the baseline for information only: it is a wall-clock
+ * time of a few microseconds, recorded on another machine, so it is
+ * not reliable enough to fail on. --threshold turns it into a check for
+ * comparisons made on the same, otherwise idle, machine.
+ *
+ * *************************************************************************/
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "../Game.c"
+#include "Bench.h"
+#include "LevelList.h"
+#include <time.h>
+#include <errno.h>
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#ifndef BENCH_LEVELS_DIR
+#define BENCH_LEVELS_DIR			"Levels"
+#endif // BENCH_LEVELS_DIR
+
+#ifndef REPLAY_BASELINE_FILE
+#define REPLAY_BASELINE_FILE		"replay_baseline.txt"
+#endif // REPLAY_BASELINE_FILE
+
+#define REPLAY_SAMPLES				3
+#define REPLAY_RETRIES				2
+#define REPLAY_MAX_NAME				32
+#define REPLAY_MAX_COMBINATIONS		16
+#define REPLAY_MAX_PLT_SIZE			0x4000
+#define REPLAY_SEED					1
+// 30 minutes of game time.
+#define REPLAY_MAX_FRAMES			(REFRESH_FREQUENCY * 60 * 30)
+// Frames to wait before trying again with a flight
+// whose instructions were cancelled.
+#define REPLAY_RETRY_FRAMES			REFRESH_FREQUENCY
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_replayResult
+{
+	char name[REPLAY_MAX_NAME];
+	uint32_t frames;
+	uint32_t score;
+	uint32_t lost;
+	// Average cost per frame, in nanoseconds.
+	double simNs;
+	double renderNs;
+	bool finished;
+	bool collision;
+}TYPE_REPLAY_RESULT;
+
+typedef struct t_replayPilot
+{
+	// Flight which is being given instructions.
+	uint8_t flight;
+	// Key pressed on last frame, or 0.
+	unsigned short lastKey;
+	// Taxi path for flight, as a list of corners.
+	uint16_t corners[PLAYER_MAX_WAYPOINTS];
+	uint8_t nCorners;
+	uint8_t cornerIdx;
+	// Passengers left when unboarding was started.
+	uint8_t passengers;
+	uint32_t retryFrame[GAME_MAX_AIRCRAFT];
+	uint32_t frame;
+}TYPE_REPLAY_PILOT;
+
+/* *************************************
+ * 	Local variables
+ * *************************************/
+
+static TYPE_REPLAY_PILOT Pilot;
+static bool ReplayTrace;
+static uint8_t ReplayLevelData[LEVEL_HEADER_SIZE + (GAME_MAX_MAP_SIZE * sizeof (uint16_t))];
+static uint8_t ReplayPltData[REPLAY_MAX_PLT_SIZE];
+
+/* *************************************
+ * 	Autopilot
+ * *************************************/
+
+static uint8_t ReplayTileType(const uint16_t tile)
+{
+	// Building data and mirror flag are ignored.
+	return (uint8_t)levelBuffer[tile] & ~TILE_MIRROR_FLAG;
+}
+
+static bool ReplayIsParking(const uint16_t tile)
+{
+	// Same check as GameStateSelectTaxiwayParking().
+	const uint16_t tileData = levelBuffer[tile] & ~TILE_MIRROR_FLAG;
+
+	return (tileData == TILE_PARKING) || (tileData == TILE_PARKING_2);
+}
+
+static bool ReplayIsHoldingPoint(const uint16_t tile)
+{
+	// Same check as GameStateSelectTaxiwayRunway().
+	switch (levelBuffer[tile])
+	{
+		case TILE_RWY_HOLDING_POINT:
+			// Fall through
+		case TILE_RWY_HOLDING_POINT | TILE_MIRROR_FLAG:
+			// Fall through
+		case TILE_RWY_HOLDING_POINT_2:
+			// Fall through
+		case TILE_RWY_HOLDING_POINT_2 | TILE_MIRROR_FLAG:
+		return true;
+
+		default:
+		return false;
+	}
+}
+
+static bool ReplayIsTaxiway(const uint16_t tile)
+{
+	// Tiles accepted by GamePathToTile(), except runway, parking
+	// and holding point tiles, which can only be used as start
+	// or end points so aircraft never block each other.
+	static const uint8_t TaxiwayTiles[] =
+	{
+		TILE_ASPHALT_WITH_BORDERS,
+		TILE_TAXIWAY_CORNER_GRASS,
+		TILE_TAXIWAY_CORNER_GRASS_2,
+		TILE_TAXIWAY_GRASS,
+		TILE_TAXIWAY_INTERSECT_GRASS,
+		TILE_TAXIWAY_4WAY_CROSSING,
+		TILE_TAXIWAY_CORNER_GRASS_3
+	};
+
+	return SystemContains_u8(ReplayTileType(tile), TaxiwayTiles, sizeof (TaxiwayTiles));
+}
+
+static bool ReplayHasAircraft(const uint8_t i)
+{
+	// Flights on STATE_APPROACH are not linked to any aircraft yet.
+	return	(FlightData.State[i] != STATE_IDLE)
+				&&
+			(FlightData.State[i] != STATE_APPROACH)
+				&&
+			(AircraftFromFlightDataIndex(i) != NULL);
+}
+
+/* *******************************************************************
+ *
+ * @name: void ReplayGetBusyTiles(bool* const busy, const uint8_t self)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Marks tiles where any aircraft other than self is placed, as well
+ *  as remaining targets for aircraft moving on ground, so taxi paths
+ *  never cross each other.
+ *
+ * *******************************************************************/
+static void ReplayGetBusyTiles(bool* const busy, const uint8_t self)
+{
+	uint8_t i;
+
+	memset(busy, 0, GameLevelSize * sizeof (bool));
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		if ((i == self) || (ReplayHasAircraft(i) == false))
+		{
+			continue;
+		}
+
+		busy[AircraftGetTileFromFlightDataIndex(i) % GameLevelSize] = true;
+
+		switch (FlightData.State[i])
+		{
+			case STATE_TAXIING:
+				// Fall through
+			case STATE_USER_STOPPED:
+				// Fall through
+			case STATE_AUTO_STOPPED:
+				// Fall through
+			case STATE_ENTERING_RWY:
+			{
+				const TYPE_AIRCRAFT_DATA* const ptrAircraft = AircraftFromFlightDataIndex(i);
+				uint8_t j;
+
+				for (j = ptrAircraft->TargetIdx; (j < AIRCRAFT_MAX_TARGETS) && (ptrAircraft->Target[j] != 0); j++)
+				{
+					busy[ptrAircraft->Target[j] % GameLevelSize] = true;
+				}
+			}
+			break;
+
+			default:
+			break;
+		}
+	}
+}
+
+static bool ReplayIsPendingDeparture(const uint16_t tile)
+{
+	uint8_t i;
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		if (	(FlightData.FlightDirection[i] == DEPARTURE)
+					&&
+				(FlightData.State[i] == STATE_IDLE)
+					&&
+				(FlightData.Finished[i] == false)
+					&&
+				(FlightData.Parking[i] == tile)	)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+/* *******************************************************************
+ *
+ * @name: bool ReplayPlanRoute(const uint8_t i)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Looks for the shortest path from aircraft position to a free
+ *  parking (arrivals) or runway holding point (departures), and
+ *  stores its corners into Pilot.
+ *
+ * @remarks:
+ *  Arrivals first try to avoid parking tiles used by departures
+ *  which have not appeared yet, or they would be delayed.
+ *
+ * @return:
+ *  true if a path was found, false otherwise.
+ *
+ * *******************************************************************/
+static bool ReplayPlanRoute(const uint8_t i)
+{
+	static bool busy[GAME_MAX_MAP_SIZE];
+	static uint16_t prev[GAME_MAX_MAP_SIZE];
+	static uint16_t queue[GAME_MAX_MAP_SIZE];
+	static uint16_t path[GAME_MAX_MAP_SIZE];
+	const uint16_t start = AircraftGetTileFromFlightDataIndex(i);
+	const bool arrival = FlightData.FlightDirection[i] == ARRIVAL;
+	uint8_t pass;
+
+	if (start >= GameLevelSize)
+	{
+		return false;
+	}
+
+	ReplayGetBusyTiles(busy, i);
+
+	for (pass = 0; pass < (arrival ? 2 : 1); pass++)
+	{
+		uint16_t head = 0;
+		uint16_t tail = 0;
+		uint16_t dest = 0;
+
+		memset(prev, 0xFF, sizeof (prev));
+		prev[start] = start;
+		queue[tail++] = start;
+
+		while ((head < tail) && (dest == 0))
+		{
+			const uint16_t tile = queue[head++];
+			const uint8_t column = tile % GameLevelColumns;
+			const int32_t neighbours[] =
+			{
+				(tile >= GameLevelColumns) ? tile - GameLevelColumns : -1,
+				(column < (GameLevelColumns - 1)) ? tile + 1 : -1,
+				((tile + GameLevelColumns) < GameLevelSize) ? tile + GameLevelColumns : -1,
+				(column > 0) ? tile - 1 : -1
+			};
+
+			size_t n;
+
+			for (n = 0; n < ARRAY_SIZE(neighbours); n++)
+			{
+				const int32_t next = neighbours[n];
+
+				// Tile 0 cannot be used, as it ends waypoint lists.
+				if ((next <= 0) || (prev[next] != 0xFFFF) || busy[next])
+				{
+					continue;
+				}
+
+				if (arrival ? ReplayIsParking(next) : ReplayIsHoldingPoint(next))
+				{
+					if ((pass == 0) && arrival && ReplayIsPendingDeparture(next))
+					{
+						continue;
+					}
+
+					prev[next] = tile;
+					dest = next;
+					break;
+				}
+				else if (ReplayIsTaxiway(next))
+				{
+					prev[next] = tile;
+					queue[tail++] = next;
+				}
+			}
+		}
+
+		if (dest != 0)
+		{
+			uint16_t len = 0;
+			uint16_t tile;
+			uint16_t k;
+
+			for (tile = dest; tile != start; tile = prev[tile])
+			{
+				path[len++] = tile;
+			}
+
+			// First waypoint is aircraft position.
+			if (len >= PLAYER_MAX_WAYPOINTS)
+			{
+				return false;
+			}
+
+			path[len] = start;
+			Pilot.nCorners = 0;
+			Pilot.cornerIdx = 0;
+
+			// path[] is reversed: path[len] is the start point.
+			for (k = len; k > 0; k--)
+			{
+				const uint16_t current = path[k - 1];
+
+				if (	(k == 1)
+							||
+						((current - path[k]) != (path[k - 2] - current))	)
+				{
+					Pilot.corners[Pilot.nCorners++] = current;
+				}
+			}
+
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool ReplayRunwayFree(const uint16_t rwyHeader, const uint8_t self)
+{
+	uint16_t rwyArray[GAME_MAX_RWY_LENGTH];
+	uint8_t i;
+
+	if (	(rwyHeader == 0)
+				||
+			SystemContains_u16(rwyHeader, GameUsedRwy, GAME_MAX_RUNWAYS)	)
+	{
+		return false;
+	}
+
+	GameGetSelectedRunwayArray(rwyHeader, rwyArray, sizeof (rwyArray));
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		if ((i != self) && ReplayHasAircraft(i))
+		{
+			const uint16_t tile = AircraftGetTileFromFlightDataIndex(i);
+			uint8_t j;
+
+			for (j = 0; (j < GAME_MAX_RWY_LENGTH) && (rwyArray[j] != 0); j++)
+			{
+				if (rwyArray[j] == tile)
+				{
+					return false;
+				}
+			}
+		}
+	}
+
+	return true;
+}
+
+static int8_t ReplayFreeRunway(void)
+{
+	int8_t i;
+
+	for (i = 0; (i < GAME_MAX_RUNWAYS) && (GameRwy[i] != 0); i++)
+	{
+		if (ReplayRunwayFree(GameRwy[i], FLIGHT_DATA_INVALID_IDX))
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static uint16_t ReplayHoldingRunway(const uint8_t i)
+{
+	TYPE_RWY_ENTRY_DATA rwyEntryData = {0};
+
+	GameGetRunwayEntryTile(i, &rwyEntryData);
+
+	return rwyEntryData.rwyHeader;
+}
+
+/* *******************************************************************
+ *
+ * @name: int ReplayPriority(const uint8_t i)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Priority for flight i (lower is more urgent), or -1 if flight does
+ *  not need any instructions right now. Aircraft on runways go
+ *  first, so they can be used by other flights as soon as possible.
+ *
+ * *******************************************************************/
+static int ReplayPriority(const uint8_t i)
+{
+	if (	(FlightData.Finished[i] != false)
+				||
+			(Pilot.retryFrame[i] > Pilot.frame)	)
+	{
+		return -1;
+	}
+
+	switch (FlightData.State[i])
+	{
+		case STATE_READY_FOR_TAKEOFF:
+		return 0;
+
+		case STATE_HOLDING_RWY:
+		return ReplayRunwayFree(ReplayHoldingRunway(i), i) ? 1 : -1;
+
+		case STATE_LANDED:
+		return ReplayPlanRoute(i) ? 2 : -1;
+
+		case STATE_APPROACH:
+		return (ReplayFreeRunway() >= 0) ? 3 : -1;
+
+		case STATE_PARKED:
+		return ReplayPlanRoute(i) ? 4 : -1;
+
+		case STATE_UNBOARDING:
+		return 5;
+
+		default:
+		return -1;
+	}
+}
+
+static uint8_t ReplayNextFlight(const bool unboarding)
+{
+	uint8_t best = FLIGHT_DATA_INVALID_IDX;
+	int bestPriority = 0;
+	uint8_t i;
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		const int priority = ReplayPriority(i);
+
+		if (	(priority < 0)
+					||
+				((unboarding == false) && (FlightData.State[i] == STATE_UNBOARDING))	)
+		{
+			continue;
+		}
+
+		if (	(best == FLIGHT_DATA_INVALID_IDX)
+					||
+				(priority < bestPriority)
+					||
+				((priority == bestPriority) && (FlightData.RemainingTime[i] < FlightData.RemainingTime[best]))	)
+		{
+			best = i;
+			bestPriority = priority;
+		}
+	}
+
+	// Route for selected flight is needed later.
+	if ((best != FLIGHT_DATA_INVALID_IDX) && ((bestPriority == 2) || (bestPriority == 4)))
+	{
+		ReplayPlanRoute(best);
+	}
+
+	return best;
+}
+
+static unsigned short ReplayCancel(const char* const reason)
+{
+	if (Pilot.flight != FLIGHT_DATA_INVALID_IDX)
+	{
+		Pilot.retryFrame[Pilot.flight] = Pilot.frame + REPLAY_RETRY_FRAMES;
+	}
+
+	if (ReplayTrace)
+	{
+		printf("%6u: cancelled instructions for flight %d: %s\n", Pilot.frame, Pilot.flight, reason);
+	}
+
+	return PAD_TRIANGLE;
+}
+
+/* *******************************************************************
+ *
+ * @name: unsigned short ReplayPilotDecide(TYPE_PLAYER* const ptrPlayer)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Key to be pressed on current frame depending on player state,
+ *  or 0 if no key must be pressed.
+ *
+ * *******************************************************************/
+static unsigned short ReplayPilotDecide(TYPE_PLAYER* const ptrPlayer)
+{
+	if (ptrPlayer->Unboarding)
+	{
+		const uint8_t flight = ptrPlayer->FlightDataSelectedAircraft;
+
+		// Leave after each completed sequence if other flights need instructions.
+		if (	(ptrPlayer->UnboardingSequenceIdx == 0)
+					&&
+				(FlightData.Passengers[flight] < Pilot.passengers)
+					&&
+				(ReplayNextFlight(false) != FLIGHT_DATA_INVALID_IDX)	)
+		{
+			return PAD_CIRCLE;
+		}
+
+		return ptrPlayer->UnboardingSequence[ptrPlayer->UnboardingSequenceIdx];
+	}
+	else if (ptrPlayer->SelectRunway)
+	{
+		const uint8_t flight = ptrPlayer->FlightDataSelectedAircraft;
+
+		if (flight != Pilot.flight)
+		{
+			return ReplayCancel("unexpected flight selected");
+		}
+
+		if (FlightData.State[flight] == STATE_APPROACH)
+		{
+			const int8_t rwy = ReplayFreeRunway();
+
+			if (rwy < 0)
+			{
+				return ReplayCancel("no free runways");
+			}
+			else if (ptrPlayer->SelectedRunway < rwy)
+			{
+				return PAD_RIGHT;
+			}
+			else if (ptrPlayer->SelectedRunway > rwy)
+			{
+				return PAD_LEFT;
+			}
+
+			return PAD_CROSS;
+		}
+		else if (	(FlightData.State[flight] == STATE_HOLDING_RWY)
+						&&
+					ReplayRunwayFree(GameRwy[ptrPlayer->SelectedRunway], flight)	)
+		{
+			return PAD_CROSS;
+		}
+
+		return ReplayCancel("runway is busy");
+	}
+	else if (ptrPlayer->SelectTaxiwayParking || ptrPlayer->SelectTaxiwayRunway)
+	{
+		const uint16_t corner = Pilot.corners[Pilot.cornerIdx];
+		TYPE_ISOMETRIC_POS IsoPos;
+
+		if (ptrPlayer->FlightDataSelectedAircraft != Pilot.flight)
+		{
+			return ReplayCancel("unexpected flight selected");
+		}
+		else if (	(Pilot.cornerIdx != 0)
+						&&
+					(ptrPlayer->Waypoints[ptrPlayer->LastWaypointIdx] != Pilot.corners[Pilot.cornerIdx - 1])	)
+		{
+			return ReplayCancel("invalid path");
+		}
+		else if (Pilot.cornerIdx >= Pilot.nCorners)
+		{
+			return ReplayCancel("path was not accepted");
+		}
+		else if (ptrPlayer->LockTarget)
+		{
+			// Camera is moved back to locked aircraft on this frame.
+			return 0;
+		}
+
+		// Move cursor to next corner.
+		IsoPos.x = GameGetXFromTile_short(corner);
+		IsoPos.y = GameGetYFromTile_short(corner);
+		IsoPos.z = 0;
+
+		CameraMoveToIsoPos(ptrPlayer, IsoPos);
+
+		Pilot.cornerIdx++;
+
+		return PAD_CROSS;
+	}
+	else if (ptrPlayer->ShowAircraftData)
+	{
+		uint8_t j;
+
+		Pilot.flight = ReplayNextFlight(true);
+
+		if (Pilot.flight == FLIGHT_DATA_INVALID_IDX)
+		{
+			return PAD_TRIANGLE;
+		}
+
+		// Select flight from aircraft list.
+		for (j = 0; j < ptrPlayer->ActiveAircraft; j++)
+		{
+			if (ptrPlayer->ActiveAircraftList[j] == Pilot.flight)
+			{
+				ptrPlayer->SelectedAircraft = j;
+				Pilot.passengers = FlightData.Passengers[Pilot.flight];
+				return PAD_CROSS;
+			}
+		}
+
+		return ReplayCancel("flight not found on aircraft list");
+	}
+	else if (ReplayNextFlight(true) != FLIGHT_DATA_INVALID_IDX)
+	{
+		// Show aircraft list.
+		return PAD_CIRCLE;
+	}
+
+	return 0;
+}
+
+static const char* ReplayKeyName(const unsigned short key)
+{
+	switch (key)
+	{
+		case PAD_CROSS:		return "CROSS";
+		case PAD_CIRCLE:	return "CIRCLE";
+		case PAD_SQUARE:	return "SQUARE";
+		case PAD_TRIANGLE:	return "TRIANGLE";
+		case PAD_LEFT:		return "LEFT";
+		case PAD_RIGHT:		return "RIGHT";
+		default:			return "?";
+	}
+}
+
+/* *******************************************************************
+ *
+ * @name: unsigned short ReplayPilot(TYPE_PLAYER* const ptrPlayer)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Called once per frame before game calculations. Keys are
+ *  released on the frame after being pressed, as a single press
+ *  would not be detected otherwise when the same key is pressed
+ *  twice in a row.
+ *
+ * *******************************************************************/
+static unsigned short ReplayPilot(TYPE_PLAYER* const ptrPlayer)
+{
+	unsigned short key = 0;
+
+	if (Pilot.lastKey == 0)
+	{
+		key = ReplayPilotDecide(ptrPlayer);
+
+		if (ReplayTrace && (key != 0))
+		{
+			const uint8_t flight = ptrPlayer->Unboarding ? ptrPlayer->FlightDataSelectedAircraft : Pilot.flight;
+
+			if (flight < FlightData.nAircraft)
+			{
+				printf("%6u: %-8s flight %d, state %d\n", Pilot.frame, ReplayKeyName(key), flight, FlightData.State[flight]);
+			}
+			else
+			{
+				printf("%6u: %-8s\n", Pilot.frame, ReplayKeyName(key));
+			}
+		}
+	}
+
+	Pilot.lastKey = key;
+
+	return key;
+}
+
+/* *************************************
+ * 	Measurement
+ * *************************************/
+
+static double ReplayNow(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ((double)ts.tv_sec * 1e9) + (double)ts.tv_nsec;
+}
+
+static uint32_t ReplayLoadFile(const char* const levelsDir, const char* const path, uint8_t* const buffer, const size_t sz)
+{
+	// CD-ROM paths are mapped to files with the same name inside levelsDir.
+	const char* const name = strrchr(path, '\\') != NULL ? strrchr(path, '\\') + 1 : path;
+	char hostPath[512];
+	FILE* f;
+	size_t size;
+
+	snprintf(hostPath, sizeof (hostPath), "%s/%s", levelsDir, name);
+
+	f = fopen(hostPath, "rb");
+
+	if (f == NULL)
+	{
+		fprintf(stderr, "Could not open %s: %s\n", hostPath, strerror(errno));
+		return 0;
+	}
+
+	size = fread(buffer, sizeof (uint8_t), sz, f);
+
+	fclose(f);
+
+	BenchRegisterFile(path, buffer, size);
+
+	return size;
+}
+
+/* *******************************************************************
+ *
+ * @name: bool ReplayRun(const char* const lvlPath, const char* const pltPath, TYPE_REPLAY_RESULT* const ptrResult)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Plays a level until all flights are finished, a collision is
+ *  found or REPLAY_MAX_FRAMES are reached. Game() main loop is
+ *  replicated here, so calculations and rendering can be timed
+ *  separately.
+ *
+ * @return:
+ *  false if level could not be loaded, true otherwise.
+ *
+ * *******************************************************************/
+static bool ReplayRun(const char* const lvlPath, const char* const pltPath, TYPE_REPLAY_RESULT* const ptrResult)
+{
+	const TYPE_GAME_CONFIGURATION cfg =
+	{
+		.TwoPlayers = false,
+		.LVLPath = lvlPath,
+		.PLTPath = pltPath
+	};
+
+	TYPE_PLAYER* const ptrPlayer = &PlayerData[PLAYER_ONE];
+	double simNs = 0.0;
+	double renderNs = 0.0;
+	uint8_t i;
+
+	memset(&Pilot, 0, sizeof (Pilot));
+	Pilot.flight = FLIGHT_DATA_INVALID_IDX;
+
+	srand(REPLAY_SEED);
+	BenchResetTicks();
+
+	twoPlayers = cfg.TwoPlayers;
+	GameInit(&cfg);
+
+	if ((GameLevelSize == 0) || (FlightData.nAircraft == 0))
+	{
+		fprintf(stderr, "Could not load %s and %s!\n", lvlPath, pltPath);
+		return false;
+	}
+
+	ptrResult->finished = false;
+	ptrResult->collision = false;
+
+	for (Pilot.frame = 0; Pilot.frame < REPLAY_MAX_FRAMES; Pilot.frame++)
+	{
+		double start;
+		double end;
+
+		BenchPressKey(ReplayPilot(ptrPlayer));
+
+		DialogHandler();
+		GameExit();
+		GameEmergencyMode();
+
+		start = ReplayNow();
+
+		if (DialogSimulationPaused() == false)
+		{
+			GameCalculations();
+		}
+
+		end = ReplayNow();
+		simNs += end - start;
+
+		GameGraphics();
+
+		renderNs += ReplayNow() - end;
+
+		GameStartupFlag = false;
+
+		if (GameAircraftCollisionFlag)
+		{
+			ptrResult->collision = true;
+			break;
+		}
+		else if (levelFinished)
+		{
+			ptrResult->finished = true;
+			break;
+		}
+	}
+
+	ptrResult->frames = Pilot.frame + 1;
+	ptrResult->score = GameGetScore();
+	ptrResult->lost = 0;
+	ptrResult->simNs = simNs / ptrResult->frames;
+	ptrResult->renderNs = renderNs / ptrResult->frames;
+
+	for (i = 0; i < FlightData.nAircraft; i++)
+	{
+		// See GameAircraftState(): flights are lost when no time is left.
+		if (FlightData.Finished[i] && (FlightData.RemainingTime[i] == 0))
+		{
+			ptrResult->lost++;
+		}
+	}
+
+	return true;
+}
+
+/* *************************************
+ * 	Baseline
+ * *************************************/
+
+static size_t ReplayReadBaseline(const char* const path, TYPE_REPLAY_RESULT* const results, const size_t maxResults)
+{
+	FILE* const f = fopen(path, "r");
+	char line[128];
+	size_t n = 0;
+
+	if (f == NULL)
+	{
+		return 0;
+	}
+
+	while ((n < maxResults) && (fgets(line, sizeof (line), f) != NULL))
+	{
+		TYPE_REPLAY_RESULT* const ptrResult = &results[n];
+
+		if (line[0] == '#')
+		{
+			continue;
+		}
+
+		if (sscanf(	line, "%31s %u %u %u %lf %lf",
+					ptrResult->name,
+					&ptrResult->frames,
+					&ptrResult->score,
+					&ptrResult->lost,
+					&ptrResult->simNs,
+					&ptrResult->renderNs	) == 6)
+		{
+			n++;
+		}
+	}
+
+	fclose(f);
+
+	return n;
+}
+
+static bool ReplayWriteBaseline(const char* const path, const TYPE_REPLAY_RESULT* const results, const size_t n)
+{
+	FILE* const f = fopen(path, "w");
+	size_t i;
+
+	if (f == NULL)
+	{
+		fprintf(stderr, "Could not open %s: %s\n", path, strerror(errno));
+		return false;
+	}
+
+	fprintf(f, "# Generated by replay --update-baseline.\n");
+	fprintf(f, "# name frames score lost sim_ns/frame render_ns/frame\n");
+	fprintf(f, "# Costs per frame are only checked if --threshold is given.\n");
+
+	for (i = 0; i < n; i++)
+	{
+		const TYPE_REPLAY_RESULT* const ptrResult = &results[i];
+
+		fprintf(f, "%s %u %u %u %.1f %.1f\n",
+				ptrResult->name,
+				ptrResult->frames,
+				ptrResult->score,
+				ptrResult->lost,
+				ptrResult->simNs,
+				ptrResult->renderNs	);
+	}
+
+	fclose(f);
+
+	return true;
+}
+
+static const TYPE_REPLAY_RESULT* ReplayFindResult(const char* const name, const TYPE_REPLAY_RESULT* const results, const size_t n)
+{
+	size_t i;
+
+	for (i = 0; i < n; i++)
+	{
+		if (strcmp(results[i].name, name) == 0)
+		{
+			return &results[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool ReplaySameOutcome(const TYPE_REPLAY_RESULT* const a, const TYPE_REPLAY_RESULT* const b)
+{
+	return	(a->frames == b->frames)
+				&&
+			(a->score == b->score)
+				&&
+			(a->lost == b->lost);
+}
+
+/* *******************************************************************
+ *
+ * @name: bool ReplayMeasure(const char* const lvlPath, const char* const pltPath, TYPE_REPLAY_RESULT* const ptrResult)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Plays level REPLAY_SAMPLES times, keeping cost per frame from
+ *  the fastest sample.
+ *
+ * @return:
+ *  false if level could not be loaded or samples had different
+ *  outcomes, true otherwise.
+ *
+ * *******************************************************************/
+static bool ReplayMeasure(const char* const lvlPath, const char* const pltPath, TYPE_REPLAY_RESULT* const ptrResult)
+{
+	size_t i;
+
+	for (i = 0; i < REPLAY_SAMPLES; i++)
+	{
+		TYPE_REPLAY_RESULT sample = *ptrResult;
+
+		if (ReplayRun(lvlPath, pltPath, &sample) == false)
+		{
+			return false;
+		}
+
+		if (i == 0)
+		{
+			*ptrResult = sample;
+		}
+		else if (ReplaySameOutcome(ptrResult, &sample) == false)
+		{
+			fprintf(stderr, "%s: replay is not deterministic!\n", ptrResult->name);
+			return false;
+		}
+		else if ((sample.simNs + sample.renderNs) < (ptrResult->simNs + ptrResult->renderNs))
+		{
+			ptrResult->simNs = sample.simNs;
+			ptrResult->renderNs = sample.renderNs;
+		}
+
+		// Only traced once.
+		ReplayTrace = false;
+	}
+
+	return true;
+}
+
+/* *******************************************************************
+ *
+ * @name: bool ReplayCheckPause(const char* const lvlPath, const char* const pltPath)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Presses PAD_START twice and checks simulation is halted by the
+ *  first press and resumed by the second one, i.e.: the press which
+ *  closes pause dialog must not open it again on the same frame.
+ *
+ * @return:
+ *  false if level could not be loaded or check failed, true otherwise.
+ *
+ * *******************************************************************/
+static bool ReplayCheckPause(const char* const lvlPath, const char* const pltPath)
+{
+	const TYPE_GAME_CONFIGURATION cfg =
+	{
+		.TwoPlayers = false,
+		.LVLPath = lvlPath,
+		.PLTPath = pltPath
+	};
+
+	static const struct
+	{
+		unsigned short key;
+		bool paused;
+	}frames[] =
+	{
+		{ PAD_START,	true	},
+		{ 0,			true	},
+		{ PAD_START,	false	},
+		{ 0,			false	}
+	};
+
+	size_t i;
+
+	srand(REPLAY_SEED);
+	BenchResetTicks();
+
+	twoPlayers = cfg.TwoPlayers;
+	GameInit(&cfg);
+
+	if ((GameLevelSize == 0) || (FlightData.nAircraft == 0))
+	{
+		fprintf(stderr, "Could not load %s and %s!\n", lvlPath, pltPath);
+		return false;
+	}
+
+	// Pause is ignored on first frame.
+	GameStartupFlag = false;
+
+	for (i = 0; i < ARRAY_SIZE(frames); i++)
+	{
+		BenchPressKey(frames[i].key);
+
+		DialogHandler();
+		GameExit();
+
+		if (DialogSimulationPaused() != frames[i].paused)
+		{
+			fprintf(stderr, "Frame %d: simulation %s after PAD_START was pressed twice!\n",
+					(int)i, frames[i].paused ? "was not paused" : "was not resumed");
+			return false;
+		}
+
+		if (DialogSimulationPaused() == false)
+		{
+			GameCalculations();
+		}
+
+		SystemCyclicHandler();
+	}
+
+	return true;
+}
+
+static void ReplayName(char* const name, const size_t sz, const char* const lvlPath, const char* const pltPath)
+{
+	const char* const lvl = strrchr(lvlPath, '\\') + 1;
+	const char* const plt = strrchr(pltPath, '\\') + 1;
+
+	// e.g.: "LEVEL1/TUTORIA1".
+	snprintf(name, sz, "%.*s/%.*s", (int)strcspn(lvl, "."), lvl, (int)strcspn(plt, "."), plt);
+}
+
+static void ReplayUsage(const char* const argv0)
+{
+	fprintf(stderr,	"Usage: %s [--levels DIR] [--baseline FILE] [--threshold PCT]\n"
+					"          [--update-baseline] [--trace] [--verbose] [name filter]\n", argv0);
+}
+
+int main(int argc, char* argv[])
+{
+	TYPE_REPLAY_RESULT baseline[REPLAY_MAX_COMBINATIONS];
+	TYPE_REPLAY_RESULT results[REPLAY_MAX_COMBINATIONS];
+	const char* levelsDir = BENCH_LEVELS_DIR;
+	const char* baselinePath = REPLAY_BASELINE_FILE;
+	const char* filter = NULL;
+	// Cost per frame is not checked unless a threshold is given.
+	double threshold = 0.0;
+	bool updateBaseline = false;
+	bool trace = false;
+	size_t nBaseline;
+	size_t nResults = 0;
+	size_t nFailures = 0;
+	LEVEL_ID level;
+	int i;
+
+	for (i = 1; i < argc; i++)
+	{
+		if ((strcmp(argv[i], "--levels") == 0) && ((i + 1) < argc))
+		{
+			levelsDir = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--baseline") == 0) && ((i + 1) < argc))
+		{
+			baselinePath = argv[++i];
+		}
+		else if ((strcmp(argv[i], "--threshold") == 0) && ((i + 1) < argc))
+		{
+			threshold = atof(argv[++i]);
+		}
+		else if (strcmp(argv[i], "--update-baseline") == 0)
+		{
+			updateBaseline = true;
+		}
+		else if (strcmp(argv[i], "--trace") == 0)
+		{
+			trace = true;
+		}
+		else if (strcmp(argv[i], "--verbose") == 0)
+		{
+			BenchVerbose = true;
+		}
+		else if (argv[i][0] != '-')
+		{
+			filter = argv[i];
+		}
+		else
+		{
+			ReplayUsage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	GfxInitDrawEnv();
+	GfxInitDispEnv();
+	GfxSetDefaultPrimitiveList();
+
+	nBaseline = ReplayReadBaseline(baselinePath, baseline, ARRAY_SIZE(baseline));
+
+	if (	(ReplayLoadFile(levelsDir, MainMenuLevelList[LEVEL1], ReplayLevelData, sizeof (ReplayLevelData)) == 0)
+				||
+			(ReplayLoadFile(levelsDir, MainMenuPltList[LEVEL1][0], ReplayPltData, sizeof (ReplayPltData)) == 0)
+				||
+			(ReplayCheckPause(MainMenuLevelList[LEVEL1], MainMenuPltList[LEVEL1][0]) == false)	)
+	{
+		return EXIT_FAILURE;
+	}
+
+	printf(	"%-20s %7s %7s %5s %12s %12s %12s %9s\n",
+			"level", "frames", "score", "lost", "sim ns/f", "render ns/f", "baseline", "delta");
+
+	for (level = LEVEL1; level < MAX_LEVELS; level++)
+	{
+		const char* const lvlPath = MainMenuLevelList[level];
+		const char* const* pltPath;
+
+		for (pltPath = MainMenuPltList[level]; *pltPath != NULL; pltPath++)
+		{
+			TYPE_REPLAY_RESULT* const ptrResult = &results[nResults];
+			const TYPE_REPLAY_RESULT* ptrBaseline;
+			const char* status = "";
+			int retry;
+
+			if (nResults >= ARRAY_SIZE(results))
+			{
+				fprintf(stderr, "Too many levels! Maximum: %d\n", REPLAY_MAX_COMBINATIONS);
+				return EXIT_FAILURE;
+			}
+
+			memset(ptrResult, 0, sizeof (*ptrResult));
+			ReplayName(ptrResult->name, sizeof (ptrResult->name), lvlPath, *pltPath);
+
+			if ((filter != NULL) && (strstr(ptrResult->name, filter) == NULL))
+			{
+				continue;
+			}
+
+			if (	(ReplayLoadFile(levelsDir, lvlPath, ReplayLevelData, sizeof (ReplayLevelData)) == 0)
+						||
+					(ReplayLoadFile(levelsDir, *pltPath, ReplayPltData, sizeof (ReplayPltData)) == 0)	)
+			{
+				return EXIT_FAILURE;
+			}
+
+			ReplayTrace = trace;
+
+			if (ReplayMeasure(lvlPath, *pltPath, ptrResult) == false)
+			{
+				return EXIT_FAILURE;
+			}
+
+			nResults++;
+
+			ptrBaseline = ReplayFindResult(ptrResult->name, baseline, nBaseline);
+
+			for (	retry = 0;
+					(retry < REPLAY_RETRIES)
+						&&
+					(updateBaseline == false)
+						&&
+					(threshold > 0.0)
+						&&
+					(ptrBaseline != NULL)
+						&&
+					((ptrResult->simNs + ptrResult->renderNs) > ((ptrBaseline->simNs + ptrBaseline->renderNs) * (1.0 + (threshold / 100.0))));
+					retry++	)
+			{
+				TYPE_REPLAY_RESULT sample = *ptrResult;
+
+				if (	(ReplayMeasure(lvlPath, *pltPath, &sample) != false)
+							&&
+						((sample.simNs + sample.renderNs) < (ptrResult->simNs + ptrResult->renderNs))	)
+				{
+					ptrResult->simNs = sample.simNs;
+					ptrResult->renderNs = sample.renderNs;
+				}
+			}
+
+			if (ptrResult->collision)
+			{
+				status = " COLLISION";
+			}
+			else if (ptrResult->finished == false)
+			{
+				status = " NOT FINISHED";
+			}
+			else if ((ptrBaseline != NULL) && (updateBaseline == false))
+			{
+				if (ReplaySameOutcome(ptrResult, ptrBaseline) == false)
+				{
+					status = " MISMATCH";
+				}
+				else if (	(threshold > 0.0)
+								&&
+							((ptrResult->simNs + ptrResult->renderNs) > ((ptrBaseline->simNs + ptrBaseline->renderNs) * (1.0 + (threshold / 100.0))))	)
+				{
+					status = " REGRESSION";
+				}
+			}
+
+			if (status[0] != '\0')
+			{
+				nFailures++;
+			}
+
+			if (ptrBaseline == NULL)
+			{
+				printf(	"%-20s %7u %7u %5u %12.1f %12.1f %12s %9s%s\n",
+						ptrResult->name,
+						ptrResult->frames,
+						ptrResult->score,
+						ptrResult->lost,
+						ptrResult->simNs,
+						ptrResult->renderNs,
+						"-",
+						"new",
+						status	);
+			}
+			else
+			{
+				const double total = ptrResult->simNs + ptrResult->renderNs;
+				const double baselineTotal = ptrBaseline->simNs + ptrBaseline->renderNs;
+
+				printf(	"%-20s %7u %7u %5u %12.1f %12.1f %12.1f %+8.1f%%%s\n",
+						ptrResult->name,
+						ptrResult->frames,
+						ptrResult->score,
+						ptrResult->lost,
+						ptrResult->simNs,
+						ptrResult->renderNs,
+						baselineTotal,
+						((total / baselineTotal) - 1.0) * 100.0,
+						status	);
+
+				if (ReplaySameOutcome(ptrResult, ptrBaseline) == false)
+				{
+					printf(	"%-20s %7u %7u %5u (baseline)\n",
+							"",
+							ptrBaseline->frames,
+							ptrBaseline->score,
+							ptrBaseline->lost	);
+				}
+			}
+		}
+	}
+
+	if (updateBaseline)
+	{
+		if (filter != NULL)
+		{
+			size_t j;
+
+			// Keep baseline values for levels which were not played.
+			for (j = 0; j < nBaseline; j++)
+			{
+				if (	(ReplayFindResult(baseline[j].name, results, nResults) == NULL)
+							&&
+						(nResults < ARRAY_SIZE(results))	)
+				{
+					results[nResults++] = baseline[j];
+				}
+			}
+		}
+
+		if (ReplayWriteBaseline(baselinePath, results, nResults) == false)
+		{
+			return EXIT_FAILURE;
+		}
+
+		printf("Baseline written to %s\n", baselinePath);
+	}
+	else if (nBaseline == 0)
+	{
+		printf("No baseline found at %s. Run with --update-baseline to create it.\n", baselinePath);
+	}
+
+	if (nFailures != 0)
+	{
+		printf("%d level(s) failed.", (int)nFailures);
+
+		if (threshold > 0.0)
+		{
+			printf(" Baseline cost is sim + render ns/frame, threshold %.1f%%", threshold);
+		}
+
+		printf("\n");
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
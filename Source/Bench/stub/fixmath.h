@@ -0,0 +1,67 @@
+#ifndef BENCH_STUB_FIXMATH_H__
+#define BENCH_STUB_FIXMATH_H__
+
+/* *************************************
+ * 	Subset of libfixmath used by game logic.
+ * *************************************/
+
+#include <stdint.h>
+
+typedef int32_t fix16_t;
+
+static inline fix16_t fix16_from_int(int a)
+{
+	return a * 0x00010000;
+}
+
+static inline int fix16_to_int(fix16_t a)
+{
+	// Rounds to nearest, as libfixmath does.
+	if (a >= 0)
+	{
+		return (a + 0x00008000) >> 16;
+	}
+
+	return (a - 0x00008000) >> 16;
+}
+
+static inline fix16_t fix16_smul(fix16_t a, fix16_t b)
+{
+	const int64_t product = ((int64_t)a * b) >> 16;
+
+	if (product > INT32_MAX)
+	{
+		return INT32_MAX;
+	}
+	else if (product < INT32_MIN)
+	{
+		return INT32_MIN;
+	}
+
+	return (fix16_t)product;
+}
+
+static inline fix16_t fix16_sdiv(fix16_t a, fix16_t b)
+{
+	int64_t quotient;
+
+	if (b == 0)
+	{
+		return (a >= 0) ? INT32_MAX : INT32_MIN;
+	}
+
+	quotient = ((int64_t)a << 16) / b;
+
+	if (quotient > INT32_MAX)
+	{
+		return INT32_MAX;
+	}
+	else if (quotient < INT32_MIN)
+	{
+		return INT32_MIN;
+	}
+
+	return (fix16_t)quotient;
+}
+
+#endif // BENCH_STUB_FIXMATH_H__
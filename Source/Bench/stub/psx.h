@@ -0,0 +1,161 @@
+#ifndef BENCH_STUB_PSX_H__
+#define BENCH_STUB_PSX_H__
+
+/* *************************************
+ * 	Minimal PSXSDK replacement, only providing
+ * 	types and constants needed to build game
+ * 	logic for a Linux host. GPU/SPU/BIOS calls
+ * 	are defined as no-ops in BenchStubs.c.
+ * *************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdarg.h>
+#include <strings.h>
+
+#define NORMAL_LUMINANCE	128
+
+#define COLORMODE_4BPP		0
+#define COLORMODE_8BPP		1
+#define COLORMODE_16BPP		2
+#define COLORMODE_24BPP		3
+#define COLORMODE(x)		((x) << 24)
+
+#define ENABLE_TRANS		(1 << 0)
+#define TRANS_MODE(x)		((x) << 1)
+#define H_FLIP				(1 << 3)
+#define V_FLIP				(1 << 4)
+
+#define VMODE_NTSC			0
+#define VMODE_PAL			1
+
+enum
+{
+	PAD_LEFT = 1 << 15,
+	PAD_RIGHT = 1 << 13,
+	PAD_UP = 1 << 12,
+	PAD_DOWN = 1 << 14,
+	PAD_L2 = 1 << 0,
+	PAD_R2 = 1 << 1,
+	PAD_L1 = 1 << 2,
+	PAD_R1 = 1 << 3,
+	PAD_TRIANGLE = 1 << 4,
+	PAD_CIRCLE = 1 << 5,
+	PAD_CROSS = 1 << 6,
+	PAD_SQUARE = 1 << 7,
+	PAD_SELECT = 1 << 8,
+	PAD_START = 1 << 11
+};
+
+typedef struct
+{
+	short x, y;
+	unsigned char u, v;
+	short w, h;
+	unsigned short cx, cy;
+	unsigned char r, g, b;
+	unsigned char tpage;
+	unsigned int attribute;
+	short mx, my;
+	short scalex, scaley;
+	int rotate;
+}GsSprite;
+
+typedef struct
+{
+	short x[4], y[4];
+	unsigned char r[4], g[4], b[4];
+	unsigned int attribute;
+}GsGPoly4;
+
+typedef struct
+{
+	short x[4], y[4];
+	unsigned char u[4], v[4];
+	unsigned char r, g, b;
+	unsigned int attribute;
+	unsigned char tpage;
+	short cx, cy;
+}GsTPoly4;
+
+typedef struct
+{
+	short x, y, w, h;
+	unsigned char r, g, b;
+	unsigned int attribute;
+}GsRectangle;
+
+typedef struct
+{
+	short x[2], y[2];
+	unsigned char r, g, b;
+	unsigned int attribute;
+}GsLine;
+
+typedef struct
+{
+	short x, y, w, h;
+	int draw_on_display, dither, ignore_mask, set_mask;
+}GsDrawEnv;
+
+typedef struct
+{
+	short x, y;
+}GsDispEnv;
+
+typedef struct
+{
+	int pmode;
+	int has_clut;
+	int clut_x, clut_y, clut_w, clut_h;
+	int x, y, w, h;
+	void* clut_data;
+	void* data;
+}GsImage;
+
+typedef struct
+{
+	int version;
+	int data_size;
+	int sample_rate;
+	char name[16];
+	void* data;
+	int spu_addr;
+	int cur_voice;
+}SsVag;
+
+#define SPU_MAXVOL	0x3FFF
+
+// GPU DMA channel control register. Never busy on host.
+extern volatile unsigned int BenchStubD2_CHCR;
+#define D2_CHCR		BenchStubD2_CHCR
+
+enum memcard_status
+{
+	MEMCARD_STATUS_UNKNOWN
+};
+
+void GsSortSprite(GsSprite* spr);
+void GsSortGPoly4(GsGPoly4* poly);
+void GsSortTPoly4(GsTPoly4* poly);
+void GsSortRectangle(GsRectangle* rect);
+void GsSortLine(GsLine* line);
+void GsSortCls(int r, int g, int b);
+int GsListPos(void);
+void GsSetList(unsigned int* listptr);
+void GsDrawList(void);
+int GsIsDrawing(void);
+int GsImageFromTim(GsImage* image, void* timdata);
+int GsSpriteFromImage(GsSprite* sprite, GsImage* image, int do_upload);
+void GsUploadCLUT(GsImage* image);
+void GsSetDrawEnv(GsDrawEnv* env);
+void GsSetDrawEnv_DMA(GsDrawEnv* env);
+void GsSetDispEnv(GsDispEnv* env);
+void SsReadVag(SsVag* vag, void* data);
+void SsUploadVagEx(SsVag* vag, int spu_addr);
+void SsPlayVag(SsVag* vag, unsigned char voice, unsigned short vl, unsigned short vr);
+void SsKeyOff(int voice);
+unsigned short PSX_PollPad(int pad_num, unsigned char* type, unsigned char* id, unsigned char* raw);
+int GetRCnt(int spec);
+
+#endif // BENCH_STUB_PSX_H__
@@ -0,0 +1,10 @@
+#ifndef BENCH_STUB_PSXSIO_H__
+#define BENCH_STUB_PSXSIO_H__
+
+void SIOStart(int baud);
+int SIOCheckInBuffer(void);
+int SIOCheckOutBuffer(void);
+unsigned char SIOReadByte(void);
+void SIOSendByte(unsigned char byte);
+
+#endif // BENCH_STUB_PSXSIO_H__
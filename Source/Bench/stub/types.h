@@ -0,0 +1,7 @@
+#ifndef BENCH_STUB_TYPES_H__
+#define BENCH_STUB_TYPES_H__
+
+#include <stddef.h>
+#include <stdint.h>
+
+#endif // BENCH_STUB_TYPES_H__
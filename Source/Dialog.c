@@ -0,0 +1,167 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Dialog.h"
+#include "Profiler.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define DIALOG_STACK_SIZE 4
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+// Focus stack. Topmost dialog is the last one.
+static TYPE_DIALOG* DialogStack[DIALOG_STACK_SIZE];
+static uint8_t DialogCount;
+// Set by DialogHandler() when topmost dialog is closed,
+// so the same key press is not reused by any other module.
+static bool DialogClosed;
+
+void DialogInit(void)
+{
+	memset(DialogStack, 0, sizeof (DialogStack));
+	DialogCount = 0;
+	DialogClosed = false;
+}
+
+bool DialogOpen(TYPE_DIALOG* const ptrDialog)
+{
+	if (DialogIsOpen(ptrDialog))
+	{
+		return true;
+	}
+
+	if (DialogCount >= DIALOG_STACK_SIZE)
+	{
+		Serial_printf("Dialog stack is full!\n");
+		return false;
+	}
+
+	DialogStack[DialogCount++] = ptrDialog;
+
+	PROFILER_EVENT(PROFILER_EVENT_DIALOG_OPEN);
+
+	return true;
+}
+
+void DialogClose(const TYPE_DIALOG* const ptrDialog)
+{
+	uint8_t i;
+
+	for (i = 0; i < DialogCount; i++)
+	{
+		if (DialogStack[i] == ptrDialog)
+		{
+			// Keep order for dialogs above.
+			memmove(&DialogStack[i],
+					&DialogStack[i + 1],
+					(DialogCount - i - 1) * sizeof (TYPE_DIALOG*));
+
+			DialogStack[--DialogCount] = NULL;
+			break;
+		}
+	}
+}
+
+bool DialogIsOpen(const TYPE_DIALOG* const ptrDialog)
+{
+	uint8_t i;
+
+	for (i = 0; i < DialogCount; i++)
+	{
+		if (DialogStack[i] == ptrDialog)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool DialogAnyOpen(void)
+{
+	return (DialogCount != 0);
+}
+
+bool DialogHasFocus(bool (*PadKeySinglePress_Callback)(unsigned short))
+{
+	if (DialogCount == 0)
+	{
+		return false;
+	}
+
+	return (DialogStack[DialogCount - 1]->PadKeySinglePress_Callback == PadKeySinglePress_Callback);
+}
+
+bool DialogSimulationPaused(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < DialogCount; i++)
+	{
+		if (DialogStack[i]->Policy == DIALOG_POLICY_PAUSE)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+bool DialogClosedThisFrame(void)
+{
+	return DialogClosed;
+}
+
+/* *******************************************************************
+ *
+ * @name: void DialogHandler(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Only topmost dialog receives input. It is removed from focus
+ *  stack once its handler returns false, so focus returns to the
+ *  dialog below on next frame.
+ *
+ * @remarks:
+ *  DialogClosedThisFrame() returns true until next call once a
+ *  dialog has been closed here.
+ *
+ * *******************************************************************/
+void DialogHandler(void)
+{
+	TYPE_DIALOG* ptrDialog;
+
+	DialogClosed = false;
+
+	if (DialogCount == 0)
+	{
+		return;
+	}
+
+	ptrDialog = DialogStack[DialogCount - 1];
+
+	if (ptrDialog->Handler(ptrDialog) == false)
+	{
+		DialogClose(ptrDialog);
+		DialogClosed = true;
+	}
+}
+
+void DialogRender(void)
+{
+	uint8_t i;
+
+	for (i = 0; i < DialogCount; i++)
+	{
+		const TYPE_DIALOG* const ptrDialog = DialogStack[i];
+
+		ptrDialog->Render(ptrDialog);
+	}
+}
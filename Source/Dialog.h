@@ -0,0 +1,75 @@
+#ifndef DIALOG_HEADER__
+#define DIALOG_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef enum t_dialogPolicy
+{
+	// Simulation is halted while dialog is open.
+	DIALOG_POLICY_PAUSE,
+	// Simulation keeps running under dialog.
+	DIALOG_POLICY_RUN
+}DIALOG_POLICY;
+
+typedef struct t_dialog
+{
+	DIALOG_POLICY Policy;
+	// Input from this pad is routed to dialog while it has focus.
+	bool (*PadKeySinglePress_Callback)(unsigned short);
+	// Called on each frame while dialog has focus.
+	// Dialog is closed once it returns false.
+	bool (*Handler)(struct t_dialog* const ptrDialog);
+	// Called on each frame while dialog is open.
+	void (*Render)(const struct t_dialog* const ptrDialog);
+}TYPE_DIALOG;
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+// Closes all dialogs.
+void DialogInit(void);
+
+// Pushes dialog on top of focus stack. Dialog data must remain
+// valid until it is closed. Returns false if stack is full.
+bool DialogOpen(TYPE_DIALOG* const ptrDialog);
+
+// Removes dialog from focus stack, if open.
+void DialogClose(const TYPE_DIALOG* const ptrDialog);
+
+bool DialogIsOpen(const TYPE_DIALOG* const ptrDialog);
+
+// Returns true if any dialog is open.
+bool DialogAnyOpen(void);
+
+// Returns true if input from given pad is being used by topmost dialog,
+// so it must be ignored by any other module.
+bool DialogHasFocus(bool (*PadKeySinglePress_Callback)(unsigned short));
+
+// Returns true if any open dialog halts simulation.
+bool DialogSimulationPaused(void);
+
+// Returns true if a dialog was closed on last call to DialogHandler().
+// Key presses which closed it must not be handled again on same frame.
+bool DialogClosedThisFrame(void);
+
+// Routes input to topmost dialog. To be called once per frame.
+void DialogHandler(void);
+
+// Renders all open dialogs, from bottom to top. To be called
+// once per frame, after the rest of the scene has been sorted.
+void DialogRender(void);
+
+#endif // DIALOG_HEADER__
@@ -0,0 +1,77 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "EmuHook.h"
+
+#ifdef EMU_HOOK_ENABLED
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define I_MASK (*(volatile unsigned int*)0x1F801074)
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+// Read and written by emulator scripts while game is running.
+static volatile TYPE_EMU_HOOK_MAILBOX EmuHookMailbox =
+{
+	.magic = {EMU_HOOK_MAGIC_0, EMU_HOOK_MAGIC_1},
+	.version = EMU_HOOK_VERSION
+};
+
+/* *******************************************************************
+ *
+ * @name: void EmuHookSignal(const EMU_HOOK_POINT point, const uint32_t arg)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Updates mailbox contents and increases its sequence number.
+ *  Emulator scripts trigger on any write into seq, and then read
+ *  CPU cycle count along with mailbox contents.
+ *
+ * @remarks:
+ *  Called from both main context and loading screen VBlank ISR,
+ *  which reaches SystemDevMenu() through GfxDrawScene_Fast(), so
+ *  interrupts are masked while mailbox is updated. Otherwise, the
+ *  ISR could overwrite point and arg before seq is written.
+ *
+ * *******************************************************************/
+void EmuHookSignal(const EMU_HOOK_POINT point, const uint32_t arg)
+{
+	const unsigned int mask = I_MASK;
+
+	I_MASK = 0;
+
+	if (point == EMU_HOOK_FRAME)
+	{
+		GFX_LAYER layer;
+
+		EmuHookMailbox.frame++;
+		EmuHookMailbox.primitives = GfxGetPrimitiveListUsage();
+		EmuHookMailbox.primitivesPeak = GfxGetPrimitiveListPeak();
+		EmuHookMailbox.droppedSprites = GfxGetDroppedSprites();
+
+		for (layer = 0; layer < MAX_GFX_LAYERS; layer++)
+		{
+			EmuHookMailbox.layerPrimitives[layer] = GfxGetLayerUsage(layer);
+		}
+	}
+
+	EmuHookMailbox.point = point;
+	EmuHookMailbox.arg = arg;
+	EmuHookMailbox.seq++;
+
+	I_MASK = mask;
+}
+
+void EmuHookPad(unsigned short* const ptrPad)
+{
+	*ptrPad |= (unsigned short)EmuHookMailbox.pad;
+}
+
+#endif // EMU_HOOK_ENABLED
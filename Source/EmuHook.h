@@ -0,0 +1,94 @@
+#ifndef EMU_HOOK_HEADER__
+#define EMU_HOOK_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+#include "Gfx.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Identifies mailbox on RAM. Emulator scripts look for
+// both words, stored consecutively (see Source/EmuPerf).
+#define EMU_HOOK_MAGIC_0			0x50524941	// "AIRP"
+#define EMU_HOOK_MAGIC_1			0x4B4F4F48	// "HOOK"
+// Must be increased whenever TYPE_EMU_HOOK_MAILBOX layout changes.
+#define EMU_HOOK_VERSION			1
+
+#ifdef EMU_HOOK_ENABLED
+
+#define EMU_HOOK(point, arg)		EmuHookSignal(point, arg)
+#define EMU_HOOK_PAD(ptrPad)		EmuHookPad(ptrPad)
+
+#else
+
+// Hooks are compiled out unless EMU_HOOK_ENABLED is defined.
+#define EMU_HOOK(point, arg)
+#define EMU_HOOK_PAD(ptrPad)
+
+#endif // EMU_HOOK_ENABLED
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+// Fixed points where emulator scripts are signalled.
+// Values are shared with Source/EmuPerf/perf.lua.
+typedef enum t_emuHookPoint
+{
+	// arg: number of files to load.
+	EMU_HOOK_LOAD_BEGIN = 1,
+	// arg: number of files to load.
+	EMU_HOOK_LOAD_END,
+	EMU_HOOK_GRAPHICS_BEGIN,
+	EMU_HOOK_GRAPHICS_END,
+	// CPU has stopped waiting for GPU to finish previous frame.
+	EMU_HOOK_GPU_WAIT_END,
+	// Raised from SystemDevMenu() once per frame, right
+	// before primitive list is sent to GPU.
+	EMU_HOOK_FRAME
+}EMU_HOOK_POINT;
+
+// Only 32-bit fields are used, so emulator scripts
+// can read them without caring about padding.
+typedef struct t_emuHookMailbox
+{
+	uint32_t magic[2];
+	uint32_t version;
+	// Written by emulator script: keys (PAD_CROSS, PAD_START...)
+	// reported as pressed on pad one until overwritten.
+	uint32_t pad;
+	uint32_t frame;
+	// EMU_HOOK_POINT.
+	uint32_t point;
+	uint32_t arg;
+	// Primitive list statistics from last frame.
+	uint32_t primitives;
+	uint32_t primitivesPeak;
+	uint32_t droppedSprites;
+	uint32_t layerPrimitives[MAX_GFX_LAYERS];
+	// Written last, so emulator scripts can set a write
+	// breakpoint on it and read all other fields.
+	uint32_t seq;
+}TYPE_EMU_HOOK_MAILBOX;
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+#ifdef EMU_HOOK_ENABLED
+
+// Fills mailbox and signals emulator script by writing into seq.
+// Real hardware just sees a few memory writes.
+void EmuHookSignal(const EMU_HOOK_POINT point, const uint32_t arg);
+
+// Adds keys written by emulator script into pad data read from pad one.
+void EmuHookPad(unsigned short* const ptrPad);
+
+#endif // EMU_HOOK_ENABLED
+
+#endif // EMU_HOOK_HEADER__
@@ -0,0 +1,430 @@
+--[[ ***********************************************************************
+ *
+ * EmuPerf: measures airport.exe under PCSX-Redux, running headless.
+ *
+ * EXPERIMENTAL: this script has not been run under PCSX-Redux yet. It
+ * has only been exercised against a mocked PCSX table. These calls are
+ * assumed to behave as documented by PCSX-Redux, and are checked for
+ * existence on startup (see checkApi()):
+ *  PCSX.getMemPtr()            Pointer to main RAM, usable through ffi.
+ *  PCSX.getRegisters().cycle   Emulated CPU cycle count.
+ *  PCSX.addBreakpoint(address, "Write", width, cause, invoker)
+ *  PCSX.Events.createEventListener("GPU::Vsync", callback)
+ *  PCSX.quit(code)
+ * Frame and load times are meaningless if any of them differs.
+ *
+ * Game must be built with -DEMU_HOOK=ON, so EmuHook module signals
+ * this script at fixed points (loading, GameGraphics(), GPU wait and
+ * SystemDevMenu(), once per frame) by writing into a mailbox on RAM.
+ * A write breakpoint on the mailbox reads emulated CPU cycle count
+ * and primitive list statistics on each signal, and keys from an input
+ * script are written back into the mailbox, so pad one sees them.
+ *
+ * Usage (see emu_perf target on top-level CMakeLists.txt):
+ *  pcsx-redux -no-ui -stdout -lua_stdout -interpreter -run
+ *      -iso airport.cue -dofile perf.lua
+ *
+ * Environment variables:
+ *  AIRPORT_EMU_INPUTS  Input script. Default: inputs.txt.
+ *  AIRPORT_EMU_CSV     Per-frame results. Default: emu_perf.csv.
+ *
+ * Input script commands, one per line ('#' starts a comment):
+ *  wait N          Waits for N frames.
+ *  waitload        Waits until next loading screen has finished.
+ *  press KEY...    Presses keys for 2 frames, then releases them.
+ *  hold N KEY...   Presses keys for N frames, then releases them.
+ *                  Next command is executed without waiting.
+ *  measure N       Records N frames into CSV file and summary.
+ *  quit            Prints summary and exits.
+ *
+ * Interpreter is used so cycle counts follow R3000A timings.
+ *
+ * *********************************************************************** ]]
+
+local ffi = require("ffi")
+local bit = require("bit")
+
+-- Must match EmuHook.h.
+local EMU_HOOK_MAGIC_0 = 0x50524941
+local EMU_HOOK_MAGIC_1 = 0x4B4F4F48
+local EMU_HOOK_VERSION = 1
+
+local EMU_HOOK_LOAD_BEGIN = 1
+local EMU_HOOK_LOAD_END = 2
+local EMU_HOOK_GRAPHICS_BEGIN = 3
+local EMU_HOOK_GRAPHICS_END = 4
+local EMU_HOOK_GPU_WAIT_END = 5
+local EMU_HOOK_FRAME = 6
+
+-- Word offsets inside TYPE_EMU_HOOK_MAILBOX.
+local MAILBOX_VERSION = 2
+local MAILBOX_PAD = 3
+local MAILBOX_FRAME = 4
+local MAILBOX_POINT = 5
+local MAILBOX_ARG = 6
+local MAILBOX_PRIMITIVES = 7
+local MAILBOX_PRIMITIVES_PEAK = 8
+local MAILBOX_DROPPED = 9
+local MAILBOX_LAYERS = 10
+local MAX_GFX_LAYERS = 6
+local MAILBOX_SEQ = MAILBOX_LAYERS + MAX_GFX_LAYERS
+
+local RAM_SIZE = 2 * 1024 * 1024
+local CPU_FREQUENCY = 33868800
+-- Mailbox is looked for once per VBlank, up to this number of times.
+local MAX_SCAN_VSYNCS = 600
+-- Guards against input scripts which never reach "quit".
+local MAX_FRAMES = 60 * 60 * 50
+
+-- Same values as PAD_CROSS, PAD_START... from <psx.h>.
+local PAD_KEYS =
+{
+	L2 = bit.lshift(1, 0), R2 = bit.lshift(1, 1), L1 = bit.lshift(1, 2), R1 = bit.lshift(1, 3),
+	TRIANGLE = bit.lshift(1, 4), CIRCLE = bit.lshift(1, 5), CROSS = bit.lshift(1, 6), SQUARE = bit.lshift(1, 7),
+	SELECT = bit.lshift(1, 8), START = bit.lshift(1, 11),
+	UP = bit.lshift(1, 12), RIGHT = bit.lshift(1, 13), DOWN = bit.lshift(1, 14), LEFT = bit.lshift(1, 15)
+}
+
+local LAYER_NAMES = {"other", "terrain", "buildings", "aircraft", "gui", "fonts"}
+
+local mailbox = nil
+local mailboxAddress = 0
+local scanVsyncs = 0
+local commands = {}
+local commandIdx = 1
+local waitFrames = 0
+local releaseFrame = nil
+local waitingLoad = false
+local measureFrames = 0
+local csv = nil
+local frames = 0
+
+-- Cycle count on each hook point, for current frame.
+local stamps = {}
+local loadStart = nil
+
+local stats =
+{
+	frame = {},
+	graphics = {},
+	gpuWait = {},
+	primitives = {},
+	loads = {}
+}
+
+local function cycles()
+	return tonumber(PCSX.getRegisters().cycle)
+end
+
+local function fail(message)
+	print("EmuPerf: " .. message)
+	PCSX.quit(1)
+end
+
+-- Fails early if PCSX-Redux does not provide the API this script relies on.
+local function checkApi()
+	local functions = {"getMemPtr", "getRegisters", "addBreakpoint", "quit"}
+
+	for _, name in ipairs(functions) do
+		if type(PCSX[name]) ~= "function" then
+			fail("PCSX." .. name .. "() is not available")
+			return false
+		end
+	end
+
+	if PCSX.Events == nil or type(PCSX.Events.createEventListener) ~= "function" then
+		fail("PCSX.Events.createEventListener() is not available")
+		return false
+	end
+
+	if tonumber(PCSX.getRegisters().cycle) == nil then
+		fail("PCSX.getRegisters() does not provide a cycle count")
+		return false
+	end
+
+	return true
+end
+
+local function parseInputs(path)
+	local file = io.open(path, "r")
+
+	if file == nil then
+		fail("could not open input script " .. path)
+		return
+	end
+
+	for line in file:lines() do
+		local words = {}
+
+		line = line:gsub("#.*", "")
+
+		for word in line:gmatch("%S+") do
+			table.insert(words, word)
+		end
+
+		if #words ~= 0 then
+			table.insert(commands, words)
+		end
+	end
+
+	file:close()
+end
+
+local function keysFrom(words, first)
+	local keys = 0
+
+	for i = first, #words do
+		local key = PAD_KEYS[words[i]:upper()]
+
+		if key == nil then
+			fail("unknown key " .. words[i])
+			return 0
+		end
+
+		keys = bit.bor(keys, key)
+	end
+
+	return keys
+end
+
+local function summary(name, values, unit, scale)
+	local n = #values
+
+	if n == 0 then
+		return
+	end
+
+	local min, max, sum = math.huge, 0, 0
+
+	for _, v in ipairs(values) do
+		min = math.min(min, v)
+		max = math.max(max, v)
+		sum = sum + v
+	end
+
+	print(string.format("%-12s avg %10.1f min %10.1f max %10.1f %s (%d samples)",
+		name, sum / n * scale, min * scale, max * scale, unit, n))
+end
+
+local function printSummary()
+	local us = 1000000 / CPU_FREQUENCY
+
+	print("EmuPerf summary:")
+	summary("frame", stats.frame, "us", us)
+	summary("graphics", stats.graphics, "us", us)
+	summary("gpu_wait", stats.gpuWait, "us", us)
+	summary("primitives", stats.primitives, "", 1)
+
+	for i, load in ipairs(stats.loads) do
+		print(string.format("load %-7d %10.1f ms (%d files)", i, load.cycles * us / 1000, load.files))
+	end
+end
+
+local function quit()
+	printSummary()
+
+	if csv ~= nil then
+		csv:close()
+	end
+
+	PCSX.quit(0)
+end
+
+-- Executes input script commands until one of them must wait.
+local function runCommands()
+	while (waitFrames == 0) and (waitingLoad == false) and (measureFrames == 0) do
+		local words = commands[commandIdx]
+
+		if words == nil then
+			quit()
+			return
+		end
+
+		commandIdx = commandIdx + 1
+
+		local command = words[1]:lower()
+
+		if command == "wait" then
+			waitFrames = tonumber(words[2])
+		elseif command == "waitload" then
+			waitingLoad = true
+		elseif command == "press" then
+			mailbox[MAILBOX_PAD] = keysFrom(words, 2)
+			releaseFrame = frames + 2
+			waitFrames = 2
+		elseif command == "hold" then
+			mailbox[MAILBOX_PAD] = keysFrom(words, 3)
+			releaseFrame = frames + tonumber(words[2])
+		elseif command == "measure" then
+			measureFrames = tonumber(words[2])
+		elseif command == "quit" then
+			quit()
+			return
+		else
+			fail("unknown command " .. command)
+			return
+		end
+	end
+end
+
+local function onFrame()
+	local frameCycles = nil
+
+	frames = frames + 1
+
+	if stamps.frame ~= nil then
+		frameCycles = stamps.now - stamps.frame
+	end
+
+	if releaseFrame ~= nil and frames >= releaseFrame then
+		mailbox[MAILBOX_PAD] = 0
+		releaseFrame = nil
+	end
+
+	if measureFrames > 0 and frameCycles ~= nil then
+		local graphics = 0
+		local gpuWait = 0
+		local layers = {}
+
+		if stamps.graphicsBegin ~= nil and stamps.graphicsEnd ~= nil then
+			graphics = stamps.graphicsEnd - stamps.graphicsBegin
+			table.insert(stats.graphics, graphics)
+
+			if stamps.gpuWaitEnd ~= nil then
+				gpuWait = stamps.gpuWaitEnd - stamps.graphicsEnd
+				table.insert(stats.gpuWait, gpuWait)
+			end
+		end
+
+		table.insert(stats.frame, frameCycles)
+		table.insert(stats.primitives, mailbox[MAILBOX_PRIMITIVES])
+
+		for i = 0, MAX_GFX_LAYERS - 1 do
+			table.insert(layers, tostring(mailbox[MAILBOX_LAYERS + i]))
+		end
+
+		csv:write(string.format("%d,%d,%d,%d,%d,%d,%d,%s\n",
+			mailbox[MAILBOX_FRAME],
+			frameCycles,
+			graphics,
+			gpuWait,
+			mailbox[MAILBOX_PRIMITIVES],
+			mailbox[MAILBOX_PRIMITIVES_PEAK],
+			mailbox[MAILBOX_DROPPED],
+			table.concat(layers, ",")))
+
+		measureFrames = measureFrames - 1
+	end
+
+	if waitFrames > 0 then
+		waitFrames = waitFrames - 1
+	end
+
+	stamps = {frame = stamps.now}
+
+	if frames > MAX_FRAMES then
+		fail("input script did not finish after " .. MAX_FRAMES .. " frames")
+		return
+	end
+
+	runCommands()
+end
+
+local function onHook(address, width, cause)
+	local point = mailbox[MAILBOX_POINT]
+
+	stamps.now = cycles()
+
+	if point == EMU_HOOK_FRAME then
+		onFrame()
+	elseif point == EMU_HOOK_GRAPHICS_BEGIN then
+		stamps.graphicsBegin = stamps.now
+	elseif point == EMU_HOOK_GRAPHICS_END then
+		stamps.graphicsEnd = stamps.now
+	elseif point == EMU_HOOK_GPU_WAIT_END then
+		stamps.gpuWaitEnd = stamps.now
+	elseif point == EMU_HOOK_LOAD_BEGIN then
+		loadStart = stamps.now
+	elseif point == EMU_HOOK_LOAD_END then
+		-- First load might have started before the mailbox was
+		-- found, so its duration is unknown and not recorded.
+		if loadStart ~= nil then
+			table.insert(stats.loads, {cycles = stamps.now - loadStart, files = mailbox[MAILBOX_ARG]})
+			loadStart = nil
+		end
+
+		waitingLoad = false
+		runCommands()
+	end
+
+	-- Emulation must not be paused.
+	return false
+end
+
+-- Copies of initialized data (e.g.: on CD-ROM sector buffers) are
+-- skipped by waiting until the game has signalled at least once.
+local function findMailbox()
+	local ram = ffi.cast("uint32_t*", PCSX.getMemPtr())
+
+	for i = 0, (RAM_SIZE / 4) - MAILBOX_SEQ - 1 do
+		if ram[i] == EMU_HOOK_MAGIC_0 and ram[i + 1] == EMU_HOOK_MAGIC_1 and ram[i + MAILBOX_SEQ] ~= 0 then
+			if ram[i + MAILBOX_VERSION] ~= EMU_HOOK_VERSION then
+				fail("unexpected mailbox version " .. ram[i + MAILBOX_VERSION])
+				return false
+			end
+
+			mailbox = ram + i
+			mailboxAddress = 0x80000000 + (i * 4)
+			return true
+		end
+	end
+
+	return false
+end
+
+local function start()
+	local inputs = os.getenv("AIRPORT_EMU_INPUTS") or "inputs.txt"
+	local csvPath = os.getenv("AIRPORT_EMU_CSV") or "emu_perf.csv"
+
+	parseInputs(inputs)
+
+	csv = io.open(csvPath, "w")
+
+	if csv == nil then
+		fail("could not open " .. csvPath)
+		return
+	end
+
+	csv:write("frame,frame_cycles,graphics_cycles,gpu_wait_cycles,primitives,primitives_peak,dropped")
+
+	for _, name in ipairs(LAYER_NAMES) do
+		csv:write("," .. name)
+	end
+
+	csv:write("\n")
+
+	print(string.format("EmuPerf: mailbox found at 0x%08X", mailboxAddress))
+
+	-- Global, so it is not garbage-collected.
+	hookBreakpoint = PCSX.addBreakpoint(mailboxAddress + (MAILBOX_SEQ * 4), "Write", 4, "EmuHook", onHook)
+	runCommands()
+end
+
+-- Executable is loaded from CD-ROM after BIOS has booted,
+-- so mailbox is looked for on each VBlank until found. Listener
+-- is global, so it is not garbage-collected.
+if checkApi() then
+	vsyncListener = PCSX.Events.createEventListener("GPU::Vsync", function()
+		if mailbox ~= nil then
+			return
+		end
+
+		scanVsyncs = scanVsyncs + 1
+
+		if findMailbox() then
+			start()
+		elseif scanVsyncs > MAX_SCAN_VSYNCS then
+			fail("mailbox not found. Was airport.exe built with -DEMU_HOOK=ON?")
+		end
+	end)
+end
@@ -81,6 +81,8 @@ void EndAnimation(void)
 
 		//~ SfxStopMusic();
 	}
+
+	GfxReleaseDisplayData();
 }
 
 void EndAnimationFadeOut(void)
@@ -34,6 +34,22 @@ enum
  * 	Local Prototypes
  * *************************************/
 
+static bool FontIsVisible(const TYPE_FONT* const ptrFont);
+static uint16_t FontLayout(	const TYPE_FONT* const ptrFont,
+							const char* str,
+							TYPE_FONT_GLYPH* const glyphs,
+							const uint16_t max_glyphs,
+							short* const w,
+							short* const h	);
+static void FontEmit(	TYPE_FONT* const ptrFont,
+						short x,
+						short y,
+						const TYPE_FONT_GLYPH* const glyphs,
+						const uint16_t n_glyphs,
+						short w,
+						short h	);
+static bool FontRunIsDirty(const TYPE_FONT_RUN* const ptrRun, const TYPE_FONT* const ptrFont, const char* const text);
+
 /* *************************************
  * 	Local Variables
  * *************************************/
@@ -44,10 +60,13 @@ TYPE_FONT RadioFont, SmallFont;
  * *************************************/
 
 static char _internal_text[FONT_INTERNAL_TEXT_BUFFER_MAX_SIZE];
+static TYPE_FONT_GLYPH _internal_glyphs[FONT_INTERNAL_TEXT_BUFFER_MAX_SIZE];
 static volatile unsigned char _blend_effect_lum;
 
 bool FontLoadImage(const char* strPath, TYPE_FONT * ptrFont)
 {
+	// spr is the first member from TYPE_FONT, so AssetCache
+	// links this file to ptrFont as well.
 	if (GfxSpriteFromFile(strPath, &ptrFont->spr) == false)
 	{
 		return false;
@@ -123,48 +142,60 @@ void FontCyclic(void)
 	_blend_effect_lum -= 8;
 }
 
-void FontPrintText(TYPE_FONT * ptrFont, short x, short y, const char* str, ...)
+static bool FontIsVisible(const TYPE_FONT* const ptrFont)
 {
-	uint16_t i;
-	uint8_t line_count = 0;
-	int result;
-	short orig_x = x;
-
-	va_list ap;
-
-    // Do not print anything if either 1Hz or 2Hz flags are configured
-    // and 1/2Hz signal has not been yet emitted by Gfx.
+	// Do not print anything if either 1Hz or 2Hz flags are configured
+	// and 1/2Hz signal has not been yet emitted by Gfx.
 	if (ptrFont->flags & FONT_1HZ_FLASH)
 	{
-		if (Gfx1HzFlash() == false)
-		{
-			return;
-		}
+		return Gfx1HzFlash();
 	}
 	else if (ptrFont->flags & FONT_2HZ_FLASH)
 	{
-		if (Gfx2HzFlash() == false)
-		{
-			return;
-		}
+		return Gfx2HzFlash();
 	}
 
-	va_start(ap, str);
+	return true;
+}
 
-	result = vsnprintf(	_internal_text,
-						FONT_INTERNAL_TEXT_BUFFER_MAX_SIZE,
-						str,
-						ap	);
+/* *******************************************************************
+ *
+ * @name: uint16_t FontLayout(const TYPE_FONT* const ptrFont, const char* str, TYPE_FONT_GLYPH* const glyphs, const uint16_t max_glyphs, short* const w, short* const h)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Converts a formatted string into an array of glyphs, whose
+ *  positions (relative to text origin), UV offsets and line breaks
+ *  are calculated according to font parameters.
+ *
+ * @return:
+ *  Number of glyphs written into glyphs. Bounding box dimensions
+ *  are written into w and h.
+ *
+ * *******************************************************************/
+static uint16_t FontLayout(	const TYPE_FONT* const ptrFont,
+							const char* str,
+							TYPE_FONT_GLYPH* const glyphs,
+							const uint16_t max_glyphs,
+							short* const w,
+							short* const h	)
+{
+	const bool wrap = (ptrFont->flags & FONT_WRAP_LINE) && (ptrFont->max_ch_wrap != 0);
+	uint16_t i;
+	uint16_t n_glyphs = 0;
+	uint8_t line_count = 0;
+	short x = 0;
+	short y = 0;
 
-	for (i = 0; i < result ; i++)
-	{
-		unsigned char _ch = _internal_text[i];
+	*w = 0;
+	*h = 0;
 
-		if (_ch == '\0')
-		{
-			// End of string
-			break;
-		}
+	for (i = 0; (str[i] != '\0') && (n_glyphs < max_glyphs); i++)
+	{
+		const unsigned char _ch = str[i];
+		TYPE_FONT_GLYPH* ptrGlyph;
+		unsigned short btn = 0;
 
 		switch(_ch)
 		{
@@ -173,26 +204,19 @@ void FontPrintText(TYPE_FONT * ptrFont, short x, short y, const char* str, ...)
 				bool linefeed_needed = false;
 
 				// Check if the next word fits on the same line
-				if ( (ptrFont->flags & FONT_WRAP_LINE) && (ptrFont->max_ch_wrap != 0) )
+				if (wrap)
 				{
 					uint16_t j;
 					uint8_t aux_line_count = line_count;
 
-					for (j = i + 1; j < result; j++)
+					for (j = i + 1; (str[j] != '\0') && (str[j] != ' '); j++)
 					{
-						if (_internal_text[j] != ' ')
-						{
-							if (++aux_line_count >= ptrFont->max_ch_wrap)
-							{
-								line_count = 0;
-								x = orig_x;
-								y += ptrFont->char_h;
-								linefeed_needed = true;
-								break;
-							}
-						}
-						else
+						if (++aux_line_count >= ptrFont->max_ch_wrap)
 						{
+							line_count = 0;
+							x = 0;
+							y += ptrFont->char_h;
+							linefeed_needed = true;
 							break;
 						}
 					}
@@ -202,97 +226,253 @@ void FontPrintText(TYPE_FONT * ptrFont, short x, short y, const char* str, ...)
 				{
 					x += ptrFont->char_w;
 				}
-
-				continue;
 			}
+			continue;
+
 			case '\n':
-				x = orig_x;
+				x = 0;
 				y += ptrFont->char_h;
-			break;
+			continue;
 
 			case SQUARE_BTN_8BIT:
-				GfxDrawButton(x, y, PAD_SQUARE);
-
-				x += BUTTON_SIZE;
-
-				line_count += BUTTON_SIZE / ptrFont->char_w;
+				btn = PAD_SQUARE;
 			break;
 
 			case CIRCLE_BTN_8BIT:
-				GfxDrawButton(x, y, PAD_CIRCLE);
-
-				x += BUTTON_SIZE;
-				line_count += BUTTON_SIZE / ptrFont->char_w;
+				btn = PAD_CIRCLE;
 			break;
 
 			case TRIANGLE_BTN_8BIT:
-				GfxDrawButton(x, y, PAD_TRIANGLE);
-
-				x += BUTTON_SIZE;
-				line_count += BUTTON_SIZE / ptrFont->char_w;
+				btn = PAD_TRIANGLE;
 			break;
 
 			case CROSS_BTN_8BIT:
-				GfxDrawButton(x, y, PAD_CROSS);
-
-				x += BUTTON_SIZE;
-				line_count += BUTTON_SIZE / ptrFont->char_w;
+				btn = PAD_CROSS;
 			break;
 
 			default:
-
-				if ( (ptrFont->flags & FONT_WRAP_LINE) && (ptrFont->max_ch_wrap != 0) )
+				if (wrap)
 				{
 					if (++line_count >= ptrFont->max_ch_wrap)
 					{
 						line_count = 0;
-						x = orig_x;
+						x = 0;
 						y += ptrFont->char_h;
 					}
 				}
+			break;
+		}
 
-				ptrFont->spr.x = x;
-				ptrFont->spr.y = y;
-				ptrFont->spr.w = ptrFont->char_w;
-				ptrFont->spr.h = ptrFont->char_h;
-				ptrFont->spr.u = (short)( (_ch - ptrFont->init_ch) % ptrFont->char_per_row) * ptrFont->char_w;
-				ptrFont->spr.u += ptrFont->spr_u; // Add original offset for image
-				ptrFont->spr.v = (short)( (_ch - ptrFont->init_ch) / ptrFont->char_per_row) * ptrFont->char_h;
-				ptrFont->spr.v += ptrFont->spr_v; // Add original offset for image
+		ptrGlyph = &glyphs[n_glyphs++];
 
-				if (ptrFont->flags & FONT_BLEND_EFFECT)
-				{
-					ptrFont->spr.r += 8;
-					ptrFont->spr.g += 8;
-					ptrFont->spr.b += 8;
-				}
-				else
-				{
-					ptrFont->spr.r = NORMAL_LUMINANCE;
-					ptrFont->spr.g = NORMAL_LUMINANCE;
-					ptrFont->spr.b = NORMAL_LUMINANCE;
-				}
-				/*Serial_printf("char_w = %d, char_h = %d, char_per_row = %d, init_ch: %c\n",
-						ptrFont->char_w,
-						ptrFont->char_h,
-						ptrFont->char_per_row,
-						ptrFont->init_ch);
-				Serial_printf("Char: %c, spr.u = %d, spr.v = %d\n",str[i],ptrFont->spr.u, ptrFont->spr.v);
-				Serial_printf("Sprite CX = %d, sprite CY = %d\n",ptrFont->spr.cx, ptrFont->spr.cy);*/
-				//Serial_printf("Sprite rgb={%d,%d,%d}\n",ptrFont->spr.r, ptrFont->spr.g, ptrFont->spr.b);
-
-				GfxSortSprite(&ptrFont->spr);
-				x += ptrFont->char_spacing;
-			break;
+		ptrGlyph->x = x;
+		ptrGlyph->y = y;
+		ptrGlyph->btn = btn;
+
+		if (btn != 0)
+		{
+			x += BUTTON_SIZE;
+			line_count += BUTTON_SIZE / ptrFont->char_w;
+
+			*w = (x > *w)? x : *w;
+			*h = ((y + BUTTON_SIZE) > *h)? (y + BUTTON_SIZE) : *h;
+		}
+		else
+		{
+			ptrGlyph->u = (unsigned char)(((_ch - ptrFont->init_ch) % ptrFont->char_per_row) * ptrFont->char_w);
+			ptrGlyph->v = (unsigned char)(((_ch - ptrFont->init_ch) / ptrFont->char_per_row) * ptrFont->char_h);
+
+			*w = ((x + ptrFont->char_w) > *w)? (x + ptrFont->char_w) : *w;
+			*h = ((y + ptrFont->char_h) > *h)? (y + ptrFont->char_h) : *h;
+
+			x += ptrFont->char_spacing;
+		}
+	}
+
+	return n_glyphs;
+}
+
+/* *******************************************************************
+ *
+ * @name: void FontEmit(TYPE_FONT* const ptrFont, short x, short y, const TYPE_FONT_GLYPH* const glyphs, const uint16_t n_glyphs, short w, short h)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds glyphs calculated by FontLayout() to primitive list,
+ *  using (x, y) as text origin.
+ *
+ * @remarks:
+ *  Screen limits are checked once for the whole bounding box,
+ *  so glyphs are sorted without further checks.
+ *
+ * *******************************************************************/
+static void FontEmit(	TYPE_FONT* const ptrFont,
+						short x,
+						short y,
+						const TYPE_FONT_GLYPH* const glyphs,
+						const uint16_t n_glyphs,
+						short w,
+						short h	)
+{
+	const bool blend = ptrFont->flags & FONT_BLEND_EFFECT;
+	GFX_LAYER prevLayer;
+	uint16_t i;
+
+	if (GfxIsInsideScreenArea(x, y, w, h) == false)
+	{
+		return;
+	}
+
+	prevLayer = GfxSetLayer(GFX_LAYER_FONTS);
+
+	ptrFont->spr.w = ptrFont->char_w;
+	ptrFont->spr.h = ptrFont->char_h;
+
+	if (blend == false)
+	{
+		ptrFont->spr.r = NORMAL_LUMINANCE;
+		ptrFont->spr.g = NORMAL_LUMINANCE;
+		ptrFont->spr.b = NORMAL_LUMINANCE;
+	}
+
+	for (i = 0; i < n_glyphs; i++)
+	{
+		const TYPE_FONT_GLYPH* const ptrGlyph = &glyphs[i];
+
+		if (ptrGlyph->btn != 0)
+		{
+			GfxDrawButton(x + ptrGlyph->x, y + ptrGlyph->y, ptrGlyph->btn);
+			continue;
 		}
+
+		ptrFont->spr.x = x + ptrGlyph->x;
+		ptrFont->spr.y = y + ptrGlyph->y;
+		// Add original offset for image
+		ptrFont->spr.u = ptrFont->spr_u + ptrGlyph->u;
+		ptrFont->spr.v = ptrFont->spr_v + ptrGlyph->v;
+
+		if (blend)
+		{
+			ptrFont->spr.r += 8;
+			ptrFont->spr.g += 8;
+			ptrFont->spr.b += 8;
+		}
+
+		GfxSortSprite_Fast(&ptrFont->spr);
 	}
 
-	if (ptrFont->flags & FONT_BLEND_EFFECT)
+	if (blend)
 	{
 		ptrFont->spr.r = _blend_effect_lum;
 		ptrFont->spr.g = _blend_effect_lum;
 		ptrFont->spr.b = _blend_effect_lum;
 	}
 
+	GfxSetLayer(prevLayer);
+}
+
+void FontPrintText(TYPE_FONT * ptrFont, short x, short y, const char* str, ...)
+{
+	uint16_t n_glyphs;
+	short w;
+	short h;
+	va_list ap;
+
+	if (FontIsVisible(ptrFont) == false)
+	{
+		return;
+	}
+
+	va_start(ap, str);
+
+	vsnprintf(	_internal_text,
+				FONT_INTERNAL_TEXT_BUFFER_MAX_SIZE,
+				str,
+				ap	);
+
+	va_end(ap);
+
+	n_glyphs = FontLayout(	ptrFont,
+							_internal_text,
+							_internal_glyphs,
+							FONT_INTERNAL_TEXT_BUFFER_MAX_SIZE,
+							&w,
+							&h	);
+
+	FontEmit(ptrFont, x, y, _internal_glyphs, n_glyphs, w, h);
+}
+
+static bool FontRunIsDirty(const TYPE_FONT_RUN* const ptrRun, const TYPE_FONT* const ptrFont, const char* const text)
+{
+	const uint8_t max_ch_wrap = (ptrFont->flags & FONT_WRAP_LINE)? ptrFont->max_ch_wrap : 0;
+
+	return (	(ptrRun->ptrFont != ptrFont)
+					||
+				(ptrRun->char_w != ptrFont->char_w)
+					||
+				(ptrRun->char_h != ptrFont->char_h)
+					||
+				(ptrRun->char_spacing != ptrFont->char_spacing)
+					||
+				(ptrRun->init_ch != ptrFont->init_ch)
+					||
+				(ptrRun->max_ch_wrap != max_ch_wrap)
+					||
+				(strncmp(ptrRun->text, text, FONT_RUN_MAX_LENGTH) != 0)	);
+}
+
+/* *******************************************************************
+ *
+ * @name: void FontRunPrint(TYPE_FONT_RUN* const ptrRun, TYPE_FONT* const ptrFont, short x, short y, const char* str, ...)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Same as FontPrintText(), but glyph layout is cached into ptrRun
+ *  and only calculated again if formatted text or font parameters
+ *  have changed since last call.
+ *
+ * @remarks:
+ *  Intended for text which is drawn on every frame but rarely
+ *  changes (e.g.: score, clock, aircraft list). ptrRun must be
+ *  zero-initialized before first use. Formatted text longer than
+ *  FONT_RUN_MAX_LENGTH - 1 characters is truncated.
+ *
+ * *******************************************************************/
+void FontRunPrint(TYPE_FONT_RUN* const ptrRun, TYPE_FONT* const ptrFont, short x, short y, const char* str, ...)
+{
+	char text[FONT_RUN_MAX_LENGTH];
+	va_list ap;
+
+	if (FontIsVisible(ptrFont) == false)
+	{
+		return;
+	}
+
+	va_start(ap, str);
+
+	vsnprintf(text, sizeof (text), str, ap);
+
 	va_end(ap);
+
+	if (FontRunIsDirty(ptrRun, ptrFont, text))
+	{
+		memcpy(ptrRun->text, text, sizeof (text));
+
+		ptrRun->ptrFont = ptrFont;
+		ptrRun->char_w = ptrFont->char_w;
+		ptrRun->char_h = ptrFont->char_h;
+		ptrRun->char_spacing = ptrFont->char_spacing;
+		ptrRun->init_ch = ptrFont->init_ch;
+		ptrRun->max_ch_wrap = (ptrFont->flags & FONT_WRAP_LINE)? ptrFont->max_ch_wrap : 0;
+		ptrRun->n_glyphs = (uint8_t)FontLayout(	ptrFont,
+												ptrRun->text,
+												ptrRun->glyphs,
+												FONT_RUN_MAX_LENGTH,
+												&ptrRun->w,
+												&ptrRun->h	);
+	}
+
+	FontEmit(ptrFont, x, y, ptrRun->glyphs, ptrRun->n_glyphs, ptrRun->w, ptrRun->h);
 }
@@ -23,6 +23,8 @@
 bool FontLoadImage(const char* strPath, TYPE_FONT * ptrFont);
 void FontSetSize(TYPE_FONT * ptrFont, short size);
 void FontPrintText(TYPE_FONT *ptrFont, short x, short y, const char* str, ...);
+// Same as FontPrintText(), but layout is cached into ptrRun until text or font parameters change.
+void FontRunPrint(TYPE_FONT_RUN* const ptrRun, TYPE_FONT* const ptrFont, short x, short y, const char* str, ...);
 void FontSetInitChar(TYPE_FONT * ptrFont, char c);
 void FontSetFlags(TYPE_FONT * ptrFont, FONT_FLAGS flags);
 void FontCyclic(void);
@@ -13,6 +13,13 @@
 #include "Sfx.h"
 #include "Pad.h"
 #include "Message.h"
+#include "Dialog.h"
+#include "Profiler.h"
+#include "AssetCache.h"
+#include "Vram.h"
+#include "Log.h"
+#include "Memory.h"
+#include "EmuHook.h"
 
 /* *************************************
  *  Defines
@@ -49,11 +56,17 @@ typedef struct t_rwyentrydata
     uint16_t rwyHeader;
 }TYPE_RWY_ENTRY_DATA;
 
-typedef struct t_GameLevelBuffer_UVData
+// Tile sprite data which does not change during gameplay.
+// Calculated once on GameLoadLevel().
+typedef struct t_GameLevelBuffer_RenderData
 {
-    short u;
-    short v;
-}TYPE_TILE_UV_DATA;
+    GsSprite* ptrTileset;   // NULL for invalid tiles.
+    unsigned char u;
+    unsigned char v;
+    short mx;
+    short my;
+    bool flip;
+}TYPE_TILE_RENDER_DATA;
 
 enum
 {
@@ -119,6 +132,21 @@ enum
     LAST_TILE_TILESET2 = TILE_TAXIWAY_CORNER_GRASS_3
 };
 
+enum
+{
+    BUILDING_NONE,
+    BUILDING_HANGAR,
+    BUILDING_ILS,
+    BUILDING_ATC_TOWER,
+    BUILDING_ATC_LOC,
+    BUILDING_TERMINAL,
+    BUILDING_TERMINAL_2,
+    BUILDING_GATE,
+
+    LAST_BUILDING = BUILDING_GATE,
+    MAX_BUILDING_ID
+};
+
 enum
 {
     SOUND_M1_INDEX,
@@ -132,10 +160,11 @@ enum
  * *************************************/
 
 static void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg);
-static void GameInitTileUVTable(void);
 static bool GameExit(void);
 static void GameLoadLevel(const char* path);
-static bool GamePause(void);
+static uint8_t GameCheckLevelHeader(const uint8_t* const LevelHeader);
+static void GameSetGeneratedTile(uint8_t* const levelData, const uint8_t columns, const uint8_t row, const uint8_t column, const uint8_t building, const uint8_t tile);
+static void GamePause(void);
 static void GameFinished(const uint8_t i);
 static void GameEmergencyMode(void);
 static void GameCalculations(void);
@@ -157,7 +186,6 @@ static void GameStateSelectTaxiwayParking(TYPE_PLAYER* const ptrPlayer, TYPE_FLI
 static void GameStateLockTarget(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
 static TYPE_ISOMETRIC_POS GameSelectAircraft(TYPE_PLAYER* const ptrPlayer);
 static void GameSelectAircraftWaypoint(TYPE_PLAYER* const ptrPlayer);
-static void GameGetRunwayArray(void);
 static void GameGetSelectedRunwayArray(uint16_t rwyHeader, uint16_t* rwyArray, size_t sz);
 static void GameAssignRunwaytoAircraft(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
 static bool GamePathToTile(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
@@ -205,7 +233,7 @@ static bool GameAircraftCollisionFlag;
 static uint8_t GameAircraftCollisionIdx;
 static uint8_t GameAircraftTilemap[GAME_MAX_MAP_SIZE][GAME_MAX_AIRCRAFT_PER_TILE];
 
-static TYPE_TILE_UV_DATA GameLevelBuffer_UVData[GAME_MAX_MAP_SIZE];
+static TYPE_TILE_RENDER_DATA GameLevelBuffer_RenderData[GAME_MAX_MAP_SIZE];
 
 // Radio chatter
 static SsVag ApproachSnds[MAX_RADIO_CHATTER_SOUNDS];
@@ -278,6 +306,11 @@ void Game(const TYPE_GAME_CONFIGURATION* const pGameCfg)
 
     while (1)
     {
+        // Input is routed to topmost dialog before any other
+        // module reads it, so a key press which opens a dialog
+        // is not handled by the dialog itself on the same frame.
+        DialogHandler();
+
         if (GameExit())
         {
             break;
@@ -285,7 +318,10 @@ void Game(const TYPE_GAME_CONFIGURATION* const pGameCfg)
 
         GameEmergencyMode();
 
-        GameCalculations();
+        if (DialogSimulationPaused() == false)
+        {
+            GameCalculations();
+        }
 
         GameGraphics();
 
@@ -315,25 +351,24 @@ void Game(const TYPE_GAME_CONFIGURATION* const pGameCfg)
  * ***************************************************************************************/
 static bool GameExit(void)
 {
-    if (levelFinished)
+    if (GameGuiDialogExit())
     {
-        // Exit game on level finished.
-        if (GameGuiFinishedDialog(&PlayerData[PLAYER_ONE]))
-        {
-            return true;
-        }
+        // Exit game if player desires to exit.
+        return true;
     }
 
-    if (GamePause())
+    if (levelFinished)
     {
-        // Exit game if player desires to exit.
-        return true;
+        // Dialog is opened again on next frame
+        // if player chooses to resume.
+        GameGuiFinishedDialog(&PlayerData[PLAYER_ONE]);
     }
 
+    GamePause();
+
     if (GameAircraftCollisionFlag)
     {
         GameGuiAircraftCollision(&PlayerData[PLAYER_ONE]);
-        return true;
     }
 
     return false;
@@ -341,23 +376,26 @@ static bool GameExit(void)
 
 /* ***************************************************************************************
  *
- * @name: bool GamePause(void)
+ * @name: void GamePause(void)
  *
  * @author: Xavier Del Campo
  *
  * @brief:
- *  When PAD_START is pressed, it draws a rectangle on top of the screen and the game halts.
+ *  When PAD_START is pressed, pause dialog is opened and the game halts.
  *
  * @remarks:
+ *  Ignored while any other dialog is open, and also on the frame
+ *  a dialog has been closed, so PAD_START press which closed
+ *  pause dialog does not open it again.
  *
  * ***************************************************************************************/
-static bool GamePause(void)
+static void GamePause(void)
 {
     uint8_t i;
 
-    if (GameStartupFlag)
+    if (GameStartupFlag || DialogAnyOpen() || DialogClosedThisFrame())
     {
-        return false;
+        return;
     }
 
     for (i = 0 ; i < MAX_PLAYERS ; i++)
@@ -372,15 +410,13 @@ static bool GamePause(void)
             {
                 Serial_printf("Player %d set pause_flag to true!\n",i);
 
-                // Blocking function:
-                //  * Returns true if player pointed to by ptrPlayer wants to exit game
-                //  * Returns false if player pointed to by ptrPlayer wants to resume game
-                return GameGuiPauseDialog(ptrPlayer);
+                // Input from ptrPlayer is routed to pause dialog
+                // until player either resumes or exits game.
+                GameGuiPauseDialog(ptrPlayer);
+                return;
             }
         }
     }
-
-    return false;
 }
 
 /* ***************************************************************************************
@@ -393,7 +429,8 @@ static bool GamePause(void)
  *  Game basic parameters initialization.
  *
  * @remarks:
- *  Tilesets and buildings are only loaded on first game. Then, only PLT is loaded.
+ *  Tilesets, buildings and sounds are only loaded again if they are no
+ *  longer resident (see AssetCache). PLT is always loaded.
  *
  * ***************************************************************************************/
 void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
@@ -431,16 +468,29 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
 
     GameStartupFlag = true;
 
+    // Dialogs from a previous game must not remain open.
+    DialogInit();
+
     // Has to be initialized before loading *.PLT files inside LoadMenu().
     MessageInit();
 
+    // Main menu regions are only evicted if game data needs their space.
+    VramSetOwner(VRAM_OWNER_GAME);
+
+    // Files which are still resident from previous games are not loaded again.
+    LOAD_FILES(GameFileList, GameFileDest);
+
     if (loaded == false)
     {
         loaded = true;
 
-        LOAD_FILES(GameFileList, GameFileDest);
-
         GameSpawnMinTime = TimerCreate(GAME_MINIMUM_PARKING_SPAWN_TIME, false, GameMinimumSpawnTimeout);
+
+        MEMORY_REGISTER("Game", levelBuffer);
+        MEMORY_REGISTER("Game", GameLevelBuffer_RenderData);
+        MEMORY_REGISTER("Game", GameAircraftTilemap);
+        MEMORY_REGISTER("Game", PlayerData);
+        MEMORY_REGISTER("Game", FlightData);
     }
 
     LoadMenu(   &pGameCfg->PLTPath,
@@ -452,8 +502,6 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
 
     GameGuiInit();
 
-    memset(GameRwy, 0, GAME_MAX_RUNWAYS * sizeof (uint16_t) );
-
     memset(GameUsedRwy, 0, GAME_MAX_RUNWAYS * sizeof (uint16_t) );
 
     PlayerData[PLAYER_ONE].Active = true;
@@ -467,6 +515,9 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
     PlayerData[PLAYER_ONE].InvalidPath = false;
     PlayerData[PLAYER_ONE].LockTarget = false;
     PlayerData[PLAYER_ONE].Unboarding = false;
+    // Runways and aircraft from previous level are no longer valid.
+    PlayerData[PLAYER_ONE].SelectedRunway = 0;
+    PlayerData[PLAYER_ONE].SelectedAircraft = 0;
 
     memset(PlayerData[PLAYER_ONE].UnboardingSequence, 0, GAME_MAX_SEQUENCE_KEYS * sizeof (unsigned short) );
     memset(PlayerData[PLAYER_ONE].TileData, 0, GAME_MAX_MAP_SIZE * sizeof (TYPE_TILE_DATA));
@@ -485,6 +536,9 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
         PlayerData[PLAYER_TWO].InvalidPath = false;
         PlayerData[PLAYER_TWO].LockTarget = false;
         PlayerData[PLAYER_TWO].Unboarding = false;
+        // Runways and aircraft from previous level are no longer valid.
+        PlayerData[PLAYER_TWO].SelectedRunway = 0;
+        PlayerData[PLAYER_TWO].SelectedAircraft = 0;
 
         memset(PlayerData[PLAYER_TWO].UnboardingSequence, 0, GAME_MAX_SEQUENCE_KEYS * sizeof (unsigned short) );
         memset(PlayerData[PLAYER_TWO].TileData, 0, GAME_MAX_MAP_SIZE * sizeof (TYPE_TILE_DATA));
@@ -512,6 +566,9 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
         PlayerData[i].WaypointIdx = 0;
         PlayerData[i].LastWaypointIdx = 0;
         PlayerData[i].RemainingAircraft = 0;
+        // Free VRAM might have changed since last game.
+        PlayerData[i].AircraftListCache.AllocFailed = false;
+        PlayerData[i].AircraftListCache.Valid = false;
     }
 
     aircraftCreated = false;
@@ -540,16 +597,14 @@ void GameInit(const TYPE_GAME_CONFIGURATION* const pGameCfg)
 
     GameScore = 0;
 
-    GameGetRunwayArray();
-
     GameSelectedTile = 0;
 
     levelFinished = false;
 
-    GameInitTileUVTable();
-
     AircraftInit();
 
+    VramPrintStats();
+
     LoadMenuEnd();
 
     GfxSetGlobalLuminance(0);
@@ -704,7 +759,12 @@ static void GameGetAircraftTilemap(const uint8_t i)
             }
         }
 
-        GameAircraftTilemap[tileNr][j] = i;
+        // Flights on approach are all reported on tile 0,
+        // so they can exceed GAME_MAX_AIRCRAFT_PER_TILE.
+        if (j < GAME_MAX_AIRCRAFT_PER_TILE)
+        {
+            GameAircraftTilemap[tileNr][j] = i;
+        }
     }
 }
 
@@ -727,6 +787,8 @@ void GameCalculations(void)
 {
     uint8_t i;
 
+    PROFILER_BEGIN(PROFILER_SECTION_GAME_CALCULATIONS);
+
     GameClock();
 
     // Set level finished flag. It will
@@ -744,17 +806,29 @@ void GameCalculations(void)
     }
 
     MessageHandler();
+
+    PROFILER_BEGIN(PROFILER_SECTION_AIRCRAFT_HANDLER);
     AircraftHandler();
+    PROFILER_END(PROFILER_SECTION_AIRCRAFT_HANDLER);
+
     GameGuiCalculateSlowScore();
 
     for (i = 0 ; i < MAX_PLAYERS ; i++)
     {
-        // Run player-specific functions for each player
-        if (PlayerData[i].Active)
+        // Run player-specific functions for each player.
+        // Input from a player whose pad is routed to a
+        // dialog must not be handled by gameplay.
+        if (    PlayerData[i].Active
+                    &&
+                (DialogHasFocus(PlayerData[i].PadKeySinglePress_Callback) == false) )
         {
             GamePlayerHandler(&PlayerData[i], &FlightData);
         }
     }
+
+    PROFILER_GAME_STATE(FlightData.ActiveAircraft, PlayerData);
+
+    PROFILER_END(PROFILER_SECTION_GAME_CALCULATIONS);
 }
 
 /* ***************************************************************************************
@@ -805,7 +879,11 @@ void GamePlayerHandler(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptr
     GameStateSelectTaxiwayParking(ptrPlayer, ptrFlightData);
     GameStateShowAircraft(ptrPlayer, ptrFlightData);
     CameraHandler(ptrPlayer);
+
+    PROFILER_BEGIN(PROFILER_SECTION_TERRAIN_PRECALCULATIONS);
     GameRenderTerrainPrecalculations(ptrPlayer, ptrFlightData);
+    PROFILER_END(PROFILER_SECTION_TERRAIN_PRECALCULATIONS);
+
     GameGuiActiveAircraftPage(ptrPlayer, ptrFlightData);
     GameSelectAircraftFromList(ptrPlayer, ptrFlightData);
 }
@@ -908,8 +986,7 @@ void GameGraphics(void)
     uint8_t i;
     bool split_screen = false;
 
-    // Caution: blocking function!
-    MessageRender();
+    EMU_HOOK(EMU_HOOK_GRAPHICS_BEGIN, 0);
 
     if (twoPlayers)
     {
@@ -937,17 +1014,35 @@ void GameGraphics(void)
             // only if 2-player mode is active. Else, render
             // the whole screen as usual.
 
+            // Primitives are linked by depth from now on, so they
+            // can be sorted in any order.
+            GfxOTBegin();
+
+            // Terrain is the first layer to be dropped
+            // if primitive list is close to its limit.
+            GfxSetLayer(GFX_LAYER_TERRAIN);
+
             // Render background first.
             GameDrawBackground();
 
             // Then ground tiles must be rendered.
 
+            PROFILER_BEGIN(PROFILER_SECTION_RENDER_TERRAIN);
             GameRenderTerrain(ptrPlayer);
+            PROFILER_END(PROFILER_SECTION_RENDER_TERRAIN);
 
             // Ground tiles are now rendered. Now, depending on building/aircraft
             // positions, determine in what order they should be rendered.
 
+            PROFILER_BEGIN(PROFILER_SECTION_RENDER_BUILDING_AIRCRAFT);
             GameRenderBuildingAircraft(ptrPlayer);
+            PROFILER_END(PROFILER_SECTION_RENDER_BUILDING_AIRCRAFT);
+
+            GfxOTSetZ(GFX_OT_GUI_Z);
+
+            GfxSetLayer(GFX_LAYER_GUI);
+
+            PROFILER_BEGIN(PROFILER_SECTION_GUI);
 
             GameGuiAircraftList(ptrPlayer, &FlightData);
 
@@ -957,11 +1052,9 @@ void GameGraphics(void)
 
             GameGuiDrawUnboardingSequence(ptrPlayer);
 
-            if (split_screen)
-            {
-                GfxDrawScene_NoSwap();
-                while (GsIsDrawing());
-            }
+            PROFILER_END(PROFILER_SECTION_GUI);
+
+            GfxOTEnd();
         }
     }
 
@@ -974,16 +1067,24 @@ void GameGraphics(void)
 
     // Draw common elements for both players (messages, clock...)
 
+    PROFILER_BEGIN(PROFILER_SECTION_GUI);
+
     GameGuiBubble(&FlightData);
 
     GameGuiClock(GameHour,GameMinutes);
 
     GameGuiShowScore();
 
-    if (split_screen)
-    {
-        GfxDrawScene_NoSwap();
-    }
+    // Dialogs are drawn on top of everything else.
+    DialogRender();
+
+    PROFILER_END(PROFILER_SECTION_GUI);
+
+    // Both split screen halves and common elements are drawn
+    // on a single primitive list submission. Then, CPU can
+    // calculate next frame while GPU is still drawing.
+
+    EMU_HOOK(EMU_HOOK_GRAPHICS_END, 0);
 
     GfxDrawScene();
 }
@@ -1068,30 +1169,17 @@ static void GameDrawBackground(void)
  *      Pointer to player data structure.
  *
  * @brief:
- *  Determines rendering order depending on building/aircraft
- *  isometric position data.
+ *  Renders buildings and aircraft into ordering table buckets
+ *  depending on their isometric position data.
  *
  * @remarks:
+ *  Must be called between GfxOTBegin() and GfxOTEnd(), so rendering
+ *  order is resolved by the GPU ordering table instead of the CPU.
  *
  * *******************************************************************/
 
 void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
 {
-    enum
-    {
-        BUILDING_NONE,
-        BUILDING_HANGAR,
-        BUILDING_ILS,
-        BUILDING_ATC_TOWER,
-        BUILDING_ATC_LOC,
-        BUILDING_TERMINAL,
-        BUILDING_TERMINAL_2,
-        BUILDING_GATE,
-
-        LAST_BUILDING = BUILDING_GATE,
-        MAX_BUILDING_ID
-    };
-
     enum
     {
         BUILDING_ATC_LOC_OFFSET_X = TILE_SIZE >> 1,
@@ -1307,24 +1395,12 @@ void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
     {
         // Building data is stored in levelBuffer MSB. LSB is dedicated to tile data.
         uint8_t CurrentBuilding = (uint8_t)(levelBuffer[tileNr] >> 8);
-        uint8_t j;
         uint8_t k;
-        uint8_t AircraftRenderOrder[GAME_MAX_AIRCRAFT_PER_TILE];
-        short Aircraft_Y_Data[GAME_MAX_AIRCRAFT_PER_TILE];
-
-        memset(AircraftRenderOrder, FLIGHT_DATA_INVALID_IDX, sizeof (AircraftRenderOrder) );
 
-        for (j = 0; j < GAME_MAX_AIRCRAFT_PER_TILE; j++)
+        for (k = 0; k < GAME_MAX_AIRCRAFT_PER_TILE; k++)
         {
-            // Fill with 0x7FFF (maximum 16-bit positive value).
-            Aircraft_Y_Data[j] = 0x7FFF;
-        }
-
-        for (j = 0; j < GAME_MAX_AIRCRAFT_PER_TILE; j++)
-        {
-            uint8_t AircraftIdx = GameAircraftTilemap[tileNr][j];
-
-            TYPE_ISOMETRIC_POS aircraftIsoPos = AircraftGetIsoPos(AircraftIdx);
+            const uint8_t AircraftIdx = GameAircraftTilemap[tileNr][k];
+            TYPE_ISOMETRIC_POS aircraftIsoPos;
 
             if (AircraftIdx == FLIGHT_DATA_INVALID_IDX)
             {
@@ -1332,39 +1408,19 @@ void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
                 break;
             }
 
-            //DEBUG_PRINT_VAR(aircraftIsoPos.y);
-
-            for (k = 0; k < GAME_MAX_AIRCRAFT_PER_TILE; k++)
-            {
-                if (aircraftIsoPos.y < Aircraft_Y_Data[k])
-                {
-                    uint8_t idx;
+            aircraftIsoPos = AircraftGetIsoPos(AircraftIdx);
 
-                    for (idx = k; idx < (GAME_MAX_AIRCRAFT_PER_TILE - 1); idx++)
-                    {
-                        // Move previous Y values to the right.
-                        Aircraft_Y_Data[idx + 1] = Aircraft_Y_Data[idx];
-                        AircraftRenderOrder[idx + 1] = AircraftRenderOrder[idx];
-                    }
+            // Rendering order against buildings and other
+            // aircraft is resolved by the ordering table.
+            GfxOTSetZ(GfxOTDepthFromIsometric(&aircraftIsoPos));
 
-                    Aircraft_Y_Data[k] = aircraftIsoPos.y;
-                    AircraftRenderOrder[k] = AircraftIdx;
+            GfxSetLayer(GFX_LAYER_AIRCRAFT);
 
-                    break;
-                }
-            }
+            AircraftRender(ptrPlayer, AircraftIdx);
         }
 
-        if (CurrentBuilding == BUILDING_NONE)
+        if (CurrentBuilding != BUILDING_NONE)
         {
-            for (k = 0; k < GAME_MAX_AIRCRAFT_PER_TILE; k++)
-            {
-                AircraftRender(ptrPlayer, AircraftRenderOrder[k]);
-            }
-        }
-        else
-        {
-            // Determine rendering order depending on Y value.
             short x_bldg_offset = GameBuildingData[CurrentBuilding].IsoPos.x;
             short y_bldg_offset = GameBuildingData[CurrentBuilding].IsoPos.y;
             short z_bldg_offset = GameBuildingData[CurrentBuilding].IsoPos.z;
@@ -1380,7 +1436,6 @@ void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
 
             // Isometric -> Cartesian conversion
             TYPE_CARTESIAN_POS buildingCartPos = GfxIsometricToCartesian(&buildingIsoPos);
-            bool buildingDrawn = false;
 
             // Define new coordinates for building.
             GameBuildingSpr.x = buildingCartPos.x - GameBuildingData[CurrentBuilding].orig_x;
@@ -1393,42 +1448,14 @@ void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
 
             CameraApplyCoordinatesToSprite(ptrPlayer, &GameBuildingSpr);
 
-            for (k = 0; k < GAME_MAX_AIRCRAFT_PER_TILE; k++)
-            {
-                if (AircraftRenderOrder[k] == FLIGHT_DATA_INVALID_IDX)
-                {
-                    if (buildingDrawn == false)
-                    {
-                        GfxSortSprite(&GameBuildingSpr);
-
-                        GameBuildingSpr.u = orig_u;
-                        GameBuildingSpr.v = orig_v;
+            GfxOTSetZ(GfxOTDepthFromIsometric(&buildingIsoPos));
 
-                        buildingDrawn = true;
-                    }
+            GfxSetLayer(GFX_LAYER_BUILDINGS);
 
-                    break;
-                }
+            GfxSortSprite(&GameBuildingSpr);
 
-                if (Aircraft_Y_Data[k] < buildingIsoPos.y)
-                {
-                    AircraftRender(ptrPlayer, AircraftRenderOrder[k]);
-                }
-                else
-                {
-                    if (buildingDrawn == false)
-                    {
-                        GfxSortSprite(&GameBuildingSpr);
-
-                        GameBuildingSpr.u = orig_u;
-                        GameBuildingSpr.v = orig_v;
-
-                        buildingDrawn = true;
-                    }
-
-                    AircraftRender(ptrPlayer, AircraftRenderOrder[k]);
-                }
-            }
+            GameBuildingSpr.u = orig_u;
+            GameBuildingSpr.v = orig_v;
         }
 
         if (columns < (GameLevelColumns - 1) )
@@ -1445,92 +1472,490 @@ void GameRenderBuildingAircraft(TYPE_PLAYER* const ptrPlayer)
 
 /* *******************************************************************
  *
- * @name: void GameLoadLevel(void)
+ * @name: void GameLoadLevel(const char* path)
  *
  * @author: Xavier Del Campo
  *
  * @brief:
  *  Loads and parses *.LVL data.
  *
- *
  * @remarks:
- *  Filepath for *.LVL is given by GameLevelList[0]. Do NOT ever move
- *  it from there to avoid problems!
+ *  Header is validated from a LEVEL_HEADER_SIZE-byte read, and then
+ *  tile data is read directly into levelBuffer, so System's file
+ *  buffer is not used. Tile UV table and runway headers (GameRwy)
+ *  are calculated on the same pass that converts tile data
+ *  from big-endian (as written by MapEditor) to native byte order.
  *
  * *******************************************************************/
 
 static void GameLoadLevel(const char* path)
 {
+    uint8_t LevelHeader[LEVEL_HEADER_SIZE];
     uint8_t i = 0;
-    uint8_t* ptrBuffer;
-    char LevelHeader[LEVEL_MAGIC_NUMBER_SIZE + 1];
-
-    /* TODO - Very important */
-    // Map contents (that means, without header) should be copied to levelBuffer
-    // Header treatment (magic number, map size, map title...) should be done
-    // using System's file buffer.
+    uint8_t nRwy = 0;
+    uint16_t tileNr;
+    uint32_t fileSize;
+    uint32_t levelDataSize;
 
-    if (SystemLoadFile((char*)path) == false)
+    if (AssetCacheIsResident(path, levelBuffer))
     {
+        // levelBuffer and data derived from it are not modified
+        // during gameplay, so they can be reused as they are.
+        Serial_printf("Level \"%s\" is already resident.\n", path);
         return;
     }
 
-    ptrBuffer = SystemGetBufferAddress();
+    AssetCacheRemove(levelBuffer);
 
-    //SystemLoadFileToBuffer(GameLevelList[0],levelBuffer,GAME_MAX_MAP_SIZE);
+    memset(levelBuffer, 0, sizeof (levelBuffer));
+    memset(GameLevelBuffer_RenderData, 0, sizeof (GameLevelBuffer_RenderData));
+    memset(GameRwy, 0, sizeof (GameRwy));
+    memset(GameLevelTitle, 0, sizeof (GameLevelTitle));
 
-    memset(LevelHeader,0, LEVEL_MAGIC_NUMBER_SIZE + 1);
+    GameLevelSize = 0;
 
-    memmove(LevelHeader,ptrBuffer,LEVEL_MAGIC_NUMBER_SIZE);
+    if (SystemOpenFile(path, &fileSize) == false)
+    {
+        return;
+    }
 
-    LevelHeader[LEVEL_MAGIC_NUMBER_SIZE] = '\0';
+    if (SystemReadFileChunk(LevelHeader, sizeof (LevelHeader)) != sizeof (LevelHeader))
+    {
+        Serial_printf("Level file is too short! Size: %d bytes\n", fileSize);
+        SystemCloseFile();
+        return;
+    }
 
-    Serial_printf("Level header: %s\n",LevelHeader);
+    GameLevelColumns = GameCheckLevelHeader(LevelHeader);
 
-    if (strncmp(LevelHeader,LEVEL_MAGIC_NUMBER_STRING,LEVEL_MAGIC_NUMBER_SIZE) != 0)
+    if (GameLevelColumns == 0)
     {
-        Serial_printf("Invalid level header! Read \"%s\" instead of " LEVEL_MAGIC_NUMBER_STRING "\n", LevelHeader);
+        SystemCloseFile();
         return;
     }
 
-    i += LEVEL_MAGIC_NUMBER_SIZE;
+    Serial_printf("Level size: %d\n",GameLevelColumns);
 
-    GameLevelColumns = ptrBuffer[i++];
+    // Title is placed after magic number and number of columns.
+    i = LEVEL_MAGIC_NUMBER_SIZE + 1;
 
-    Serial_printf("Level size: %d\n",GameLevelColumns);
+    memmove(GameLevelTitle, &LevelHeader[i], LEVEL_TITLE_SIZE - 1);
+
+    Serial_printf("Game level title: %s\n",GameLevelTitle);
+
+    levelDataSize = GameLevelColumns * GameLevelColumns * sizeof (uint16_t);
 
-    if (    (GameLevelColumns < MIN_MAP_COLUMNS)
+    if (    (fileSize < (LEVEL_HEADER_SIZE + levelDataSize))
                 ||
-            (GameLevelColumns > MAX_MAP_COLUMNS)    )
+            (SystemReadFileChunk((uint8_t*)levelBuffer, levelDataSize) != levelDataSize)  )
     {
-        Serial_printf("Invalid map size! Value: %d\n",GameLevelColumns);
+        Serial_printf("Level data is incomplete! Expected %d bytes\n", levelDataSize);
+        SystemCloseFile();
+        memset(levelBuffer, 0, sizeof (levelBuffer));
         return;
     }
 
+    SystemCloseFile();
+
     GameLevelSize = GameLevelColumns * GameLevelColumns;
 
-    memset(GameLevelTitle,0,LEVEL_TITLE_SIZE);
+    // Tables sized for GAME_MAX_MAP_SIZE tiles, of which only
+    // GameLevelSize are used by current level.
+    MEMORY_USAGE(levelBuffer, GameLevelSize * sizeof (levelBuffer[0]));
+    MEMORY_USAGE(GameLevelBuffer_RenderData, GameLevelSize * sizeof (GameLevelBuffer_RenderData[0]));
+    MEMORY_USAGE(GameAircraftTilemap, GameLevelSize * sizeof (GameAircraftTilemap[0]));
+    MEMORY_USAGE(PlayerData, sizeof (PlayerData) - (MAX_PLAYERS * (GAME_MAX_MAP_SIZE - GameLevelSize) * sizeof (PlayerData[0].TileData[0])));
 
-    memmove(GameLevelTitle,&ptrBuffer[i],LEVEL_TITLE_SIZE);
+    for (tileNr = 0; tileNr < GameLevelSize; tileNr++)
+    {
+        // Tile data is stored as big-endian inside *.LVL files.
+        const uint16_t tileData = (levelBuffer[tileNr] >> 8) | (levelBuffer[tileNr] << 8);
+        const uint8_t CurrentBuilding = (uint8_t)(tileData >> 8);
+        uint8_t CurrentTile = (uint8_t)(tileData & 0x007F);   // Remove building data
+                                                              // and mirror flag.
 
-    Serial_printf("Game level title: %s\n",GameLevelTitle);
+        levelBuffer[tileNr] = tileData;
+
+        if (CurrentTile > LAST_TILE_TILESET2)
+        {
+            Serial_printf("Invalid tile %d found on tile number %d\n", CurrentTile, tileNr);
+        }
+
+        if (CurrentBuilding >= MAX_BUILDING_ID)
+        {
+            Serial_printf("Invalid building %d found on tile number %d\n", CurrentBuilding, tileNr);
+
+            // Remove building data so it is never used as an index
+            // for building data tables.
+            levelBuffer[tileNr] &= 0x00FF;
+        }
+
+        if (CurrentTile == TILE_RWY_START_1)
+        {
+            if (nRwy < GAME_MAX_RUNWAYS)
+            {
+                GameRwy[nRwy++] = tileNr;
+            }
+            else
+            {
+                Serial_printf("Too many runways! Maximum: %d\n", GAME_MAX_RUNWAYS);
+            }
+        }
+
+        TYPE_TILE_RENDER_DATA* const ptrRenderData = &GameLevelBuffer_RenderData[tileNr];
+
+        if (CurrentTile <= LAST_TILE_TILESET1)
+        {
+            ptrRenderData->ptrTileset = &GameTilesetSpr;
+        }
+        else if (CurrentTile <= LAST_TILE_TILESET2)
+        {
+            ptrRenderData->ptrTileset = &GameTileset2Spr;
+            CurrentTile -= FIRST_TILE_TILESET2;
+        }
+        else
+        {
+            // Invalid tiles are never rendered.
+            continue;
+        }
+
+        ptrRenderData->u = (CurrentTile % COLUMNS_PER_TILESET) << TILE_SIZE_BIT_SHIFT;
+        ptrRenderData->v = (CurrentTile / COLUMNS_PER_TILESET) * TILE_SIZE_H;
+        ptrRenderData->mx = ptrRenderData->u + (TILE_SIZE >> 1);
+        ptrRenderData->my = ptrRenderData->v + (TILE_SIZE_H >> 1);
+
+        // Flipped tiles have bit 7 set.
+        ptrRenderData->flip = (tileData & TILE_MIRROR_FLAG)? true : false;
+    }
+
+    Serial_printf("GameRwy = ");
+
+    for (i = 0; i < nRwy; i++)
+    {
+        Serial_printf("%d ", GameRwy[i]);
+    }
+
+    Serial_printf("\n");
+
+    AssetCacheAdd(path, levelBuffer, ASSET_RESIDENCY_RAM);
+}
+
+/* *******************************************************************
+ *
+ * @name: uint8_t GameCheckLevelHeader(const uint8_t* const LevelHeader)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Validates magic number and map size from *.LVL header.
+ *
+ * @return:
+ *  Number of columns, or 0 if header is not valid.
+ *
+ * *******************************************************************/
+
+static uint8_t GameCheckLevelHeader(const uint8_t* const LevelHeader)
+{
+    uint8_t columns;
+
+    if (strncmp((const char*)LevelHeader, LEVEL_MAGIC_NUMBER_STRING, LEVEL_MAGIC_NUMBER_SIZE) != 0)
+    {
+        Serial_printf("Invalid level header! Read \"%.3s\" instead of " LEVEL_MAGIC_NUMBER_STRING "\n", LevelHeader);
+        return 0;
+    }
+
+    columns = LevelHeader[LEVEL_MAGIC_NUMBER_SIZE];
+
+    if (    (columns < MIN_MAP_COLUMNS)
+                ||
+            (columns > MAX_MAP_COLUMNS)    )
+    {
+        Serial_printf("Invalid map size! Value: %d\n", columns);
+        return 0;
+    }
+
+    return columns;
+}
+
+/* *******************************************************************
+ *
+ * @name: void GameSetGeneratedTile(uint8_t* const levelData, const uint8_t columns, const uint8_t row, const uint8_t column, const uint8_t building, const uint8_t tile)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Writes tile data as big-endian, as done by MapEditor.
+ *
+ * *******************************************************************/
+
+static void GameSetGeneratedTile(   uint8_t* const levelData,
+                                    const uint8_t columns,
+                                    const uint8_t row,
+                                    const uint8_t column,
+                                    const uint8_t building,
+                                    const uint8_t tile  )
+{
+    uint8_t* const ptrTile = &levelData[LEVEL_HEADER_SIZE + ((((uint16_t)row * columns) + column) * sizeof (uint16_t))];
+
+    ptrTile[0] = building;
+    ptrTile[1] = tile;
+}
+
+/* *******************************************************************
+ *
+ * @name: uint32_t GameGenerateLevel(const TYPE_LEVEL_CONFIG* const ptrLevelConfig, uint8_t* const buffer, const uint32_t sz)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Writes a synthetic *.LVL file into buffer, so that levels with a
+ *  known number of runways and parking tiles can be generated for
+ *  profiling purposes.
+ *
+ * @remarks:
+ *  From top to bottom, map is made of:
+ *      - Apron rows: parking tiles (with gates) on odd columns,
+ *        followed by a taxiway row.
+ *      - Runway rows: a taxiway row, holding points and a runway
+ *        with two exits. Runway length is limited to
+ *        GAME_MAX_RWY_LENGTH tiles.
+ *      - Remaining rows: grass, a few buildings and water.
+ *  All taxiway rows are connected to a vertical taxiway on column 0.
+ *  Apron rows are placed first so that parking tile numbers fit into
+ *  8-bit PLT parking fields.
+ *
+ * @return:
+ *  Level file size, or 0 if level does not fit into buffer or map.
+ *
+ * *******************************************************************/
+
+uint32_t GameGenerateLevel(const TYPE_LEVEL_CONFIG* const ptrLevelConfig, uint8_t* const buffer, const uint32_t sz)
+{
+    const uint8_t columns = ptrLevelConfig->Columns;
+    const uint8_t parkingPerRow = columns >> 1;
+    const uint8_t rwyLength = (columns - 1) < GAME_MAX_RWY_LENGTH ? (columns - 1) : GAME_MAX_RWY_LENGTH;
+    const uint8_t rwyExit[] = {2, rwyLength - 1};
+    const uint32_t fileSize = LEVEL_HEADER_SIZE + ((uint32_t)columns * columns * sizeof (uint16_t));
+    uint8_t apronRows;
+    uint8_t spineEnd;
+    uint8_t nParking = 0;
+    uint8_t row = 0;
+    uint8_t col;
+    uint8_t i;
+
+    if ((columns < MIN_MAP_COLUMNS) || (columns > MAX_MAP_COLUMNS))
+    {
+        Serial_printf("GameGenerateLevel(): invalid map size %d\n", columns);
+        return 0;
+    }
+
+    if (    (ptrLevelConfig->nRunway > GAME_MAX_RUNWAYS)
+                ||
+            (ptrLevelConfig->nParking > GAME_MAX_PARKING)   )
+    {
+        Serial_printf("GameGenerateLevel(): too many runways (%d) or parking tiles (%d)\n",
+                        ptrLevelConfig->nRunway,
+                        ptrLevelConfig->nParking  );
+        return 0;
+    }
+
+    // Each apron unit takes a parking row and a taxiway row.
+    apronRows = ((ptrLevelConfig->nParking + parkingPerRow - 1) / parkingPerRow) << 1;
+
+    if ((apronRows + (ptrLevelConfig->nRunway * 3)) > columns)
+    {
+        Serial_printf("GameGenerateLevel(): %d runways and %d parking tiles do not fit into %dx%d map\n",
+                        ptrLevelConfig->nRunway,
+                        ptrLevelConfig->nParking,
+                        columns,
+                        columns   );
+        return 0;
+    }
+
+    if ((apronRows != 0) && ((((apronRows - 2) * columns) + columns - 1) > UCHAR_MAX))
+    {
+        Serial_printf("GameGenerateLevel(): parking tiles would not fit into PLT files\n");
+        return 0;
+    }
+
+    if (sz < fileSize)
+    {
+        Serial_printf("GameGenerateLevel(): buffer is too small! Expected %d bytes\n", fileSize);
+        return 0;
+    }
+
+    // Zeroed tile data means grass without buildings.
+    memset(buffer, 0, fileSize);
+    memmove(buffer, LEVEL_MAGIC_NUMBER_STRING, LEVEL_MAGIC_NUMBER_SIZE);
+    buffer[LEVEL_MAGIC_NUMBER_SIZE] = columns;
+    strncpy(    (char*)&buffer[LEVEL_MAGIC_NUMBER_SIZE + 1],
+                ptrLevelConfig->strTitle != NULL ? ptrLevelConfig->strTitle : "Generated level",
+                LEVEL_TITLE_SIZE - 1    );
+
+    // Last row connected to vertical taxiway.
+    if (ptrLevelConfig->nRunway != 0)
+    {
+        spineEnd = apronRows + ((ptrLevelConfig->nRunway - 1) * 3);
+    }
+    else
+    {
+        spineEnd = apronRows != 0 ? apronRows - 1 : 0;
+    }
+
+    for (; row < apronRows; row += 2)
+    {
+        for (col = 1; col < columns; col += 2)
+        {
+            if (nParking < ptrLevelConfig->nParking)
+            {
+                // Same layout as LEVEL2.LVL: mirrored parking,
+                // gate on its right and a crossing below.
+                GameSetGeneratedTile(buffer, columns, row, col, BUILDING_NONE, TILE_PARKING | TILE_MIRROR_FLAG);
+                GameSetGeneratedTile(buffer, columns, row + 1, col, BUILDING_NONE, TILE_TAXIWAY_4WAY_CROSSING);
+
+                if ((col + 1) < columns)
+                {
+                    GameSetGeneratedTile(buffer, columns, row, col + 1, BUILDING_GATE, TILE_ASPHALT);
+                    GameSetGeneratedTile(buffer, columns, row + 1, col + 1, BUILDING_NONE, TILE_TAXIWAY_GRASS);
+                }
+
+                nParking++;
+            }
+            else
+            {
+                GameSetGeneratedTile(buffer, columns, row + 1, col, BUILDING_NONE, TILE_TAXIWAY_GRASS);
+
+                if ((col + 1) < columns)
+                {
+                    GameSetGeneratedTile(buffer, columns, row + 1, col + 1, BUILDING_NONE, TILE_TAXIWAY_GRASS);
+                }
+            }
+        }
+    }
+
+    for (i = 0; i < ptrLevelConfig->nRunway; i++, row += 3)
+    {
+        for (col = 1; col <= rwyLength; col++)
+        {
+            uint8_t rwyTile = TILE_RWY_MID;
+
+            if ((col == rwyExit[0]) || (col == rwyExit[1]))
+            {
+                GameSetGeneratedTile(buffer, columns, row, col, BUILDING_NONE, TILE_TAXIWAY_INTERSECT_GRASS);
+                GameSetGeneratedTile(   buffer,
+                                        columns,
+                                        row + 1,
+                                        col,
+                                        BUILDING_NONE,
+                                        (col == rwyExit[0] ? TILE_RWY_HOLDING_POINT : TILE_RWY_HOLDING_POINT_2) | TILE_MIRROR_FLAG );
+                rwyTile = TILE_RWY_EXIT;
+            }
+            else
+            {
+                GameSetGeneratedTile(buffer, columns, row, col, BUILDING_NONE, TILE_TAXIWAY_GRASS);
+            }
+
+            if (col == 1)
+            {
+                rwyTile = TILE_RWY_START_1;
+            }
+            else if (col == rwyLength)
+            {
+                rwyTile = TILE_RWY_START_2;
+            }
+
+            GameSetGeneratedTile(buffer, columns, row + 2, col, BUILDING_NONE, rwyTile);
+        }
+    }
+
+    // Vertical taxiway on column 0, starting from first taxiway row.
+    for (i = 1; i <= spineEnd; i++)
+    {
+        const bool taxiwayRow = (i < apronRows) ? (i & 1) : (((i - apronRows) % 3) == 0);
+        uint8_t tile = TILE_TAXIWAY_GRASS | TILE_MIRROR_FLAG;
+
+        if (taxiwayRow != false)
+        {
+            tile = (i == 1) || (i == spineEnd) ? TILE_TAXIWAY_CORNER_GRASS : TILE_TAXIWAY_INTERSECT_GRASS | TILE_MIRROR_FLAG;
+        }
+
+        GameSetGeneratedTile(buffer, columns, i, 0, BUILDING_NONE, tile);
+    }
+
+    if ((row + 1) < columns)
+    {
+        // Some buildings on free rows, so they are rendered as well.
+        static const uint8_t buildings[] = {BUILDING_ATC_TOWER, BUILDING_HANGAR, BUILDING_TERMINAL, BUILDING_ATC_LOC};
+
+        for (i = 0; (i < ARRAY_SIZE(buildings)) && (((i << 1) + 1) < columns); i++)
+        {
+            GameSetGeneratedTile(buffer, columns, row, (i << 1) + 1, buildings[i], TILE_ASPHALT);
+        }
+
+        for (col = 0; col < columns; col++)
+        {
+            GameSetGeneratedTile(buffer, columns, columns - 1, col, BUILDING_NONE, TILE_WATER);
+        }
+    }
+
+    return fileSize;
+}
+
+/* *******************************************************************
+ *
+ * @name: uint8_t GameGetParkingTiles(const uint8_t* const levelData, const uint32_t sz, uint8_t* const parking, const uint8_t max)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Looks for parking tiles inside *.LVL data (e.g.: from SystemLoadFile()
+ *  or GameGenerateLevel()), so TYPE_PLT_CONFIG can be filled for any level.
+ *
+ * @remarks:
+ *  Parking tiles above tile number 255 are skipped, as they cannot
+ *  be used on PLT files.
+ *
+ * @return:
+ *  Number of parking tiles written into parking.
+ *
+ * *******************************************************************/
 
-    i += LEVEL_TITLE_SIZE;
+uint8_t GameGetParkingTiles(const uint8_t* const levelData, const uint32_t sz, uint8_t* const parking, const uint8_t max)
+{
+    uint8_t columns;
+    uint16_t tileNr;
+    uint8_t n = 0;
 
-    memset(levelBuffer, 0, GAME_MAX_MAP_SIZE);
+    if (sz < LEVEL_HEADER_SIZE)
+    {
+        return 0;
+    }
 
-    i = LEVEL_HEADER_SIZE;
+    columns = GameCheckLevelHeader(levelData);
+
+    if (columns == 0)
+    {
+        return 0;
+    }
+
+    if (sz < (LEVEL_HEADER_SIZE + ((uint32_t)columns * columns * sizeof (uint16_t))))
+    {
+        Serial_printf("GameGetParkingTiles(): level data is incomplete!\n");
+        return 0;
+    }
 
+    for (tileNr = 0; (tileNr < (columns * columns)) && (tileNr <= UCHAR_MAX) && (n < max); tileNr++)
     {
-        size_t j;
-        size_t k;
+        // Low byte of big-endian tile data, without mirror flag.
+        const uint8_t tile = levelData[LEVEL_HEADER_SIZE + (tileNr * sizeof (uint16_t)) + 1] & ~TILE_MIRROR_FLAG;
 
-        for (j = LEVEL_HEADER_SIZE, k = 0; k < GameLevelSize; j += sizeof (uint16_t), k++)
+        if ((tile == TILE_PARKING) || (tile == TILE_PARKING_2))
         {
-            levelBuffer[k] = ptrBuffer[j + 1];
-            levelBuffer[k] |= (ptrBuffer[j] << 8);
+            parking[n++] = (uint8_t)tileNr;
         }
     }
+
+    return n;
 }
 
 /* ******************************************************************************************
@@ -1601,15 +2026,16 @@ static void GameAircraftState(const uint8_t i)
 
                     if (bParkingBusy == false)
                     {
-                        uint16_t target[2] = {0};
+                        uint16_t target[AIRCRAFT_MAX_TARGETS] = {0};
                         // Arrays are copied to AircraftAddNew, so we create a first and only
-                        // target which is the parking tile itself, and the second element
-                        // is just the NULL character.
-                        // Not an ideal solution, but the best one currently available.
+                        // target which is the parking tile itself. AircraftAddNew() always
+                        // copies AIRCRAFT_MAX_TARGETS elements, so remaining ones must be
+                        // zeroed instead of being read past the end of the array.
 
                         FlightData.State[i] = STATE_PARKED;
 
                         aircraftCreated = true;
+                        PROFILER_EVENT(PROFILER_EVENT_AIRCRAFT_SPAWN);
 
                         // Create notification request for incoming aircraft
                         GameGuiBubbleShow();
@@ -1629,9 +2055,10 @@ static void GameAircraftState(const uint8_t i)
 
                     FlightData.State[i] = STATE_APPROACH;
                     aircraftCreated = true;
+                    PROFILER_EVENT(PROFILER_EVENT_AIRCRAFT_SPAWN);
 
                     // Play chatter sound.
-                    SfxPlaySound(&ApproachSnds[idx]);
+                    SfxPlaySound_Ex(&ApproachSnds[idx], SFX_PRIORITY_LOW);
 
                     // Create notification request for incoming aircraft
                     GameGuiBubbleShow();
@@ -1648,27 +2075,6 @@ static void GameAircraftState(const uint8_t i)
     }
 }
 
-static void GameInitTileUVTable(void)
-{
-    uint16_t i;
-
-    memset(GameLevelBuffer_UVData, 0, sizeof (GameLevelBuffer_UVData));
-
-    for (i = 0 ; i < GameLevelSize; i++)
-    {
-        uint8_t CurrentTile = (uint8_t)(levelBuffer[i] & 0x007F);   // Remove building data
-                                                                    // and mirror flag.
-
-        if (CurrentTile >= FIRST_TILE_TILESET2)
-        {
-            CurrentTile -= FIRST_TILE_TILESET2;
-        }
-
-        GameLevelBuffer_UVData[i].u = (short)(CurrentTile % COLUMNS_PER_TILESET) << TILE_SIZE_BIT_SHIFT;
-        GameLevelBuffer_UVData[i].v = (short)(CurrentTile / COLUMNS_PER_TILESET) * TILE_SIZE_H;
-    }
-}
-
 /* ******************************************************************************************
  *
  * @name: void GameRenderTerrainPrecalculations(TYPE_PLAYER* const ptrPlayer)
@@ -1752,13 +2158,17 @@ static void GameRenderTerrainPrecalculations(TYPE_PLAYER* const ptrPlayer, const
 
         CameraApplyCoordinatesToCartesianPos(ptrPlayer, &tileData->CartPos);
 
-        if (GfxIsInsideScreenArea(  tileData->CartPos.x,
-                                    tileData->CartPos.y,
-                                    TILE_SIZE,
-                                    TILE_SIZE_H ))
-        {
-            tileData->ShowTile = true;
+        // GameRenderTerrain() does not perform any further checks,
+        // so hidden and invalid tiles must be discarded here.
+        tileData->ShowTile =    (GameLevelBuffer_RenderData[i].ptrTileset != NULL)
+                                                &&
+                                GfxIsInsideScreenArea(  tileData->CartPos.x,
+                                                        tileData->CartPos.y,
+                                                        TILE_SIZE,
+                                                        TILE_SIZE_H );
 
+        if (tileData->ShowTile)
+        {
             tileData->r = NORMAL_LUMINANCE;
             tileData->g = NORMAL_LUMINANCE;
             tileData->b = NORMAL_LUMINANCE;
@@ -1830,7 +2240,8 @@ static void GameRenderTerrainPrecalculations(TYPE_PLAYER* const ptrPlayer, const
                         {
                             const TYPE_AIRCRAFT_DATA* const ptrAircraft = AircraftFromFlightDataIndex(aircraftIndex);
 
-                            if (ptrAircraft->State == STATE_PARKED)
+                            // Flights without an aircraft yet return NULL.
+                            if ((ptrAircraft != NULL) && (ptrAircraft->State == STATE_PARKED))
                             {
                                 const uint16_t tile = AircraftGetTileFromFlightDataIndex(aircraftIndex);
 
@@ -1919,82 +2330,50 @@ void GameRenderTerrain(TYPE_PLAYER* const ptrPlayer)
 {
     uint16_t i;
 
+    GameTilesetSpr.w = TILE_SIZE;
+    GameTilesetSpr.h = TILE_SIZE_H;
+    GameTileset2Spr.w = TILE_SIZE;
+    GameTileset2Spr.h = TILE_SIZE_H;
+
     for (i = 0 ; i < GameLevelSize; i++)
     {
-        if (ptrPlayer->TileData[i].ShowTile)
-        {
-            bool flip_id;
-            GsSprite* ptrTileset;
-            uint8_t aux_id;
-            uint8_t CurrentTile = (uint8_t)(levelBuffer[i] & 0x00FF);
-
-            // Flipped tiles have bit 7 set.
-            if (CurrentTile & TILE_MIRROR_FLAG)
-            {
-                flip_id = true;
-                aux_id = CurrentTile;
-                CurrentTile &= ~(TILE_MIRROR_FLAG);
-            }
-            else
-            {
-                flip_id = false;
-            }
-
-            if (CurrentTile <= LAST_TILE_TILESET1)
-            {
-                // Draw using GameTilesetSpr
-                ptrTileset = &GameTilesetSpr;
-            }
-            else if (   (CurrentTile > LAST_TILE_TILESET1)
-                            &&
-                        (CurrentTile <= LAST_TILE_TILESET2) )
-            {
-                // Draw using GameTileset2Spr
-                ptrTileset = &GameTileset2Spr;
-            }
-            else
-            {
-                ptrTileset = NULL;
-                continue;
-            }
+        const TYPE_TILE_DATA* const tileData = &ptrPlayer->TileData[i];
 
-            // Apply {X, Y} data from precalculated lookup tables.
-            ptrTileset->x = ptrPlayer->TileData[i].CartPos.x;
-            ptrTileset->y = ptrPlayer->TileData[i].CartPos.y;
-
-            // Apply RGB data from precalculated lookup tables.
-            ptrTileset->r = ptrPlayer->TileData[i].r;
-            ptrTileset->g = ptrPlayer->TileData[i].g;
-            ptrTileset->b = ptrPlayer->TileData[i].b;
-
-            if (flip_id)
+        if (tileData->ShowTile)
+        {
+            const TYPE_TILE_RENDER_DATA* const ptrRenderData = &GameLevelBuffer_RenderData[i];
+            GsSprite* const ptrTileset = ptrRenderData->ptrTileset;
+
+            // Apply {X, Y} and RGB data from precalculated lookup tables.
+            ptrTileset->x = tileData->CartPos.x;
+            ptrTileset->y = tileData->CartPos.y;
+            ptrTileset->r = tileData->r;
+            ptrTileset->g = tileData->g;
+            ptrTileset->b = tileData->b;
+
+            // Apply static tile data calculated on GameLoadLevel().
+            ptrTileset->u = ptrRenderData->u;
+            ptrTileset->v = ptrRenderData->v;
+            ptrTileset->mx = ptrRenderData->mx;
+            ptrTileset->my = ptrRenderData->my;
+
+            if (ptrRenderData->flip)
             {
                 ptrTileset->attribute |= H_FLIP;
             }
-
-            ptrTileset->w = TILE_SIZE;
-            ptrTileset->h = TILE_SIZE_H;
-
-            ptrTileset->u = GameLevelBuffer_UVData[i].u;
-            ptrTileset->v = GameLevelBuffer_UVData[i].v;
-
-            ptrTileset->mx = ptrTileset->u + (TILE_SIZE >> 1);
-            ptrTileset->my = ptrTileset->v + (TILE_SIZE_H >> 1);
-
-            if (flip_id)
-            {
-                flip_id = false;
-                CurrentTile = aux_id;
-            }
-
-            GfxSortSprite(ptrTileset);
-
-            if (ptrTileset->attribute & H_FLIP)
+            else
             {
                 ptrTileset->attribute &= ~(H_FLIP);
             }
+
+            // Tiles have already been checked against
+            // screen limits on GameRenderTerrainPrecalculations().
+            GfxSortSprite_Fast(ptrTileset);
         }
     }
+
+    GameTilesetSpr.attribute &= ~(H_FLIP);
+    GameTileset2Spr.attribute &= ~(H_FLIP);
 }
 
 /* *******************************************************************
@@ -2469,53 +2848,6 @@ static void GameStateSelectRunway(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA
     }
 }
 
-/* **************************************************************************************************
- *
- * @name: void GameGetRunwayArray(void)
- *
- * @author: Xavier Del Campo
- *
- *
- * @brief:
- *  On startup, an array of runway headers is created from levelBuffer once *.LVL is parsed.
- *
- * @remarks:
- *  Do not confuse GameRwy with GameRwyArray, which are used for completely different purposes.
- *
- * **************************************************************************************************/
-void GameGetRunwayArray(void)
-{
-    uint16_t i;
-    uint8_t j = 0;
-
-    for (i = 0; i < GameLevelSize; i++)
-    {
-        uint8_t tileNr = levelBuffer[i] & ~TILE_MIRROR_FLAG;
-
-        if (tileNr == TILE_RWY_START_1)
-        {
-            if (SystemContains_u16(i, levelBuffer, GAME_MAX_RUNWAYS) == false)
-            {
-                GameRwy[j++] = i;
-            }
-        }
-    }
-
-    Serial_printf("GameRwy = ");
-
-    for (i = 0; i < GAME_MAX_RUNWAYS; i++)
-    {
-        if (GameRwy[i] == 0)
-        {
-            break;
-        }
-
-        Serial_printf("%d ", GameRwy[i]);
-    }
-
-    Serial_printf("\n");
-}
-
 /* **************************************************************************************************
  *
  * @name: void GameSelectAircraftFromList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
@@ -2696,7 +3028,7 @@ DIRECTION GameGetRunwayDirection(uint16_t rwyHeader)
             return DIR_NORTH;
 
         default:
-            Serial_printf("Unknown direction for tile %d\n",rwyHeader);
+            LOG_WARNING("Unknown direction for tile %d\n",rwyHeader);
             break;
     }
 
@@ -2737,10 +3069,10 @@ void GameGetSelectedRunwayArray(uint16_t rwyHeader, uint16_t* rwyArray, size_t s
 
     if (sz != (GAME_MAX_RWY_LENGTH * sizeof (uint16_t) ))
     {
-        Serial_printf(  "GameGetSelectedRunwayArray: size %d is different"
-                        " than expected (%d bytes). Returning...\n",
-                        sz,
-                        (GAME_MAX_RWY_LENGTH * sizeof (uint16_t) ) );
+        LOG_ERROR(  "GameGetSelectedRunwayArray: size %d is different"
+                    " than expected (%d bytes). Returning...\n",
+                    sz,
+                    (GAME_MAX_RWY_LENGTH * sizeof (uint16_t) ) );
         return;
     }
 
@@ -2761,7 +3093,7 @@ void GameGetSelectedRunwayArray(uint16_t rwyHeader, uint16_t* rwyArray, size_t s
 
         if (dir == NO_DIRECTION)
         {
-            Serial_printf("rwyHeader = %d returned NO_DIRECTION\n", rwyHeader);
+            LOG_WARNING("rwyHeader = %d returned NO_DIRECTION\n", rwyHeader);
             return;
         }
     }
@@ -2806,7 +3138,7 @@ void GameGetSelectedRunwayArray(uint16_t rwyHeader, uint16_t* rwyArray, size_t s
         case NO_DIRECTION:
             // Fall through
         default:
-            Serial_printf("Invalid runway direction.\n");
+            LOG_WARNING("Invalid runway direction.\n");
         return;
     }
 
@@ -2913,7 +3245,7 @@ void GameAssignRunwaytoAircraft(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA*
             return;
         }
 
-        SfxPlaySound(&TowerFinalSnds[SystemRand(SOUND_M1_INDEX, MAX_RADIO_CHATTER_SOUNDS - 1)]);
+        SfxPlaySound_Ex(&TowerFinalSnds[SystemRand(SOUND_M1_INDEX, MAX_RADIO_CHATTER_SOUNDS - 1)], SFX_PRIORITY_LOW);
     }
     else if (ptrFlightData->State[aircraftIndex] == STATE_HOLDING_RWY)
     {
@@ -4040,7 +4372,7 @@ void GameRemoveFlight(const uint8_t idx, const bool successful)
                     {
                         if (FlightData.State[idx] == STATE_UNBOARDING)
                         {
-                            memset(ptrPlayer->UnboardingSequence, 0, GAME_MAX_SEQUENCE_KEYS);
+                            memset(ptrPlayer->UnboardingSequence, 0, sizeof (ptrPlayer->UnboardingSequence));
                             ptrPlayer->UnboardingSequenceIdx = 0;
                             ptrPlayer->Unboarding = false;
                             ptrPlayer->LockTarget = false;
@@ -56,5 +56,7 @@ void		GameCalculateRemainingAircraft(void);
 void		GameAircraftCollision(uint8_t AircraftIdx);
 void        GameStopFlight(uint8_t AicraftIdx);
 void        GameResumeFlightFromAutoStop(uint8_t AircraftIdx);
+uint32_t	GameGenerateLevel(const TYPE_LEVEL_CONFIG* const ptrLevelConfig, uint8_t* const buffer, const uint32_t sz);
+uint8_t		GameGetParkingTiles(const uint8_t* const levelData, const uint32_t sz, uint8_t* const parking, const uint8_t max);
 
 #endif //GAME_HEADER__
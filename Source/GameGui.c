@@ -8,6 +8,8 @@
 #include "Game.h"
 #include "LoadMenu.h"
 #include "Timer.h"
+#include "Vram.h"
+#include "Dialog.h"
 
 /* *************************************
  *  Defines
@@ -193,14 +195,40 @@ enum
     GAME_GUI_SECOND_DISPLAY_TPAGE = 22,
 };
 
+// Indexes for TYPE_PLAYER.TextRuns[]. Must not exceed PLAYER_MAX_TEXT_RUNS.
+enum
+{
+    TEXT_RUN_REMAINING_AIRCRAFT,
+    TEXT_RUN_NEXT_AIRCRAFT,
+    TEXT_RUN_FLIGHT_NUMBER,
+    TEXT_RUN_STATE = TEXT_RUN_FLIGHT_NUMBER + GAME_GUI_AIRCRAFT_DATA_MAX_PAGE,
+    TEXT_RUN_REMAINING_TIME = TEXT_RUN_STATE + GAME_GUI_AIRCRAFT_DATA_MAX_PAGE,
+
+    MAX_TEXT_RUNS = TEXT_RUN_REMAINING_TIME + GAME_GUI_AIRCRAFT_DATA_MAX_PAGE
+};
+
+// Build fails (negative array size) if text runs do not fit into TYPE_PLAYER.TextRuns[].
+typedef char GameGuiTextRunsCheck[(MAX_TEXT_RUNS <= PLAYER_MAX_TEXT_RUNS) ? 1 : -1];
+
 /* **************************************
  *  Local prototypes                    *
  * *************************************/
 
 static void GameGuiShowAircraftData(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
+static void GameGuiAircraftListContents(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
+static void GameGuiAircraftListCached(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
+static uint32_t GameGuiHashAdd(uint32_t hash, uint32_t value);
+static uint32_t GameGuiAircraftListHash(const TYPE_PLAYER* const ptrPlayer, const TYPE_FLIGHT_DATA* const ptrFlightData);
+static bool GameGuiVramCacheAlloc(TYPE_VRAM_CACHE* const ptrCache, short w, short h);
 static void GameGuiClearPassengersLeft(void);
 static void GameGuiBubbleStop(void);
 static void GameGuiBubbleStopVibration(void);
+static bool GameGuiPauseDialogHandler(TYPE_DIALOG* const ptrDialog);
+static void GameGuiPauseDialogRender(const TYPE_DIALOG* const ptrDialog);
+static bool GameGuiFinishedDialogHandler(TYPE_DIALOG* const ptrDialog);
+static void GameGuiFinishedDialogRender(const TYPE_DIALOG* const ptrDialog);
+static bool GameGuiCollisionDialogHandler(TYPE_DIALOG* const ptrDialog);
+static void GameGuiCollisionDialogRender(const TYPE_DIALOG* const ptrDialog);
 
 /* **************************************
  *  Local variables                     *
@@ -258,13 +286,35 @@ static const GsGPoly4 PauseRect =
     .attribute = ENABLE_TRANS | TRANS_MODE(0)
 };
 
-static GsSprite SecondDisplay;
 static GsSprite DepArrSpr;
 static GsSprite PageUpDownSpr;
+static GsSprite AircraftListSpr;
 static TYPE_TIMER* ShowAircraftPassengersTimer;
 static bool GameGuiClearPassengersLeft_Flag;
 static bool showBubble;
 static bool bubbleVibration;
+static bool dialogExit;
+
+static TYPE_DIALOG PauseDialog =
+{
+    .Policy = DIALOG_POLICY_PAUSE,
+    .Handler = GameGuiPauseDialogHandler,
+    .Render = GameGuiPauseDialogRender
+};
+
+static TYPE_DIALOG FinishedDialog =
+{
+    .Policy = DIALOG_POLICY_PAUSE,
+    .Handler = GameGuiFinishedDialogHandler,
+    .Render = GameGuiFinishedDialogRender
+};
+
+static TYPE_DIALOG CollisionDialog =
+{
+    .Policy = DIALOG_POLICY_PAUSE,
+    .Handler = GameGuiCollisionDialogHandler,
+    .Render = GameGuiCollisionDialogRender
+};
 
 static const char* GameFileList[] = {   "DATA\\SPRITES\\BUBBLE.TIM"   ,
                                         "DATA\\FONTS\\FONT_1.FNT"     ,
@@ -297,11 +347,13 @@ void GameGuiInit(void)
 
     static bool initialised;
 
+    // Files which are still resident are not loaded again.
+    LOAD_FILES(GameFileList, GameFileDest);
+
     if (initialised == false)
     {
         initialised = true;
 
-        LOAD_FILES(GameFileList, GameFileDest);
         ShowAircraftPassengersTimer = TimerCreate(20, true, GameGuiClearPassengersLeft);
     }
 
@@ -324,51 +376,74 @@ void GameGuiInit(void)
     AircraftDataGPoly4.b[2] = AIRCRAFT_DATA_GSGPOLY4_B2;
     AircraftDataGPoly4.b[3] = AIRCRAFT_DATA_GSGPOLY4_B3;
 
+    // Aircraft list offscreen cache is drawn as a 16bpp sprite.
+    AircraftListSpr.attribute = COLORMODE(COLORMODE_16BPP);
+    AircraftListSpr.r = NORMAL_LUMINANCE;
+    AircraftListSpr.g = NORMAL_LUMINANCE;
+    AircraftListSpr.b = NORMAL_LUMINANCE;
+
     slowScore = 0;
 
     showBubble = false;
 
+    dialogExit = false;
+
     FontSetSpacing(&RadioFont, RADIO_FONT_SPACING);
 }
 
 /* ***************************************************************************************
  *
- * @name: bool GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
+ * @name: void GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
  *
  * @author: Xavier Del Campo
  *
  * @brief:
- *  Checks for pause event (player presses START button). If true, it traps the game
- *  on a while loop, waiting for user action.
+ *  Opens pause dialog. Input from ptrPlayer is routed to it until
+ *  PAD_START (resume) or PAD_CROSS (exit gameplay) are pressed.
  *
  * @remarks:
- *  Blocking function!
+ *  Non-blocking. Simulation is halted while dialog is open.
  *
  * ***************************************************************************************/
-bool GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
+void GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer)
 {
-    GfxSaveDisplayData(&SecondDisplay);
-
-    GfxSetGlobalLuminance(NORMAL_LUMINANCE);
-
-    while (GfxIsGPUBusy());
+    PauseDialog.PadKeySinglePress_Callback = ptrPlayer->PadKeySinglePress_Callback;
 
-    do
+    if (DialogOpen(&PauseDialog))
     {
-        if (ptrPlayer->PadKeySinglePress_Callback(PAD_CROSS))
-        {
-            return true;
-        }
-
-        GfxSortSprite(&SecondDisplay);
+        GfxSetGlobalLuminance(NORMAL_LUMINANCE);
+    }
+}
 
-        GsSortGPoly4(&PauseRect);
+static bool GameGuiPauseDialogHandler(TYPE_DIALOG* const ptrDialog)
+{
+    if (ptrDialog->PadKeySinglePress_Callback(PAD_CROSS))
+    {
+        dialogExit = true;
+        return false;
+    }
 
-        GfxDrawScene_Slow();
+    return (ptrDialog->PadKeySinglePress_Callback(PAD_START) == false);
+}
 
-    } while (ptrPlayer->PadKeySinglePress_Callback(PAD_START) == false);
+static void GameGuiPauseDialogRender(const TYPE_DIALOG* const ptrDialog)
+{
+    GsSortGPoly4(&PauseRect);
+}
 
-    return false;
+/* ***************************************************************************************
+ *
+ * @name: bool GameGuiDialogExit(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  true if player has chosen to exit gameplay from any dialog.
+ *
+ * ***************************************************************************************/
+bool GameGuiDialogExit(void)
+{
+    return dialogExit;
 }
 
 
@@ -495,28 +570,16 @@ void GameGuiActiveAircraftPage(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* c
  * @brief:
  *  Draws aircraft list for current player when ptrPlayer->ShowAircraftData state is active.
  *
+ * @remarks:
+ *  Semi-transparent background and selection rectangle are drawn directly, since they
+ *  are blended against the scene. The rest of the list is drawn through an offscreen
+ *  VRAM cache (see GameGuiAircraftListCached()).
+ *
  * **********************************************************************************************/
 void GameGuiAircraftList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
 {
     short y_offset;
     uint8_t page_aircraft;
-    short orig_pageupdn_u;
-
-    enum
-    {
-        GAME_GUI_REMAINING_AIRCRAFT_X = AIRCRAFT_DATA_GSGPOLY4_X0 + 16,
-        GAME_GUI_REMAINING_AIRCRAFT_Y = AIRCRAFT_DATA_GSGPOLY4_Y2 - 16,
-        GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER = AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER + 4,
-        GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER = AIRCRAFT_DATA_GSGPOLY4_Y2_2PLAYER - 16
-    };
-
-    enum
-    {
-        GAME_GUI_NEXT_AIRCRAFT_TIME_X = GAME_GUI_REMAINING_AIRCRAFT_X,
-        GAME_GUI_NEXT_AIRCRAFT_TIME_Y = GAME_GUI_REMAINING_AIRCRAFT_Y + 8,
-        GAME_GUI_NEXT_AIRCRAFT_TIME_X_2PLAYER = GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER,
-        GAME_GUI_NEXT_AIRCRAFT_TIME_Y_2PLAYER = GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER + 8,
-    };
 
     enum
     {
@@ -557,62 +620,6 @@ void GameGuiAircraftList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const p
 
         GsSortGPoly4(&AircraftDataGPoly4);
 
-        const struct
-        {
-            struct pos
-            {
-                short x;
-                short y;
-            } remainingTime;
-
-            struct pos aircraftTime;
-        } posData =
-        {
-            .remainingTime =
-            {
-                .x = GameTwoPlayersActive() ?
-                        GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER
-                    :   GAME_GUI_REMAINING_AIRCRAFT_X,
-                .y = GameTwoPlayersActive() ?
-                        GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER
-                        :GAME_GUI_REMAINING_AIRCRAFT_Y
-            },
-
-            .aircraftTime =
-            {
-                .x = GameTwoPlayersActive() ?
-                        GAME_GUI_NEXT_AIRCRAFT_TIME_X_2PLAYER
-                    :   GAME_GUI_NEXT_AIRCRAFT_TIME_X,
-                .y = GameTwoPlayersActive() ?
-                        GAME_GUI_NEXT_AIRCRAFT_TIME_Y_2PLAYER
-                    :   GAME_GUI_NEXT_AIRCRAFT_TIME_Y
-            },
-        };
-
-        if (ptrPlayer->RemainingAircraft
-                    &&
-            (ptrPlayer->NextAircraftTime != USHRT_MAX))
-        {
-            FontPrintText(&SmallFont,
-                          posData.remainingTime.x,
-                          posData.remainingTime.y,
-                          "Remaining aircraft: %d",
-                          ptrPlayer->RemainingAircraft);
-
-            FontPrintText(&SmallFont,
-                          posData.aircraftTime.x,
-                          posData.aircraftTime.y,
-                          "Next aircraft: %d sec",
-                          ptrPlayer->NextAircraftTime);
-        }
-        else
-        {
-            FontPrintText(&SmallFont,
-                          posData.remainingTime.x,
-                          posData.remainingTime.y,
-                          "No aircraft left");
-        }
-
         if (ptrPlayer->ActiveAircraft != 0)
         {
             if (GameTwoPlayersActive())
@@ -655,89 +662,365 @@ void GameGuiAircraftList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const p
             SelectedAircraftGPoly4.y[3] += y_offset;
 
             GsSortGPoly4(&SelectedAircraftGPoly4);
+        }
 
-            PageUpDownSpr.attribute |= GFX_2HZ_FLASH;
+        GameGuiAircraftListCached(ptrPlayer, ptrFlightData);
 
-            if (ptrPlayer->ActiveAircraft > (GAME_GUI_AIRCRAFT_DATA_MAX_PAGE * (ptrPlayer->FlightDataPage + 1) ) )
+        if (ptrPlayer->ActiveAircraft != 0)
+        {
+            if (ptrFlightData->State[ptrPlayer->FlightDataSelectedAircraft] == STATE_USER_STOPPED)
             {
-                orig_pageupdn_u = PageUpDownSpr.u;
-
-                PageUpDownSpr.u = orig_pageupdn_u + AIRCRAFT_DATA_FLIGHT_PAGE_UP_U;
+                GfxDrawButton(AIRCRAFT_STOP_X, AIRCRAFT_STOP_Y, PAD_L1);
+                FontPrintText(&SmallFont, AIRCRAFT_STOP_TEXT_X, AIRCRAFT_STOP_TEXT_Y, "Resume taxiing");
+            }
+            else if (ptrFlightData->State[ptrPlayer->FlightDataSelectedAircraft] == STATE_TAXIING)
+            {
+                GfxDrawButton(AIRCRAFT_STOP_X, AIRCRAFT_STOP_Y, PAD_L1);
+                FontPrintText(&SmallFont, AIRCRAFT_STOP_TEXT_X, AIRCRAFT_STOP_TEXT_Y, "Stop immediately");
+            }
+        }
+    }
+}
 
-                if (GameTwoPlayersActive())
-                {
-                    PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_UP_X_2PLAYER;
-                    PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_UP_Y_2PLAYER;
-                }
-                else
-                {
-                    PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_UP_X;
-                    PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_UP_Y;
-                }
+/* **********************************************************************************************
+ *
+ * @name: void GameGuiAircraftListContents(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Draws aircraft list text, icons and page arrows, using screen coordinates.
+ *
+ * **********************************************************************************************/
+static void GameGuiAircraftListContents(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
+{
+    short orig_pageupdn_u;
 
-                GfxSortSprite(&PageUpDownSpr);
+    enum
+    {
+        GAME_GUI_REMAINING_AIRCRAFT_X = AIRCRAFT_DATA_GSGPOLY4_X0 + 16,
+        GAME_GUI_REMAINING_AIRCRAFT_Y = AIRCRAFT_DATA_GSGPOLY4_Y2 - 16,
+        GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER = AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER + 4,
+        GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER = AIRCRAFT_DATA_GSGPOLY4_Y2_2PLAYER - 16
+    };
 
-                PageUpDownSpr.u = orig_pageupdn_u;
-            }
+    enum
+    {
+        GAME_GUI_NEXT_AIRCRAFT_TIME_X = GAME_GUI_REMAINING_AIRCRAFT_X,
+        GAME_GUI_NEXT_AIRCRAFT_TIME_Y = GAME_GUI_REMAINING_AIRCRAFT_Y + 8,
+        GAME_GUI_NEXT_AIRCRAFT_TIME_X_2PLAYER = GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER,
+        GAME_GUI_NEXT_AIRCRAFT_TIME_Y_2PLAYER = GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER + 8,
+    };
 
-            if (ptrPlayer->FlightDataPage != 0)
-            {
-                orig_pageupdn_u = PageUpDownSpr.u;
+    const struct
+    {
+        struct pos
+        {
+            short x;
+            short y;
+        } remainingTime;
 
-                PageUpDownSpr.u = orig_pageupdn_u + AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_U;
+        struct pos aircraftTime;
+    } posData =
+    {
+        .remainingTime =
+        {
+            .x = GameTwoPlayersActive() ?
+                    GAME_GUI_REMAINING_AIRCRAFT_X_2PLAYER
+                :   GAME_GUI_REMAINING_AIRCRAFT_X,
+            .y = GameTwoPlayersActive() ?
+                    GAME_GUI_REMAINING_AIRCRAFT_Y_2PLAYER
+                    :GAME_GUI_REMAINING_AIRCRAFT_Y
+        },
+
+        .aircraftTime =
+        {
+            .x = GameTwoPlayersActive() ?
+                    GAME_GUI_NEXT_AIRCRAFT_TIME_X_2PLAYER
+                :   GAME_GUI_NEXT_AIRCRAFT_TIME_X,
+            .y = GameTwoPlayersActive() ?
+                    GAME_GUI_NEXT_AIRCRAFT_TIME_Y_2PLAYER
+                :   GAME_GUI_NEXT_AIRCRAFT_TIME_Y
+        },
+    };
 
-                if (GameTwoPlayersActive())
-                {
-                    PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_X_2PLAYER;
-                    PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_Y_2PLAYER;
-                }
-                else
-                {
-                    PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_X;
-                    PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_Y;
-                }
+    if (ptrPlayer->RemainingAircraft
+                &&
+        (ptrPlayer->NextAircraftTime != USHRT_MAX))
+    {
+        FontRunPrint(&ptrPlayer->TextRuns[TEXT_RUN_REMAINING_AIRCRAFT],
+                     &SmallFont,
+                     posData.remainingTime.x,
+                     posData.remainingTime.y,
+                     "Remaining aircraft: %d",
+                     ptrPlayer->RemainingAircraft);
+
+        FontRunPrint(&ptrPlayer->TextRuns[TEXT_RUN_NEXT_AIRCRAFT],
+                     &SmallFont,
+                     posData.aircraftTime.x,
+                     posData.aircraftTime.y,
+                     "Next aircraft: %d sec",
+                     ptrPlayer->NextAircraftTime);
+    }
+    else
+    {
+        FontRunPrint(&ptrPlayer->TextRuns[TEXT_RUN_REMAINING_AIRCRAFT],
+                     &SmallFont,
+                     posData.remainingTime.x,
+                     posData.remainingTime.y,
+                     "No aircraft left");
+    }
 
-                GfxSortSprite(&PageUpDownSpr);
+    if (ptrPlayer->ActiveAircraft != 0)
+    {
+        PageUpDownSpr.attribute |= GFX_2HZ_FLASH;
 
-                PageUpDownSpr.u = orig_pageupdn_u;
-            }
+        if (ptrPlayer->ActiveAircraft > (GAME_GUI_AIRCRAFT_DATA_MAX_PAGE * (ptrPlayer->FlightDataPage + 1) ) )
+        {
+            orig_pageupdn_u = PageUpDownSpr.u;
 
-            GameGuiShowAircraftData(ptrPlayer, ptrFlightData);
+            PageUpDownSpr.u = orig_pageupdn_u + AIRCRAFT_DATA_FLIGHT_PAGE_UP_U;
 
-            if (ptrFlightData->State[ptrPlayer->FlightDataSelectedAircraft] == STATE_USER_STOPPED)
+            if (GameTwoPlayersActive())
             {
-                GfxDrawButton(AIRCRAFT_STOP_X, AIRCRAFT_STOP_Y, PAD_L1);
-                FontPrintText(&SmallFont, AIRCRAFT_STOP_TEXT_X, AIRCRAFT_STOP_TEXT_Y, "Resume taxiing");
+                PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_UP_X_2PLAYER;
+                PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_UP_Y_2PLAYER;
             }
-            else if (ptrFlightData->State[ptrPlayer->FlightDataSelectedAircraft] == STATE_TAXIING)
+            else
             {
-                GfxDrawButton(AIRCRAFT_STOP_X, AIRCRAFT_STOP_Y, PAD_L1);
-                FontPrintText(&SmallFont, AIRCRAFT_STOP_TEXT_X, AIRCRAFT_STOP_TEXT_Y, "Stop immediately");
+                PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_UP_X;
+                PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_UP_Y;
             }
+
+            GfxSortSprite(&PageUpDownSpr);
+
+            PageUpDownSpr.u = orig_pageupdn_u;
         }
-        else
+
+        if (ptrPlayer->FlightDataPage != 0)
         {
+            orig_pageupdn_u = PageUpDownSpr.u;
+
+            PageUpDownSpr.u = orig_pageupdn_u + AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_U;
+
             if (GameTwoPlayersActive())
             {
-                FontPrintText(  &SmallFont,
-                                AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER +
-                                ( (AIRCRAFT_DATA_GSGPOLY4_X1_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER) >> 2),
-                                AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER +
-                                ( (AIRCRAFT_DATA_GSGPOLY4_Y2_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER) >> 1),
-                                "No flights!"   );
+                PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_X_2PLAYER;
+                PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_Y_2PLAYER;
             }
             else
             {
-                FontPrintText(  &SmallFont,
-                                AIRCRAFT_DATA_GSGPOLY4_X0 +
-                                ( (AIRCRAFT_DATA_GSGPOLY4_X1 - AIRCRAFT_DATA_GSGPOLY4_X0) >> 2),
-                                AIRCRAFT_DATA_GSGPOLY4_Y0 +
-                                ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
-                                "No flights!"   );
+                PageUpDownSpr.x = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_X;
+                PageUpDownSpr.y = AIRCRAFT_DATA_FLIGHT_PAGE_DOWN_Y;
             }
+
+            GfxSortSprite(&PageUpDownSpr);
+
+            PageUpDownSpr.u = orig_pageupdn_u;
+        }
+
+        GameGuiShowAircraftData(ptrPlayer, ptrFlightData);
+    }
+    else
+    {
+        if (GameTwoPlayersActive())
+        {
+            FontPrintText(  &SmallFont,
+                            AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER +
+                            ( (AIRCRAFT_DATA_GSGPOLY4_X1_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER) >> 2),
+                            AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER +
+                            ( (AIRCRAFT_DATA_GSGPOLY4_Y2_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER) >> 1),
+                            "No flights!"   );
+        }
+        else
+        {
+            FontPrintText(  &SmallFont,
+                            AIRCRAFT_DATA_GSGPOLY4_X0 +
+                            ( (AIRCRAFT_DATA_GSGPOLY4_X1 - AIRCRAFT_DATA_GSGPOLY4_X0) >> 2),
+                            AIRCRAFT_DATA_GSGPOLY4_Y0 +
+                            ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
+                            "No flights!"   );
+        }
+    }
+}
+
+static uint32_t GameGuiHashAdd(uint32_t hash, uint32_t value)
+{
+    return ((hash << 5) + hash) ^ value;
+}
+
+/* **********************************************************************************************
+ *
+ * @name: uint32_t GameGuiAircraftListHash(const TYPE_PLAYER* const ptrPlayer, const TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Calculates a hash (djb2) from all data shown by GameGuiAircraftListContents(),
+ *  so offscreen cache is only drawn again when any of them changes.
+ *
+ * **********************************************************************************************/
+static uint32_t GameGuiAircraftListHash(const TYPE_PLAYER* const ptrPlayer, const TYPE_FLIGHT_DATA* const ptrFlightData)
+{
+    const uint8_t init_flight = ptrPlayer->FlightDataPage * GAME_GUI_AIRCRAFT_DATA_MAX_PAGE;
+    uint32_t hash = 5381;
+    uint8_t i;
+
+    hash = GameGuiHashAdd(hash, GameTwoPlayersActive());
+    // Page arrows and aircraft state flash at 2 Hz.
+    hash = GameGuiHashAdd(hash, Gfx2HzFlash());
+    hash = GameGuiHashAdd(hash, ptrPlayer->RemainingAircraft);
+    hash = GameGuiHashAdd(hash, ptrPlayer->NextAircraftTime);
+    hash = GameGuiHashAdd(hash, ptrPlayer->ActiveAircraft);
+    hash = GameGuiHashAdd(hash, ptrPlayer->FlightDataPage);
+
+    for (i = init_flight; (i < ptrPlayer->ActiveAircraft) && ((i - init_flight) < GAME_GUI_AIRCRAFT_DATA_MAX_PAGE); i++)
+    {
+        const uint8_t idx = ptrPlayer->ActiveAircraftList[i];
+        const char* strFlightNumber = ptrFlightData->strFlightNumber[idx];
+
+        hash = GameGuiHashAdd(hash, idx);
+        hash = GameGuiHashAdd(hash, ptrFlightData->FlightDirection[idx]);
+        hash = GameGuiHashAdd(hash, ptrFlightData->State[idx]);
+        hash = GameGuiHashAdd(hash, ptrFlightData->RemainingTime[idx]);
+
+        while (*strFlightNumber != '\0')
+        {
+            hash = GameGuiHashAdd(hash, *strFlightNumber++);
         }
     }
 
+    return hash;
+}
+
+/* **********************************************************************************************
+ *
+ * @name: bool GameGuiVramCacheAlloc(TYPE_VRAM_CACHE* const ptrCache, short w, short h)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Makes sure ptrCache owns a w x h offscreen VRAM area. A new area is only
+ *  allocated if no area was allocated before or it has been evicted by
+ *  any other VRAM reservation (e.g.: GfxSaveDisplayData()).
+ *
+ * @return:
+ *  true if ptrCache owns a valid VRAM area, false otherwise.
+ *
+ * **********************************************************************************************/
+static bool GameGuiVramCacheAlloc(TYPE_VRAM_CACHE* const ptrCache, short w, short h)
+{
+    if (ptrCache->Allocated)
+    {
+        if (VramIsResident(ptrCache->x, ptrCache->y, ptrCache->w, ptrCache->h))
+        {
+            if ((ptrCache->w == w) && (ptrCache->h == h))
+            {
+                return true;
+            }
+
+            VramFree(ptrCache->x, ptrCache->y);
+        }
+
+        ptrCache->Allocated = false;
+    }
+    else if (ptrCache->AllocFailed)
+    {
+        // Avoid looking for free VRAM on every frame.
+        return false;
+    }
+
+    ptrCache->Valid = false;
+
+    if (    (VramAlloc(w, h, VRAM_AREA_16BPP, &ptrCache->x, &ptrCache->y) == false)
+                ||
+            (VramReserve(ptrCache->x, ptrCache->y, w, h, VRAM_OWNER_GAME) == false)   )
+    {
+        Serial_printf("GameGui: no VRAM available for %dx%d cache\n", w, h);
+        ptrCache->AllocFailed = true;
+        return false;
+    }
+
+    ptrCache->w = w;
+    ptrCache->h = h;
+    ptrCache->Allocated = true;
+
+    return true;
+}
+
+/* **********************************************************************************************
+ *
+ * @name: void GameGuiAircraftListCached(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Aircraft list contents are drawn into an offscreen VRAM area only when shown data
+ *  changes (usually on 1-second ticks or user input). Otherwise, they are drawn as a
+ *  single sprite.
+ *
+ * @remarks:
+ *  Offscreen area is cleared to 0x0000, which is drawn as transparent, so only text,
+ *  icons and page arrows are drawn over the background. If no VRAM is available,
+ *  contents are drawn directly into the framebuffer.
+ *
+ * **********************************************************************************************/
+static void GameGuiAircraftListCached(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData)
+{
+    TYPE_VRAM_CACHE* const ptrCache = &ptrPlayer->AircraftListCache;
+    const bool twoPlayers = GameTwoPlayersActive();
+    const short x = twoPlayers? AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER : AIRCRAFT_DATA_GSGPOLY4_X0;
+    const short y = twoPlayers? AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER : AIRCRAFT_DATA_GSGPOLY4_Y0;
+    const short w = twoPlayers?
+                        AIRCRAFT_DATA_GSGPOLY4_X1_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_X0_2PLAYER
+                    :   AIRCRAFT_DATA_GSGPOLY4_X1 - AIRCRAFT_DATA_GSGPOLY4_X0;
+    const short h = twoPlayers?
+                        AIRCRAFT_DATA_GSGPOLY4_Y2_2PLAYER - AIRCRAFT_DATA_GSGPOLY4_Y0_2PLAYER
+                    :   AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0;
+    uint32_t hash;
+
+    if (GameGuiVramCacheAlloc(ptrCache, w, h) == false)
+    {
+        GameGuiAircraftListContents(ptrPlayer, ptrFlightData);
+        return;
+    }
+
+    hash = GameGuiAircraftListHash(ptrPlayer, ptrFlightData);
+
+    if ((ptrCache->Valid == false) || (ptrCache->Hash != hash))
+    {
+        GsRectangle clearRect =
+        {
+            .x = x,
+            .y = y,
+            .w = w,
+            .h = h,
+            .r = 0,
+            .g = 0,
+            .b = 0,
+            .attribute = 0
+        };
+
+        GfxOffscreenBegin(x, y, w, h, ptrCache->x, ptrCache->y);
+
+        GsSortRectangle(&clearRect);
+
+        GameGuiAircraftListContents(ptrPlayer, ptrFlightData);
+
+        GfxOffscreenEnd();
+
+        ptrCache->Valid = true;
+        ptrCache->Hash = hash;
+    }
+
+    AircraftListSpr.x = x;
+    AircraftListSpr.y = y;
+    AircraftListSpr.w = w;
+    AircraftListSpr.h = h;
+
+    GfxTPageOffsetFromVRAMPosition(&AircraftListSpr, ptrCache->x, ptrCache->y);
+
+    GfxSortSprite(&AircraftListSpr);
 }
 
 /* **********************************************************************************************
@@ -835,17 +1118,11 @@ void GameGuiClock(uint8_t hour, uint8_t min)
         CLOCK_Y = 4
     };
 
-    static char strClock[6]; // HH:MM + \0 (6 characters needed)
-
-    if (GameStartupFlag || System1SecondTick())
-    {
-        memset(strClock, 0, 6);
-        snprintf(strClock,6,"%02d:%02d",hour, min);
-    }
+    static TYPE_FONT_RUN ClockRun;
 
     RadioFont.max_ch_wrap = 0;
     FontSetFlags(&RadioFont, FONT_NOFLAGS);
-    FontPrintText(&RadioFont,CLOCK_X,CLOCK_Y,strClock);
+    FontRunPrint(&ClockRun, &RadioFont, CLOCK_X, CLOCK_Y, "%02d:%02d", hour, min);
 }
 
 /* **********************************************************************************************
@@ -958,9 +1235,11 @@ void GameGuiShowAircraftData(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* con
             break;
         }
 
-        FontPrintText(  &SmallFont,
+        FontRunPrint(   &ptrPlayer->TextRuns[TEXT_RUN_FLIGHT_NUMBER + j],
+                        &SmallFont,
                         AircraftDataFlightNumber_X,
                         AircraftDataFlightNumber_Y + (AIRCRAFT_DATA_FLIGHT_GSGPOLY4_H * j),
+                        "%s",
                         ptrFlightData->strFlightNumber[ptrPlayer->ActiveAircraftList[i]]    );
 
         DepArrSpr.x = AircraftDataDirection_X;
@@ -992,15 +1271,18 @@ void GameGuiShowAircraftData(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* con
 
         if (strState != NULL)
         {
-            FontPrintText(  &SmallFont,
+            FontRunPrint(   &ptrPlayer->TextRuns[TEXT_RUN_STATE + j],
+                            &SmallFont,
                             AircraftDataDirection_X + AircraftDataState_X_Offset,
                             AircraftDataDirection_Y + (AIRCRAFT_DATA_FLIGHT_GSGPOLY4_H * j),
-                            (char*)strState );
+                            "%s",
+                            strState );
         }
 
         FontSetFlags(&SmallFont, FONT_NOFLAGS);
 
-        FontPrintText(  &SmallFont,
+        FontRunPrint(   &ptrPlayer->TextRuns[TEXT_RUN_REMAINING_TIME + j],
+                        &SmallFont,
                         AircraftDataRemainingTime_X,
                         AircraftDataRemainingTime_Y + (AIRCRAFT_DATA_FLIGHT_GSGPOLY4_H * j),
                         "%ds",
@@ -1104,7 +1386,10 @@ void GameGuiShowScore(void)
         SCORE_Y = 4,
     };
 
-    FontPrintText(  &RadioFont,
+    static TYPE_FONT_RUN ScoreRun;
+
+    FontRunPrint(   &ScoreRun,
+                    &RadioFont,
                     SCORE_X,
                     SCORE_Y,
                     "Score:%d", slowScore );
@@ -1154,46 +1439,49 @@ void GameGuiClearPassengersLeft(void)
 
 /* **********************************************************************************************
  *
- * @name: bool GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)
+ * @name: void GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)
  *
  * @author: Xavier Del Campo
  *
  * @brief:
  *  Executed when all aircraft has been dispatched and level has been finished.
+ *  Gameplay is exited if player presses PAD_CROSS (see GameGuiDialogExit()).
  *
- * @return:
- *  true if player has pressed PAD_CROSS so gameplay is exited.
+ * @remarks:
+ *  Non-blocking. Simulation is halted while dialog is open.
  *
  * **********************************************************************************************/
-bool GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)
+void GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)
 {
-    GfxSaveDisplayData(&SecondDisplay);
+    FinishedDialog.PadKeySinglePress_Callback = ptrPlayer->PadKeySinglePress_Callback;
 
-    GfxSetGlobalLuminance(NORMAL_LUMINANCE);
-
-    do
+    if (DialogOpen(&FinishedDialog))
     {
-        if (ptrPlayer->PadKeySinglePress_Callback(PAD_CROSS))
-        {
-            return true;
-        }
-
-        GfxSortSprite(&SecondDisplay);
-
-        GsSortGPoly4(&PauseRect);
-
-        FontPrintText(  &SmallFont,
-                        AIRCRAFT_DATA_GSGPOLY4_X0 +
-                        ( (AIRCRAFT_DATA_GSGPOLY4_X1 - AIRCRAFT_DATA_GSGPOLY4_X0) >> 2),
-                        AIRCRAFT_DATA_GSGPOLY4_Y0 +
-                        ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
-                        "Level finished!"   );
+        GfxSetGlobalLuminance(NORMAL_LUMINANCE);
+    }
+}
 
-        GfxDrawScene_Slow();
+static bool GameGuiFinishedDialogHandler(TYPE_DIALOG* const ptrDialog)
+{
+    if (ptrDialog->PadKeySinglePress_Callback(PAD_CROSS))
+    {
+        dialogExit = true;
+        return false;
+    }
 
-    } while (ptrPlayer->PadKeySinglePress_Callback(PAD_START) == false);
+    return (ptrDialog->PadKeySinglePress_Callback(PAD_START) == false);
+}
 
-    return false;
+static void GameGuiFinishedDialogRender(const TYPE_DIALOG* const ptrDialog)
+{
+    GsSortGPoly4(&PauseRect);
+
+    FontPrintText(  &SmallFont,
+                    AIRCRAFT_DATA_GSGPOLY4_X0 +
+                    ( (AIRCRAFT_DATA_GSGPOLY4_X1 - AIRCRAFT_DATA_GSGPOLY4_X0) >> 2),
+                    AIRCRAFT_DATA_GSGPOLY4_Y0 +
+                    ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
+                    "Level finished!"   );
 }
 
 /* **********************************************************************************************
@@ -1204,33 +1492,42 @@ bool GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer)
  *
  * @brief:
  *  When two or more aircraft collide, this function is called to show a "Game over"-like
- *  message on screen. Gameplay is finished at this point.
+ *  message on screen. Gameplay is finished once player presses PAD_CROSS.
  *
  * @remarks:
- *  Blocking function.
+ *  Non-blocking. Simulation is halted while dialog is open.
  *
  * **********************************************************************************************/
 void GameGuiAircraftCollision(TYPE_PLAYER* const ptrPlayer)
 {
-    GfxSaveDisplayData(&SecondDisplay);
+    CollisionDialog.PadKeySinglePress_Callback = ptrPlayer->PadKeySinglePress_Callback;
 
-    GfxSetGlobalLuminance(NORMAL_LUMINANCE);
-
-    do
+    if (DialogOpen(&CollisionDialog))
     {
-        GfxSortSprite(&SecondDisplay);
+        GfxSetGlobalLuminance(NORMAL_LUMINANCE);
+    }
+}
 
-        GsSortGPoly4(&PauseRect);
+static bool GameGuiCollisionDialogHandler(TYPE_DIALOG* const ptrDialog)
+{
+    if (ptrDialog->PadKeySinglePress_Callback(PAD_CROSS))
+    {
+        dialogExit = true;
+        return false;
+    }
 
-        FontPrintText(  &SmallFont,
-                        AIRCRAFT_DATA_GSGPOLY4_X0 + 8,
-                        AIRCRAFT_DATA_GSGPOLY4_Y0 +
-                        ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
-                        "Collision between aircraft!"   );
+    return true;
+}
 
-        GfxDrawScene_Slow();
+static void GameGuiCollisionDialogRender(const TYPE_DIALOG* const ptrDialog)
+{
+    GsSortGPoly4(&PauseRect);
 
-    } while (ptrPlayer->PadKeySinglePress_Callback(PAD_CROSS) == false);
+    FontPrintText(  &SmallFont,
+                    AIRCRAFT_DATA_GSGPOLY4_X0 + 8,
+                    AIRCRAFT_DATA_GSGPOLY4_Y0 +
+                    ( (AIRCRAFT_DATA_GSGPOLY4_Y2 - AIRCRAFT_DATA_GSGPOLY4_Y0) >> 1),
+                    "Collision between aircraft!"   );
 }
 
 /* **********************************************************************************************
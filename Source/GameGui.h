@@ -25,7 +25,8 @@
  * *************************************/
 
 void GameGuiInit(void);
-bool GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer);
+void GameGuiPauseDialog(const TYPE_PLAYER* const ptrPlayer);
+bool GameGuiDialogExit(void);
 bool GameGuiShowAircraftDataSpecialConditions(TYPE_PLAYER* const ptrPlayer);
 void GameGuiBubble(TYPE_FLIGHT_DATA* const ptrFlightData);
 void GameGuiClock(uint8_t hour, uint8_t min);
@@ -35,7 +36,7 @@ void GameGuiCalculateSlowScore(void);
 void GameGuiShowScore(void);
 void GameGuiDrawUnboardingSequence(TYPE_PLAYER* const ptrPlayer);
 void GameGuiAircraftList(TYPE_PLAYER* const ptrPlayer, TYPE_FLIGHT_DATA* const ptrFlightData);
-bool GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer);
+void GameGuiFinishedDialog(TYPE_PLAYER* const ptrPlayer);
 void GameGuiAircraftCollision(TYPE_PLAYER* const ptrPlayer);
 void GameGuiBubbleShow(void);
 void GameGuiShowPassengersLeft(TYPE_PLAYER* const ptrPlayer);
@@ -14,6 +14,8 @@
 #define AIRCRAFT_MAX_TARGETS 48
 #define PLAYER_MAX_WAYPOINTS AIRCRAFT_MAX_TARGETS
 #define GAME_MAX_SEQUENCE_KEYS 12
+#define FONT_RUN_MAX_LENGTH 24
+#define PLAYER_MAX_TEXT_RUNS 16
 
 /* *************************************
  * 	Structs and enums
@@ -150,6 +152,52 @@ typedef struct t_aircraftData
 	fix16_t YPos_Old;
 }TYPE_AIRCRAFT_DATA;
 
+typedef struct t_vramCache
+{
+	// Offscreen VRAM area, only valid if Allocated == true.
+	short x;
+	short y;
+	short w;
+	short h;
+	bool Allocated;
+	// No VRAM was available on last allocation attempt.
+	bool AllocFailed;
+	// Contents have been drawn at least once.
+	bool Valid;
+	// Calculated from data shown when contents were last drawn.
+	uint32_t Hash;
+}TYPE_VRAM_CACHE;
+
+typedef struct t_fontGlyph
+{
+	// Position relative to text origin.
+	short x;
+	short y;
+	// Relative to font image. Not used by button glyphs.
+	unsigned char u;
+	unsigned char v;
+	// PAD_xxx for button glyphs, 0 otherwise.
+	unsigned short btn;
+}TYPE_FONT_GLYPH;
+
+typedef struct t_fontRun
+{
+	// Formatted text which glyphs were laid out from.
+	char text[FONT_RUN_MAX_LENGTH];
+	// Font and font parameters used for layout.
+	const struct t_Font* ptrFont;
+	short char_w;
+	short char_h;
+	short char_spacing;
+	char init_ch;
+	uint8_t max_ch_wrap;
+	// Bounding box, relative to text origin.
+	short w;
+	short h;
+	uint8_t n_glyphs;
+	TYPE_FONT_GLYPH glyphs[FONT_RUN_MAX_LENGTH];
+}TYPE_FONT_RUN;
+
 typedef struct
 {
 	// ## State flags ##
@@ -214,6 +262,10 @@ typedef struct
     uint16_t NextAircraftTime;
     // Number of remaining aircraft in STATE_IDLE.
     uint16_t RemainingAircraft;
+    // Cached text runs for GUI elements drawn on every frame (see GameGui).
+    TYPE_FONT_RUN TextRuns[PLAYER_MAX_TEXT_RUNS];
+    // Offscreen copy of aircraft list contents (see GameGuiAircraftList()).
+    TYPE_VRAM_CACHE AircraftListCache;
 
     // Pad callbacks.
 	bool	(*const PadKeyPressed_Callback)(unsigned short);
@@ -264,15 +316,42 @@ typedef struct t_Cheat
 	void (*Callback)(void);
 }TYPE_CHEAT;
 
+// Selects how departure flights are assigned to
+// parking tiles on PLT file generation.
+typedef enum t_PltParkingDistribution
+{
+	PLT_PARKING_ROUND_ROBIN = 0,
+	PLT_PARKING_RANDOM,
+	// All departures share ParkingArray[0], for worst-case contention.
+	PLT_PARKING_SINGLE
+}PLT_PARKING_DISTRIBUTION;
+
 // TYPE_PLT_CONFIG is used for PLT file generation.
 typedef struct t_PltConfig
 {
 	uint8_t MaxTime; // Minutes
 	uint8_t nRunway;
 	uint8_t ParkingArray[GAME_MAX_PARKING];
+	uint8_t nParking; // Valid elements inside ParkingArray.
 	LEVEL_DIFFICULTY Level;
 	bool TwoPlayers;
 	uint8_t maxLostFlights;
+	uint8_t nAircraft; // 0: selected randomly, depending on Level.
+	uint8_t MinFlightInterval; // Game minutes. 0: depending on Level.
+	uint8_t MaxFlightInterval; // Game minutes. 0: depending on Level.
+	uint8_t DeparturePercentage; // 0 (arrivals only) to 100 (departures only).
+	PLT_PARKING_DISTRIBUTION ParkingDistribution;
+	uint16_t RemainingTime; // Seconds. 0: depending on Level.
+	unsigned int Seed; // 0: current rand() sequence is kept.
 }TYPE_PLT_CONFIG;
 
+// TYPE_LEVEL_CONFIG is used for LVL file generation.
+typedef struct t_LevelConfig
+{
+	uint8_t Columns;
+	uint8_t nRunway;
+	uint8_t nParking;
+	const char* strTitle; // NULL: default title is used.
+}TYPE_LEVEL_CONFIG;
+
 #endif // GAME_STRUCTURES__HEADER__
@@ -4,6 +4,14 @@
 
 #include "Gfx.h"
 #include "System.h"
+#include "AssetCache.h"
+#include "Vram.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "EmuHook.h"
+#include "LoadMenu.h"
+#include "Memory.h"
+#include "Log.h"
 #include "Camera.h"
 #include "Pad.h"
 #include "Game.h"
@@ -16,7 +24,20 @@
 #define PRIMITIVE_LIST_SIZE 0x2000
 #define DOUBLE_BUFFERING_SWAP_Y	256
 #define UPLOAD_IMAGE_FLAG 1
+#define GFX_OT_MAX_INSTANCES MAX_PLAYERS
+// Isometric depth (x + y) units per ordering table bucket.
+#define GFX_OT_DEPTH_SHIFT 4
+#define GFX_PACKET_ADDR_MASK 0x00FFFFFF
+#define GFX_PACKET_SIZE_MASK 0xFF000000
+// Packet address bits for a pointer into RAM. Cast through size_t,
+// so host builds (see Source/Bench) truncate 64-bit pointers silently.
+#define GFX_PACKET_ADDR(ptr) ((unsigned int)(size_t)(ptr) & GFX_PACKET_ADDR_MASK)
+#define GFX_GP0_CLEAR_CACHE 0x01000000
+#define GFX_GP0_DRAW_AREA_TOP_LEFT 0xE3000000
+#define GFX_GP0_DRAW_AREA_BOTTOM_RIGHT 0xE4000000
+#define GFX_GP0_DRAW_OFFSET 0xE5000000
 #define MAX_LUMINANCE 0xFF
+#define GFX_N_FRAMEBUFFERS 2
 #define GPUSTAT (*(volatile unsigned int*)0x1F801814)
 
 /* *************************************
@@ -66,10 +87,27 @@ enum
 enum
 {
 	GFX_SECOND_DISPLAY_X = 384,
-	GFX_SECOND_DISPLAY_Y = 256,
-	GFX_SECOND_DISPLAY_TPAGE = 22
+	GFX_SECOND_DISPLAY_Y = 256
 };
 
+// VRAM areas which can be used for drawing and display. Only two of
+// them are swapped at the same time, while the other one is kept
+// untouched (see GfxSaveDisplayData()).
+typedef enum t_gfxBuffer
+{
+	GFX_BUFFER_0,
+	GFX_BUFFER_1,
+	GFX_BUFFER_SECOND_DISPLAY,
+
+	MAX_GFX_BUFFERS
+}GFX_BUFFER;
+
+typedef struct t_gfxBufferPos
+{
+	short x;
+	short y;
+}TYPE_GFX_BUFFER_POS;
+
 /* *************************************
  * 	Global Variables
  * *************************************/
@@ -80,13 +118,38 @@ GsSprite PSXButtons;
  * 	Local Prototypes
  * *************************************/
 void GfxSetPrimitiveList(unsigned int* ptrList);
+static void GfxSortDrawEnv(void);
+static void GfxOTFlush(void);
+static void GfxSortFade(void);
+static void GfxSortDrawArea(short x, short y, short w, short h, short offset_x, short offset_y);
+static void GfxBudgetUpdate(void);
+static void GfxBudgetEndFrame(void);
+static bool GfxBudgetExceeded(void);
+static void GfxStaticLayersEndFrame(void);
+static GFX_BUFFER GfxNextDrawBuffer(void);
 
 
 /* *************************************
  * 	Local Variables
  * *************************************/
 
-// Drawing environment
+static const TYPE_GFX_BUFFER_POS GfxBufferPos[MAX_GFX_BUFFERS] =
+{
+	[GFX_BUFFER_0] = {.x = 0, .y = 0},
+	[GFX_BUFFER_1] = {.x = 0, .y = DOUBLE_BUFFERING_SWAP_Y},
+	[GFX_BUFFER_SECOND_DISPLAY] = {.x = GFX_SECOND_DISPLAY_X, .y = GFX_SECOND_DISPLAY_Y}
+};
+
+// Buffer drawn on last frame. It is displayed after next swap.
+static GFX_BUFFER draw_buffer = GFX_BUFFER_1;
+// Buffer being displayed.
+static GFX_BUFFER disp_buffer = GFX_BUFFER_0;
+// Buffer excluded from swapping. Holds display data
+// from GfxSaveDisplayData(), if any.
+static GFX_BUFFER spare_buffer = GFX_BUFFER_SECOND_DISPLAY;
+
+// Drawing environment. X coordinate is relative to
+// current buffer, so it is only used for split-screen.
 static GsDrawEnv DrawEnv;
 // Display environment
 static GsDispEnv DispEnv;
@@ -103,6 +166,48 @@ static uint8_t global_lum;
 static bool five_hundred_ms_show;
 static bool one_second_show;
 
+// Primitive list currently being filled.
+static unsigned int* current_prim_list = prim_list;
+// Ordering table headers. Double buffered, as primitive lists.
+static unsigned int ot_buffer[2][GFX_OT_MAX_INSTANCES][GFX_OT_SIZE];
+// Last packet header for each bucket on current ordering table.
+static unsigned int* ot_tail[GFX_OT_SIZE];
+// NULL when no ordering table is active.
+static unsigned int* ot_current;
+// Primitive list position where primitives for current depth start.
+static unsigned int ot_mark;
+static uint8_t ot_z;
+static uint8_t ot_instance;
+
+// Primitive list words which must be left free after sorting a
+// primitive from each layer. Layers drawn first get bigger reserves,
+// so they are dropped before GUI elements once the list is nearly full.
+static const uint16_t GfxBudgetReserve[MAX_GFX_LAYERS] =
+{
+	[GFX_LAYER_OTHER] = PRIMITIVE_LIST_SIZE >> 6,
+	[GFX_LAYER_TERRAIN] = PRIMITIVE_LIST_SIZE >> 2,
+	[GFX_LAYER_BUILDINGS] = PRIMITIVE_LIST_SIZE >> 3,
+	[GFX_LAYER_AIRCRAFT] = PRIMITIVE_LIST_SIZE >> 4,
+	[GFX_LAYER_GUI] = PRIMITIVE_LIST_SIZE >> 6,
+	[GFX_LAYER_FONTS] = PRIMITIVE_LIST_SIZE >> 6
+};
+
+static uint16_t budget_usage[MAX_GFX_LAYERS];
+static uint16_t budget_last_usage[MAX_GFX_LAYERS];
+static uint16_t budget_last_total;
+static uint16_t budget_peak;
+static uint16_t budget_dropped;
+static uint16_t budget_last_dropped;
+static unsigned int budget_mark;
+static GFX_LAYER budget_layer;
+
+// Screen currently using dirty-region rendering (see GfxStaticLayersPending()).
+static const void* static_owner;
+// Frames which must still be drawn with static layers, one per framebuffer.
+static uint8_t static_frames;
+// Set when static_owner has called GfxStaticLayersPending() on current frame.
+static bool static_queried;
+
 /* **********************************************************************
  *
  * @name: void GfxSwapBuffers(void)
@@ -121,7 +226,17 @@ void GfxSwapBuffers(void)
 
 	if (GsListPos() >= PRIMITIVE_LIST_SIZE)
 	{
+		uint8_t i;
+
+		// Should never happen, as primitive list budget
+		// should have dropped sprites before.
 		Serial_printf("Linked list iterator overflow!\n");
+
+		for (i = 0; i < MAX_GFX_LAYERS; i++)
+		{
+			Serial_printf("Layer %d: %d words\n", i, budget_last_usage[i]);
+		}
+
 		while (1);
 	}
 
@@ -129,11 +244,7 @@ void GfxSwapBuffers(void)
 					||
 		( (DrawEnv.w != X_SCREEN_RESOLUTION)
 						&&
-		  (DrawEnv.w != X_SCREEN_RESOLUTION >> 1) )
-					||
-		( (DispEnv.y != DOUBLE_BUFFERING_SWAP_Y)
-						&&
-		  (DispEnv.y != 0) )		)
+		  (DrawEnv.w != X_SCREEN_RESOLUTION >> 1) )	)
 	{
 		Serial_printf("What the hell is happening?\n");
 		DEBUG_PRINT_VAR(DispEnv.x);
@@ -143,26 +254,60 @@ void GfxSwapBuffers(void)
 
 		while (1);
 	}
+
+	if (ot_current != NULL)
+	{
+		Serial_printf("GfxOTEnd() was not called!\n");
+		while (1);
+	}
 #endif // PSXSDK_DEBUG
 
 	if (DrawEnv.h == Y_SCREEN_RESOLUTION)
 	{
-		if (DispEnv.y == 0)
-		{
-			DispEnv.y = DOUBLE_BUFFERING_SWAP_Y;
-			DrawEnv.y = 0;
-		}
-		else if (DispEnv.y == DOUBLE_BUFFERING_SWAP_Y)
-		{
-			DispEnv.y = 0;
-			DrawEnv.y = DOUBLE_BUFFERING_SWAP_Y;
-		}
+		GsDrawEnv env = DrawEnv;
+
+		disp_buffer = draw_buffer;
+		draw_buffer = GfxNextDrawBuffer();
+
+		DispEnv.x = GfxBufferPos[disp_buffer].x;
+		DispEnv.y = GfxBufferPos[disp_buffer].y;
+		DrawEnv.y = GfxBufferPos[draw_buffer].y;
+
+		env.x = GfxBufferPos[draw_buffer].x + DrawEnv.x;
+		env.y = DrawEnv.y;
 
 		GsSetDispEnv(&DispEnv);
-		GsSetDrawEnv(&DrawEnv);
+		GsSetDrawEnv(&env);
 	}
 }
 
+/* **********************************************************************
+ *
+ * @name: GFX_BUFFER GfxNextDrawBuffer(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Buffer where primitives sorted on current frame will be drawn,
+ *  that is, the one which was neither drawn on last frame nor
+ *  excluded by GfxSaveDisplayData().
+ *
+ * **********************************************************************/
+static GFX_BUFFER GfxNextDrawBuffer(void)
+{
+	GFX_BUFFER buffer;
+
+	for (buffer = GFX_BUFFER_0; buffer < MAX_GFX_BUFFERS; buffer++)
+	{
+		if ((buffer != draw_buffer) && (buffer != spare_buffer))
+		{
+			break;
+		}
+	}
+
+	return buffer;
+}
+
 /* **********************************************************************
  *
  * @name: void GfxInitDrawEnv(void)
@@ -215,11 +360,20 @@ void GfxInitDispEnv(void)
  * **********************************************************************/
 void GfxSetPrimitiveList(unsigned int* ptrList)
 {
+	current_prim_list = ptrList;
+	ot_instance = 0;
+
 	GsSetList(ptrList);
+
+	budget_mark = GsListPos();
 }
 
 void GfxSetDefaultPrimitiveList(void)
 {
+	MEMORY_REGISTER("Gfx", prim_list);
+	MEMORY_REGISTER("Gfx", prim_list2);
+	MEMORY_REGISTER("Gfx", ot_buffer);
+
 	GfxSetPrimitiveList(prim_list);
 }
 
@@ -237,6 +391,9 @@ void GfxSetDefaultPrimitiveList(void)
  * **********************************************************************/
 void GfxDrawScene_Fast(void)
 {
+	// Dim the whole scene, except development menu.
+	GfxSortFade();
+
     SystemDevMenu();
 
     FontSetFlags(&SmallFont, FONT_NOFLAGS);
@@ -251,6 +408,8 @@ void GfxDrawScene_Fast(void)
 		five_hundred_ms_show = five_hundred_ms_show? false:true;
 	}
 
+	GfxBudgetEndFrame();
+	GfxStaticLayersEndFrame();
 	GfxSwapBuffers();
 	FontCyclic();
 	GsDrawList();
@@ -287,9 +446,31 @@ void GfxDrawScene(void)
 
 	ptrPrimList = ((void*)ptrPrimList == (void*)&prim_list)? prim_list2 : prim_list;
 
-	while (	(SystemRefreshNeeded() == false)
-						||
-			(GfxIsGPUBusy())		);
+	// GPU and VBlank waits are done separately so they can be
+	// told apart by the profiler. GPU can't become busy again
+	// while waiting for VBlank, as no new list has been sent.
+	PROFILER_BEGIN(PROFILER_SECTION_GPU_WAIT);
+
+	while (GfxIsGPUBusy())
+	{
+		// CPU is idle anyway, so trace data and
+		// queued log messages can be sent here.
+		TRACE_DRAIN();
+		LogFlush();
+	}
+
+	PROFILER_END(PROFILER_SECTION_GPU_WAIT);
+	EMU_HOOK(EMU_HOOK_GPU_WAIT_END, 0);
+	PROFILER_BEGIN(PROFILER_SECTION_VSYNC_WAIT);
+
+	while (SystemRefreshNeeded() == false)
+	{
+		TRACE_DRAIN();
+		LogFlush();
+	}
+
+	PROFILER_END(PROFILER_SECTION_VSYNC_WAIT);
+	PROFILER_END_FRAME();
 
 	GfxDrawScene_Fast();
 
@@ -327,7 +508,7 @@ void GfxDrawScene_Slow(void)
  * @brief:
  *  Reportedly, adds a sprite to primitive list. Internal flags
  *  (e.g.: 1 Hz flash) are checked and special tasks are performed.
- *  Also, global_lum is applied to sprite's RGB values.
+ *  global_lum is not applied here, but on GfxSortFade().
  *
  * @remarks:
  *  It is checked sprite fits into screen beforehand. Use GsSortSprite()
@@ -336,9 +517,6 @@ void GfxDrawScene_Slow(void)
  * **********************************************************************/
 void GfxSortSprite(GsSprite* spr)
 {
-	uint8_t aux_r = spr->r;
-	uint8_t aux_g = spr->g;
-	uint8_t aux_b = spr->b;
 	unsigned char aux_tpage = spr->tpage;
 	short aux_w = spr->w;
 	short aux_x = spr->x;
@@ -363,35 +541,9 @@ void GfxSortSprite(GsSprite* spr)
 	{
 		return;
 	}
-
-	if (global_lum != NORMAL_LUMINANCE)
+	else if (GfxBudgetExceeded())
 	{
-		if (spr->r < NORMAL_LUMINANCE - global_lum)
-		{
-			spr->r = 0;
-		}
-		else
-		{
-			spr->r -= NORMAL_LUMINANCE - global_lum;
-		}
-
-		if (spr->g < NORMAL_LUMINANCE - global_lum)
-		{
-			spr->g = 0;
-		}
-		else
-		{
-			spr->g -= NORMAL_LUMINANCE - global_lum;
-		}
-
-		if (spr->b < NORMAL_LUMINANCE - global_lum)
-		{
-			spr->b = 0;
-		}
-		else
-		{
-			spr->b -= NORMAL_LUMINANCE - global_lum;
-		}
+		return;
 	}
 
 	if (has_1hz_flash)
@@ -426,10 +578,75 @@ void GfxSortSprite(GsSprite* spr)
 	{
 		spr->attribute |= GFX_1HZ_FLASH;
 	}
+}
 
-	spr->r = aux_r;
-	spr->g = aux_g;
-	spr->b = aux_b;
+/* **********************************************************************
+ *
+ * @name: void GfxSortSprite_Fast(GsSprite* spr)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds a sprite to primitive list without screen limit checks,
+ *  flashing flags or sprite splitting.
+ *
+ * @remarks:
+ *  Intended for large amounts of sprites which have already been
+ *  culled by the caller (e.g.: terrain tiles).
+ *
+ * **********************************************************************/
+void GfxSortSprite_Fast(GsSprite* spr)
+{
+	if (GfxBudgetExceeded())
+	{
+		return;
+	}
+
+	GsSortSprite(spr);
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxSortFade(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Applies global_lum to the whole scene by drawing a full-screen
+ *  rectangle with subtractive blending (background - foreground)
+ *  on top of all other primitives.
+ *
+ * @remarks:
+ *  This way, no colour arithmetic is needed for each sprite,
+ *  and non-textured primitives are also dimmed.
+ *
+ * **********************************************************************/
+static void GfxSortFade(void)
+{
+	static GsRectangle fadeRect =
+	{
+		.x = 0,
+		.y = 0,
+		.w = X_SCREEN_RESOLUTION,
+		.h = Y_SCREEN_RESOLUTION,
+		.attribute = ENABLE_TRANS | TRANS_MODE(2)
+	};
+
+	unsigned char fade;
+
+	if (global_lum >= NORMAL_LUMINANCE)
+	{
+		return;
+	}
+
+	// Map [NORMAL_LUMINANCE, 0] to [0, 255].
+	fade = ((NORMAL_LUMINANCE - global_lum) * 0xFF) / NORMAL_LUMINANCE;
+
+	fadeRect.r = fade;
+	fadeRect.g = fade;
+	fadeRect.b = fade;
+
+	GsSortRectangle(&fadeRect);
 }
 
 /* **********************************************************************
@@ -439,8 +656,8 @@ void GfxSortSprite(GsSprite* spr)
  * @author: Xavier Del Campo
  *
  * @return:
- *  Returns global_lum value, a global variable used to dim all drawn
- *  sprites as needed.
+ *  Returns global_lum value, a global variable used to dim the
+ *  whole scene as needed.
  *
  * **********************************************************************/
 uint8_t GfxGetGlobalLuminance(void)
@@ -455,8 +672,8 @@ uint8_t GfxGetGlobalLuminance(void)
  * @author: Xavier Del Campo
  *
  * @return:
- *  Sets global_lum value, a global variable used to dim all drawn
- *  sprites as needed.
+ *  Sets global_lum value, a global variable used to dim the
+ *  whole scene as needed.
  *
  * **********************************************************************/
 void GfxSetGlobalLuminance(uint8_t value)
@@ -544,13 +761,25 @@ bool GfxSpriteFromFile(const char* fname, GsSprite* spr)
 		return false;
 	}
 
+	LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_WAIT);
 	while (GfxIsGPUBusy());
+	LOAD_MENU_TIME_END(LOAD_MENU_TIME_WAIT);
 
 	gfx_busy = true;
 
 	GsImageFromTim(&gsi, SystemGetBufferAddress() );
 
+	if (VramPlaceImage(&gsi) == false)
+	{
+		gfx_busy = false;
+		return false;
+	}
+
+	LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_UPLOAD);
 	GsSpriteFromImage(spr, &gsi, UPLOAD_IMAGE_FLAG);
+	LOAD_MENU_TIME_END(LOAD_MENU_TIME_UPLOAD);
+
+	AssetCacheAddImage(fname, spr, &gsi);
 
 	gfx_busy = false;
 
@@ -580,13 +809,25 @@ bool GfxCLUTFromFile(const char* fname)
 		return false;
 	}
 
+	LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_WAIT);
 	while (GfxIsGPUBusy());
+	LOAD_MENU_TIME_END(LOAD_MENU_TIME_WAIT);
 
 	gfx_busy = true;
 
 	GsImageFromTim(&gsi,SystemGetBufferAddress() );
 
+	if (VramPlaceCLUT(&gsi) == false)
+	{
+		gfx_busy = false;
+		return false;
+	}
+
+	LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_UPLOAD);
 	GsUploadCLUT(&gsi);
+	LOAD_MENU_TIME_END(LOAD_MENU_TIME_UPLOAD);
+
+	AssetCacheAddImage(fname, NULL, &gsi);
 
 	gfx_busy = false;
 
@@ -784,30 +1025,75 @@ void GfxDrawButton(short x, short y, unsigned short btn)
 	PSXButtons.rotate = 0;
 }
 
+/* **********************************************************************
+ *
+ * @name: void GfxSaveDisplayData(GsSprite *spr)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Fills spr so it shows contents from the buffer being displayed now.
+ *  No VRAM-to-VRAM copy is done: instead, displayed buffer is excluded
+ *  from swapping, and second display area is swapped with the
+ *  remaining framebuffer until GfxReleaseDisplayData() is called.
+ *
+ * @remarks:
+ *  Only the last buffer saved is kept untouched.
+ *
+ * **********************************************************************/
 void GfxSaveDisplayData(GsSprite *spr)
 {
-	while (GfxIsGPUBusy());
+	if (spare_buffer == GFX_BUFFER_SECOND_DISPLAY)
+	{
+		// Second display area is now used for drawing.
+		VramReserve(	GFX_SECOND_DISPLAY_X,
+						GFX_SECOND_DISPLAY_Y,
+						X_SCREEN_RESOLUTION,
+						Y_SCREEN_RESOLUTION,
+						VRAM_OWNER_SYSTEM	);
+	}
 
-	MoveImage(	DispEnv.x,
-				DispEnv.y,
-				GFX_SECOND_DISPLAY_X,
-				GFX_SECOND_DISPLAY_Y,
-				X_SCREEN_RESOLUTION,
-				Y_SCREEN_RESOLUTION);
+	spare_buffer = disp_buffer;
 
 	spr->x = 0;
 	spr->y = 0;
-	spr->tpage = GFX_SECOND_DISPLAY_TPAGE;
 	spr->attribute |= COLORMODE(COLORMODE_16BPP);
 	spr->w = X_SCREEN_RESOLUTION;
 	spr->h = Y_SCREEN_RESOLUTION;
-	spr->u = 0;
-	spr->v = 0;
 	spr->r = NORMAL_LUMINANCE;
 	spr->g = NORMAL_LUMINANCE;
 	spr->b = NORMAL_LUMINANCE;
 
-	while (GfxIsGPUBusy());
+	GfxTPageOffsetFromVRAMPosition(	spr,
+									GfxBufferPos[spare_buffer].x,
+									GfxBufferPos[spare_buffer].y	);
+
+	// Sets drawing area to the buffer selected on next swap. Texture
+	// cache is also flushed, as it might hold older display data.
+	GfxOffscreenEnd();
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxReleaseDisplayData(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Called once sprite filled by GfxSaveDisplayData() is not drawn
+ *  anymore. Double buffering returns to both framebuffers, so second
+ *  display area is not drawn again after next swap, and its VRAM
+ *  reservation is released so textures can be placed there again.
+ *
+ * **********************************************************************/
+void GfxReleaseDisplayData(void)
+{
+	if (spare_buffer != GFX_BUFFER_SECOND_DISPLAY)
+	{
+		VramFree(GFX_SECOND_DISPLAY_X, GFX_SECOND_DISPLAY_Y);
+	}
+
+	spare_buffer = GFX_BUFFER_SECOND_DISPLAY;
 }
 
 bool Gfx1HzFlash(void)
@@ -890,6 +1176,32 @@ TYPE_ISOMETRIC_POS GfxCartesianToIsometric(TYPE_CARTESIAN_POS * ptrCartPos)
 	return IsoPos;
 }
 
+/* **********************************************************************
+ *
+ * @name: void GfxSortDrawEnv(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds clip area and drawing offset from DrawEnv to primitive list,
+ *  so split-screen halves can be submitted on a single GsDrawList() call.
+ *
+ * @remarks:
+ *  Primitive list is drawn after GfxSwapBuffers(), so queued drawing
+ *  environment must target the buffer selected on next swap.
+ *
+ * **********************************************************************/
+static void GfxSortDrawEnv(void)
+{
+	const GFX_BUFFER buffer = GfxNextDrawBuffer();
+	GsDrawEnv env = DrawEnv;
+
+	env.x = GfxBufferPos[buffer].x + DrawEnv.x;
+	env.y = GfxBufferPos[buffer].y;
+
+	GsSetDrawEnv_DMA(&env);
+}
+
 void GfxSetSplitScreen(uint8_t playerIndex)
 {
 	switch(playerIndex)
@@ -908,7 +1220,7 @@ void GfxSetSplitScreen(uint8_t playerIndex)
 		break;
 	}
 
-	GsSetDrawEnv(&DrawEnv);
+	GfxSortDrawEnv();
 }
 
 void GfxDisableSplitScreen(void)
@@ -916,7 +1228,92 @@ void GfxDisableSplitScreen(void)
 	DrawEnv.x = 0;
 	DrawEnv.w = X_SCREEN_RESOLUTION;
 
-	GsSetDrawEnv_DMA(&DrawEnv);
+	GfxSortDrawEnv();
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxSortDrawArea(short x, short y, short w, short h, short offset_x, short offset_y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds clip area, drawing offset and a texture cache flush command
+ *  to primitive list. Unlike GsSetDrawEnv_DMA(), drawing offset
+ *  does not need to match clip area origin.
+ *
+ * @remarks:
+ *  Same as GfxOTBegin(), a dummy primitive is sorted and its data
+ *  words are then replaced by GP0 commands. Remaining words are
+ *  filled with NOP commands.
+ *
+ * **********************************************************************/
+static void GfxSortDrawArea(short x, short y, short w, short h, short offset_x, short offset_y)
+{
+	enum
+	{
+		GFX_DRAW_AREA_WORDS = 4
+	};
+
+	static const GsGPoly4 dummy;
+	const unsigned int linkPos = GsListPos();
+	unsigned int* ptrPacket;
+	unsigned int size;
+	unsigned int i;
+
+	GsSortGPoly4((GsGPoly4*)&dummy);
+
+	ptrPacket = &current_prim_list[linkPos];
+	size = *ptrPacket >> 24;
+
+	if (size < GFX_DRAW_AREA_WORDS)
+	{
+		Serial_printf("GfxSortDrawArea: unexpected packet size %d\n", size);
+		return;
+	}
+
+	// Texture cache must be flushed so data drawn into
+	// offscreen areas can be safely used as a texture.
+	ptrPacket[1] = GFX_GP0_CLEAR_CACHE;
+	ptrPacket[2] = GFX_GP0_DRAW_AREA_TOP_LEFT | (y << 10) | x;
+	ptrPacket[3] = GFX_GP0_DRAW_AREA_BOTTOM_RIGHT | ((y + h - 1) << 10) | (x + w - 1);
+	ptrPacket[4] = GFX_GP0_DRAW_OFFSET | ((offset_y & 0x7FF) << 11) | (offset_x & 0x7FF);
+
+	for (i = GFX_DRAW_AREA_WORDS + 1; i <= size; i++)
+	{
+		ptrPacket[i] = 0;
+	}
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxOffscreenBegin(short x, short y, short w, short h, short vram_x, short vram_y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Primitives sorted from now on are drawn into a w x h area located
+ *  at (vram_x, vram_y) instead of the framebuffer. Screen position
+ *  (x, y) is mapped to (vram_x, vram_y), so callers can still use
+ *  screen coordinates.
+ *
+ * @remarks:
+ *  GfxOffscreenEnd() must be called before sorting any other
+ *  primitive targetting the framebuffer.
+ *
+ * **********************************************************************/
+void GfxOffscreenBegin(short x, short y, short w, short h, short vram_x, short vram_y)
+{
+	GfxSortDrawArea(vram_x, vram_y, w, h, vram_x - x, vram_y - y);
+}
+
+void GfxOffscreenEnd(void)
+{
+	const GFX_BUFFER buffer = GfxNextDrawBuffer();
+	const short x = GfxBufferPos[buffer].x + DrawEnv.x;
+	const short y = GfxBufferPos[buffer].y;
+
+	GfxSortDrawArea(x, y, DrawEnv.w, DrawEnv.h, x, y);
 }
 
 short GfxGetDrawEnvWidth(void)
@@ -928,3 +1325,336 @@ short GfxGetDrawEnvHeight(void)
 {
     return DrawEnv.h;
 }
+
+/* **********************************************************************
+ *
+ * @name: void GfxOTBegin(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Starts an ordering table. Every bucket is initially linked
+ *  to the next one by an empty (size = 0) packet.
+ *
+ * @remarks:
+ *  PSXSDK writes packets sequentially and links each one to the
+ *  next position on the list. So, in order to jump into the ordering
+ *  table, a dummy primitive is sorted and its header is replaced
+ *  by an empty packet pointing to the first bucket.
+ *
+ * **********************************************************************/
+void GfxOTBegin(void)
+{
+	static const GsRectangle dummy;
+	const uint8_t buffer = (current_prim_list == prim_list)? 0 : 1;
+	unsigned int* ot;
+	unsigned int linkPos;
+	uint16_t i;
+
+	if (ot_current != NULL)
+	{
+		Serial_printf("Ordering table is already active!\n");
+		return;
+	}
+
+	if (ot_instance >= GFX_OT_MAX_INSTANCES)
+	{
+		// Primitives will be drawn in submission order.
+		Serial_printf("Maximum number of ordering tables exceeded!\n");
+		return;
+	}
+
+	ot = ot_buffer[buffer][ot_instance++];
+
+	for (i = 0; i < GFX_OT_SIZE; i++)
+	{
+		// Last bucket is linked on GfxOTEnd().
+		ot[i] = GFX_PACKET_ADDR(&ot[i + 1]);
+		ot_tail[i] = &ot[i];
+	}
+
+	linkPos = GsListPos();
+
+	GsSortRectangle((GsRectangle*)&dummy);
+
+	current_prim_list[linkPos] = GFX_PACKET_ADDR(&ot[0]);
+
+	ot_current = ot;
+	ot_mark = GsListPos();
+	ot_z = GFX_OT_BACKGROUND_Z;
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxOTFlush(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Moves packets sorted since last call into current depth bucket.
+ *  Packets keep their original order inside the bucket.
+ *
+ * **********************************************************************/
+static void GfxOTFlush(void)
+{
+	const unsigned int pos = GsListPos();
+	unsigned int last = ot_mark;
+	unsigned int* ptrLast;
+
+	if (pos == ot_mark)
+	{
+		// No primitives were sorted.
+		return;
+	}
+
+	// Look for last packet header. Packets are stored as
+	// a header word followed by (header >> 24) data words.
+	while ((last + 1 + (current_prim_list[last] >> 24)) < pos)
+	{
+		last += 1 + (current_prim_list[last] >> 24);
+	}
+
+	ptrLast = &current_prim_list[last];
+
+	*ptrLast = (*ptrLast & GFX_PACKET_SIZE_MASK) | (*ot_tail[ot_z] & GFX_PACKET_ADDR_MASK);
+	*ot_tail[ot_z] = (*ot_tail[ot_z] & GFX_PACKET_SIZE_MASK) | GFX_PACKET_ADDR(&current_prim_list[ot_mark]);
+	ot_tail[ot_z] = ptrLast;
+}
+
+void GfxOTSetZ(uint8_t z)
+{
+	if (ot_current == NULL)
+	{
+		return;
+	}
+
+	GfxOTFlush();
+
+	ot_z = z;
+	ot_mark = GsListPos();
+}
+
+void GfxOTEnd(void)
+{
+	unsigned int* ptrEnd;
+
+	if (ot_current == NULL)
+	{
+		return;
+	}
+
+	GfxOTFlush();
+
+	// Link last bucket to the position where next primitives will be sorted.
+	ptrEnd = ot_tail[GFX_OT_SIZE - 1];
+	*ptrEnd = (*ptrEnd & GFX_PACKET_SIZE_MASK) | GFX_PACKET_ADDR(&current_prim_list[GsListPos()]);
+
+	ot_current = NULL;
+}
+
+uint8_t GfxOTDepthFromIsometric(const TYPE_ISOMETRIC_POS* const ptrIsoPos)
+{
+	const short depth = (ptrIsoPos->x + ptrIsoPos->y) >> GFX_OT_DEPTH_SHIFT;
+
+	if (depth < 0)
+	{
+		return GFX_OT_FIRST_OBJECT_Z;
+	}
+	else if (depth > (GFX_OT_LAST_OBJECT_Z - GFX_OT_FIRST_OBJECT_Z))
+	{
+		return GFX_OT_LAST_OBJECT_Z;
+	}
+
+	return GFX_OT_FIRST_OBJECT_Z + depth;
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxBudgetUpdate(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Accounts primitive list words used since last call to current layer.
+ *
+ * **********************************************************************/
+static void GfxBudgetUpdate(void)
+{
+	const unsigned int pos = GsListPos();
+
+	budget_usage[budget_layer] += pos - budget_mark;
+	budget_mark = pos;
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxBudgetEndFrame(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Called right before primitive list is submitted. Per-layer usage
+ *  is stored so it can be shown on development menu, and high-water
+ *  mark is updated.
+ *
+ * **********************************************************************/
+static void GfxBudgetEndFrame(void)
+{
+	const uint16_t total = GsListPos();
+
+	GfxBudgetUpdate();
+
+	memcpy(budget_last_usage, budget_usage, sizeof (budget_usage));
+	memset(budget_usage, 0, sizeof (budget_usage));
+
+	budget_last_total = total;
+	budget_last_dropped = budget_dropped;
+	budget_dropped = 0;
+	budget_layer = GFX_LAYER_OTHER;
+
+	if (total > budget_peak)
+	{
+		budget_peak = total;
+
+		// Both lists are used on alternate frames.
+		MEMORY_USAGE(prim_list, budget_peak * sizeof (unsigned int));
+		MEMORY_USAGE(prim_list2, budget_peak * sizeof (unsigned int));
+	}
+}
+
+/* **********************************************************************
+ *
+ * @name: bool GfxBudgetExceeded(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  true if a sprite from current layer must be dropped, as primitive
+ *  list is too close to its limit. false otherwise.
+ *
+ * **********************************************************************/
+static bool GfxBudgetExceeded(void)
+{
+	if ((GsListPos() + GfxBudgetReserve[budget_layer]) >= PRIMITIVE_LIST_SIZE)
+	{
+		budget_dropped++;
+		return true;
+	}
+
+	return false;
+}
+
+GFX_LAYER GfxSetLayer(const GFX_LAYER layer)
+{
+	const GFX_LAYER prevLayer = budget_layer;
+
+	if (layer != budget_layer)
+	{
+		GfxBudgetUpdate();
+		budget_layer = layer;
+	}
+
+	return prevLayer;
+}
+
+uint16_t GfxGetLayerUsage(const GFX_LAYER layer)
+{
+	return budget_last_usage[layer];
+}
+
+uint16_t GfxGetPrimitiveListUsage(void)
+{
+	return budget_last_total;
+}
+
+uint16_t GfxGetPrimitiveListPeak(void)
+{
+	return budget_peak;
+}
+
+uint16_t GfxGetPrimitiveListSize(void)
+{
+	return PRIMITIVE_LIST_SIZE;
+}
+
+uint16_t GfxGetDroppedSprites(void)
+{
+	return budget_last_dropped;
+}
+
+/* **********************************************************************
+ *
+ * @name: bool GfxStaticLayersPending(const void* const owner)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @param:
+ *  const void* const owner:
+ *      Any address identifying calling screen (e.g.: its VBlank handler).
+ *
+ * @brief:
+ *  Used by screens which only update some regions on each frame.
+ *  Static layers must be drawn for GFX_N_FRAMEBUFFERS frames so both
+ *  framebuffers contain them. After that, only regions which change
+ *  need to be drawn again, as framebuffer contents are kept.
+ *
+ * @return:
+ *  true if static layers must be drawn on current frame, false if
+ *  only dirty regions need to be drawn.
+ *
+ * @remarks:
+ *  Both framebuffers are considered invalid if another screen has
+ *  drawn a frame in between, and also while global luminance or
+ *  development menu are blended on top of the whole scene.
+ *
+ * **********************************************************************/
+bool GfxStaticLayersPending(const void* const owner)
+{
+	if (owner != static_owner)
+	{
+		static_owner = owner;
+		static_frames = GFX_N_FRAMEBUFFERS;
+	}
+
+	if (	(global_lum < NORMAL_LUMINANCE)
+				||
+		(SystemIsDevMenuEnabled())	)
+	{
+		static_frames = GFX_N_FRAMEBUFFERS;
+	}
+
+	static_queried = true;
+
+	return (static_frames != 0);
+}
+
+void GfxInvalidateStaticLayers(void)
+{
+	static_frames = GFX_N_FRAMEBUFFERS;
+}
+
+/* **********************************************************************
+ *
+ * @name: void GfxStaticLayersEndFrame(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Called once per drawn frame. Frames drawn without calling
+ *  GfxStaticLayersPending() overwrite static layers, so current
+ *  owner is dropped.
+ *
+ * **********************************************************************/
+static void GfxStaticLayersEndFrame(void)
+{
+	if (static_queried == false)
+	{
+		static_owner = NULL;
+	}
+	else if (static_frames != 0)
+	{
+		static_frames--;
+	}
+
+	static_queried = false;
+}
@@ -24,6 +24,30 @@
 #define FULL_LUMINANCE			0xFF
 #define ROTATE_BIT_SHIFT        12 // 4096 = 2^12
 #define BUTTON_SIZE				16
+#define GFX_OT_SIZE				256
+#define GFX_OT_BACKGROUND_Z		0
+#define GFX_OT_FIRST_OBJECT_Z	1
+#define GFX_OT_LAST_OBJECT_Z	(GFX_OT_SIZE - 2)
+#define GFX_OT_GUI_Z			(GFX_OT_SIZE - 1)
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+// Primitive list usage is accounted separately for each layer.
+// When primitive list is close to its limit, sprites from layers
+// with bigger reserves (see GfxBudgetReserve[]) are dropped first.
+typedef enum t_gfxLayer
+{
+	GFX_LAYER_OTHER,
+	GFX_LAYER_TERRAIN,
+	GFX_LAYER_BUILDINGS,
+	GFX_LAYER_AIRCRAFT,
+	GFX_LAYER_GUI,
+	GFX_LAYER_FONTS,
+
+	MAX_GFX_LAYERS
+}GFX_LAYER;
 
 /* *************************************
  * 	Global prototypes
@@ -70,6 +94,11 @@ bool GfxIsGPUBusy(void);
 // screen limits.
 void GfxSortSprite(GsSprite* spr);
 
+// Fast path for sprites which have already been checked against
+// screen limits, have no flashing flags and are not wider than
+// MAX_SIZE_FOR_GSSPRITE.
+void GfxSortSprite_Fast(GsSprite* spr);
+
 uint8_t GfxGetGlobalLuminance(void);
 
 void GfxSetGlobalLuminance(uint8_t value);
@@ -84,10 +113,13 @@ int GfxRotateFromDegrees(int deg);
 
 void GfxDrawButton(short x, short y, unsigned short btn);
 
-// Sends current display data on a specific VRAM section and fills
-// sprite structure pointed to by "spr".
+// Fills sprite structure pointed to by "spr" with current display data.
+// Displayed buffer is kept untouched until GfxReleaseDisplayData() is called.
 void GfxSaveDisplayData(GsSprite *spr);
 
+// Must be called once display data from GfxSaveDisplayData() is not used anymore.
+void GfxReleaseDisplayData(void);
+
 TYPE_CARTESIAN_POS GfxIsometricToCartesian(TYPE_ISOMETRIC_POS* ptrIsoPos);
 // Function overload for fixed-point 16.16 data type.
 
@@ -104,6 +136,13 @@ void GfxSetSplitScreen(uint8_t playerIndex);
 
 void GfxDisableSplitScreen(void);
 
+// Primitives sorted from now on are drawn into given VRAM area, where
+// screen position (x, y) is mapped to (vram_x, vram_y).
+void GfxOffscreenBegin(short x, short y, short w, short h, short vram_x, short vram_y);
+
+// Restores drawing area after GfxOffscreenBegin().
+void GfxOffscreenEnd(void);
+
 // Switches between true and false every 1 exact second (used for flashing effects)
 bool Gfx1HzFlash(void);
 
@@ -117,6 +156,45 @@ void GfxDevMenuEnable(void);
 short GfxGetDrawEnvWidth(void);
 short GfxGetDrawEnvHeight(void);
 
+// Starts an ordering table. Primitives sorted until GfxOTEnd() is called
+// are linked into depth buckets (see GfxOTSetZ()) instead of submission order.
+void GfxOTBegin(void);
+
+// Primitives sorted from now on are drawn after those with lower depth.
+void GfxOTSetZ(uint8_t z);
+
+// Links ordering table into primitive list. Primitives sorted later
+// are drawn after the whole ordering table.
+void GfxOTEnd(void);
+
+// Returns ordering table depth for an object placed on given isometric position.
+uint8_t GfxOTDepthFromIsometric(const TYPE_ISOMETRIC_POS* const ptrIsoPos);
+
+// Primitives sorted from now on are accounted to given layer. Returns previous layer.
+GFX_LAYER GfxSetLayer(const GFX_LAYER layer);
+
+// Primitive list words used by a layer on last frame.
+uint16_t GfxGetLayerUsage(const GFX_LAYER layer);
+
+// Primitive list words used on last frame.
+uint16_t GfxGetPrimitiveListUsage(void);
+
+// Highest number of primitive list words used on a single frame.
+uint16_t GfxGetPrimitiveListPeak(void);
+
+// Primitive list capacity, in words.
+uint16_t GfxGetPrimitiveListSize(void);
+
+// Sprites dropped on last frame because primitive list was close to its limit.
+uint16_t GfxGetDroppedSprites(void);
+
+// Returns true if static layers for a screen identified by owner must be
+// drawn on current frame. Otherwise, only regions which change are drawn.
+bool GfxStaticLayersPending(const void* const owner);
+
+// Forces static layers to be drawn again into both framebuffers.
+void GfxInvalidateStaticLayers(void);
+
 /* *************************************
  * 	Global variables
  * *************************************/
@@ -0,0 +1,76 @@
+#ifndef LEVEL_LIST_HEADER__
+#define LEVEL_LIST_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef enum t_levelId
+{
+	LEVEL1 = 0,
+	LEVEL2,
+	LEVEL3,
+	LEVEL4,
+	LEVEL5,
+
+	MAX_LEVELS
+}LEVEL_ID;
+
+/* *************************************
+ * 	Local variables
+ * *************************************/
+
+// Levels shown on main menu. Also replayed by
+// Source/Bench/Replay.c, so both are kept in sync.
+static const char* MainMenuLevelList[] =
+{
+	[LEVEL1] = "DATA\\LEVELS\\LEVEL1.LVL",
+	[LEVEL2] = "DATA\\LEVELS\\LEVEL2.LVL",
+	[LEVEL3] = "DATA\\LEVELS\\LEVEL3.LVL",
+	[LEVEL4] = "DATA\\LEVELS\\XAMI.LVL",
+	[LEVEL5] = "DATA\\LEVELS\\LEVEL18.LVL"
+};
+
+// NULL-terminated list of *.PLT files available for each level.
+static const char** MainMenuPltList[] =
+{
+	[LEVEL1] = (const char*[])
+	{
+		"DATA\\LEVELS\\TUTORIA1.PLT",
+		"DATA\\LEVELS\\LEVEL1.PLT",
+		"DATA\\LEVELS\\EASY.PLT",
+		NULL
+	},
+
+	[LEVEL2] = (const char*[])
+	{
+		"DATA\\LEVELS\\LEVEL2.PLT",
+		NULL
+	},
+
+	[LEVEL3] = (const char*[])
+	{
+		"DATA\\LEVELS\\LEVEL3.PLT",
+		NULL
+	},
+
+	[LEVEL4]  = (const char*[])
+	{
+		"DATA\\LEVELS\\XAMI.PLT",
+		NULL
+	},
+
+	[LEVEL5]  = (const char*[])
+	{
+		"DATA\\LEVELS\\LEVEL18.PLT",
+		NULL
+	}
+};
+
+#endif // LEVEL_LIST_HEADER__
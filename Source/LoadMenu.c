@@ -8,15 +8,34 @@
 #include "PltParser.h"
 #include "Font.h"
 #include "Sfx.h"
+#include "AssetCache.h"
+#include "EmuHook.h"
 
 /* **************************************
  *  Defines                             *
  * *************************************/
 
+#ifdef PSXSDK_DEBUG
+// Files measured individually on each loading screen.
+// Any other files are only included into totals.
+#define LOAD_MENU_MAX_STATS_FILES 48
+#endif // PSXSDK_DEBUG
+
 /* **************************************
  *  Structs and enums                   *
  * *************************************/
 
+#ifdef PSXSDK_DEBUG
+typedef struct t_loadMenuStats
+{
+    const char* strFile;
+    uint32_t bytes;
+    // All values below are RCnt1 ticks (see SystemGetHblankTicks()).
+    uint32_t ticks[MAX_LOAD_MENU_TIMES];
+    uint32_t totalTicks;
+}TYPE_LOAD_MENU_STATS;
+#endif // PSXSDK_DEBUG
+
 enum
 {
     SMALL_FONT_SIZE = 8,
@@ -43,6 +62,16 @@ enum
     LOADING_BAR_LUMINANCE_STEP = 10
 };
 
+enum
+{
+    LOADING_TEXT_X = LOADING_BAR_X,
+    LOADING_TEXT_Y = LOADING_BAR_Y + LOADING_BAR_HEIGHT + 8,
+
+    // Screen band containing loading bar, plane and file name.
+    LOADING_DIRTY_Y = LOADING_BAR_Y,
+    LOADING_DIRTY_H = LOADING_TEXT_Y + SMALL_FONT_SIZE - LOADING_BAR_Y
+};
+
 enum
 {
     LOADING_TITLE_CLUT_X = 384,
@@ -76,16 +105,26 @@ enum
 
 static void LoadMenuInit(void);
 static void ISR_LoadMenuVBlank(void);
+static void LoadMenuDirtyBgUpdate(void);
 static bool LoadMenuISRHasEnded(void);
 static bool LoadMenuISRHasStarted(void);
 static void LoadMenuLoadFileList(const char* const fileList[], void* const dest[],
                                     uint8_t szFileList, uint8_t szDestList);
+#ifdef PSXSDK_DEBUG
+static void LoadMenuStatsReset(void);
+static uint32_t LoadMenuStatsFileBegin(const char* const strFile);
+static void LoadMenuStatsFileEnd(const uint32_t startTicks);
+static uint32_t LoadMenuStatsParseTicks(const TYPE_LOAD_MENU_STATS* const ptrStats);
+static void LoadMenuStatsPrint(void);
+#endif // PSXSDK_DEBUG
 
 /* *************************************
  *  Local Variables
  * *************************************/
 
 static GsGPoly4 loadMenuBg;
+// Covers only LOADING_DIRTY_Y band from loadMenuBg.
+static GsGPoly4 loadMenuDirtyBg;
 static GsSprite LoadMenuPlaneSpr;
 static GsSprite LoadMenuTitleSpr;
 static GsLine LoadMenuBarLines[LOADING_BAR_N_LINES];
@@ -122,19 +161,33 @@ static volatile bool isr_ended;
 // so load menu does not have to be initialised each time;
 static bool load_menu_running;
 
+#ifdef PSXSDK_DEBUG
+// Load time breakdown from current (or last) loading screen.
+static TYPE_LOAD_MENU_STATS LoadMenuFileStats[LOAD_MENU_MAX_STATS_FILES];
+static TYPE_LOAD_MENU_STATS LoadMenuTotalStats;
+// Used for files beyond LOAD_MENU_MAX_STATS_FILES.
+static TYPE_LOAD_MENU_STATS LoadMenuOverflowStats;
+static uint8_t LoadMenuStatsFiles;
+// Files skipped because they were still resident.
+static uint8_t LoadMenuResidentFiles;
+// Stats for file being loaded, or NULL.
+static TYPE_LOAD_MENU_STATS* ptrLoadMenuCurrentStats;
+static uint32_t LoadMenuTimeStart[MAX_LOAD_MENU_TIMES];
+#endif // PSXSDK_DEBUG
+
 void LoadMenuInit(void)
 {
     int i;
-    static bool first_load = false;
 
-    if (first_load == false)
-    {
-        first_load = true;
-        LoadMenuLoadFileList(   LoadMenuFiles,
-                                LoadMenuDest,
-                                sizeof (LoadMenuFiles) / sizeof (char*),
-                                sizeof (LoadMenuDest)   / sizeof (void*));
-    }
+#ifdef PSXSDK_DEBUG
+    LoadMenuStatsReset();
+#endif // PSXSDK_DEBUG
+
+    // Files which are still resident are not loaded again.
+    LoadMenuLoadFileList(   LoadMenuFiles,
+                            LoadMenuDest,
+                            sizeof (LoadMenuFiles) / sizeof (char*),
+                            sizeof (LoadMenuDest)   / sizeof (void*));
 
     FontSetSize(&SmallFont, SMALL_FONT_SIZE);
     FontSetSpacing(&SmallFont, SMALL_FONT_SPACING);
@@ -145,6 +198,8 @@ void LoadMenuInit(void)
 
     LoadMenuPlaneSpr.x = PLANE_START_X;
     LoadMenuPlaneSpr.y = PLANE_START_Y;
+    LoadMenuPlaneSpr.w = PLANE_SIZE;
+    LoadMenuPlaneSpr.h = PLANE_SIZE;
 
     // "Loading..." title init
 
@@ -185,6 +240,16 @@ void LoadMenuInit(void)
         loadMenuBg.b[i] = 0;
     }
 
+    loadMenuDirtyBg.x[0] = 0;
+    loadMenuDirtyBg.x[1] = X_SCREEN_RESOLUTION;
+    loadMenuDirtyBg.x[2] = 0;
+    loadMenuDirtyBg.x[3] = X_SCREEN_RESOLUTION;
+
+    loadMenuDirtyBg.y[0] = LOADING_DIRTY_Y;
+    loadMenuDirtyBg.y[1] = LOADING_DIRTY_Y;
+    loadMenuDirtyBg.y[2] = LOADING_DIRTY_Y + LOADING_DIRTY_H;
+    loadMenuDirtyBg.y[3] = LOADING_DIRTY_Y + LOADING_DIRTY_H;
+
     // "Loading" bar line 0 (up left - up right)
 
     LoadMenuBarLines[0].x[0] = LOADING_BAR_X;
@@ -243,7 +308,8 @@ void LoadMenuInit(void)
     SmallFont.spr.g = 0;
     SmallFont.spr.b = 0;
 
-    GfxSetGlobalLuminance(0);
+    // Fade-in is done by ISR_LoadMenuVBlank() on each primitive.
+    GfxSetGlobalLuminance(NORMAL_LUMINANCE);
 
     SetVBlankHandler(&ISR_LoadMenuVBlank);
 }
@@ -260,6 +326,10 @@ void LoadMenuEnd(void)
     SetVBlankHandler(&ISR_SystemDefaultVBlank);
 
     GfxSetGlobalLuminance(NORMAL_LUMINANCE);
+
+#ifdef PSXSDK_DEBUG
+    LoadMenuStatsPrint();
+#endif // PSXSDK_DEBUG
 }
 
 void ISR_LoadMenuVBlank(void)
@@ -279,6 +349,9 @@ void ISR_LoadMenuVBlank(void)
 
     if (startup_flag)
     {
+        // All layers are being faded in.
+        GfxInvalidateStaticLayers();
+
         // "Loading..." text
         if (LoadMenuTitleSpr.r < LOADING_TITLE_LUMINANCE_TARGET)
         {
@@ -337,6 +410,8 @@ void ISR_LoadMenuVBlank(void)
     }
     else if (end_flag)
     {
+        GfxInvalidateStaticLayers();
+
         LoadMenuTitleSpr.r -= LOADING_TITLE_LUMINANCE_STEP;
         LoadMenuTitleSpr.g -= LOADING_TITLE_LUMINANCE_STEP;
         LoadMenuTitleSpr.b -= LOADING_TITLE_LUMINANCE_STEP;
@@ -395,7 +470,19 @@ void ISR_LoadMenuVBlank(void)
         }
     }
 
-    GsSortGPoly4(&loadMenuBg);
+    if (GfxStaticLayersPending(&ISR_LoadMenuVBlank))
+    {
+        GsSortGPoly4(&loadMenuBg);
+        GsSortSprite(&LoadMenuTitleSpr);
+
+        LoadMenuDirtyBgUpdate();
+    }
+    else
+    {
+        // Background and title are already on both framebuffers,
+        // so only the band where bar, plane and text are is cleared.
+        GsSortGPoly4(&loadMenuDirtyBg);
+    }
 
     GsSortRectangle(&LoadMenuBarRect);
 
@@ -404,23 +491,46 @@ void ISR_LoadMenuVBlank(void)
         GsSortLine(&LoadMenuBarLines[i]);
     }
 
-    GsSortSprite(&LoadMenuTitleSpr);
-
-    LoadMenuPlaneSpr.w = PLANE_SIZE;
-    LoadMenuPlaneSpr.h = PLANE_SIZE;
-
     GsSortSprite(&LoadMenuPlaneSpr);
 
     FontSetFlags(&SmallFont, FONT_BLEND_EFFECT);
 
     FontPrintText(  &SmallFont,
-                    LOADING_BAR_X,
-                    LOADING_BAR_Y + LOADING_BAR_HEIGHT + 8,
+                    LOADING_TEXT_X,
+                    LOADING_TEXT_Y,
                     strCurrentFile  );
 
     GfxDrawScene_Fast();
 }
 
+/* *******************************************************************
+ *
+ * @name: void LoadMenuDirtyBgUpdate(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Interpolates loadMenuBg vertical gradient so loadMenuDirtyBg
+ *  colours match background on LOADING_DIRTY_Y band.
+ *
+ * *******************************************************************/
+static void LoadMenuDirtyBgUpdate(void)
+{
+    uint8_t i;
+
+    for (i = 0; i < 4; i++)
+    {
+        // Upper vertices are 0 and 1, lower vertices are 2 and 3.
+        const uint8_t top = i & 1;
+        const uint8_t bottom = top + 2;
+        const int y = loadMenuDirtyBg.y[i];
+
+        loadMenuDirtyBg.r[i] = loadMenuBg.r[top] + (((loadMenuBg.r[bottom] - loadMenuBg.r[top]) * y) / Y_SCREEN_RESOLUTION);
+        loadMenuDirtyBg.g[i] = loadMenuBg.g[top] + (((loadMenuBg.g[bottom] - loadMenuBg.g[top]) * y) / Y_SCREEN_RESOLUTION);
+        loadMenuDirtyBg.b[i] = loadMenuBg.b[top] + (((loadMenuBg.b[bottom] - loadMenuBg.b[top]) * y) / Y_SCREEN_RESOLUTION);
+    }
+}
+
 bool LoadMenuISRHasEnded(void)
 {
     return isr_ended;
@@ -443,7 +553,11 @@ void LoadMenu(  const char* const fileList[],
         while (LoadMenuISRHasStarted() == false);
     }
 
+    EMU_HOOK(EMU_HOOK_LOAD_BEGIN, szFileList);
+
     LoadMenuLoadFileList(fileList, dest, szFileList, szDestList);
+
+    EMU_HOOK(EMU_HOOK_LOAD_END, szFileList);
 }
 
 void LoadMenuLoadFileList(  const char* const fileList[], void* const dest[],
@@ -462,6 +576,10 @@ void LoadMenuLoadFileList(  const char* const fileList[], void* const dest[],
 
     for (fileLoadedCount = 0; fileLoadedCount < szFileList ; fileLoadedCount++)
     {
+#ifdef PSXSDK_DEBUG
+        uint32_t startTicks;
+#endif // PSXSDK_DEBUG
+
         strCurrentFile = fileList[fileLoadedCount];
 
         if (strCurrentFile == NULL)
@@ -487,6 +605,22 @@ void LoadMenuLoadFileList(  const char* const fileList[], void* const dest[],
 
         Serial_printf("File extension: .%s\n", extension);
 
+        // PLT data is modified during gameplay, so it must be always parsed again.
+        if (    (strncmp(extension, "PLT", 3) != 0)
+                            &&
+                (AssetCacheIsResident(strCurrentFile, dest[fileLoadedCount]))   )
+        {
+            Serial_printf("File \"%s\" is already resident.\n", strCurrentFile);
+#ifdef PSXSDK_DEBUG
+            LoadMenuResidentFiles++;
+#endif // PSXSDK_DEBUG
+            continue;
+        }
+
+#ifdef PSXSDK_DEBUG
+        startTicks = LoadMenuStatsFileBegin(strCurrentFile);
+#endif // PSXSDK_DEBUG
+
         if (strncmp(extension, "TIM", 3) == 0)
         {
             if (GfxSpriteFromFile(strCurrentFile, dest[fileLoadedCount]) == false)
@@ -531,5 +665,211 @@ void LoadMenuLoadFileList(  const char* const fileList[], void* const dest[],
         {
             Serial_printf("LoadMenu does not recognize following extension: %s\n",extension);
         }
+
+#ifdef PSXSDK_DEBUG
+        LoadMenuStatsFileEnd(startTicks);
+#endif // PSXSDK_DEBUG
     }
 }
+
+#ifdef PSXSDK_DEBUG
+
+static void LoadMenuStatsReset(void)
+{
+    memset(LoadMenuFileStats, 0, sizeof (LoadMenuFileStats));
+    memset(&LoadMenuTotalStats, 0, sizeof (LoadMenuTotalStats));
+    LoadMenuStatsFiles = 0;
+    LoadMenuResidentFiles = 0;
+    ptrLoadMenuCurrentStats = NULL;
+}
+
+/* *******************************************************************
+ *
+ * @name: uint32_t LoadMenuStatsFileBegin(const char* const strFile)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Selects where times reported by LoadMenuTimeEnd() and
+ *  LoadMenuAddBytes() are stored, until LoadMenuStatsFileEnd().
+ *
+ * @return:
+ *  Current RCnt1 ticks, to be passed to LoadMenuStatsFileEnd().
+ *
+ * *******************************************************************/
+static uint32_t LoadMenuStatsFileBegin(const char* const strFile)
+{
+    if (LoadMenuStatsFiles < LOAD_MENU_MAX_STATS_FILES)
+    {
+        ptrLoadMenuCurrentStats = &LoadMenuFileStats[LoadMenuStatsFiles++];
+    }
+    else
+    {
+        ptrLoadMenuCurrentStats = &LoadMenuOverflowStats;
+        memset(ptrLoadMenuCurrentStats, 0, sizeof (TYPE_LOAD_MENU_STATS));
+    }
+
+    ptrLoadMenuCurrentStats->strFile = strFile;
+
+    return SystemGetHblankTicks();
+}
+
+static void LoadMenuStatsFileEnd(const uint32_t startTicks)
+{
+    TYPE_LOAD_MENU_STATS* const ptrStats = ptrLoadMenuCurrentStats;
+    uint8_t i;
+
+    ptrStats->totalTicks = SystemGetHblankTicks() - startTicks;
+
+    LoadMenuTotalStats.bytes += ptrStats->bytes;
+    LoadMenuTotalStats.totalTicks += ptrStats->totalTicks;
+
+    for (i = 0; i < MAX_LOAD_MENU_TIMES; i++)
+    {
+        LoadMenuTotalStats.ticks[i] += ptrStats->ticks[i];
+    }
+
+    ptrLoadMenuCurrentStats = NULL;
+}
+
+void LoadMenuTimeBegin(const LOAD_MENU_TIME time)
+{
+    if (ptrLoadMenuCurrentStats != NULL)
+    {
+        LoadMenuTimeStart[time] = SystemGetHblankTicks();
+    }
+}
+
+void LoadMenuTimeEnd(const LOAD_MENU_TIME time)
+{
+    if (ptrLoadMenuCurrentStats != NULL)
+    {
+        ptrLoadMenuCurrentStats->ticks[time] += SystemGetHblankTicks() - LoadMenuTimeStart[time];
+    }
+}
+
+void LoadMenuAddBytes(const uint32_t bytes)
+{
+    if (ptrLoadMenuCurrentStats != NULL)
+    {
+        ptrLoadMenuCurrentStats->bytes += bytes;
+    }
+}
+
+/* *******************************************************************
+ *
+ * @name: uint32_t LoadMenuStatsParseTicks(const TYPE_LOAD_MENU_STATS* const ptrStats)
+ *
+ * @return:
+ *  Time not spent on waits, CD-ROM access or uploads, i.e.: time spent
+ *  parsing file contents (TIM headers, PLT data, VRAM placement...).
+ *
+ * *******************************************************************/
+static uint32_t LoadMenuStatsParseTicks(const TYPE_LOAD_MENU_STATS* const ptrStats)
+{
+    uint32_t ticks = 0;
+    uint8_t i;
+
+    for (i = 0; i < MAX_LOAD_MENU_TIMES; i++)
+    {
+        ticks += ptrStats->ticks[i];
+    }
+
+    return (ptrStats->totalTicks > ticks) ? (ptrStats->totalTicks - ticks) : 0;
+}
+
+/* *******************************************************************
+ *
+ * @name: void LoadMenuStatsPrint(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Prints bytes and time spent on each file from last loading
+ *  screen, followed by totals, over serial port. Times are in us.
+ *
+ * *******************************************************************/
+static void LoadMenuStatsPrint(void)
+{
+    uint8_t i;
+
+    Serial_printf("Load time breakdown: %d files, %d resident (us)\n",
+                    LoadMenuStatsFiles,
+                    LoadMenuResidentFiles   );
+
+    Serial_printf("file;bytes;wait;seek;read;parse;upload;total\n");
+
+    for (i = 0; i <= LoadMenuStatsFiles; i++)
+    {
+        const TYPE_LOAD_MENU_STATS* const ptrStats = (i < LoadMenuStatsFiles) ? &LoadMenuFileStats[i] : &LoadMenuTotalStats;
+
+        Serial_printf(  "%s;%d;%d;%d;%d;%d;%d;%d\n",
+                        (i < LoadMenuStatsFiles) ? ptrStats->strFile : "TOTAL",
+                        ptrStats->bytes,
+                        SystemHblankTicksToUs(ptrStats->ticks[LOAD_MENU_TIME_WAIT]),
+                        SystemHblankTicksToUs(ptrStats->ticks[LOAD_MENU_TIME_SEEK]),
+                        SystemHblankTicksToUs(ptrStats->ticks[LOAD_MENU_TIME_READ]),
+                        SystemHblankTicksToUs(LoadMenuStatsParseTicks(ptrStats)),
+                        SystemHblankTicksToUs(ptrStats->ticks[LOAD_MENU_TIME_UPLOAD]),
+                        SystemHblankTicksToUs(ptrStats->totalTicks)   );
+    }
+}
+
+/* *******************************************************************
+ *
+ * @name: void LoadMenuDevMenu(short x, short y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Draws total times from last loading screen, in ms, as:
+ *  W: wait, S: seek, R: read, P: parse, U: upload. Below, number
+ *  of loaded files and the one which took longest.
+ *
+ * *******************************************************************/
+void LoadMenuDevMenu(short x, short y)
+{
+    enum
+    {
+        LOAD_MENU_DEV_MENU_ROW_H = 8
+    };
+
+    const TYPE_LOAD_MENU_STATS* ptrSlowest = NULL;
+    char strSlowest[16] = "-";
+    uint8_t i;
+
+    for (i = 0; i < LoadMenuStatsFiles; i++)
+    {
+        if ((ptrSlowest == NULL) || (LoadMenuFileStats[i].totalTicks > ptrSlowest->totalTicks))
+        {
+            ptrSlowest = &LoadMenuFileStats[i];
+        }
+    }
+
+    if (ptrSlowest != NULL)
+    {
+        SystemGetFileBasename(ptrSlowest->strFile, strSlowest, sizeof (strSlowest));
+    }
+
+    FontPrintText(  &SmallFont,
+                    x,
+                    y,
+                    "Load %dms W%d S%d R%d P%d U%d",
+                    SystemHblankTicksToUs(LoadMenuTotalStats.totalTicks) / 1000,
+                    SystemHblankTicksToUs(LoadMenuTotalStats.ticks[LOAD_MENU_TIME_WAIT]) / 1000,
+                    SystemHblankTicksToUs(LoadMenuTotalStats.ticks[LOAD_MENU_TIME_SEEK]) / 1000,
+                    SystemHblankTicksToUs(LoadMenuTotalStats.ticks[LOAD_MENU_TIME_READ]) / 1000,
+                    SystemHblankTicksToUs(LoadMenuStatsParseTicks(&LoadMenuTotalStats)) / 1000,
+                    SystemHblankTicksToUs(LoadMenuTotalStats.ticks[LOAD_MENU_TIME_UPLOAD]) / 1000  );
+
+    FontPrintText(  &SmallFont,
+                    x,
+                    y + LOAD_MENU_DEV_MENU_ROW_H,
+                    "%d files %dKB, max %s %dms",
+                    LoadMenuStatsFiles,
+                    LoadMenuTotalStats.bytes >> 10,
+                    strSlowest,
+                    (ptrSlowest != NULL) ? (SystemHblankTicksToUs(ptrSlowest->totalTicks) / 1000) : 0  );
+}
+
+#endif // PSXSDK_DEBUG
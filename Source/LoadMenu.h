@@ -14,6 +14,45 @@
 #define LOAD_FILES(x, y)    \
     LoadMenu(x, y, sizeof (x) / sizeof(x[0]), sizeof (y) / sizeof(y[0]))
 
+#ifdef PSXSDK_DEBUG
+
+#define LOAD_MENU_TIME_BEGIN(time)      LoadMenuTimeBegin(time)
+#define LOAD_MENU_TIME_END(time)        LoadMenuTimeEnd(time)
+#define LOAD_MENU_BYTES(bytes)          LoadMenuAddBytes(bytes)
+#define LOAD_MENU_DEV_MENU(x, y)        LoadMenuDevMenu(x, y)
+// Vertical space used by LoadMenuDevMenu().
+#define LOAD_MENU_DEV_MENU_H            16
+
+#else
+
+// Load time breakdown is compiled out on release builds.
+#define LOAD_MENU_TIME_BEGIN(time)
+#define LOAD_MENU_TIME_END(time)
+#define LOAD_MENU_BYTES(bytes)
+#define LOAD_MENU_DEV_MENU(x, y)
+#define LOAD_MENU_DEV_MENU_H            0
+
+#endif // PSXSDK_DEBUG
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+// Time spent by each file listed on LoadMenu(). Any time
+// not included here is accounted as parsing time.
+typedef enum t_loadMenuTime
+{
+	// Blocked on SystemIsBusy() or GfxIsGPUBusy().
+	LOAD_MENU_TIME_WAIT,
+	// Opening file and looking for its size.
+	LOAD_MENU_TIME_SEEK,
+	LOAD_MENU_TIME_READ,
+	// Transfers into VRAM or SPU RAM.
+	LOAD_MENU_TIME_UPLOAD,
+
+	MAX_LOAD_MENU_TIMES
+}LOAD_MENU_TIME;
+
 /* *************************************
  * 	Global prototypes
  * *************************************/
@@ -22,6 +61,20 @@ void LoadMenu(	const char*	const fileList[],
 				void* const dest[],
 				uint8_t szFileList	, uint8_t szDestList);
 
+// Prints load time breakdown if PSXSDK_DEBUG is defined.
 void LoadMenuEnd(void);
 
+#ifdef PSXSDK_DEBUG
+
+// Only files loaded by LoadMenu() are measured.
+// Other calls have no effect.
+void LoadMenuTimeBegin(const LOAD_MENU_TIME time);
+void LoadMenuTimeEnd(const LOAD_MENU_TIME time);
+void LoadMenuAddBytes(const uint32_t bytes);
+
+// Draws total times from last loading screen and its slowest file.
+void LoadMenuDevMenu(short x, short y);
+
+#endif // PSXSDK_DEBUG
+
 #endif //LOAD_MENU_HEADER__
@@ -0,0 +1,299 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Log.h"
+#include <stdarg.h>
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Must be a power of two.
+#define LOG_QUEUE_SIZE		16
+#define LOG_QUEUE_MASK		(LOG_QUEUE_SIZE - 1)
+#define LOG_MAX_ARGS		6
+#define LOG_STRING_SIZE		48
+#define LOG_LINE_SIZE		128
+#define LOG_SPEC_SIZE		16
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_logEntry
+{
+	const char* format;
+	// For %s conversions, offset inside strings[].
+	uint32_t args[LOG_MAX_ARGS];
+	char strings[LOG_STRING_SIZE];
+}TYPE_LOG_ENTRY;
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static const char* LogNextConversion(const char* format, char* const conversion);
+static size_t LogCopyLiteral(char* const line, size_t len, const size_t sz, const char* from, const char* const to);
+static void LogFormat(const TYPE_LOG_ENTRY* const ptrEntry, char* const line, const size_t sz);
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static TYPE_LOG_ENTRY LogQueue[LOG_QUEUE_SIZE];
+static uint8_t LogHead;
+static uint8_t LogTail;
+static uint16_t LogDropped;
+
+/* *******************************************************************************************
+ *
+ * @name: const char* LogNextConversion(const char* format, char* const conversion)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Looks for next conversion specification inside format.
+ *
+ * @return:
+ *  Pointer to the '%' character which starts it, or NULL if none is
+ *  found. Conversion character (e.g.: 'd', 's') is written into
+ *  conversion. "%%" is not considered a conversion.
+ *
+ * *******************************************************************************************/
+static const char* LogNextConversion(const char* format, char* const conversion)
+{
+	while ((format = strchr(format, '%')) != NULL)
+	{
+		const char* spec = format + 1;
+
+		// Skip flags, width, precision and length modifiers.
+		while ((*spec != '\0') && (strchr("-+ #0123456789.hl", *spec) != NULL))
+		{
+			spec++;
+		}
+
+		if (*spec == '\0')
+		{
+			return NULL;
+		}
+		else if (*spec == '%')
+		{
+			format = spec + 1;
+			continue;
+		}
+
+		*conversion = *spec;
+		return format;
+	}
+
+	return NULL;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void LogDeferred(const char* const format, ...)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Only argument values are stored here, so calling code is not
+ *  slowed down by string formatting and SIO access.
+ *
+ * @remarks:
+ *  Message is dropped if queue is full.
+ *
+ * *******************************************************************************************/
+void LogDeferred(const char* const format, ...)
+{
+	TYPE_LOG_ENTRY* ptrEntry;
+	const char* ptrFormat = format;
+	size_t stringsUsed = 0;
+	uint8_t nArgs = 0;
+	char conversion;
+	va_list ap;
+
+	if (((LogHead + 1) & LOG_QUEUE_MASK) == LogTail)
+	{
+		LogDropped++;
+		return;
+	}
+
+	ptrEntry = &LogQueue[LogHead];
+	ptrEntry->format = format;
+
+	va_start(ap, format);
+
+	while (	(nArgs < LOG_MAX_ARGS)
+				&&
+			((ptrFormat = LogNextConversion(ptrFormat, &conversion)) != NULL)	)
+	{
+		if (conversion == 's')
+		{
+			const char* const str = va_arg(ap, const char*);
+			const size_t available = LOG_STRING_SIZE - stringsUsed;
+			size_t len = strlen(str);
+
+			if (available == 0)
+			{
+				// Storage is full. Point to terminating character of last string.
+				ptrEntry->args[nArgs++] = LOG_STRING_SIZE - 1;
+				ptrFormat++;
+				continue;
+			}
+
+			if (len >= available)
+			{
+				len = available - 1;
+			}
+
+			memcpy(&ptrEntry->strings[stringsUsed], str, len);
+			ptrEntry->strings[stringsUsed + len] = '\0';
+
+			ptrEntry->args[nArgs++] = stringsUsed;
+			stringsUsed += len + 1;
+		}
+		else
+		{
+			ptrEntry->args[nArgs++] = va_arg(ap, unsigned int);
+		}
+
+		ptrFormat++;
+	}
+
+	va_end(ap);
+
+	LogHead = (LogHead + 1) & LOG_QUEUE_MASK;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: size_t LogCopyLiteral(char* const line, size_t len, const size_t sz, const char* from, const char* const to)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Appends text between from and to into line, replacing "%%" by '%'.
+ *
+ * @return:
+ *  New line length.
+ *
+ * *******************************************************************************************/
+static size_t LogCopyLiteral(char* const line, size_t len, const size_t sz, const char* from, const char* const to)
+{
+	while ((from < to) && (len < (sz - 1)))
+	{
+		if ((from[0] == '%') && (from[1] == '%'))
+		{
+			from++;
+		}
+
+		line[len++] = *from++;
+	}
+
+	line[len] = '\0';
+
+	return len;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void LogFormat(const TYPE_LOG_ENTRY* const ptrEntry, char* const line, const size_t sz)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Rebuilds message from a queued entry. Each conversion specification
+ *  is formatted on its own, so every argument is passed to snprintf()
+ *  with its actual type.
+ *
+ * *******************************************************************************************/
+static void LogFormat(const TYPE_LOG_ENTRY* const ptrEntry, char* const line, const size_t sz)
+{
+	const char* ptrFormat = ptrEntry->format;
+	const char* ptrSpec;
+	size_t len = 0;
+	uint8_t nArgs = 0;
+	char conversion;
+
+	line[0] = '\0';
+
+	while (	(len < (sz - 1))
+				&&
+			(nArgs < LOG_MAX_ARGS)
+				&&
+			((ptrSpec = LogNextConversion(ptrFormat, &conversion)) != NULL)	)
+	{
+		char spec[LOG_SPEC_SIZE];
+		const char* const ptrEnd = strchr(ptrSpec + 1, conversion) + 1;
+		size_t specLen = ptrEnd - ptrSpec;
+
+		len = LogCopyLiteral(line, len, sz, ptrFormat, ptrSpec);
+
+		if (specLen >= sizeof (spec))
+		{
+			specLen = sizeof (spec) - 1;
+		}
+
+		memcpy(spec, ptrSpec, specLen);
+		spec[specLen] = '\0';
+
+		if (conversion == 's')
+		{
+			len += snprintf(&line[len], sz - len, spec, &ptrEntry->strings[ptrEntry->args[nArgs]]);
+		}
+		else
+		{
+			len += snprintf(&line[len], sz - len, spec, (unsigned int)ptrEntry->args[nArgs]);
+		}
+
+		if (len >= sz)
+		{
+			// Output was truncated by snprintf().
+			return;
+		}
+
+		nArgs++;
+		ptrFormat = ptrEnd;
+	}
+
+	LogCopyLiteral(line, len, sz, ptrFormat, ptrFormat + strlen(ptrFormat));
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool LogFlush(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Formats and prints oldest queued message.
+ *
+ * @remarks:
+ *  Called from GfxDrawScene() while waiting for GPU or VBlank,
+ *  where CPU would be idle anyway.
+ *
+ * *******************************************************************************************/
+bool LogFlush(void)
+{
+	static char line[LOG_LINE_SIZE];
+
+	if (LogDropped != 0)
+	{
+		Serial_printf("%d log messages dropped\n", LogDropped);
+		LogDropped = 0;
+	}
+
+	if (LogTail == LogHead)
+	{
+		return false;
+	}
+
+	LogFormat(&LogQueue[LogTail], line, sizeof (line));
+
+	LogTail = (LogTail + 1) & LOG_QUEUE_MASK;
+
+	Serial_printf("%s", line);
+
+	return LogTail != LogHead;
+}
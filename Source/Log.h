@@ -0,0 +1,83 @@
+#ifndef LOG_HEADER__
+#define LOG_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define LOG_LEVEL_NONE		0
+#define LOG_LEVEL_ERROR		1
+#define LOG_LEVEL_WARNING	2
+#define LOG_LEVEL_INFO		3
+#define LOG_LEVEL_DEBUG		4
+
+// Threshold for modules which do not define LOG_MODULE_LEVEL.
+// Can be overridden from command line.
+#ifndef LOG_LEVEL_DEFAULT
+#ifdef PSXSDK_DEBUG
+#define LOG_LEVEL_DEFAULT	LOG_LEVEL_INFO
+#else
+#define LOG_LEVEL_DEFAULT	LOG_LEVEL_ERROR
+#endif // PSXSDK_DEBUG
+#endif // LOG_LEVEL_DEFAULT
+
+// Modules can set their own threshold by defining
+// LOG_MODULE_LEVEL before including this header, e.g.:
+//  #define LOG_MODULE_LEVEL LOG_LEVEL_WARNING
+//  #include "Log.h"
+// Hence, this header must only be included from *.c files.
+#ifndef LOG_MODULE_LEVEL
+#define LOG_MODULE_LEVEL	LOG_LEVEL_DEFAULT
+#endif // LOG_MODULE_LEVEL
+
+// Messages above threshold are removed by the preprocessor, so
+// neither the call nor its format string end up in the executable.
+// Errors are printed immediately, since they are rare and might
+// be followed by a crash. Any other message is only stored by
+// LogDeferred() and formatted later by LogFlush().
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(...)		Serial_printf(__VA_ARGS__)
+#else
+#define LOG_ERROR(...)		((void)0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_WARNING
+#define LOG_WARNING(...)	LogDeferred(__VA_ARGS__)
+#else
+#define LOG_WARNING(...)	((void)0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(...)		LogDeferred(__VA_ARGS__)
+#else
+#define LOG_INFO(...)		((void)0)
+#endif
+
+#if LOG_MODULE_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(...)		LogDeferred(__VA_ARGS__)
+#else
+#define LOG_DEBUG(...)		((void)0)
+#endif
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+// Stores format string pointer and raw arguments into a queue.
+// Format string must be a literal. Supported conversions are
+// those taking an int (%d, %u, %X, %c...) and %s. Strings are
+// copied, so they do not need to remain valid until LogFlush().
+void LogDeferred(const char* const format, ...);
+
+// Formats and prints one queued message, if any.
+// Returns true if more messages are pending.
+bool LogFlush(void);
+
+#endif // LOG_HEADER__
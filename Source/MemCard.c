@@ -4,6 +4,7 @@
 
 #include "MemCard.h"
 #include "System.h"
+#include "Vram.h"
 #include "Pad.h"
 #include "Font.h"
 
@@ -174,22 +175,9 @@ void MemCardInit(void)
 	}
 
 	bzero((TYPE_MEMCARD_ERRORS*)&MemCardErrors, sizeof (TYPE_MEMCARD_ERRORS) );
-}
-
-void ISR_MemCardDataHandling(void)
-{
 
-	uint8_t i;
-
-	if (	(GfxIsGPUBusy()) || (SystemIsBusy()) )
-	{
-		return;
-	}
-
-	// Dim background
-	SecondDisplay.r = NORMAL_LUMINANCE >> 1;
-	SecondDisplay.g = NORMAL_LUMINANCE >> 1;
-	SecondDisplay.b = NORMAL_LUMINANCE >> 1;
+	// Primitives drawn by ISR_MemCardDataHandling() never move,
+	// so they are only set up once.
 
 	MemCardRect.x[0] = MEMCARD_BG_X;
 	MemCardRect.x[1] = MEMCARD_BG_X + MEMCARD_BG_W;
@@ -257,20 +245,39 @@ void ISR_MemCardDataHandling(void)
 		MemCardProgressBarLines[i].b = NORMAL_LUMINANCE;
 	}
 
-	// Set progress bar attributes
+	// Progress bar attributes. Width is set by ISR_MemCardDataHandling().
 
 	MemCardProgressBar.x = MEMCARD_PROGRESS_BAR_X;
 	MemCardProgressBar.y = MEMCARD_PROGRESS_BAR_Y;
 
-	MemCardProgressBar.w = ProgressBarXOffset;
 	MemCardProgressBar.h = MEMCARD_PROGRESS_BAR_H;
 
 	MemCardProgressBar.r = MEMCARD_PROGRESS_BAR_R;
 	MemCardProgressBar.g = MEMCARD_PROGRESS_BAR_G;
 	MemCardProgressBar.b = MEMCARD_PROGRESS_BAR_B;
+}
+
+void ISR_MemCardDataHandling(void)
+{
+
+	uint8_t i;
+
+	if (	(GfxIsGPUBusy()) || (SystemIsBusy()) )
+	{
+		return;
+	}
 
-	GfxSortSprite(&SecondDisplay);
-	GsSortGPoly4(&MemCardRect);
+	MemCardProgressBar.w = ProgressBarXOffset;
+
+	if (GfxStaticLayersPending(&ISR_MemCardDataHandling))
+	{
+		GfxSortSprite(&SecondDisplay);
+		GsSortGPoly4(&MemCardRect);
+	}
+
+	// Progress bar only grows, and text is always drawn with the same
+	// glyphs on the same position, so both can be drawn on top of
+	// previous contents without clearing them.
 	GsSortRectangle(&MemCardProgressBar);
 
 	for (i = 0; i < MEMCARD_PROGRESS_BAR_N_LINES; i++)
@@ -598,6 +605,20 @@ bool MemCardUploadToGPU(TYPE_BLOCK_DATA * ptrBlockData)
 		return false;
 	}
 
+	// Icon and CLUT areas for all blocks and slots. Reserving
+	// them as a whole keeps the number of VRAM regions low.
+	VramReserve(	MEMCARD_BLOCK_IMAGE_X,
+					MEMCARD_BLOCK_IMAGE_Y,
+					(MEMCARD_BLOCK_IMAGE_W * MEMCARD_BLOCK_MAX_ICONS * MEMCARD_BLOCKS_PER_CARD) >> MEMCARD_BLOCK_IMAGE_W_BITSHIFT,
+					MEMCARD_BLOCK_IMAGE_H * MEMCARD_NUMBER_OF_SLOTS,
+					VRAM_OWNER_SYSTEM	);
+
+	VramReserve(	MEMCARD_BLOCK_CLUT_X,
+					MEMCARD_BLOCK_CLUT_Y,
+					MEMCARD_BLOCK_CLUT_W * MEMCARD_BLOCK_MAX_ICONS,
+					(MEMCARD_BLOCK_CLUT_H << 4) * MEMCARD_NUMBER_OF_SLOTS,
+					VRAM_OWNER_SYSTEM	);
+
 	for (i = 0; i < ptrBlockData->IconNumber; i++)
 	{
 		gs.pmode = COLORMODE_4BPP;
@@ -767,8 +788,16 @@ bool MemCardGetAllData(void)
 
 	GfxSaveDisplayData(&SecondDisplay);
 
+	// Dim background
+	SecondDisplay.r = NORMAL_LUMINANCE >> 1;
+	SecondDisplay.g = NORMAL_LUMINANCE >> 1;
+	SecondDisplay.b = NORMAL_LUMINANCE >> 1;
+
 	GfxSetGlobalLuminance(NORMAL_LUMINANCE);
 
+	// Progress bar starts from zero again.
+	GfxInvalidateStaticLayers();
+
 	// ISR_MemCardDataHandling draws a rectangle on top to show
 	// memory card loading progress.
 
@@ -794,6 +823,7 @@ bool MemCardGetAllData(void)
 			{
 				// Return to normal behaviour if anything fails
 				SetVBlankHandler(&ISR_SystemDefaultVBlank);
+				GfxReleaseDisplayData();
 				return false;
 			}
 
@@ -972,6 +1002,7 @@ TYPE_BLOCK_DATA * MemCardShowMap(void)
 		}
 		else if (PadOneKeyReleased(PAD_CROSS))
 		{
+			GfxReleaseDisplayData();
 			return &MemCardData[selectedBlock - BLOCK_1][selectedSlot];
 		}
 		else if (PadOneKeyReleased(PAD_LEFT))
@@ -1129,6 +1160,8 @@ TYPE_BLOCK_DATA * MemCardShowMap(void)
 		GfxDrawScene_Slow();
 	}
 
+	GfxReleaseDisplayData();
+
 	return NULL;
 }
 
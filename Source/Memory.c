@@ -0,0 +1,239 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Memory.h"
+
+#ifdef PSXSDK_DEBUG
+
+#include "System.h"
+#include "Font.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define MEMORY_MAX_TABLES	24
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_memoryTable
+{
+	const char* strModule;
+	const char* strName;
+	const void* ptr;
+	size_t sz;
+	// Highest number of bytes reported by MemoryUsage().
+	// Equals sz for tables which are never reported.
+	size_t peak;
+	bool usageReported;
+}TYPE_MEMORY_TABLE;
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static TYPE_MEMORY_TABLE* MemoryFindTable(const void* const ptr);
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static TYPE_MEMORY_TABLE MemoryTables[MEMORY_MAX_TABLES];
+static uint8_t MemoryTableCount;
+static size_t MemoryTotalBytes;
+
+/* *******************************************************************************************
+ *
+ * @name: TYPE_MEMORY_TABLE* MemoryFindTable(const void* const ptr)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Registered table starting at ptr, or NULL if not found.
+ *
+ * *******************************************************************************************/
+static TYPE_MEMORY_TABLE* MemoryFindTable(const void* const ptr)
+{
+	uint8_t i;
+
+	for (i = 0; i < MemoryTableCount; i++)
+	{
+		if (MemoryTables[i].ptr == ptr)
+		{
+			return &MemoryTables[i];
+		}
+	}
+
+	return NULL;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void MemoryRegister(const char* const strModule, const char* const strName, const void* const ptr, const size_t sz)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds a statically allocated table to the memory report.
+ *
+ * *******************************************************************************************/
+void MemoryRegister(const char* const strModule, const char* const strName, const void* const ptr, const size_t sz)
+{
+	TYPE_MEMORY_TABLE* ptrTable;
+
+	if (MemoryFindTable(ptr) != NULL)
+	{
+		return;
+	}
+
+	if (MemoryTableCount >= MEMORY_MAX_TABLES)
+	{
+		Serial_printf("MemoryRegister(): no room for %s.%s!\n", strModule, strName);
+		return;
+	}
+
+	ptrTable = &MemoryTables[MemoryTableCount++];
+
+	ptrTable->strModule = strModule;
+	ptrTable->strName = strName;
+	ptrTable->ptr = ptr;
+	ptrTable->sz = sz;
+	ptrTable->peak = sz;
+	ptrTable->usageReported = false;
+
+	MemoryTotalBytes += sz;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void MemoryUsage(const void* const ptr, const size_t used)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Updates peak usage for a registered table. Calls for
+ *  tables which have not been registered yet are ignored.
+ *
+ * *******************************************************************************************/
+void MemoryUsage(const void* const ptr, const size_t used)
+{
+	TYPE_MEMORY_TABLE* const ptrTable = MemoryFindTable(ptr);
+
+	if (ptrTable == NULL)
+	{
+		return;
+	}
+
+	if ((ptrTable->usageReported == false) || (used > ptrTable->peak))
+	{
+		ptrTable->peak = used;
+		ptrTable->usageReported = true;
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void MemoryDevMenu(short x, short y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Draws total size of registered tables and stack usage on a single line.
+ *
+ * *******************************************************************************************/
+void MemoryDevMenu(short x, short y)
+{
+	FontPrintText(	&SmallFont,
+					x,
+					y,
+					"Tables %dK stack %d/%d",
+					MemoryTotalBytes >> 10,
+					SystemGetStackHighWaterMark(),
+					SystemGetStackSize()	);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void MemoryDump(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Prints size and peak usage of each registered table over serial port,
+ *  followed by stack high-water mark. Use Source/MemoryReport for sizes
+ *  of all sections and symbols, taken from linker map file.
+ *
+ * *******************************************************************************************/
+void MemoryDump(void)
+{
+	uint8_t i;
+
+	Serial_printf("Registered tables (%d bytes):\n", MemoryTotalBytes);
+
+	for (i = 0; i < MemoryTableCount; i++)
+	{
+		const char* const strModule = MemoryTables[i].strModule;
+		size_t moduleBytes = 0;
+		uint8_t j;
+
+		// Print each module only once, on its first table.
+		for (j = 0; j < i; j++)
+		{
+			if (strcmp(MemoryTables[j].strModule, strModule) == 0)
+			{
+				break;
+			}
+		}
+
+		if (j != i)
+		{
+			continue;
+		}
+
+		for (j = i; j < MemoryTableCount; j++)
+		{
+			if (strcmp(MemoryTables[j].strModule, strModule) == 0)
+			{
+				moduleBytes += MemoryTables[j].sz;
+			}
+		}
+
+		Serial_printf("%s: %d bytes\n", strModule, moduleBytes);
+
+		for (j = i; j < MemoryTableCount; j++)
+		{
+			const TYPE_MEMORY_TABLE* const ptrTable = &MemoryTables[j];
+
+			if (strcmp(ptrTable->strModule, strModule) != 0)
+			{
+				continue;
+			}
+
+			if (ptrTable->usageReported != false)
+			{
+				Serial_printf(	"\t%s: %d bytes at 0x%08X, peak %d (%d%%)\n",
+								ptrTable->strName,
+								ptrTable->sz,
+								ptrTable->ptr,
+								ptrTable->peak,
+								ptrTable->sz != 0 ? (int)((ptrTable->peak * 100) / ptrTable->sz) : 0	);
+			}
+			else
+			{
+				Serial_printf(	"\t%s: %d bytes at 0x%08X\n",
+								ptrTable->strName,
+								ptrTable->sz,
+								ptrTable->ptr	);
+			}
+		}
+	}
+
+	Serial_printf(	"Stack: %d/%d bytes used (high-water mark)\n",
+					SystemGetStackHighWaterMark(),
+					SystemGetStackSize()	);
+}
+
+#endif // PSXSDK_DEBUG
@@ -0,0 +1,53 @@
+#ifndef MEMORY_HEADER__
+#define MEMORY_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#ifdef PSXSDK_DEBUG
+
+// Tables must be statically allocated arrays or structures,
+// so their size can be known from sizeof.
+#define MEMORY_REGISTER(module, table)	MemoryRegister(module, #table, &(table), sizeof (table))
+#define MEMORY_USAGE(table, used)		MemoryUsage(&(table), used)
+#define MEMORY_DEV_MENU(x, y)			MemoryDevMenu(x, y)
+
+#else
+
+// Memory counters are compiled out on release builds.
+#define MEMORY_REGISTER(module, table)
+#define MEMORY_USAGE(table, used)
+#define MEMORY_DEV_MENU(x, y)
+
+#endif // PSXSDK_DEBUG
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+#ifdef PSXSDK_DEBUG
+
+// Adds a table to the memory report. Registering the same
+// table again (e.g.: on each GameInit() call) has no effect.
+void MemoryRegister(const char* const strModule, const char* const strName, const void* const ptr, const size_t sz);
+
+// Updates peak number of bytes used from a registered table.
+void MemoryUsage(const void* const ptr, const size_t used);
+
+// Draws total size of registered tables and stack high-water mark.
+void MemoryDevMenu(short x, short y);
+
+// Prints size and peak usage of each registered table,
+// grouped by module, over serial port.
+void MemoryDump(void);
+
+#endif // PSXSDK_DEBUG
+
+#endif // MEMORY_HEADER__
@@ -0,0 +1,468 @@
+/* *************************************************************************
+ *
+ * MemoryReport: reads a map file written by GNU ld (-Wl,-Map=...) and
+ * prints how RAM is distributed across output sections, object files
+ * and the largest symbols, so the RAM budget can be checked before
+ * raising limits such as GAME_MAX_MAP_SIZE or GAME_MAX_AIRCRAFT.
+ *
+ * Build:
+ *  g++ -O2 -Wall -o MemoryReport main.cpp
+ *
+ * Usage:
+ *  MemoryReport airport.map [max symbols]
+ *
+ * Symbol sizes are not stored on map files, so they are calculated
+ * as the distance to the next symbol (or to the end of its input
+ * section). Static symbols are not listed by ld, so objects should
+ * be built with -fdata-sections: then each variable is placed on its
+ * own input section (e.g.: .bss.levelBuffer), whose name is used.
+ * Otherwise, size of static variables is accounted to the previous
+ * global symbol on the same input section.
+ *
+ * *************************************************************************/
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// PSX main RAM is mapped on KSEG0 from 0x80000000 to 0x80200000.
+// First 64 KiB are reserved for the kernel.
+static const uint64_t RAM_BEGIN = 0x80010000;
+static const uint64_t RAM_END = 0x80200000;
+// Must match BEGIN_STACK_ADDRESS and STACK_SIZE (see System.c).
+static const uint64_t STACK_BEGIN = 0x801FFF00;
+static const uint64_t STACK_SIZE = 24 << 10;
+
+enum Category
+{
+    CATEGORY_TEXT,
+    CATEGORY_RODATA,
+    CATEGORY_DATA,
+    CATEGORY_BSS,
+    CATEGORY_OTHER,
+
+    MAX_CATEGORIES
+};
+
+static const char* const CategoryNames[MAX_CATEGORIES] =
+{
+    "text",
+    "rodata",
+    "data",
+    "bss",
+    "other"
+};
+
+struct Section
+{
+    std::string name;
+    uint64_t address;
+    uint64_t size;
+};
+
+struct Symbol
+{
+    std::string name;
+    std::string object;
+    uint64_t address;
+    uint64_t size;
+    Category category;
+};
+
+struct ObjectUsage
+{
+    uint64_t bytes[MAX_CATEGORIES];
+};
+
+static Category GetCategory(const std::string& section)
+{
+    static const struct
+    {
+        const char* prefix;
+        Category category;
+    } prefixes[] =
+    {
+        {".text", CATEGORY_TEXT},
+        {".init", CATEGORY_TEXT},
+        {".fini", CATEGORY_TEXT},
+        {".rodata", CATEGORY_RODATA},
+        {".data", CATEGORY_DATA},
+        {".sdata", CATEGORY_DATA},
+        {".bss", CATEGORY_BSS},
+        {".sbss", CATEGORY_BSS},
+        {"COMMON", CATEGORY_BSS},
+        {".scommon", CATEGORY_BSS}
+    };
+
+    for (const auto& p : prefixes)
+    {
+        if (section.compare(0, strlen(p.prefix), p.prefix) == 0)
+        {
+            return p.category;
+        }
+    }
+
+    return CATEGORY_OTHER;
+}
+
+static bool ParseHex(const std::string& token, uint64_t& value)
+{
+    if (token.compare(0, 2, "0x") != 0)
+    {
+        return false;
+    }
+
+    char* end;
+
+    value = strtoull(token.c_str(), &end, 16);
+
+    return *end == '\0';
+}
+
+// Removes directories and CMake object directories, e.g.:
+// "CMakeFiles/airport.dir/Source/Game.c.obj" -> "Game.c.obj".
+static std::string ShortObjectName(const std::string& path)
+{
+    const size_t slash = path.find_last_of('/');
+
+    return slash == std::string::npos ? path : path.substr(slash + 1);
+}
+
+// Called when an input section ends. section holds input section
+// start and its variable name, if built with -fdata-sections.
+static void FinishSymbols(std::vector<Symbol>& pending, const Symbol& section, const uint64_t sectionEnd, std::vector<Symbol>& symbols)
+{
+    const bool found = std::any_of(pending.begin(), pending.end(),
+        [&](const Symbol& s) { return s.address == section.address; });
+
+    if (!found && !section.name.empty())
+    {
+        pending.push_back(section);
+    }
+
+    std::sort(pending.begin(), pending.end(),
+        [](const Symbol& a, const Symbol& b) { return a.address < b.address; });
+
+    for (size_t i = 0; i < pending.size(); i++)
+    {
+        const uint64_t next = (i + 1) < pending.size() ? pending[i + 1].address : sectionEnd;
+
+        pending[i].size = next > pending[i].address ? next - pending[i].address : 0;
+        symbols.push_back(pending[i]);
+    }
+
+    pending.clear();
+}
+
+int main(int argc, char* argv[])
+{
+    if ((argc != 2) && (argc != 3))
+    {
+        fprintf(stderr, "Usage: %s airport.map [max symbols]\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(argv[1]);
+
+    if (!input)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    const size_t maxSymbols = argc == 3 ? strtoul(argv[2], NULL, 0) : 30;
+    std::vector<Section> sections;
+    std::vector<Symbol> symbols;
+    std::vector<Symbol> pending;
+    std::map<std::string, ObjectUsage> objects;
+    std::string line;
+    std::string outputSection;
+    std::string inputSection;
+    std::string inputObject;
+    Symbol inputSymbol;
+    uint64_t inputEnd = 0;
+    uint64_t fill = 0;
+    bool memoryMap = false;
+
+    while (std::getline(input, line))
+    {
+        if (!line.empty() && (line.back() == '\r'))
+        {
+            line.pop_back();
+        }
+
+        if (!memoryMap)
+        {
+            memoryMap = line == "Linker script and memory map";
+            continue;
+        }
+
+        std::istringstream tokens(line);
+        std::vector<std::string> t;
+        std::string token;
+
+        while (tokens >> token)
+        {
+            t.push_back(token);
+        }
+
+        if (t.empty())
+        {
+            continue;
+        }
+
+        uint64_t address;
+        uint64_t size;
+
+        if ((line[0] != ' ') && (t[0][0] == '.'))
+        {
+            // Output section. Address and size are written on next
+            // line when section name is too long.
+            FinishSymbols(pending, inputSymbol, inputEnd, symbols);
+            outputSection = t[0];
+            inputSection.clear();
+            inputSymbol.name.clear();
+
+            if (t.size() == 1)
+            {
+                if (!std::getline(input, line))
+                {
+                    break;
+                }
+
+                std::istringstream next(line);
+
+                while (next >> token)
+                {
+                    t.push_back(token);
+                }
+            }
+
+            if (    (t.size() >= 3)
+                        &&
+                    ParseHex(t[1], address)
+                        &&
+                    ParseHex(t[2], size)
+                        &&
+                    (address != 0)  )
+            {
+                sections.push_back({outputSection, address, size});
+            }
+
+            continue;
+        }
+
+        if ((line[0] != ' ') || outputSection.empty())
+        {
+            // /DISCARD/, LOAD and OUTPUT commands...
+            continue;
+        }
+
+        if (t[0] == "*fill*")
+        {
+            if ((t.size() >= 3) && ParseHex(t[2], size))
+            {
+                fill += size;
+            }
+
+            continue;
+        }
+
+        if ((line[1] == '.') || (t[0] == "COMMON") || (t[0] == ".scommon"))
+        {
+            // Input section: name, address, size and object file.
+            // Name might be written on its own line if too long.
+            FinishSymbols(pending, inputSymbol, inputEnd, symbols);
+
+            inputSection = t[0];
+            inputSymbol.name.clear();
+
+            if (t.size() == 1)
+            {
+                if (!std::getline(input, line))
+                {
+                    break;
+                }
+
+                std::istringstream next(line);
+
+                while (next >> token)
+                {
+                    t.push_back(token);
+                }
+            }
+
+            if (    (t.size() >= 4)
+                        &&
+                    ParseHex(t[1], address)
+                        &&
+                    ParseHex(t[2], size)
+                        &&
+                    (address != 0)  )
+            {
+                // Object file names might contain spaces.
+                inputObject = t[3];
+
+                for (size_t i = 4; i < t.size(); i++)
+                {
+                    inputObject += " " + t[i];
+                }
+
+                inputObject = ShortObjectName(inputObject);
+                inputEnd = address + size;
+
+                // ".bss.levelBuffer" -> "levelBuffer". Merged strings and
+                // constants (e.g.: .rodata.str1.4) are not variables.
+                const Category category = GetCategory(outputSection);
+                const size_t dot = inputSection.find('.', 1);
+
+                if (    (dot != std::string::npos)
+                            &&
+                        (size != 0)
+                            &&
+                        ((category == CATEGORY_DATA) || (category == CATEGORY_BSS) || (category == CATEGORY_RODATA))
+                            &&
+                        (inputSection.compare(dot, 4, ".str") != 0)
+                            &&
+                        (inputSection.compare(dot, 4, ".cst") != 0) )
+                {
+                    std::string name = inputSection.substr(dot + 1);
+
+                    // Position-independent builds use .data.rel.ro.* and .data.rel.*.
+                    for (const char* const prefix : {"rel.ro.", "rel.local.", "rel."})
+                    {
+                        if (name.compare(0, strlen(prefix), prefix) == 0)
+                        {
+                            name.erase(0, strlen(prefix));
+                            break;
+                        }
+                    }
+
+                    inputSymbol = {name, inputObject, address, 0, category};
+                }
+                objects[inputObject].bytes[category] += size;
+            }
+            else
+            {
+                inputSection.clear();
+            }
+
+            continue;
+        }
+
+        if (    (t.size() == 2)
+                    &&
+                !inputSection.empty()
+                    &&
+                ParseHex(t[0], address)
+                    &&
+                (address < inputEnd)
+                    &&
+                (t[1].find('=') == std::string::npos)   )
+        {
+            // Global symbol inside current input section.
+            pending.push_back({t[1], inputObject, address, 0, GetCategory(outputSection)});
+        }
+    }
+
+    FinishSymbols(pending, inputSymbol, inputEnd, symbols);
+
+    if (sections.empty())
+    {
+        fprintf(stderr, "No sections found on %s. Is it a GNU ld map file?\n", argv[1]);
+        return 1;
+    }
+
+    uint64_t totals[MAX_CATEGORIES] = {0};
+    uint64_t imageEnd = 0;
+    uint64_t imageBytes = 0;
+
+    printf("Output sections:\n");
+
+    for (const Section& s : sections)
+    {
+        printf("  %-24s 0x%08" PRIx64 " %8" PRIu64 " bytes\n", s.name.c_str(), s.address, s.size);
+        totals[GetCategory(s.name)] += s.size;
+        imageBytes += s.size;
+        imageEnd = std::max(imageEnd, s.address + s.size);
+    }
+
+    printf("\nTotal: %" PRIu64 " bytes (", imageBytes);
+
+    for (int i = 0; i < MAX_CATEGORIES; i++)
+    {
+        printf("%s%s %" PRIu64, i ? ", " : "", CategoryNames[i], totals[i]);
+    }
+
+    printf("), %" PRIu64 " bytes of alignment padding\n", fill);
+
+    if ((sections.front().address >= RAM_BEGIN) && (imageEnd <= RAM_END))
+    {
+        const uint64_t stackEnd = STACK_BEGIN - STACK_SIZE;
+
+        printf( "Image ends at 0x%08" PRIx64 ". Free RAM until stack (0x%08" PRIx64 "): %" PRId64 " bytes\n",
+                imageEnd,
+                stackEnd,
+                (int64_t)stackEnd - (int64_t)imageEnd);
+    }
+
+    std::vector<std::pair<std::string, ObjectUsage>> sortedObjects(objects.begin(), objects.end());
+
+    auto objectTotal = [](const ObjectUsage& u)
+    {
+        uint64_t total = 0;
+
+        for (int i = 0; i < MAX_CATEGORIES; i++)
+        {
+            total += u.bytes[i];
+        }
+
+        return total;
+    };
+
+    std::sort(sortedObjects.begin(), sortedObjects.end(),
+        [&](const std::pair<std::string, ObjectUsage>& a, const std::pair<std::string, ObjectUsage>& b)
+        {
+            return objectTotal(a.second) > objectTotal(b.second);
+        });
+
+    printf("\n%-32s %8s %8s %8s %8s %8s %8s\n", "Object file", "text", "rodata", "data", "bss", "other", "total");
+
+    for (const auto& o : sortedObjects)
+    {
+        printf("%-32s", o.first.c_str());
+
+        for (int i = 0; i < MAX_CATEGORIES; i++)
+        {
+            printf(" %8" PRIu64, o.second.bytes[i]);
+        }
+
+        printf(" %8" PRIu64 "\n", objectTotal(o.second));
+    }
+
+    std::sort(symbols.begin(), symbols.end(),
+        [](const Symbol& a, const Symbol& b) { return a.size > b.size; });
+
+    printf("\nLargest symbols:\n");
+
+    for (size_t i = 0; (i < symbols.size()) && (i < maxSymbols); i++)
+    {
+        const Symbol& s = symbols[i];
+
+        printf( "  %-32s %-7s %8" PRIu64 " bytes  %s\n",
+                s.name.c_str(),
+                CategoryNames[s.category],
+                s.size,
+                s.object.c_str());
+    }
+
+    return 0;
+}
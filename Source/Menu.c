@@ -15,6 +15,10 @@
 #include "MemCard.h"
 #include "Serial.h"
 #include "Pad.h"
+#include "Vram.h"
+#include "Profiler.h"
+#include "Memory.h"
+#include "LevelList.h"
 
 /* **************************************
  *  Defines                             *
@@ -27,17 +31,6 @@
  *  Structs and enums                   *
  * *************************************/
 
-typedef enum t_levelId
-{
-    LEVEL1 = 0,
-    LEVEL2,
-    LEVEL3,
-    LEVEL4,
-    LEVEL5,
-
-    MAX_LEVELS
-}LEVEL_ID;
-
 typedef struct t_lvlpltdata
 {
     LEVEL_ID levelID;
@@ -122,6 +115,18 @@ typedef struct
 
 }TYPE_MMBtn;
 
+// Everything main menu screen depends on. Screen is only
+// drawn again when any of these change.
+typedef struct t_mainMenuState
+{
+    MainMenuLevel menuLevel;
+    LEVEL_ID SelectedLevel;
+    uint8_t SelectedPlt;
+    bool isLevelSelected;
+    bool padTwoConnected;
+    TYPE_MMBtn btn[MAIN_MENU_BUTTONS_MAX];
+}TYPE_MAIN_MENU_STATE;
+
 /* **************************************
  *  Local prototypes                    *
  * **************************************/
@@ -137,6 +142,7 @@ static void MainMenuButtonHandler(void);
 static void MainMenuRestoreInitValues(void);
 static void MenuTestCheat(void);
 static void MainMenuRenderLevelList(void);
+static bool MainMenuStateChanged(void);
 
 /* **************************************
  *  Local variables                     *
@@ -149,55 +155,15 @@ static TYPE_CHEAT TestCheat;
 static TYPE_CHEAT StackCheckCheat;
 static TYPE_CHEAT DevMenuCheat;
 static TYPE_CHEAT SerialCheat;
+#ifdef PSXSDK_DEBUG
+static TYPE_CHEAT ProfilerDumpCheat;
+static TYPE_CHEAT MemoryDumpCheat;
+#endif // PSXSDK_DEBUG
 static volatile bool BcnGWSpr_set;
 static LEVEL_ID SelectedLevel;
 static uint8_t SelectedPlt;
 static bool isLevelSelected;
 
-static const char* MainMenuLevelList[] =
-{
-    [LEVEL1] = "DATA\\LEVELS\\LEVEL1.LVL",
-    [LEVEL2] = "DATA\\LEVELS\\LEVEL2.LVL",
-    [LEVEL3] = "DATA\\LEVELS\\LEVEL3.LVL",
-    [LEVEL4] = "DATA\\LEVELS\\XAMI.LVL",
-    [LEVEL5] = "DATA\\LEVELS\\LEVEL18.LVL"
-};
-
-static const char** MainMenuPltList[] =
-{
-    [LEVEL1] = (const char*[])
-    {
-        "DATA\\LEVELS\\TUTORIA1.PLT",
-        "DATA\\LEVELS\\LEVEL1.PLT",
-        "DATA\\LEVELS\\EASY.PLT",
-        NULL
-    },
-
-    [LEVEL2] = (const char*[])
-    {
-        "DATA\\LEVELS\\LEVEL2.PLT",
-        NULL
-    },
-
-    [LEVEL3] = (const char*[])
-    {
-        "DATA\\LEVELS\\LEVEL3.PLT",
-        NULL
-    },
-
-    [LEVEL4]  = (const char*[])
-    {
-        "DATA\\LEVELS\\XAMI.PLT",
-        NULL
-    },
-
-    [LEVEL5]  = (const char*[])
-    {
-        "DATA\\LEVELS\\LEVEL18.PLT",
-        NULL
-    }
-};
-
 static TYPE_GAME_CONFIGURATION GameCfg;
 
 static TYPE_MMBtn MainMenuBtn[MAIN_MENU_BUTTONS_MAX];
@@ -255,36 +221,53 @@ static void MainMenuInit(void)
         "DATA\\SPRITES\\MAINMENU.TIM",
         "DATA\\SOUNDS\\BELL.VAG",
         "DATA\\SOUNDS\\ACCEPT.VAG",
-        "DATA\\SPRITES\\BUTTONS.TIM",
+        "DATA\\SPRITES\\BUTTONS.TIM"
+    };
+
+    static void* const MainMenuDest[] =
+    {
+        &MenuSpr,
+        &BellSnd,
+        &AcceptSnd,
+        &PSXButtons
+    };
+
 #ifndef NO_INTRO
+    static const char* const IntroFiles[] =
+    {
         "DATA\\SPRITES\\PSXDISK.TIM",
         "DATA\\FONTS\\INTROFNT.TIM",
         "DATA\\SPRITES\\GPL.TIM",
         "DATA\\SOUNDS\\TRAYCL.VAG",
         "DATA\\SOUNDS\\SPINDISK.VAG"
-#endif // NO_INTRO
     };
 
-    static void* const MainMenuDest[] =
+    static void* const IntroDest[] =
     {
-        &MenuSpr,
-        &BellSnd,
-        &AcceptSnd,
-        &PSXButtons,
-#ifndef NO_INTRO
         &PsxDisk,
         &PSXSDKIntroFont,
         &GPL_Logo,
         &TrayClSnd,
         &SpinDiskSnd
-#endif // NO_INTRO
     };
+#endif // NO_INTRO
+
+    VramSetOwner(VRAM_OWNER_MENU);
 
     LoadMenu(   MainMenuFiles,
                 MainMenuDest,
                 sizeof (MainMenuFiles) / sizeof (char*) ,
                 sizeof (MainMenuDest) / sizeof (void*) );
 
+#ifndef NO_INTRO
+    // Intro regions are released by MainMenu() once it has been played.
+    VramSetOwner(VRAM_OWNER_INTRO);
+
+    LOAD_FILES(IntroFiles, IntroDest);
+
+    VramSetOwner(VRAM_OWNER_MENU);
+#endif // NO_INTRO
+
     MainMenuBtn[PLAY_BUTTON_INDEX].offset_u = PLAY_BUTTON_U_OFFSET;
     MainMenuBtn[PLAY_BUTTON_INDEX].offset_v = PLAY_BUTTON_Y_OFFSET;
     MainMenuBtn[PLAY_BUTTON_INDEX].timer = 0;
@@ -374,6 +357,34 @@ static void MenuCheatInit(void)
             sizeof (unsigned short) * CHEAT_ARRAY_SIZE);
 
     PadAddCheat(&SerialCheat);
+
+#ifdef PSXSDK_DEBUG
+    ProfilerDumpCheat.Callback = &ProfilerDump;
+    memset(ProfilerDumpCheat.Combination, 0 , CHEAT_ARRAY_SIZE);
+
+    memmove( ProfilerDumpCheat.Combination,
+            (unsigned short[CHEAT_ARRAY_SIZE])
+            {   PAD_L2, PAD_R2, PAD_L2, PAD_R2,
+                PAD_SQUARE, PAD_SQUARE, 0 , 0 ,
+                0, 0, 0, 0,
+                0, 0, 0, 0  } ,
+            sizeof (unsigned short) * CHEAT_ARRAY_SIZE);
+
+    PadAddCheat(&ProfilerDumpCheat);
+
+    MemoryDumpCheat.Callback = &MemoryDump;
+    memset(MemoryDumpCheat.Combination, 0 , CHEAT_ARRAY_SIZE);
+
+    memmove( MemoryDumpCheat.Combination,
+            (unsigned short[CHEAT_ARRAY_SIZE])
+            {   PAD_L2, PAD_R2, PAD_L2, PAD_R2,
+                PAD_CIRCLE, PAD_CIRCLE, 0 , 0 ,
+                0, 0, 0, 0,
+                0, 0, 0, 0  } ,
+            sizeof (unsigned short) * CHEAT_ARRAY_SIZE);
+
+    PadAddCheat(&MemoryDumpCheat);
+#endif // PSXSDK_DEBUG
 }
 
 void MainMenu(void)
@@ -382,6 +393,10 @@ void MainMenu(void)
 
 #ifndef NO_INTRO
     PSXSDKIntro();
+
+    // Intro is only played once, so its textures
+    // can be replaced by game data from now on.
+    VramFreeOwner(VRAM_OWNER_INTRO);
 #endif //PSXSDK_DEBUG
 
     GfxSetGlobalLuminance(NORMAL_LUMINANCE);
@@ -399,26 +414,36 @@ void MainMenu(void)
 
         MainMenuButtonHandler();
 
-        GsSortCls(MAIN_MENU_BG_R, MAIN_MENU_BG_G, MAIN_MENU_BG_B);
+        if (MainMenuStateChanged())
+        {
+            GfxInvalidateStaticLayers();
+        }
 
-        switch(menuLevel)
+        // Both framebuffers are left untouched while
+        // there are no button animations or user input.
+        if (GfxStaticLayersPending(&MainMenuBtn))
         {
-            case PLAY_OPTIONS_LEVEL:
-                MainMenuDrawButton(&MainMenuBtn[PLAY_BUTTON_INDEX]);
-                MainMenuDrawButton(&MainMenuBtn[OPTIONS_BUTTON_INDEX]);
-            break;
-
-            case ONE_TWO_PLAYERS_LEVEL:
-                MainMenuDrawButton(&MainMenuBtn[ONE_PLAYER_BUTTON_INDEX]);
-                MainMenuDrawButton(&MainMenuBtn[TWO_PLAYER_BUTTON_INDEX]);
-            break;
-
-            case LEVEL_LIST_LEVEL:
-                MainMenuRenderLevelList();
-            break;
-
-            default:
-            break;
+            GsSortCls(MAIN_MENU_BG_R, MAIN_MENU_BG_G, MAIN_MENU_BG_B);
+
+            switch(menuLevel)
+            {
+                case PLAY_OPTIONS_LEVEL:
+                    MainMenuDrawButton(&MainMenuBtn[PLAY_BUTTON_INDEX]);
+                    MainMenuDrawButton(&MainMenuBtn[OPTIONS_BUTTON_INDEX]);
+                break;
+
+                case ONE_TWO_PLAYERS_LEVEL:
+                    MainMenuDrawButton(&MainMenuBtn[ONE_PLAYER_BUTTON_INDEX]);
+                    MainMenuDrawButton(&MainMenuBtn[TWO_PLAYER_BUTTON_INDEX]);
+                break;
+
+                case LEVEL_LIST_LEVEL:
+                    MainMenuRenderLevelList();
+                break;
+
+                default:
+                break;
+            }
         }
 
         GfxDrawScene_Slow();
@@ -581,6 +606,40 @@ static void MainMenuRenderLevelList(void)
     GsSortGPoly4(&levelListSelectionRect);
 }
 
+/* *******************************************************************
+ *
+ * @name: bool MainMenuStateChanged(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  true if anything drawn on main menu has changed since last call
+ *  (including button animations), false otherwise.
+ *
+ * *******************************************************************/
+static bool MainMenuStateChanged(void)
+{
+    static TYPE_MAIN_MENU_STATE prevState;
+    TYPE_MAIN_MENU_STATE state;
+    bool changed;
+
+    // Padding bytes must be also equal so memcmp() can be used.
+    memset(&state, 0, sizeof (state));
+
+    state.menuLevel = menuLevel;
+    state.SelectedLevel = SelectedLevel;
+    state.SelectedPlt = SelectedPlt;
+    state.isLevelSelected = isLevelSelected;
+    state.padTwoConnected = PadTwoConnected();
+    memcpy(state.btn, MainMenuBtn, sizeof (MainMenuBtn));
+
+    changed = (memcmp(&state, &prevState, sizeof (state)) != 0);
+
+    memcpy(&prevState, &state, sizeof (state));
+
+    return changed;
+}
+
 static void MainMenuRestoreInitValues(void)
 {
     uint8_t i;
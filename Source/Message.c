@@ -5,6 +5,7 @@
 #include "Message.h"
 #include "Gfx.h"
 #include "Pad.h"
+#include "Dialog.h"
 
 /* **************************************
  * 	Defines								*
@@ -21,6 +22,9 @@
  * 	Local prototypes					*
  * *************************************/
 
+static bool MessageDialogHandler(TYPE_DIALOG* const ptrDialog);
+static void MessageRender(const TYPE_DIALOG* const ptrDialog);
+
 /* **************************************
  * 	Local variables						*
  * *************************************/
@@ -28,10 +32,21 @@
 static TYPE_MESSAGE_DATA tMessageFIFO[MESSAGE_FIFO_SIZE];
 static uint8_t MessageIdx;
 
+// Simulation is halted until message is read.
+static TYPE_DIALOG MessageDialog =
+{
+	.Policy = DIALOG_POLICY_PAUSE,
+	.PadKeySinglePress_Callback = &PadOneKeySinglePress,
+	.Handler = &MessageDialogHandler,
+	.Render = &MessageRender
+};
+
 void MessageInit(void)
 {
 	bzero(tMessageFIFO, sizeof (tMessageFIFO));
 	MessageIdx = NO_MESSAGE;
+
+	DialogClose(&MessageDialog);
 }
 
 bool MessageCreate(TYPE_MESSAGE_DATA* ptrMessage)
@@ -81,99 +96,106 @@ void MessageHandler(void)
 				}
 			}
 		}
+
+		if (MessageIdx != NO_MESSAGE)
+		{
+			// Message is shown on top of the scene until closed.
+			DialogOpen(&MessageDialog);
+		}
 	}
 }
 
-void MessageRender(void)
+/* *******************************************************************
+ *
+ * @name: bool MessageDialogHandler(TYPE_DIALOG* const ptrDialog)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  false once player has pressed PAD_CROSS, so message is closed.
+ *
+ * *******************************************************************/
+static bool MessageDialogHandler(TYPE_DIALOG* const ptrDialog)
 {
-	if (MessageIdx != NO_MESSAGE)
+	if (ptrDialog->PadKeySinglePress_Callback(PAD_CROSS))
 	{
-		enum
-		{
-			MESSAGE_RECT_W = 256,
-			MESSAGE_RECT_H = 72,
-			MESSAGE_RECT_X = (X_SCREEN_RESOLUTION - MESSAGE_RECT_W) >> 1,
-			MESSAGE_RECT_Y = (Y_SCREEN_RESOLUTION - MESSAGE_RECT_H) >> 1,
-		};
-
-		GsGPoly4 messageRect = {	.x[0] = MESSAGE_RECT_X,
-									.x[1] = MESSAGE_RECT_X + MESSAGE_RECT_W,
-									.x[2] = messageRect.x[0],
-									.x[3] = messageRect.x[1],
-
-									.y[0] = MESSAGE_RECT_Y,
-									.y[1] = messageRect.y[0],
-									.y[2] = MESSAGE_RECT_Y + MESSAGE_RECT_H,
-									.y[3] = messageRect.y[2]	,
-
-									.r[0] = 0,
-									.r[1] = 0,
-									.r[2] = 0,
-									.r[3] = 0,
-
-									.g[0] = NORMAL_LUMINANCE,
-									.g[1] = NORMAL_LUMINANCE,
-									.g[2] = NORMAL_LUMINANCE >> 1,
-									.g[3] = NORMAL_LUMINANCE >> 1,
+		MessageIdx = NO_MESSAGE;
+		return false;
+	}
 
-									.b[0] = NORMAL_LUMINANCE >> 2,
-									.b[1] = NORMAL_LUMINANCE >> 2,
-									.b[2] = NORMAL_LUMINANCE >> 3,
-									.b[3] = NORMAL_LUMINANCE >> 3,
+	return true;
+}
 
-									.attribute = 0	};
+static void MessageRender(const TYPE_DIALOG* const ptrDialog)
+{
+	enum
+	{
+		MESSAGE_RECT_W = 256,
+		MESSAGE_RECT_H = 72,
+		MESSAGE_RECT_X = (X_SCREEN_RESOLUTION - MESSAGE_RECT_W) >> 1,
+		MESSAGE_RECT_Y = (Y_SCREEN_RESOLUTION - MESSAGE_RECT_H) >> 1,
+	};
+
+	GsGPoly4 messageRect = {	.x[0] = MESSAGE_RECT_X,
+								.x[1] = MESSAGE_RECT_X + MESSAGE_RECT_W,
+								.x[2] = messageRect.x[0],
+								.x[3] = messageRect.x[1],
+
+								.y[0] = MESSAGE_RECT_Y,
+								.y[1] = messageRect.y[0],
+								.y[2] = MESSAGE_RECT_Y + MESSAGE_RECT_H,
+								.y[3] = messageRect.y[2]	,
+
+								.r[0] = 0,
+								.r[1] = 0,
+								.r[2] = 0,
+								.r[3] = 0,
+
+								.g[0] = NORMAL_LUMINANCE,
+								.g[1] = NORMAL_LUMINANCE,
+								.g[2] = NORMAL_LUMINANCE >> 1,
+								.g[3] = NORMAL_LUMINANCE >> 1,
+
+								.b[0] = NORMAL_LUMINANCE >> 2,
+								.b[1] = NORMAL_LUMINANCE >> 2,
+								.b[2] = NORMAL_LUMINANCE >> 3,
+								.b[3] = NORMAL_LUMINANCE >> 3,
+
+								.attribute = 0	};
+
+	enum
+	{
+		MESSAGE_TEXT_X = MESSAGE_RECT_X + 8,
+		MESSAGE_TEXT_Y = MESSAGE_RECT_Y + 8,
 
-		GsSprite backgroundSpr = {0};
+		CONTINUE_TEXT_X = MESSAGE_TEXT_X,
+		CONTINUE_TEXT_Y = MESSAGE_RECT_Y + MESSAGE_RECT_H - 16,
+	};
 
-		GfxSaveDisplayData(&backgroundSpr);
+	char* strMessage = MessageGetString();
 
-		backgroundSpr.x = 0;
-		backgroundSpr.y = 0;
+	GsSortGPoly4(&messageRect);
 
-		do
+	if (strMessage != NULL)
+	{
+		enum
 		{
-			enum
-			{
-				MESSAGE_TEXT_X = MESSAGE_RECT_X + 8,
-				MESSAGE_TEXT_Y = MESSAGE_RECT_Y + 8,
-
-				CONTINUE_TEXT_X = MESSAGE_TEXT_X,
-				CONTINUE_TEXT_Y = MESSAGE_RECT_Y + MESSAGE_RECT_H - 16,
-			};
-
-			char* strMessage = MessageGetString();
-
-			GfxSortSprite(&backgroundSpr);
-
-			GsSortGPoly4(&messageRect);
-
-			if (strMessage != NULL)
-			{
-				enum
-				{
-					MAX_CH_PER_LINE = 32
-				};
-
-				FontSetFlags(&SmallFont, FONT_WRAP_LINE);
-				FontSetMaxCharPerLine(&SmallFont, MAX_CH_PER_LINE);
-
-				FontPrintText(&SmallFont, MESSAGE_TEXT_X, MESSAGE_TEXT_Y, strMessage);
-
-				// Restore default values
-				FontSetFlags(&SmallFont, FONT_NOFLAGS);
-				FontSetMaxCharPerLine(&SmallFont, 0);
-			}
+			MAX_CH_PER_LINE = 32
+		};
 
-			FontPrintText(&SmallFont, CONTINUE_TEXT_X, CONTINUE_TEXT_Y, "Press   to continue...");
+		FontSetFlags(&SmallFont, FONT_WRAP_LINE);
+		FontSetMaxCharPerLine(&SmallFont, MAX_CH_PER_LINE);
 
-			GfxDrawButton(CONTINUE_TEXT_X + (strlen("Press") << 3) - 4, CONTINUE_TEXT_Y - 4, PAD_CROSS);
+		FontPrintText(&SmallFont, MESSAGE_TEXT_X, MESSAGE_TEXT_Y, strMessage);
 
-			GfxDrawScene_Slow();
+		// Restore default values
+		FontSetFlags(&SmallFont, FONT_NOFLAGS);
+		FontSetMaxCharPerLine(&SmallFont, 0);
+	}
 
-		} while (PadOneKeySinglePress(PAD_CROSS) == false);
+	FontPrintText(&SmallFont, CONTINUE_TEXT_X, CONTINUE_TEXT_Y, "Press   to continue...");
 
-		MessageIdx = NO_MESSAGE;
-	}
+	GfxDrawButton(CONTINUE_TEXT_X + (strlen("Press") << 3) - 4, CONTINUE_TEXT_Y - 4, PAD_CROSS);
 }
 
 char* MessageGetString(void)
@@ -31,7 +31,6 @@ typedef struct t_messagedata
 void MessageInit(void);
 bool MessageCreate(TYPE_MESSAGE_DATA* ptrMessage);
 void MessageHandler(void);
-void MessageRender(void);
 char* MessageGetString(void);
 
 #endif // MESSAGE_HEADER__
@@ -4,6 +4,7 @@
 #include "Pad.h"
 #include "System.h"
 #include "Timer.h"
+#include "EmuHook.h"
 
 /* *************************************
  * 	Defines
@@ -341,6 +342,9 @@ bool UpdatePads(void)
         PSX_ReadPad(&pad1,&pad2);
     }
 
+    // Keys from emulator scripts, if any.
+    EMU_HOOK_PAD(&pad1);
+
 	if (PadOneConnected() == false)
 	{
 		both_pads_connected = false;
@@ -6,6 +6,7 @@
 #include "System.h"
 #include "Game.h"
 #include "Message.h"
+#include "Log.h"
 
 /* *************************************
  * 	Defines
@@ -13,11 +14,61 @@
 
 #define LINE_MAX_CHARACTERS MAX_MESSAGE_STR_SIZE
 #define MESSAGE_HEADER_STR	"MESSAGE"
+// Generated files are much smaller than System's file buffer:
+// each flight line takes less than 48 characters.
+#define GENERATED_FILE_MAX_SIZE	0x800
 
 /* **************************************
  * 	Structs and enums					*
  * *************************************/
 
+typedef enum t_pltLineType
+{
+	PLT_LINE_NONE = 0,
+	PLT_LINE_COMMENT,
+	PLT_LINE_START_TIME,
+	PLT_LINE_AIRCRAFT_DATA,
+	PLT_LINE_MESSAGE
+}PLT_LINE_TYPE;
+
+enum
+{
+	DEPARTURE_ARRIVAL_INDEX = 0,
+	FLIGHT_NUMBER_INDEX,
+	PASSENGERS_INDEX,
+	HOURS_MINUTES_INDEX,
+	PARKING_INDEX,
+	REMAINING_TIME_INDEX,
+
+	AIRCRAFT_DATA_FIELDS
+};
+
+enum
+{
+	MESSAGE_HEADER_INDEX = 0,
+	MESSAGE_TIMEOUT_INDEX,
+	MESSAGE_STR_INDEX,
+
+	MESSAGE_FIELDS
+};
+
+// Scanner state, so that no hidden tokenizer state (i.e.: strtok())
+// is shared with any other code.
+typedef struct t_pltScanner
+{
+	TYPE_FLIGHT_DATA* ptrFlightData;
+	TYPE_MESSAGE_DATA tMessage;
+	PLT_LINE_TYPE tLine;
+	uint16_t line;
+	uint16_t column;
+	uint16_t fieldColumn;
+	uint16_t fieldLength;
+	uint8_t fieldIndex;
+	uint8_t aircraftIndex;
+	bool first_line_read;
+	char field[LINE_MAX_CHARACTERS];
+}TYPE_PLT_SCANNER;
+
 /* *************************************
  * 	Local Variables
  * *************************************/
@@ -27,289 +78,633 @@
  * *************************************/
 
 static void PltParserResetBuffers(TYPE_FLIGHT_DATA* const ptrFlightData);
+static void PltParserStart(TYPE_PLT_SCANNER* const ptrScanner, TYPE_FLIGHT_DATA* const ptrFlightData);
+static bool PltParserFinish(TYPE_PLT_SCANNER* const ptrScanner, const char* const strName, bool success);
+static bool PltParserScanChar(TYPE_PLT_SCANNER* const ptrScanner, const char c);
+static bool PltParserEndField(TYPE_PLT_SCANNER* const ptrScanner);
+static bool PltParserEndLine(TYPE_PLT_SCANNER* const ptrScanner);
+static bool PltParserReadNumber(TYPE_PLT_SCANNER* const ptrScanner, const uint16_t max, uint16_t* const ptrValue);
+static bool PltParserReadTime(TYPE_PLT_SCANNER* const ptrScanner, uint8_t* const ptrHours, uint8_t* const ptrMinutes);
+static void PltParserError(const TYPE_PLT_SCANNER* const ptrScanner, const char* const strError);
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserLoadFile(const char* strPath, TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Fills ptrFlightData with flight schedule and messages from a PLT file.
+ *
+ * @remarks: file is read in CD_SECTOR_SIZE chunks and parsed character by
+ * 			character in a single pass, so file size is not limited by
+ * 			internal file buffer and no strtok() state is involved.
+ * 			Errors are reported along with line and column numbers.
+ *
+ * ********************************************************************************************/
 
 bool PltParserLoadFile(const char* strPath, TYPE_FLIGHT_DATA* const ptrFlightData)
 {
-	enum
+	// Kept out of the stack (see STACK_SIZE on System.c).
+	static uint8_t chunk[CD_SECTOR_SIZE];
+	TYPE_PLT_SCANNER scanner;
+	uint32_t nBytes;
+	uint32_t fileSize = 0;
+	uint32_t totalBytes = 0;
+	bool success = true;
+
+	if (SystemOpenFile(strPath, &fileSize) == false)
 	{
-		PLT_HOUR_MINUTE_CHARACTERS = 2,
-		PLT_FIRST_LINE_CHARACTERS = 5,
-		PLT_COLON_POSITION = 2
-	};
-
-	uint8_t i;
-	uint8_t j;
-	uint8_t aircraftIndex;
-	bool first_line_read = false;
-	char* buffer;
-	char lineBuffer[LINE_MAX_CHARACTERS];
-	char* lineBufferPtr;
-	char* pltBufferSavePtr;
-	char strHour[PLT_HOUR_MINUTE_CHARACTERS] = {'\0'};
-	char strMinutes[PLT_HOUR_MINUTE_CHARACTERS] = {'\0'};;
-	uint8_t* strPltBuffer;
-
-	if (SystemLoadFile(strPath) == false)
-	{
-		Serial_printf("Error loading file %s!\n",strPath);
+		LOG_ERROR("Error loading file %s!\n",strPath);
 		return false;
 	}
 
-	strPltBuffer = SystemGetBufferAddress();
+	PltParserStart(&scanner, ptrFlightData);
+
+	while ((success != false) && ((nBytes = SystemReadFileChunk(chunk, sizeof (chunk))) != 0))
+	{
+		uint32_t i;
+
+		totalBytes += nBytes;
+
+		for (i = 0; i < nBytes; i++)
+		{
+			if (PltParserScanChar(&scanner, (char)chunk[i]) == false)
+			{
+				success = false;
+				break;
+			}
+		}
+	}
+
+	SystemCloseFile();
 
+	if ((success != false) && (totalBytes != fileSize))
+	{
+		// Partial contents must not be parsed as a complete file.
+		LOG_ERROR("%s: read %d out of %d bytes!\n", strPath, (int)totalBytes, (int)fileSize);
+		success = false;
+	}
+
+	return PltParserFinish(&scanner, strPath, success);
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserLoadBuffer(const char* strBuffer, TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Fills ptrFlightData from null-terminated PLT data already
+ * 			available in memory (e.g.: from PltParserGenerateFile()).
+ *
+ * ********************************************************************************************/
+
+bool PltParserLoadBuffer(const char* strBuffer, TYPE_FLIGHT_DATA* const ptrFlightData)
+{
+	TYPE_PLT_SCANNER scanner;
+	bool success = true;
+
+	PltParserStart(&scanner, ptrFlightData);
+
+	for (; (success != false) && (*strBuffer != '\0'); strBuffer++)
+	{
+		success = PltParserScanChar(&scanner, *strBuffer);
+	}
+
+	return PltParserFinish(&scanner, "PLT buffer", success);
+}
+
+/* ********************************************************************************************
+ *
+ * @name	void PltParserStart(TYPE_PLT_SCANNER* const ptrScanner, TYPE_FLIGHT_DATA* const ptrFlightData)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Resets flight data and scanner state before parsing.
+ *
+ * ********************************************************************************************/
+
+static void PltParserStart(TYPE_PLT_SCANNER* const ptrScanner, TYPE_FLIGHT_DATA* const ptrFlightData)
+{
 	PltParserResetBuffers(ptrFlightData);
 
-	// Now, buffer shall be read from line to line
+	bzero(ptrScanner, sizeof (TYPE_PLT_SCANNER));
+
+	ptrScanner->ptrFlightData = ptrFlightData;
+	ptrScanner->line = 1;
+	ptrScanner->column = 1;
+	ptrScanner->fieldColumn = 1;
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserFinish(TYPE_PLT_SCANNER* const ptrScanner, const char* const strName, bool success)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Processes last line and sets total number of aircraft.
+ *
+ * @return:	false if any error was found while parsing, true otherwise.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserFinish(TYPE_PLT_SCANNER* const ptrScanner, const char* const strName, bool success)
+{
+	TYPE_FLIGHT_DATA* const ptrFlightData = ptrScanner->ptrFlightData;
 
-	buffer = strtok_r((char*)strPltBuffer,"\n",&pltBufferSavePtr);
+	if (success != false)
+	{
+		// Last line might not be terminated by a newline character.
+		success = PltParserEndLine(ptrScanner);
+	}
 
-	aircraftIndex = 0;
+	if (success == false)
+	{
+		LOG_ERROR("Could not parse %s.\n", strName);
+		return false;
+	}
 
-	while (buffer != NULL)
+	if (ptrScanner->first_line_read == false)
 	{
-		if (buffer[0] == '#')
+		LOG_ERROR("%s: initial time (HH:MM) was not found.\n", strName);
+		return false;
+	}
+
+	ptrFlightData->nAircraft = ptrScanner->aircraftIndex;	//Set total number of aircraft used
+	ptrFlightData->ActiveAircraft = 0;
+
+	LOG_INFO("Number of aircraft parsed: %d\n",ptrFlightData->nAircraft);
+
+	return true;
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserScanChar(TYPE_PLT_SCANNER* const ptrScanner, const char c)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Feeds one character into the scanner.
+ *
+ * @return:	false on syntax error, true otherwise.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserScanChar(TYPE_PLT_SCANNER* const ptrScanner, const char c)
+{
+	bool success = true;
+
+	switch (c)
+	{
+		case '\r':
+			// Ignore carriage return from DOS-style line endings.
+		return true;
+
+		case '\n':
+			success = PltParserEndLine(ptrScanner);
+
+			ptrScanner->line++;
+			ptrScanner->column = 1;
+			ptrScanner->fieldColumn = 1;
+		return success;
+
+		default:
+		break;
+	}
+
+	if (ptrScanner->tLine == PLT_LINE_NONE)
+	{
+		// First character of a new line.
+		if (c == '#')
 		{
-			// Comment line
-			buffer = strtok_r(NULL,"\n",&pltBufferSavePtr);
-			continue;
+			ptrScanner->tLine = PLT_LINE_COMMENT;
 		}
-
-		if (first_line_read == false)
+		else if (ptrScanner->first_line_read == false)
 		{
 			// First (non-comment) line should indicate level time
 			// i.e.: 10:30, or 22:45
-			first_line_read = true;
+			ptrScanner->tLine = PLT_LINE_START_TIME;
+		}
+		else
+		{
+			// Actual line type is known once first field has been read.
+			ptrScanner->tLine = PLT_LINE_AIRCRAFT_DATA;
+		}
+	}
+
+	if (ptrScanner->tLine == PLT_LINE_COMMENT)
+	{
+		// Skip everything until newline character.
+	}
+	else if ((c == ';')
+				&&
+			(	(ptrScanner->tLine != PLT_LINE_MESSAGE)
+						||
+				(ptrScanner->fieldIndex != MESSAGE_STR_INDEX)	)	)
+	{
+		// Message text is the last field, so it can contain ';' characters.
+		success = PltParserEndField(ptrScanner);
+
+		ptrScanner->fieldIndex++;
+		ptrScanner->fieldColumn = ptrScanner->column + 1;
+	}
+	else if (ptrScanner->fieldLength < (LINE_MAX_CHARACTERS - 1))
+	{
+		ptrScanner->field[ptrScanner->fieldLength++] = c;
+	}
+	else
+	{
+		PltParserError(ptrScanner, "field is too long");
+		success = false;
+	}
+
+	ptrScanner->column++;
+
+	return success;
+}
 
-			if (strlen(buffer) != PLT_FIRST_LINE_CHARACTERS)
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserEndField(TYPE_PLT_SCANNER* const ptrScanner)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Stores field data read by the scanner depending on line type
+ * 			and field index.
+ *
+ * @return:	false on syntax error, true otherwise.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserEndField(TYPE_PLT_SCANNER* const ptrScanner)
+{
+	TYPE_FLIGHT_DATA* const ptrFlightData = ptrScanner->ptrFlightData;
+	const uint8_t aircraftIndex = ptrScanner->aircraftIndex;
+	uint16_t value;
+
+	ptrScanner->field[ptrScanner->fieldLength] = '\0';
+
+	switch (ptrScanner->tLine)
+	{
+		case PLT_LINE_START_TIME:
+		{
+			uint8_t Hours;
+			uint8_t Minutes;
+
+			if (ptrScanner->fieldIndex != 0)
 			{
-                int k;
-
-                printf("Buffer: ");
-
-                for (k = 0; k < strlen(buffer); k++)
-                {
-                    printf("0x%02X ", buffer[k]);
-                }
-				// Format should always be HH:MM (5 characters)
-				// Treat any other combination as possible error
-                Serial_printf(  "Invalid first line length: %d, expected %d characters.\n",
-                                strlen(buffer),
-                                PLT_FIRST_LINE_CHARACTERS   );
+				PltParserError(ptrScanner, "unexpected field on initial time line");
 				return false;
 			}
 
-			if (buffer[PLT_COLON_POSITION] != ':')
+			if (PltParserReadTime(ptrScanner, &Hours, &Minutes) == false)
 			{
-				// Check whether time format is HH:MM
-                Serial_printf("Invalid hour/minute format: %s\n", buffer);
 				return false;
 			}
 
-			j = 0;
+			GameSetTime(Hours, Minutes);
+			ptrScanner->first_line_read = true;
+		}
+		break;
 
-			for (i = 0; i < PLT_FIRST_LINE_CHARACTERS ; i++)
+		case PLT_LINE_AIRCRAFT_DATA:
+			if ((ptrScanner->fieldIndex != DEPARTURE_ARRIVAL_INDEX)
+						&&
+				(aircraftIndex >= GAME_MAX_AIRCRAFT)	)
 			{
-				if (i == PLT_COLON_POSITION)
-				{
-					j = 0;
-					continue;
-				}
-				else if (i < PLT_COLON_POSITION)
-				{
-					strHour[j++] = buffer[i];
-				}
-				else
-				{
-					strMinutes[j++] = buffer[i];
-				}
+				PltParserError(ptrScanner, "too many aircraft");
+				return false;
 			}
 
-			GameSetTime((uint8_t)atoi(strHour),(uint8_t)atoi(strMinutes) );
-		}
-		else
-		{
-			enum
+			switch (ptrScanner->fieldIndex)
 			{
-				MESSAGE_INFO,
-				AIRCRAFT_DATA
-			} tLine = AIRCRAFT_DATA; // Default value
-			TYPE_MESSAGE_DATA tMessage = {0};
-
-			// File header (initial game time) has already been read
-			strncpy(lineBuffer, buffer, LINE_MAX_CHARACTERS);
-
-			lineBufferPtr = strtok(lineBuffer,";");
-
-			i = 0;
-
-			Serial_printf("New line read: %s\n",buffer);
-
-			while (lineBufferPtr != NULL)
-			{
-				switch(i)
-				{
-					enum
+				case DEPARTURE_ARRIVAL_INDEX:
+					if (strcmp(ptrScanner->field, "DEPARTURE") == 0)
 					{
-						DEPARTURE_ARRIVAL_INDEX = 0,
-						FLIGHT_NUMBER_INDEX,
-						PASSENGERS_INDEX,
-						HOURS_MINUTES_INDEX,
-						PARKING_INDEX,
-						REMAINING_TIME_INDEX
-					};
-
-					enum
-					{
-						MESSAGE_HEADER_INDEX = 0,
-						MESSAGE_TIMEOUT_INDEX,
-						MESSAGE_STR_INDEX
-					};
-
-					//case MESSAGE_HEADER_INDEX:
-						// Fall through
-					case DEPARTURE_ARRIVAL_INDEX:
-
-						if (strncmp(lineBufferPtr,"DEPARTURE",strlen("DEPARTURE") ) == 0)
+						if (aircraftIndex < GAME_MAX_AIRCRAFT)
 						{
 							ptrFlightData->FlightDirection[aircraftIndex] = DEPARTURE;
-							Serial_printf("Aircraft %d set to DEPARTURE.\n",aircraftIndex);
 						}
-						else if (strncmp(lineBufferPtr,"ARRIVAL",strlen("ARRIVAL") ) == 0)
+					}
+					else if (strcmp(ptrScanner->field, "ARRIVAL") == 0)
+					{
+						if (aircraftIndex < GAME_MAX_AIRCRAFT)
 						{
 							ptrFlightData->FlightDirection[aircraftIndex] = ARRIVAL;
-							Serial_printf("Aircraft %d set to ARRIVAL.\n",aircraftIndex);
 						}
-						else if (strncmp(lineBufferPtr, MESSAGE_HEADER_STR, strlen(MESSAGE_HEADER_STR) ) == 0)
-						{
-							tLine = MESSAGE_INFO;
-						}
-						else
-						{
-							Serial_printf("Flight direction is not correct!\n");
-						}
-					break;
+					}
+					else if (strcmp(ptrScanner->field, MESSAGE_HEADER_STR) == 0)
+					{
+						ptrScanner->tLine = PLT_LINE_MESSAGE;
+					}
+					else
+					{
+						PltParserError(ptrScanner, "flight direction is not correct");
+						return false;
+					}
+				break;
 
-					//case MESSAGE_TIMEOUT_INDEX:
-						// Fall through
-					case FLIGHT_NUMBER_INDEX:
+				case FLIGHT_NUMBER_INDEX:
+				{
+					size_t len = strlen(ptrScanner->field);
 
-						if (tLine == MESSAGE_INFO)
-						{
-							uint8_t Hours;
-							uint8_t Minutes;
+					// Longer flight numbers are truncated.
+					if (len > (GAME_MAX_CHARACTERS - 1))
+					{
+						len = GAME_MAX_CHARACTERS - 1;
+					}
 
-							if (	strlen(lineBufferPtr) != strlen("HH:MM") )
-							{
-								Serial_printf("Hour minute format is not correct! Read %s\n", lineBufferPtr);
-								break;
-							}
+					memcpy(ptrFlightData->strFlightNumber[aircraftIndex], ptrScanner->field, len);
+					ptrFlightData->strFlightNumber[aircraftIndex][len] = '\0';
+				}
+				break;
 
-							// Copy hour
-							strHour[0] = lineBufferPtr[0];
-							strHour[1] = lineBufferPtr[1];
-							// Copy minutes
-							strMinutes[0] = lineBufferPtr[3];
-							strMinutes[1] = lineBufferPtr[4];
+				case PASSENGERS_INDEX:
+					if (PltParserReadNumber(ptrScanner, UCHAR_MAX, &value) == false)
+					{
+						return false;
+					}
 
-							Hours = (uint8_t)atoi(strHour);
-							Minutes = (uint8_t)atoi(strMinutes);
+					ptrFlightData->Passengers[aircraftIndex] = value;
+				break;
 
-							tMessage.Timeout = (uint32_t)(Hours * 60) + Minutes;
+				case HOURS_MINUTES_INDEX:
+					if (PltParserReadTime(	ptrScanner,
+											&ptrFlightData->Hours[aircraftIndex],
+											&ptrFlightData->Minutes[aircraftIndex]	) == false)
+					{
+						return false;
+					}
+				break;
 
-							Serial_printf("Message timeout: %d seconds.\n", tMessage.Timeout);
-						}
-						else
-						{
-							strncpy(ptrFlightData->strFlightNumber[aircraftIndex],lineBufferPtr,GAME_MAX_CHARACTERS);
-							ptrFlightData->strFlightNumber[aircraftIndex][GAME_MAX_CHARACTERS - 1] = '\0';
-							Serial_printf("Aircraft %d flight number set to %s.\n",aircraftIndex,ptrFlightData->strFlightNumber[aircraftIndex]);
-						}
+				case PARKING_INDEX:
+					if (PltParserReadNumber(ptrScanner, UCHAR_MAX, &value) == false)
+					{
+						return false;
+					}
 
-					break;
+					if (ptrFlightData->FlightDirection[aircraftIndex] == DEPARTURE)
+					{
+						ptrFlightData->Parking[aircraftIndex] = value;
+					}
+					else
+					{
+						ptrFlightData->Parking[aircraftIndex] = 0;
+					}
+				break;
 
-					// case MESSAGE_STR_INDEX:
-						// Fall through
-					case PASSENGERS_INDEX:
-						if (tLine == MESSAGE_INFO)
-						{
-							strncpy(tMessage.strMessage, lineBufferPtr, MAX_MESSAGE_STR_SIZE);
-							MessageCreate(&tMessage);
+				case REMAINING_TIME_INDEX:
+					if (PltParserReadNumber(ptrScanner, USHRT_MAX, &value) == false)
+					{
+						return false;
+					}
 
-							bzero(&tMessage, sizeof (tMessage));
-						}
-						else
-						{
-							ptrFlightData->Passengers[aircraftIndex] = atoi(lineBufferPtr);
-							Serial_printf("Aircraft %d passengers set to %d.\n",aircraftIndex,ptrFlightData->Passengers[aircraftIndex]);
-						}
-					break;
+					ptrFlightData->RemainingTime[aircraftIndex] = value;
+				break;
 
-					case PARKING_INDEX:
-						if (ptrFlightData->FlightDirection[aircraftIndex] == DEPARTURE)
-						{
-							ptrFlightData->Parking[aircraftIndex] = atoi(lineBufferPtr);
-						}
-						else
-						{
-							ptrFlightData->Parking[aircraftIndex] = 0;
-						}
-						Serial_printf("Aircraft %d parking set to %d.\n",aircraftIndex,ptrFlightData->Parking[aircraftIndex]);
-					break;
+				default:
+					PltParserError(ptrScanner, "too many fields for aircraft data");
+				return false;
+			}
+		break;
 
-					case HOURS_MINUTES_INDEX:
-						if (	strlen(lineBufferPtr) != strlen("HH:MM") )
-						{
-							Serial_printf("Hour minute format is not correct!\n");
-							break;
-						}
+		case PLT_LINE_MESSAGE:
+			switch (ptrScanner->fieldIndex)
+			{
+				case MESSAGE_TIMEOUT_INDEX:
+				{
+					uint8_t Hours;
+					uint8_t Minutes;
 
-						// Copy hour
-						strHour[0] = lineBufferPtr[0];
-						strHour[1] = lineBufferPtr[1];
-						// Copy minutes
-						strMinutes[0] = lineBufferPtr[3];
-						strMinutes[1] = lineBufferPtr[4];
+					if (PltParserReadTime(ptrScanner, &Hours, &Minutes) == false)
+					{
+						return false;
+					}
 
-						ptrFlightData->Hours[aircraftIndex] = (uint8_t)atoi(strHour);
-						ptrFlightData->Minutes[aircraftIndex] = (uint8_t)atoi(strMinutes);
+					ptrScanner->tMessage.Timeout = (uint32_t)(Hours * 60) + Minutes;
+				}
+				break;
 
-						Serial_printf("Aircraft %d time set to %02d:%02d.\n",	aircraftIndex,
-																				ptrFlightData->Hours[aircraftIndex],
-																				ptrFlightData->Minutes[aircraftIndex]	);
-					break;
+				case MESSAGE_STR_INDEX:
+					memmove(ptrScanner->tMessage.strMessage, ptrScanner->field, ptrScanner->fieldLength + 1);
+				break;
 
-					case REMAINING_TIME_INDEX:
-						ptrFlightData->RemainingTime[aircraftIndex] = (uint16_t)atoi(lineBufferPtr);
-						Serial_printf("ptrFlightData->RemainingTime[%d] = %d\n", aircraftIndex, ptrFlightData->RemainingTime[aircraftIndex]);
-					break;
+				default:
+				break;
+			}
+		break;
 
+		case PLT_LINE_COMMENT:
+			// Fall through
+		case PLT_LINE_NONE:
+			// Fall through
+		default:
+		break;
+	}
 
-					default:
-					break;
-				}
+	ptrScanner->fieldLength = 0;
 
-				lineBufferPtr = strtok(NULL,";");
-				i++;
+	return true;
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserEndLine(TYPE_PLT_SCANNER* const ptrScanner)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Processes last field on current line and checks whether
+ * 			all expected fields have been read.
+ *
+ * @return:	false on syntax error, true otherwise.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserEndLine(TYPE_PLT_SCANNER* const ptrScanner)
+{
+	bool success = true;
+
+	switch (ptrScanner->tLine)
+	{
+		case PLT_LINE_START_TIME:
+			success = PltParserEndField(ptrScanner);
+		break;
+
+		case PLT_LINE_AIRCRAFT_DATA:
+			if ((success = PltParserEndField(ptrScanner)) == false)
+			{
+				break;
 			}
 
-			if (tLine == AIRCRAFT_DATA)
+			if (ptrScanner->tLine == PLT_LINE_MESSAGE)
 			{
-				ptrFlightData->State[aircraftIndex] = STATE_IDLE;
-				aircraftIndex++;
+				// Line consisted only of MESSAGE header.
+				PltParserError(ptrScanner, "message timeout and text are missing");
+				success = false;
 			}
+			else if (ptrScanner->fieldIndex != (AIRCRAFT_DATA_FIELDS - 1))
+			{
+				PltParserError(ptrScanner, "incomplete aircraft data");
+				success = false;
+			}
+			else
+			{
+				ptrScanner->ptrFlightData->State[ptrScanner->aircraftIndex] = STATE_IDLE;
+				ptrScanner->aircraftIndex++;
+			}
+		break;
+
+		case PLT_LINE_MESSAGE:
+			if ((success = PltParserEndField(ptrScanner)) == false)
+			{
+				break;
+			}
+
+			if (ptrScanner->fieldIndex != (MESSAGE_FIELDS - 1))
+			{
+				PltParserError(ptrScanner, "incomplete message data");
+				success = false;
+			}
+			else
+			{
+				MessageCreate(&ptrScanner->tMessage);
+				bzero(&ptrScanner->tMessage, sizeof (ptrScanner->tMessage));
+			}
+		break;
+
+		case PLT_LINE_COMMENT:
+			// Fall through
+		case PLT_LINE_NONE:
+			// Fall through
+		default:
+			// Empty lines are allowed.
+		break;
+	}
+
+	ptrScanner->tLine = PLT_LINE_NONE;
+	ptrScanner->fieldIndex = 0;
+	ptrScanner->fieldLength = 0;
+
+	return success;
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserReadNumber(TYPE_PLT_SCANNER* const ptrScanner, const uint16_t max, uint16_t* const ptrValue)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Converts current field into an unsigned integer not greater than max.
+ *
+ * @return:	false if field is empty or contains any non-digit character.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserReadNumber(TYPE_PLT_SCANNER* const ptrScanner, const uint16_t max, uint16_t* const ptrValue)
+{
+	uint32_t value = 0;
+	uint16_t i;
+
+	if (ptrScanner->fieldLength == 0)
+	{
+		PltParserError(ptrScanner, "empty numeric field");
+		return false;
+	}
+
+	for (i = 0; i < ptrScanner->fieldLength; i++)
+	{
+		const char c = ptrScanner->field[i];
+
+		if ((c < '0') || (c > '9'))
+		{
+			PltParserError(ptrScanner, "invalid number");
+			return false;
 		}
 
-		buffer = strtok_r(NULL,"\n",&pltBufferSavePtr);
+		value = (value * 10) + (c - '0');
+
+		if (value > max)
+		{
+			PltParserError(ptrScanner, "number is out of range");
+			return false;
+		}
 	}
 
-	ptrFlightData->nAircraft = aircraftIndex;	//Set total number of aircraft used
-	ptrFlightData->ActiveAircraft = 0;
+	*ptrValue = (uint16_t)value;
+
+	return true;
+}
+
+/* ********************************************************************************************
+ *
+ * @name	bool PltParserReadTime(TYPE_PLT_SCANNER* const ptrScanner, uint8_t* const ptrHours, uint8_t* const ptrMinutes)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Converts current field, expected as HH:MM, into hours and minutes.
+ *
+ * @return:	false on invalid format.
+ *
+ * ********************************************************************************************/
+
+static bool PltParserReadTime(TYPE_PLT_SCANNER* const ptrScanner, uint8_t* const ptrHours, uint8_t* const ptrMinutes)
+{
+	enum
+	{
+		PLT_TIME_CHARACTERS = 5,
+		PLT_COLON_POSITION = 2
+	};
 
-	Serial_printf("Number of aircraft parsed: %d\n",ptrFlightData->nAircraft);
+	const char* const str = ptrScanner->field;
+	uint8_t i;
+
+	if (ptrScanner->fieldLength != PLT_TIME_CHARACTERS)
+	{
+		PltParserError(ptrScanner, "hour/minute format must be HH:MM");
+		return false;
+	}
+
+	for (i = 0; i < PLT_TIME_CHARACTERS; i++)
+	{
+		if (i == PLT_COLON_POSITION)
+		{
+			if (str[i] != ':')
+			{
+				PltParserError(ptrScanner, "hour/minute format must be HH:MM");
+				return false;
+			}
+		}
+		else if ((str[i] < '0') || (str[i] > '9'))
+		{
+			PltParserError(ptrScanner, "invalid hour/minute digit");
+			return false;
+		}
+	}
+
+	*ptrHours = ((str[0] - '0') * 10) + (str[1] - '0');
+	*ptrMinutes = ((str[3] - '0') * 10) + (str[4] - '0');
 
 	return true;
 }
 
+/* ********************************************************************************************
+ *
+ * @name	void PltParserError(const TYPE_PLT_SCANNER* const ptrScanner, const char* const strError)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Reports a syntax error pointing to the first column of current field.
+ *
+ * ********************************************************************************************/
+
+static void PltParserError(const TYPE_PLT_SCANNER* const ptrScanner, const char* const strError)
+{
+	LOG_ERROR(	"PLT error at line %d, column %d: %s.\n",
+					ptrScanner->line,
+					ptrScanner->fieldColumn,
+					strError	);
+}
+
 void PltParserResetBuffers(TYPE_FLIGHT_DATA* const ptrFlightData)
 {
     bzero(ptrFlightData, sizeof (TYPE_FLIGHT_DATA));
@@ -331,6 +726,25 @@ void PltParserResetBuffers(TYPE_FLIGHT_DATA* const ptrFlightData)
 #endif
 }
 
+/* ********************************************************************************************
+ *
+ * @name	uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:	Writes a null-terminated PLT file into System's file buffer,
+ * 			which can then be loaded by PltParserLoadBuffer().
+ *
+ * @remarks: nAircraft, MinFlightInterval, MaxFlightInterval and
+ * 			RemainingTime are selected depending on difficulty level
+ * 			when set to 0. DeparturePercentage is always used as is,
+ * 			so 0 generates arrivals only. Setting ptrPltConfig->Seed
+ * 			makes output reproducible across runs.
+ *
+ * @return:	pointer to generated file, or NULL if ptrPltConfig is not valid.
+ *
+ * ********************************************************************************************/
+
 uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig)
 {
 	enum
@@ -353,6 +767,24 @@ uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig)
 		MAX_AIRCRAFT_HARD = GAME_MAX_AIRCRAFT,
 	};
 
+	enum
+	{
+		REMAINING_TIME_EASY = 400,
+		REMAINING_TIME_MEDIUM = 300,
+		REMAINING_TIME_HARD = 200
+	};
+
+	enum
+	{
+		MIN_PASSENGERS = 50,
+		MAX_PASSENGERS = 250,
+		MIN_FLIGHT_NUMBER = 1000,
+		MAX_FLIGHT_NUMBER = 9999 - (GAME_MAX_AIRCRAFT * 10),
+		MAX_FLIGHT_NUMBER_STEP = 10,
+		// Highest value accepted by PltParserReadTime().
+		MAX_FLIGHT_TIME = (99 * 60) + 59
+	};
+
 	typedef enum t_Hour
 	{
 		MIN_HOUR = 0,
@@ -365,15 +797,15 @@ uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig)
 		MAX_MINUTE = 59
 	}TYPE_MINUTE;
 
-	uint8_t* PltBuffer = SystemGetBufferAddress();
+	char* const PltBuffer = (char*)SystemGetBufferAddress();
 	uint8_t minAircraftTime;
 	uint8_t maxAircraftTime;
 	uint8_t nAircraft;
-	uint8_t i;
+	uint16_t remainingTime;
+	uint16_t flightTime = 0;
+	uint16_t flightNumber;
+	size_t len;
 	uint8_t j;
-	TYPE_HOUR InitialHour;
-	TYPE_MINUTE InitialMinutes;
-	char auxBuffer[32] = {'\0'};
 
 	switch(ptrPltConfig->Level)
 	{
@@ -381,71 +813,147 @@ uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig)
 			minAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MIN_SECONDS_EASY;
 			maxAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MAX_SECONDS_EASY;
 			nAircraft = SystemRand(MIN_AIRCRAFT_EASY, MAX_AIRCRAFT_EASY);
+			remainingTime = REMAINING_TIME_EASY;
 		break;
 
 		case LEVEL_DIFFICULTY_MEDIUM:
 			minAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MIN_SECONDS_MEDIUM;
 			maxAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MAX_SECONDS_MEDIUM;
 			nAircraft = SystemRand(MIN_AIRCRAFT_MEDIUM, MAX_AIRCRAFT_MEDIUM);
+			remainingTime = REMAINING_TIME_MEDIUM;
 		break;
 
 		case LEVEL_DIFFICULTY_HARD:
 			minAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MIN_SECONDS_HARD;
 			maxAircraftTime = MIN_AIRCRAFT_TIMELAPSE_MAX_SECONDS_HARD;
 			nAircraft = SystemRand(MIN_AIRCRAFT_HARD, MAX_AIRCRAFT_HARD);
+			remainingTime = REMAINING_TIME_HARD;
 		break;
 
 		default:
-			Serial_printf("PltParserGenerateFile(): Undefined level!\n");
+			LOG_ERROR("PltParserGenerateFile(): Undefined level!\n");
 		return NULL;
 	}
 
-#ifndef PSXSDK_DEBUG
-#	pragma message ("Remember to remove this")
-	printf("%d\n", minAircraftTime);
-	printf("%d\n", maxAircraftTime);
-#endif // PSXSDK_DEBUG
+	if (ptrPltConfig->Seed != 0)
+	{
+		srand(ptrPltConfig->Seed);
+	}
 
-	SystemClearFileBuffer();
+	if (ptrPltConfig->nAircraft != 0)
+	{
+		nAircraft = ptrPltConfig->nAircraft;
+	}
 
-	// At this point, PltBuffer is filled with zeros. Start generating PLT file.
+	if (ptrPltConfig->MinFlightInterval != 0)
+	{
+		minAircraftTime = ptrPltConfig->MinFlightInterval;
+	}
 
-	InitialHour = SystemRand(MIN_HOUR, MAX_HOUR);
+	if (ptrPltConfig->MaxFlightInterval != 0)
+	{
+		maxAircraftTime = ptrPltConfig->MaxFlightInterval;
+	}
 
-	InitialMinutes = SystemRand(MIN_MINUTE, MAX_MINUTE);
+	if (ptrPltConfig->RemainingTime != 0)
+	{
+		remainingTime = ptrPltConfig->RemainingTime;
+	}
 
-	snprintf(auxBuffer, 32, "%d:%d\n", InitialHour, InitialMinutes);
+	if (nAircraft > GAME_MAX_AIRCRAFT)
+	{
+		LOG_ERROR("PltParserGenerateFile(): too many aircraft (%d). Maximum: %d\n", nAircraft, GAME_MAX_AIRCRAFT);
+		return NULL;
+	}
 
-	for (i = 0; auxBuffer[i] != '\0'; i++)
+	if (minAircraftTime > maxAircraftTime)
 	{
-		// Transfer contents generated from snprintf to main buffer.
-		PltBuffer[i] = auxBuffer[i];
+		LOG_ERROR("PltParserGenerateFile(): invalid flight interval (%d-%d)\n", minAircraftTime, maxAircraftTime);
+		return NULL;
 	}
 
-	Serial_printf("%s\n", PltBuffer);
-	DEBUG_PRINT_VAR(ptrPltConfig->Level);
-	DEBUG_PRINT_VAR(nAircraft);
-	DEBUG_PRINT_VAR(minAircraftTime);
-	DEBUG_PRINT_VAR(maxAircraftTime);
+	if (ptrPltConfig->DeparturePercentage > 100)
+	{
+		LOG_ERROR("PltParserGenerateFile(): invalid departure percentage %d\n", ptrPltConfig->DeparturePercentage);
+		return NULL;
+	}
 
-	for (j = 0; j < nAircraft; j++)
+	if (	(ptrPltConfig->DeparturePercentage != 0)
+				&&
+			(	(ptrPltConfig->nParking == 0)
+					||
+				(ptrPltConfig->nParking > GAME_MAX_PARKING)	)	)
 	{
-		uint8_t dep_arr_rand = SystemRand(0,100);
+		LOG_ERROR("PltParserGenerateFile(): departures need 1-%d parking tiles\n", GAME_MAX_PARKING);
+		return NULL;
+	}
 
-		if (dep_arr_rand < 50)
-		{
-			// Set departure flight
+	SystemClearFileBuffer();
+
+	// At this point, PltBuffer is filled with zeros. Start generating PLT file.
 
-			memmove(&PltBuffer[i], "DEPARTURE", sizeof ("DEPARTURE") * sizeof (uint8_t) );
-			i += strlen("DEPARTURE");
+	len = snprintf(	PltBuffer,
+					GENERATED_FILE_MAX_SIZE,
+					"#Generated by PltParserGenerateFile()\n%02d:%02d\n",
+					(TYPE_HOUR)SystemRand(MIN_HOUR, MAX_HOUR),
+					(TYPE_MINUTE)SystemRand(MIN_MINUTE, MAX_MINUTE)	);
+
+	flightNumber = SystemRand(MIN_FLIGHT_NUMBER, MAX_FLIGHT_NUMBER);
+
+	for (j = 0; (j < nAircraft) && (len < GENERATED_FILE_MAX_SIZE); j++)
+	{
+		// 0-99, so 100% always means departure and 0% never does.
+		const bool departure = SystemRand(0, 99) < ptrPltConfig->DeparturePercentage;
+		uint8_t parking = 0;
+
+		flightTime += SystemRand(minAircraftTime, maxAircraftTime);
+
+		if (flightTime > MAX_FLIGHT_TIME)
+		{
+			flightTime = MAX_FLIGHT_TIME;
 		}
-		else
+
+		flightNumber += SystemRand(1, MAX_FLIGHT_NUMBER_STEP);
+
+		if (departure != false)
 		{
-			// Set arrival flight
-			memmove(&PltBuffer[i], "ARRIVAL", sizeof ("ARRIVAL") * sizeof (uint8_t) );
-			i += strlen("ARRIVAL");
+			switch (ptrPltConfig->ParkingDistribution)
+			{
+				case PLT_PARKING_RANDOM:
+					parking = ptrPltConfig->ParkingArray[SystemRand(0, ptrPltConfig->nParking - 1)];
+				break;
+
+				case PLT_PARKING_SINGLE:
+					parking = ptrPltConfig->ParkingArray[0];
+				break;
+
+				case PLT_PARKING_ROUND_ROBIN:
+					// Fall through
+				default:
+					parking = ptrPltConfig->ParkingArray[j % ptrPltConfig->nParking];
+				break;
+			}
 		}
+
+		len += snprintf(&PltBuffer[len],
+						GENERATED_FILE_MAX_SIZE - len,
+						"%s;PHX%d;%d;%02d:%02d;%d;%d\n",
+						departure? "DEPARTURE" : "ARRIVAL",
+						flightNumber,
+						(int)SystemRand(MIN_PASSENGERS, MAX_PASSENGERS),
+						flightTime / 60,
+						flightTime % 60,
+						parking,
+						remainingTime	);
+	}
+
+	if (len >= GENERATED_FILE_MAX_SIZE)
+	{
+		LOG_ERROR("PltParserGenerateFile(): output was truncated!\n");
+		return NULL;
 	}
 
-	return PltBuffer;
+	LOG_DEBUG("Generated PLT file (%d aircraft, %d bytes)\n", nAircraft, (int)len);
+
+	return (uint8_t*)PltBuffer;
 }
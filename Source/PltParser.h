@@ -17,6 +17,7 @@
  * 	Global prototypes
  * *************************************/
 bool PltParserLoadFile(const char* strPath, TYPE_FLIGHT_DATA* const ptrFlightData);
+bool PltParserLoadBuffer(const char* strBuffer, TYPE_FLIGHT_DATA* const ptrFlightData);
 uint8_t* PltParserGenerateFile(TYPE_PLT_CONFIG* ptrPltConfig);
 
 /* *************************************
@@ -0,0 +1,570 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Profiler.h"
+
+#ifdef PSXSDK_DEBUG
+
+#include "System.h"
+#include "Font.h"
+#include "Trace.h"
+#include "Game.h"
+#include "Dialog.h"
+#include "Log.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Number of frames used to calculate min/avg/max values.
+#define PROFILER_WINDOW_FRAMES	REFRESH_FREQUENCY
+// Time between two VBlank interrupts.
+#define PROFILER_VSYNC_PERIOD_US	(1000000 / REFRESH_FREQUENCY)
+// Quarter of a VBlank period per bin, so last bin
+// collects frames longer than 4 VBlank periods.
+#define PROFILER_HISTOGRAM_BINS		16
+#define PROFILER_HISTOGRAM_BIN_US	(PROFILER_VSYNC_PERIOD_US >> 2)
+// Frames are synchronized to VBlank, so any frame longer
+// than this has missed at least one VBlank.
+#define PROFILER_HITCH_US			(PROFILER_VSYNC_PERIOD_US + (PROFILER_VSYNC_PERIOD_US >> 1))
+#define PROFILER_MAX_HITCHES		4
+// Player mode flags, from TYPE_PLAYER state flags.
+#define PROFILER_MODE_CHARACTERS	"LRTPKU"
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_profilerStats
+{
+	uint32_t min;
+	uint32_t avg;
+	uint32_t max;
+}TYPE_PROFILER_STATS;
+
+// Context for one of the longest frames.
+typedef struct t_profilerHitch
+{
+	uint32_t frame;
+	uint32_t us;
+	uint32_t sectionUs[MAX_PROFILER_SECTIONS];
+	uint8_t activeAircraft;
+	uint8_t playerModes[MAX_PLAYERS];
+	// PROFILER_EVENT flags.
+	uint8_t events;
+	bool dialogOpen;
+}TYPE_PROFILER_HITCH;
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static const char* const ProfilerSectionNames[MAX_PROFILER_SECTIONS] =
+{
+	[PROFILER_SECTION_FRAME] = "Frame",
+	[PROFILER_SECTION_GAME_CALCULATIONS] = "Calc",
+	[PROFILER_SECTION_AIRCRAFT_HANDLER] = "Aircr",
+	[PROFILER_SECTION_TERRAIN_PRECALCULATIONS] = "TerPre",
+	[PROFILER_SECTION_RENDER_TERRAIN] = "Terr",
+	[PROFILER_SECTION_RENDER_BUILDING_AIRCRAFT] = "BldAc",
+	[PROFILER_SECTION_GUI] = "Gui",
+	[PROFILER_SECTION_GPU_WAIT] = "GPU",
+	[PROFILER_SECTION_VSYNC_WAIT] = "VSync"
+};
+
+// RCnt2 value when each section was entered.
+static uint32_t ProfilerStart[MAX_PROFILER_SECTIONS];
+// RCnt2 ticks accumulated during current frame.
+static uint32_t ProfilerFrameTicks[MAX_PROFILER_SECTIONS];
+// Values accumulated during current window, in microseconds.
+static TYPE_PROFILER_STATS ProfilerWindow[MAX_PROFILER_SECTIONS];
+// Values from last complete window, shown on development menu.
+static TYPE_PROFILER_STATS ProfilerStats[MAX_PROFILER_SECTIONS];
+static uint8_t ProfilerWindowFrames;
+static bool ProfilerFrameStarted;
+static uint32_t ProfilerHistogram[PROFILER_HISTOGRAM_BINS];
+// Longest frames so far, in no particular order.
+static TYPE_PROFILER_HITCH ProfilerHitches[PROFILER_MAX_HITCHES];
+static uint32_t ProfilerFrames;
+static uint32_t ProfilerHitchCount;
+// Context for current frame, stored into ProfilerHitches if needed.
+static uint8_t ProfilerFrameEvents;
+static uint8_t ProfilerActiveAircraft;
+static uint8_t ProfilerPlayerModes[MAX_PLAYERS];
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static void ProfilerRecordFrame(void);
+static void ProfilerGetModeString(const uint8_t modes, char* const str);
+
+void ProfilerBegin(const PROFILER_SECTION section)
+{
+	ProfilerStart[section] = SystemGetRCnt2Ticks();
+
+	// Profiler sections share their IDs with trace events.
+	TRACE_BEGIN((TRACE_EVENT)section);
+}
+
+void ProfilerEnd(const PROFILER_SECTION section)
+{
+	ProfilerFrameTicks[section] += SystemGetRCnt2ElapsedTicks(ProfilerStart[section]);
+
+	TRACE_END((TRACE_EVENT)section, 0);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerEndFrame(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Accumulates times from last frame into current window. Once
+ *  PROFILER_WINDOW_FRAMES frames have been accumulated, window
+ *  values are copied into ProfilerStats so they can be shown on
+ *  development menu.
+ *
+ * @remarks:
+ *  Called from GfxDrawScene(), once VBlank has been reached.
+ *
+ * *******************************************************************************************/
+void ProfilerEndFrame(void)
+{
+	uint8_t i;
+
+	if (ProfilerFrameStarted)
+	{
+		ProfilerEnd(PROFILER_SECTION_FRAME);
+		ProfilerRecordFrame();
+	}
+	else
+	{
+		// First call: there is no previous frame to measure.
+		ProfilerFrameStarted = true;
+		memset(ProfilerFrameTicks, 0, sizeof (ProfilerFrameTicks));
+	}
+
+	ProfilerBegin(PROFILER_SECTION_FRAME);
+
+	for (i = 0; i < MAX_PROFILER_SECTIONS; i++)
+	{
+		TYPE_PROFILER_STATS* const ptrWindow = &ProfilerWindow[i];
+		const uint32_t us = SystemRCnt2TicksToUs(ProfilerFrameTicks[i]);
+
+		if ((ProfilerWindowFrames == 0) || (us < ptrWindow->min))
+		{
+			ptrWindow->min = us;
+		}
+
+		if ((ProfilerWindowFrames == 0) || (us > ptrWindow->max))
+		{
+			ptrWindow->max = us;
+		}
+
+		// Sum of all frames until window is complete.
+		ptrWindow->avg = (ProfilerWindowFrames == 0) ? us : (ptrWindow->avg + us);
+
+		ProfilerFrameTicks[i] = 0;
+	}
+
+	if (++ProfilerWindowFrames >= PROFILER_WINDOW_FRAMES)
+	{
+		for (i = 0; i < MAX_PROFILER_SECTIONS; i++)
+		{
+			ProfilerStats[i] = ProfilerWindow[i];
+			ProfilerStats[i].avg /= PROFILER_WINDOW_FRAMES;
+		}
+
+		ProfilerWindowFrames = 0;
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerRecordFrame(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Adds last frame time into histogram. If frame missed at least one
+ *  VBlank, it replaces the shortest stored hitch if last frame was
+ *  longer, along with section times and game state for that frame.
+ *
+ * @remarks:
+ *  RCnt2 interrupt is disabled during file access, so frame times are
+ *  only a lower bound when PROFILER_EVENT_FILE_ACCESS is set. Such
+ *  frames are always considered hitches.
+ *
+ * *******************************************************************************************/
+static void ProfilerRecordFrame(void)
+{
+	const uint32_t us = SystemRCnt2TicksToUs(ProfilerFrameTicks[PROFILER_SECTION_FRAME]);
+	uint32_t bin = us / PROFILER_HISTOGRAM_BIN_US;
+
+	if (bin >= PROFILER_HISTOGRAM_BINS)
+	{
+		bin = PROFILER_HISTOGRAM_BINS - 1;
+	}
+
+	ProfilerHistogram[bin]++;
+	ProfilerFrames++;
+
+	if ((us > PROFILER_HITCH_US) || (ProfilerFrameEvents & PROFILER_EVENT_FILE_ACCESS))
+	{
+		TYPE_PROFILER_HITCH* ptrHitch = &ProfilerHitches[0];
+		uint8_t i;
+
+		ProfilerHitchCount++;
+
+		// Deferred, so printing does not cause another hitch.
+		LOG_WARNING("Hitch: frame %d took %d us, events 0x%X\n", ProfilerFrames, us, ProfilerFrameEvents);
+
+		for (i = 1; i < PROFILER_MAX_HITCHES; i++)
+		{
+			if (ProfilerHitches[i].us < ptrHitch->us)
+			{
+				ptrHitch = &ProfilerHitches[i];
+			}
+		}
+
+		if (us > ptrHitch->us)
+		{
+			ptrHitch->frame = ProfilerFrames;
+			ptrHitch->us = us;
+			ptrHitch->activeAircraft = ProfilerActiveAircraft;
+			ptrHitch->events = ProfilerFrameEvents;
+			ptrHitch->dialogOpen = DialogAnyOpen();
+			memmove(ptrHitch->playerModes, ProfilerPlayerModes, sizeof (ProfilerPlayerModes));
+
+			for (i = 0; i < MAX_PROFILER_SECTIONS; i++)
+			{
+				ptrHitch->sectionUs[i] = SystemRCnt2TicksToUs(ProfilerFrameTicks[i]);
+			}
+		}
+	}
+
+	// Game state is set again by Game on next frame, if needed.
+	ProfilerFrameEvents = 0;
+	ProfilerActiveAircraft = 0;
+	memset(ProfilerPlayerModes, 0, sizeof (ProfilerPlayerModes));
+}
+
+void ProfilerEvent(const PROFILER_EVENT event)
+{
+	ProfilerFrameEvents |= event;
+}
+
+void ProfilerGameState(const uint8_t activeAircraft, const TYPE_PLAYER* const ptrPlayers)
+{
+	uint8_t i;
+
+	ProfilerActiveAircraft = activeAircraft;
+
+	for (i = 0; i < MAX_PLAYERS; i++)
+	{
+		// Same order as PROFILER_MODE_CHARACTERS.
+		const bool modes[] =
+		{
+			ptrPlayers[i].ShowAircraftData,
+			ptrPlayers[i].SelectRunway,
+			ptrPlayers[i].SelectTaxiwayRunway,
+			ptrPlayers[i].SelectTaxiwayParking,
+			ptrPlayers[i].LockTarget,
+			ptrPlayers[i].Unboarding
+		};
+
+		uint8_t j;
+
+		ProfilerPlayerModes[i] = 0;
+
+		for (j = 0; j < ARRAY_SIZE(modes); j++)
+		{
+			if (modes[j])
+			{
+				ProfilerPlayerModes[i] |= 1 << j;
+			}
+		}
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerGetModeString(const uint8_t modes, char* const str)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Converts player mode flags into characters from PROFILER_MODE_CHARACTERS,
+ *  or '-' if player was not on any mode. str must have room for
+ *  sizeof (PROFILER_MODE_CHARACTERS) characters.
+ *
+ * *******************************************************************************************/
+static void ProfilerGetModeString(const uint8_t modes, char* const str)
+{
+	uint8_t len = 0;
+	uint8_t i;
+
+	for (i = 0; i < (sizeof (PROFILER_MODE_CHARACTERS) - 1); i++)
+	{
+		if (modes & (1 << i))
+		{
+			str[len++] = PROFILER_MODE_CHARACTERS[i];
+		}
+	}
+
+	if (len == 0)
+	{
+		str[len++] = '-';
+	}
+
+	str[len] = '\0';
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerDevMenu(short x, short y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Draws a bar for each section showing its average time, plus a mark
+ *  for its maximum time. Full bar width equals one VBlank period, so
+ *  a frame is CPU-bound if GPU and VSync waits are close to zero while
+ *  CPU sections fill the bar, and GPU-bound if GPU wait is high.
+ *
+ *  Values on the right are min/avg/max, in 0.1 ms units.
+ *
+ * *******************************************************************************************/
+void ProfilerDevMenu(short x, short y)
+{
+	enum
+	{
+		PROFILER_ROW_H = 8,
+		PROFILER_BAR_X = 48,
+		PROFILER_BAR_W = 96,
+		PROFILER_BAR_H = 6,
+		PROFILER_TEXT_X = PROFILER_BAR_X + PROFILER_BAR_W + 8,
+
+		PROFILER_BAR_R = 0,
+		PROFILER_BAR_G = 255,
+		PROFILER_BAR_B = 0,
+
+		PROFILER_BAR_OVER_R = 255,
+		PROFILER_BAR_OVER_G = 0,
+		PROFILER_BAR_OVER_B = 0,
+
+		PROFILER_MAX_MARK_LUM = 255
+	};
+
+	uint8_t i;
+
+	for (i = 0; i < MAX_PROFILER_SECTIONS; i++)
+	{
+		const TYPE_PROFILER_STATS* const ptrStats = &ProfilerStats[i];
+		const short row_y = y + (i * PROFILER_ROW_H);
+		const bool over = ptrStats->avg > PROFILER_VSYNC_PERIOD_US;
+		uint32_t avg_w = (ptrStats->avg * PROFILER_BAR_W) / PROFILER_VSYNC_PERIOD_US;
+		uint32_t max_x = (ptrStats->max * PROFILER_BAR_W) / PROFILER_VSYNC_PERIOD_US;
+		GsRectangle bar = {0};
+		GsRectangle maxMark = {0};
+
+		if (avg_w > PROFILER_BAR_W)
+		{
+			avg_w = PROFILER_BAR_W;
+		}
+
+		if (max_x >= PROFILER_BAR_W)
+		{
+			max_x = PROFILER_BAR_W - 1;
+		}
+
+		FontPrintText(&SmallFont, x, row_y, "%s", ProfilerSectionNames[i]);
+
+		if (avg_w != 0)
+		{
+			bar.x = x + PROFILER_BAR_X;
+			bar.y = row_y;
+			bar.w = (unsigned short)avg_w;
+			bar.h = PROFILER_BAR_H;
+			bar.r = over ? PROFILER_BAR_OVER_R : PROFILER_BAR_R;
+			bar.g = over ? PROFILER_BAR_OVER_G : PROFILER_BAR_G;
+			bar.b = over ? PROFILER_BAR_OVER_B : PROFILER_BAR_B;
+
+			GsSortRectangle(&bar);
+		}
+
+		maxMark.x = x + PROFILER_BAR_X + (short)max_x;
+		maxMark.y = row_y;
+		maxMark.w = 1;
+		maxMark.h = PROFILER_BAR_H;
+		maxMark.r = PROFILER_MAX_MARK_LUM;
+		maxMark.g = PROFILER_MAX_MARK_LUM;
+		maxMark.b = PROFILER_MAX_MARK_LUM;
+
+		GsSortRectangle(&maxMark);
+
+		FontPrintText(	&SmallFont,
+						x + PROFILER_TEXT_X,
+						row_y,
+						"%d/%d/%d",
+						ptrStats->min / 100,
+						ptrStats->avg / 100,
+						ptrStats->max / 100	);
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerFramesDevMenu(short x, short y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Draws frame time histogram, with one bar per PROFILER_HISTOGRAM_BIN_US
+ *  interval. Bars are red for frames which missed a VBlank. Below,
+ *  longest frames are listed as: time in 0.1 ms units, active aircraft,
+ *  PROFILER_EVENT flags (A: aircraft spawn, D: dialog, F: file access)
+ *  and whether a dialog was open.
+ *
+ * *******************************************************************************************/
+void ProfilerFramesDevMenu(short x, short y)
+{
+	enum
+	{
+		PROFILER_HISTOGRAM_BAR_W = PROFILER_FRAMES_DEV_MENU_W / PROFILER_HISTOGRAM_BINS,
+		PROFILER_HISTOGRAM_H = 28,
+		PROFILER_HITCH_ROW_H = 8,
+		PROFILER_HITCHES_Y = PROFILER_HISTOGRAM_H + 10,
+
+		PROFILER_BIN_R = 0,
+		PROFILER_BIN_G = 255,
+		PROFILER_BIN_B = 0,
+
+		PROFILER_BIN_HITCH_R = 255,
+		PROFILER_BIN_HITCH_G = 0,
+		PROFILER_BIN_HITCH_B = 0
+	};
+
+	uint32_t maxCount = 0;
+	uint8_t i;
+
+	for (i = 0; i < PROFILER_HISTOGRAM_BINS; i++)
+	{
+		if (ProfilerHistogram[i] > maxCount)
+		{
+			maxCount = ProfilerHistogram[i];
+		}
+	}
+
+	for (i = 0; (maxCount != 0) && (i < PROFILER_HISTOGRAM_BINS); i++)
+	{
+		// At least one pixel for any non-empty bin, so rare hitches are visible.
+		const uint32_t h = ProfilerHistogram[i] != 0 ? 1 + ((ProfilerHistogram[i] * (PROFILER_HISTOGRAM_H - 1)) / maxCount) : 0;
+		const bool hitch = (i * PROFILER_HISTOGRAM_BIN_US) >= PROFILER_HITCH_US;
+		GsRectangle bar = {0};
+
+		if (h == 0)
+		{
+			continue;
+		}
+
+		bar.x = x + (i * PROFILER_HISTOGRAM_BAR_W);
+		bar.y = y + PROFILER_HISTOGRAM_H - (short)h;
+		bar.w = PROFILER_HISTOGRAM_BAR_W - 1;
+		bar.h = (unsigned short)h;
+		bar.r = hitch ? PROFILER_BIN_HITCH_R : PROFILER_BIN_R;
+		bar.g = hitch ? PROFILER_BIN_HITCH_G : PROFILER_BIN_G;
+		bar.b = hitch ? PROFILER_BIN_HITCH_B : PROFILER_BIN_B;
+
+		GsSortRectangle(&bar);
+	}
+
+	FontPrintText(	&SmallFont,
+					x,
+					y + PROFILER_HISTOGRAM_H + 2,
+					"Hitches %d",
+					ProfilerHitchCount	);
+
+	for (i = 0; i < PROFILER_MAX_HITCHES; i++)
+	{
+		const TYPE_PROFILER_HITCH* const ptrHitch = &ProfilerHitches[i];
+
+		if (ptrHitch->us == 0)
+		{
+			continue;
+		}
+
+		FontPrintText(	&SmallFont,
+						x,
+						y + PROFILER_HITCHES_Y + (i * PROFILER_HITCH_ROW_H),
+						"%d A%d %c%c%c",
+						ptrHitch->us / 100,
+						ptrHitch->activeAircraft,
+						(ptrHitch->events & PROFILER_EVENT_AIRCRAFT_SPAWN) ? 'A' : '-',
+						((ptrHitch->events & PROFILER_EVENT_DIALOG_OPEN) || ptrHitch->dialogOpen) ? 'D' : '-',
+						(ptrHitch->events & PROFILER_EVENT_FILE_ACCESS) ? 'F' : '-'	);
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void ProfilerDump(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Prints frame time histogram and longest frames, including time spent
+ *  on each section and game state, over serial port.
+ *
+ * *******************************************************************************************/
+void ProfilerDump(void)
+{
+	uint8_t i;
+
+	Serial_printf("Frame time histogram (%d frames, %d hitches):\n", ProfilerFrames, ProfilerHitchCount);
+
+	for (i = 0; i < PROFILER_HISTOGRAM_BINS; i++)
+	{
+		Serial_printf(	"%d-%d us: %d\n",
+						i * PROFILER_HISTOGRAM_BIN_US,
+						(i < (PROFILER_HISTOGRAM_BINS - 1)) ? (((i + 1) * PROFILER_HISTOGRAM_BIN_US) - 1) : -1,
+						ProfilerHistogram[i]	);
+	}
+
+	for (i = 0; i < PROFILER_MAX_HITCHES; i++)
+	{
+		const TYPE_PROFILER_HITCH* const ptrHitch = &ProfilerHitches[i];
+		char modes[MAX_PLAYERS][sizeof (PROFILER_MODE_CHARACTERS)];
+		uint8_t j;
+
+		if (ptrHitch->us == 0)
+		{
+			continue;
+		}
+
+		for (j = 0; j < MAX_PLAYERS; j++)
+		{
+			ProfilerGetModeString(ptrHitch->playerModes[j], modes[j]);
+		}
+
+		Serial_printf(	"Hitch: frame %d, %d us, %d aircraft, modes %s/%s, spawn %d, dialog %d, file %d\n",
+						ptrHitch->frame,
+						ptrHitch->us,
+						ptrHitch->activeAircraft,
+						modes[PLAYER_ONE],
+						modes[PLAYER_TWO],
+						(ptrHitch->events & PROFILER_EVENT_AIRCRAFT_SPAWN) ? 1 : 0,
+						((ptrHitch->events & PROFILER_EVENT_DIALOG_OPEN) || ptrHitch->dialogOpen) ? 1 : 0,
+						(ptrHitch->events & PROFILER_EVENT_FILE_ACCESS) ? 1 : 0	);
+
+		for (j = 0; j < MAX_PROFILER_SECTIONS; j++)
+		{
+			Serial_printf("  %s: %d us\n", ProfilerSectionNames[j], ptrHitch->sectionUs[j]);
+		}
+	}
+}
+
+#endif // PSXSDK_DEBUG
@@ -0,0 +1,112 @@
+#ifndef PROFILER_HEADER__
+#define PROFILER_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+#include "GameStructures.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Space used by ProfilerFramesDevMenu().
+#define PROFILER_FRAMES_DEV_MENU_W		96
+#define PROFILER_FRAMES_DEV_MENU_H		70
+
+#ifdef PSXSDK_DEBUG
+
+#define PROFILER_BEGIN(section)			ProfilerBegin(section)
+#define PROFILER_END(section)			ProfilerEnd(section)
+#define PROFILER_END_FRAME()			ProfilerEndFrame()
+#define PROFILER_DEV_MENU(x, y)			ProfilerDevMenu(x, y)
+#define PROFILER_FRAMES_DEV_MENU(x, y)	ProfilerFramesDevMenu(x, y)
+#define PROFILER_EVENT(event)			ProfilerEvent(event)
+#define PROFILER_GAME_STATE(activeAircraft, ptrPlayers)	ProfilerGameState(activeAircraft, ptrPlayers)
+// Vertical space used by ProfilerDevMenu().
+#define PROFILER_DEV_MENU_H				(MAX_PROFILER_SECTIONS << 3)
+
+#else
+
+// Profiler is compiled out on release builds.
+#define PROFILER_BEGIN(section)
+#define PROFILER_END(section)
+#define PROFILER_END_FRAME()
+#define PROFILER_DEV_MENU(x, y)
+#define PROFILER_FRAMES_DEV_MENU(x, y)
+#define PROFILER_EVENT(event)
+#define PROFILER_GAME_STATE(activeAircraft, ptrPlayers)
+#define PROFILER_DEV_MENU_H				0
+
+#endif // PSXSDK_DEBUG
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+// Order must match first entries from TRACE_EVENT (see TraceFormat.h).
+typedef enum t_profilerSection
+{
+	// Time between two consecutive frames.
+	PROFILER_SECTION_FRAME,
+	PROFILER_SECTION_GAME_CALCULATIONS,
+	PROFILER_SECTION_AIRCRAFT_HANDLER,
+	PROFILER_SECTION_TERRAIN_PRECALCULATIONS,
+	PROFILER_SECTION_RENDER_TERRAIN,
+	PROFILER_SECTION_RENDER_BUILDING_AIRCRAFT,
+	PROFILER_SECTION_GUI,
+	// CPU waits for GPU to finish previous frame.
+	PROFILER_SECTION_GPU_WAIT,
+	// CPU and GPU wait for VBlank.
+	PROFILER_SECTION_VSYNC_WAIT,
+
+	MAX_PROFILER_SECTIONS
+}PROFILER_SECTION;
+
+// Events which might cause a hitch. Stored as flags
+// along with the longest frames.
+typedef enum t_profilerEvent
+{
+	PROFILER_EVENT_AIRCRAFT_SPAWN = 1 << 0,
+	PROFILER_EVENT_DIALOG_OPEN = 1 << 1,
+	PROFILER_EVENT_FILE_ACCESS = 1 << 2
+}PROFILER_EVENT;
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+#ifdef PSXSDK_DEBUG
+
+// Starts timing a section. A section can be entered several times
+// per frame (e.g.: once per player), and its times are accumulated.
+void ProfilerBegin(const PROFILER_SECTION section);
+
+void ProfilerEnd(const PROFILER_SECTION section);
+
+// Updates min/avg/max values with times accumulated during last frame.
+// To be called once per frame.
+void ProfilerEndFrame(void);
+
+// Draws one bar per section, scaled so that full width equals one VBlank period.
+void ProfilerDevMenu(short x, short y);
+
+// Draws frame time histogram and longest frames, using
+// PROFILER_FRAMES_DEV_MENU_W x PROFILER_FRAMES_DEV_MENU_H pixels.
+void ProfilerFramesDevMenu(short x, short y);
+
+// Flags an event for current frame.
+void ProfilerEvent(const PROFILER_EVENT event);
+
+// Game state to be stored if current frame is a hitch. ptrPlayers
+// must point to MAX_PLAYERS elements. To be called once per frame.
+void ProfilerGameState(const uint8_t activeAircraft, const TYPE_PLAYER* const ptrPlayers);
+
+// Prints frame time histogram and longest frames over serial port.
+void ProfilerDump(void);
+
+#endif // PSXSDK_DEBUG
+
+#endif // PROFILER_HEADER__
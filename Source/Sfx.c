@@ -2,111 +2,495 @@
  * 	Includes
  * *************************************/
 #include "Sfx.h"
+#include "AssetCache.h"
+#include "LoadMenu.h"
 
 /* *************************************
  * 	Defines
  * *************************************/
 #define MAX_VOLUME SPU_MAXVOL
 #define NUMBER_OF_VOICES 24
+#define SFX_MAX_SAMPLES 48
+// First SPU RAM address available for sample data. Lower addresses are
+// used by capture buffers and PSXSDK's dummy sample.
+#define SFX_SPU_HEAP_START 0x1010
+#define SFX_SPU_HEAP_END (512 * 1024)
+#define SFX_SPU_ALIGNMENT 8
+// Set by hardware when a voice reaches the end of its sample.
+#define SPU_ENDX (*(volatile unsigned int*)0x1F801D9C)
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+typedef struct t_sfxSample
+{
+	bool used;
+	SsVag* vag;
+	// Needed to upload sample data again when defragmenting SPU RAM.
+	// File lists passed to LoadMenu() are static, so storing the pointer is safe.
+	const char* path;
+	uint32_t addr;
+	uint32_t size;
+}TYPE_SFX_SAMPLE;
+
+typedef struct t_sfxVoice
+{
+	SsVag* vag;
+	SFX_PRIORITY priority;
+	uint32_t age;
+}TYPE_SFX_VOICE;
 
 /* *************************************
  * 	Local Prototypes
  * *************************************/
+static bool SfxSpuGetGap(const uint32_t start, uint32_t* const end);
+static bool SfxSpuAlloc(const uint32_t size, uint32_t* const addr);
+static TYPE_SFX_SAMPLE* SfxGetSample(const SsVag* const vag);
+static void SfxDefragment(void);
+static void SfxStopVoicesPlaying(const SsVag* const vag);
+static bool SfxIsVoiceFree(const uint8_t voice);
+static bool SfxGetVoice(const SFX_PRIORITY priority, uint8_t* const voice);
 
 /* *************************************
  * 	Local Variables
  * *************************************/
 static uint16_t SfxGlobalVolumeReduction;
-static bool usedVoices[NUMBER_OF_VOICES];
+static TYPE_SFX_SAMPLE SfxSamples[SFX_MAX_SAMPLES];
+static TYPE_SFX_VOICE SfxVoices[NUMBER_OF_VOICES];
+static uint32_t SfxPlayCounter;
 
 #ifndef NO_CDDA
 static uint16_t SfxCddaVolumeReduction;
 #endif // NO_CDDA
 
-void SfxPlaySound(SsVag* sound)
+static bool SfxIsVoiceFree(const uint8_t voice)
 {
-    if (sound->data_size != 0)
-    {
-        SsPlayVag(sound, sound->cur_voice, MAX_VOLUME - SfxGlobalVolumeReduction, MAX_VOLUME - SfxGlobalVolumeReduction);
-    }
+	return ((SfxVoices[voice].vag == NULL) || (SPU_ENDX & (1 << voice)));
 }
 
-bool SfxUploadSound_Ex(const char* file_path, SsVag* vag, uint8_t voiceIndex)
+/* *******************************************************************************************
+ *
+ * @name: bool SfxGetVoice(const SFX_PRIORITY priority, uint8_t* const voice)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Looks for a voice which is not playing any sound. If all voices are busy,
+ *  the oldest voice among those with the lowest priority is stolen, as long as
+ *  its priority is not higher than requested priority.
+ *
+ * @return:
+ *  true if a voice was found, false otherwise.
+ *
+ * *******************************************************************************************/
+static bool SfxGetVoice(const SFX_PRIORITY priority, uint8_t* const voice)
 {
-#ifdef PSXSDK_DEBUG
-	static size_t SPUBytesUsed;
-#endif // PSXSDK_DEBUG
+	bool found = false;
+	uint8_t i;
 
-	if (voiceIndex >= NUMBER_OF_VOICES)
+	for (i = 0; i < NUMBER_OF_VOICES; i++)
 	{
-		Serial_printf(	"Invalid input voice index %d. Only indexes [%d-%d] are allowed.\n",
-						voiceIndex,
-						0,
-						NUMBER_OF_VOICES - 1	);
-		return false;
+		if (SfxIsVoiceFree(i) != false)
+		{
+			*voice = i;
+			return true;
+		}
 	}
 
-	if (usedVoices[voiceIndex])
+	for (i = 0; i < NUMBER_OF_VOICES; i++)
 	{
-		Serial_printf("Voice number %d is already being used.\n", voiceIndex);
-		return false;
+		const TYPE_SFX_VOICE* const ptrVoice = &SfxVoices[i];
+
+		if (ptrVoice->priority > priority)
+		{
+			continue;
+		}
+
+		if (	(found == false)
+					||
+				(ptrVoice->priority < SfxVoices[*voice].priority)
+					||
+				(	(ptrVoice->priority == SfxVoices[*voice].priority)
+						&&
+					(ptrVoice->age < SfxVoices[*voice].age)	)	)
+		{
+			found = true;
+			*voice = i;
+		}
 	}
 
-	if (SystemLoadFile(file_path) == false)
+	if (found != false)
 	{
-		return false;
+		SsKeyOff(*voice);
 	}
 
-	SsReadVag(vag, SystemGetBufferAddress());
+	return found;
+}
 
-	SsUploadVag(vag);
+void SfxPlaySound_Ex(SsVag* sound, const SFX_PRIORITY priority)
+{
+	uint8_t voice;
 
-	vag->cur_voice = voiceIndex;
+	if (sound->data_size == 0)
+	{
+		return;
+	}
 
-	usedVoices[voiceIndex] = true;
+	if (SfxGetVoice(priority, &voice) == false)
+	{
+		// All voices are playing more important sounds.
+		return;
+	}
 
-#ifdef PSXSDK_DEBUG
+	SfxVoices[voice].vag = sound;
+	SfxVoices[voice].priority = priority;
+	SfxVoices[voice].age = SfxPlayCounter++;
 
-	SPUBytesUsed += vag->data_size;
+	SsPlayVag(sound, voice, MAX_VOLUME - SfxGlobalVolumeReduction, MAX_VOLUME - SfxGlobalVolumeReduction);
+}
+
+void SfxPlaySound(SsVag* sound)
+{
+	SfxPlaySound_Ex(sound, SFX_PRIORITY_NORMAL);
+}
 
-	if (SPUBytesUsed != 0)
+static void SfxStopVoicesPlaying(const SsVag* const vag)
+{
+	uint8_t i;
+
+	for (i = 0; i < NUMBER_OF_VOICES; i++)
 	{
-		enum
+		if ((vag == NULL) || (SfxVoices[i].vag == vag))
 		{
-			SPU_MAX_ALLOWED_BYTES = 512 * 1024 // 512 KBytes
-		};
+			SsKeyOff(i);
+			SfxVoices[i].vag = NULL;
+		}
+	}
+}
 
-		uint16_t percentage = SPUBytesUsed * 100 / SPU_MAX_ALLOWED_BYTES;
+static TYPE_SFX_SAMPLE* SfxGetSample(const SsVag* const vag)
+{
+	uint8_t i;
 
-		Serial_printf("SPU usage: %d%%\n", percentage);
+	for (i = 0; i < SFX_MAX_SAMPLES; i++)
+	{
+		if ((SfxSamples[i].used != false) && (SfxSamples[i].vag == vag))
+		{
+			return &SfxSamples[i];
+		}
 	}
 
-#endif // PSXSDK_DEBUG
+	return NULL;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool SfxSpuGetGap(const uint32_t start, uint32_t* const end)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Calculates where a free gap starting at given SPU RAM address ends.
+ *
+ * @return:
+ *  false if start address lies inside a used sample, true otherwise.
+ *
+ * *******************************************************************************************/
+static bool SfxSpuGetGap(const uint32_t start, uint32_t* const end)
+{
+	uint8_t i;
+
+	*end = SFX_SPU_HEAP_END;
+
+	for (i = 0; i < SFX_MAX_SAMPLES; i++)
+	{
+		const TYPE_SFX_SAMPLE* const ptrSample = &SfxSamples[i];
+
+		if (ptrSample->used == false)
+		{
+			continue;
+		}
+
+		if ((start >= ptrSample->addr) && (start < (ptrSample->addr + ptrSample->size)))
+		{
+			return false;
+		}
+
+		if ((ptrSample->addr >= start) && (ptrSample->addr < *end))
+		{
+			*end = ptrSample->addr;
+		}
+	}
 
 	return true;
 }
 
+/* *******************************************************************************************
+ *
+ * @name: bool SfxSpuAlloc(const uint32_t size, uint32_t* const addr)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Best-fit allocator for SPU RAM. Free gaps start either on heap start
+ *  or right after a used sample. If size is 0, the largest gap is chosen.
+ *
+ * @return:
+ *  true if a gap large enough was found, false otherwise.
+ *
+ * *******************************************************************************************/
+static bool SfxSpuAlloc(const uint32_t size, uint32_t* const addr)
+{
+	bool found = false;
+	uint32_t bestGap = 0;
+	uint8_t i;
+
+	for (i = 0; i <= SFX_MAX_SAMPLES; i++)
+	{
+		uint32_t start;
+		uint32_t end;
+		uint32_t gap;
+
+		if (i == SFX_MAX_SAMPLES)
+		{
+			start = SFX_SPU_HEAP_START;
+		}
+		else if (SfxSamples[i].used != false)
+		{
+			start = SfxSamples[i].addr + SfxSamples[i].size;
+		}
+		else
+		{
+			continue;
+		}
+
+		if (SfxSpuGetGap(start, &end) == false)
+		{
+			continue;
+		}
+
+		gap = end - start;
+
+		if (	(gap >= size)
+					&&
+				(	(found == false)
+						||
+					((size != 0) && (gap < bestGap))
+						||
+					((size == 0) && (gap > bestGap))	)	)
+		{
+			found = true;
+			bestGap = gap;
+			*addr = start;
+		}
+	}
+
+	return found;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void SfxDefragment(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Moves all samples towards SPU RAM start, so free space is merged
+ *  into a single gap at the end.
+ *
+ * @remarks:
+ *  Sample data cannot be read back from SPU RAM through PSXSDK, so moved
+ *  samples are loaded again from their source files. Therefore, this
+ *  should only be called from loading stages. All voices are stopped.
+ *
+ * *******************************************************************************************/
+static void SfxDefragment(void)
+{
+	uint32_t cursor = SFX_SPU_HEAP_START;
+	uint32_t lastAddr = 0;
+	bool first = true;
+
+	SfxStopVoicesPlaying(NULL);
+
+	while (1)
+	{
+		TYPE_SFX_SAMPLE* ptrNext = NULL;
+		uint8_t i;
+
+		// Samples are processed in ascending address order,
+		// so they are never overwritten before being moved.
+		for (i = 0; i < SFX_MAX_SAMPLES; i++)
+		{
+			TYPE_SFX_SAMPLE* const ptrSample = &SfxSamples[i];
+
+			if (	(ptrSample->used != false)
+						&&
+					((first != false) || (ptrSample->addr > lastAddr))
+						&&
+					((ptrNext == NULL) || (ptrSample->addr < ptrNext->addr))	)
+			{
+				ptrNext = ptrSample;
+			}
+		}
+
+		if (ptrNext == NULL)
+		{
+			break;
+		}
+
+		first = false;
+		lastAddr = ptrNext->addr;
+
+		if (ptrNext->addr != cursor)
+		{
+			if (SystemLoadFile(ptrNext->path) == false)
+			{
+				Serial_printf("Could not move sound file \"%s\"!\n", ptrNext->path);
+
+				// Sample remains where it was.
+				cursor = ptrNext->addr + ptrNext->size;
+				continue;
+			}
+
+			SsReadVag(ptrNext->vag, SystemGetBufferAddress());
+			SsUploadVagEx(ptrNext->vag, cursor);
+			ptrNext->addr = cursor;
+		}
+
+		cursor += ptrNext->size;
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool SfxUploadSound(const char* file_path, SsVag* vag)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Loads a VAG file and uploads sample data into SPU RAM. No voice is
+ *  assigned until the sound is played (see SfxPlaySound_Ex()), so the
+ *  number of loaded sounds is only limited by SPU RAM.
+ *
+ * @return:
+ *  false if an error happened, true otherwise.
+ *
+ * *******************************************************************************************/
 bool SfxUploadSound(const char* file_path, SsVag* vag)
 {
-	bool success = false;
+	TYPE_SFX_SAMPLE* ptrSample = NULL;
+	uint32_t size;
+	uint32_t addr;
 	uint8_t i;
 
-    for (i = 0; i < NUMBER_OF_VOICES; i++)
-    {
-		if (usedVoices[i] == false)
+	// Previous contents from vag are replaced.
+	SfxFreeSound(vag);
+
+	for (i = 0; i < SFX_MAX_SAMPLES; i++)
+	{
+		if (SfxSamples[i].used == false)
 		{
-			success = true;
+			ptrSample = &SfxSamples[i];
 			break;
 		}
 	}
 
-	if (success == false)
+	if (ptrSample == NULL)
 	{
-		Serial_printf("Could not find any free SPU slot.\n");
+		Serial_printf("Could not find any free sample slot.\n");
 		return false;
 	}
 
-	return SfxUploadSound_Ex(file_path, vag, i);
+	if (SystemLoadFile(file_path) == false)
+	{
+		return false;
+	}
+
+	SsReadVag(vag, SystemGetBufferAddress());
+
+	size = (vag->data_size + SFX_SPU_ALIGNMENT - 1) & ~(SFX_SPU_ALIGNMENT - 1);
+
+	if (SfxSpuAlloc(size, &addr) == false)
+	{
+		Serial_printf("SPU RAM is fragmented. Defragmenting...\n");
+
+		SfxDefragment();
+
+		if (SfxSpuAlloc(size, &addr) == false)
+		{
+			Serial_printf("Not enough SPU RAM for \"%s\"!\n", file_path);
+			vag->data_size = 0;
+			return false;
+		}
+
+		// System buffer was overwritten during defragmentation.
+		if (SystemLoadFile(file_path) == false)
+		{
+			vag->data_size = 0;
+			return false;
+		}
+
+		SsReadVag(vag, SystemGetBufferAddress());
+	}
+
+	LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_UPLOAD);
+	SsUploadVagEx(vag, addr);
+	LOAD_MENU_TIME_END(LOAD_MENU_TIME_UPLOAD);
+
+	ptrSample->used = true;
+	ptrSample->vag = vag;
+	ptrSample->path = file_path;
+	ptrSample->addr = addr;
+	ptrSample->size = size;
+
+	AssetCacheAdd(file_path, vag, ASSET_RESIDENCY_SPU);
+
+#ifdef PSXSDK_DEBUG
+	SfxPrintStats();
+#endif // PSXSDK_DEBUG
+
+	return true;
+}
+
+void SfxFreeSound(SsVag* vag)
+{
+	TYPE_SFX_SAMPLE* const ptrSample = SfxGetSample(vag);
+
+	if (ptrSample != NULL)
+	{
+		SfxStopVoicesPlaying(vag);
+		ptrSample->used = false;
+		AssetCacheRemove(vag);
+	}
+}
+
+void SfxPrintStats(void)
+{
+	uint32_t used = 0;
+	uint32_t largestGap = 0;
+	uint32_t addr;
+	uint8_t nSamples = 0;
+	uint8_t i;
+
+	for (i = 0; i < SFX_MAX_SAMPLES; i++)
+	{
+		if (SfxSamples[i].used != false)
+		{
+			used += SfxSamples[i].size;
+			nSamples++;
+		}
+	}
+
+	if (SfxSpuAlloc(0, &addr) != false)
+	{
+		SfxSpuGetGap(addr, &largestGap);
+		largestGap -= addr;
+	}
+
+	Serial_printf(	"SPU usage: %d%% (%d samples, largest free block: %d bytes)\n",
+					used * 100 / (SFX_SPU_HEAP_END - SFX_SPU_HEAP_START),
+					nSamples,
+					largestGap	);
 }
 
 void SfxPlayTrack(MUSIC_TRACKS track)
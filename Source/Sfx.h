@@ -22,11 +22,24 @@ typedef enum
 	GAMEPLAY_LAST_TRACK = GAMEPLAY_TRACK2
 }MUSIC_TRACKS;
 
+// When all voices are busy, sounds with lower priority are stopped
+// so that new sounds with higher or equal priority can be played.
+typedef enum
+{
+	SFX_PRIORITY_LOW,
+	SFX_PRIORITY_NORMAL,
+	SFX_PRIORITY_HIGH
+}SFX_PRIORITY;
+
 /* *************************************
  * 	Global prototypes
  * *************************************/
 void SfxPlaySound(SsVag* sound);
+void SfxPlaySound_Ex(SsVag* sound, const SFX_PRIORITY priority);
 bool SfxUploadSound(const char* file_path, SsVag* vag);
+// Releases SPU RAM used by vag, stopping any voice playing it.
+void SfxFreeSound(SsVag* vag);
+void SfxPrintStats(void);
 void SfxPlayTrack(MUSIC_TRACKS track);
 void SfxStopMusic(void);
 
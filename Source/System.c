@@ -8,6 +8,17 @@
 #include "MemCard.h"
 #include "EndAnimation.h"
 #include "Timer.h"
+#include "Vram.h"
+#include "Profiler.h"
+#include "Trace.h"
+#include "EmuHook.h"
+#include "LoadMenu.h"
+#include "Memory.h"
+
+// File access messages are printed for each loaded file,
+// so only warnings and errors are kept.
+#define LOG_MODULE_LEVEL LOG_LEVEL_WARNING
+#include "Log.h"
 
 /* *************************************
  *  Defines
@@ -16,9 +27,26 @@
 
 #define END_STACK_PATTERN (uint32_t) 0x18022015
 #define BEGIN_STACK_ADDRESS (uint32_t*) 0x801FFF00
-#define STACK_SIZE (6 << 10)    // 6 KiB
+// Guard word has always been checked 24 KiB below stack start. It must
+// not be lowered until SystemGetStackHighWaterMark() has been measured
+// on every level, with enough headroom above the deepest call chain.
+#define STACK_SIZE (24 << 10)   // 24 KiB
+// Lowest stack address. BEGIN_STACK_ADDRESS is a uint32_t pointer,
+// so STACK_SIZE must not be directly subtracted from it.
+#define END_STACK_ADDRESS ((uint32_t*)((uint8_t*)BEGIN_STACK_ADDRESS - STACK_SIZE))
+// Words below current stack pointer which are not painted, as
+// SystemSetStackPattern() and interrupt handlers might use them.
+#define STACK_PATTERN_MARGIN_WORDS 64
 #define I_MASK (*(volatile unsigned int*)0x1F801074)
 #define I_STAT (*(volatile unsigned int*)0x1F801070)
+// RCnt2 runs at system clock / 8, so this value equals 10 ms.
+#define RCNT2_100US_TICK_COUNTER 0xA560
+// Value at which SystemGetRCnt2Ticks() wraps around.
+#define RCNT2_TICKS_WRAP ((uint32_t)(USHRT_MAX + 1) * RCNT2_100US_TICK_COUNTER)
+#define RCNT1_COUNT (*(volatile unsigned int*)0x1F801110)
+#define RCNT1_MODE (*(volatile unsigned int*)0x1F801114)
+// Counts horizontal retraces up to 0xFFFF, without any IRQ.
+#define RCNT1_MODE_HBLANK (1 << 8)
 
 /* *************************************
  *  Local Prototypes
@@ -26,6 +54,7 @@
 static void SystemCheckTimer(bool* timer, uint64_t* last_timer, uint8_t step);
 static void SystemSetStackPattern(void);
 static void ISR_RootCounter2(void);
+static void SystemEndFileAccess(void);
 
 /* *************************************
  *  Local Variables
@@ -54,6 +83,12 @@ static volatile bool system_busy;
 static bool devmenu_flag;
 // Used for sine-like effect.
 static unsigned char sine_counter;
+#ifndef SERIAL_INTERFACE
+// File handle used by SystemOpenFile() and related functions.
+static FILE* stream_file;
+#endif // SERIAL_INTERFACE
+// Bytes left to be read from file opened by SystemOpenFile().
+static uint32_t stream_remaining;
 
 /* *******************************************************************
  *
@@ -68,11 +103,6 @@ static unsigned char sine_counter;
  * *******************************************************************/
 void SystemInit(void)
 {
-    enum
-    {
-        RCNT2_100US_TICK_COUNTER = 0xA560
-    };
-
     //Reset global timer
     global_timer = 0;
     //Reset 1 second timer
@@ -88,6 +118,8 @@ void SystemInit(void)
     GsInit();
     //Clear VRAM
     GsClearMem();
+    //Reserve framebuffers on VRAM allocator
+    VramInit();
     //Set Video Resolution
 #ifdef _PAL_MODE_
     GsSetVideoMode(X_SCREEN_RESOLUTION, Y_SCREEN_RESOLUTION, VMODE_PAL);
@@ -121,10 +153,15 @@ void SystemInit(void)
 
     SystemSetStackPattern();
 
+    MEMORY_REGISTER("System", file_buffer);
+
     // Configure root counter 2 so that ISR_RootCounter2
     // is executed every 100 us.
     SetRCntHandler(&ISR_RootCounter2, 2, RCNT2_100US_TICK_COUNTER);
     SystemEnableRCnt2Interrupt();
+
+    // Used by SystemGetHblankTicks().
+    RCNT1_MODE = RCNT1_MODE_HBLANK;
 }
 
 static volatile uint16_t u16_0_01seconds_cnt;
@@ -144,6 +181,8 @@ void ISR_RootCounter2(void)
 {
     u16_0_01seconds_cnt++;
 
+    TRACE_DRAIN();
+
     if ((int16_t)(u16_0_01seconds_cnt - 1000) >= (int16_t)(u16_0_01seconds_cnt_prev))
     {
         u16_0_01seconds_cnt_prev = u16_0_01seconds_cnt;
@@ -151,6 +190,96 @@ void ISR_RootCounter2(void)
     }
 }
 
+/* *******************************************************************
+ *
+ * @name: uint32_t SystemGetRCnt2Ticks(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  RCnt2 ticks (system clock / 8) elapsed since SystemInit(). Only
+ *  meaningful for measuring time intervals via
+ *  SystemGetRCnt2ElapsedTicks().
+ *
+ * @remarks:
+ *  ISR counter is read again if ISR_RootCounter2 was executed
+ *  while reading RCnt2.
+ *
+ * *******************************************************************/
+uint32_t SystemGetRCnt2Ticks(void)
+{
+    uint16_t cnt;
+    uint16_t ticks;
+
+    do
+    {
+        cnt = u16_0_01seconds_cnt;
+        ticks = (uint16_t)GetRCnt(2);
+    } while (cnt != u16_0_01seconds_cnt);
+
+    return ((uint32_t)cnt * RCNT2_100US_TICK_COUNTER) + ticks;
+}
+
+uint32_t SystemGetRCnt2ElapsedTicks(const uint32_t since)
+{
+    const uint32_t now = SystemGetRCnt2Ticks();
+
+    if (now >= since)
+    {
+        return now - since;
+    }
+
+    // ISR counter has wrapped around.
+    return (RCNT2_TICKS_WRAP - since) + now;
+}
+
+uint32_t SystemRCnt2TicksToUs(const uint32_t ticks)
+{
+    // 10000 us / RCNT2_100US_TICK_COUNTER ticks = 625 / 2646.
+    // Divided first, so ticks * 625 cannot overflow.
+    return ((ticks / 2646) * 625) + (((ticks % 2646) * 625) / 2646);
+}
+
+/* *******************************************************************
+ *
+ * @name: uint32_t SystemGetHblankTicks(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return:
+ *  Horizontal retraces elapsed since first call.
+ *
+ * @remarks:
+ *  File access disables RCnt2 interrupt, so SystemGetRCnt2Ticks()
+ *  loses time while loading. RCnt1 does not need any interrupt,
+ *  but its 16-bit counter wraps around every ~4 seconds, so it is
+ *  accumulated here on each call. Not to be called from interrupt
+ *  context.
+ *
+ * *******************************************************************/
+uint32_t SystemGetHblankTicks(void)
+{
+    static uint32_t ticks;
+    static uint16_t last;
+    const uint16_t now = (uint16_t)RCNT1_COUNT;
+
+    ticks += (uint16_t)(now - last);
+    last = now;
+
+    return ticks;
+}
+
+uint32_t SystemHblankTicksToUs(const uint32_t ticks)
+{
+#ifdef _PAL_MODE_
+    // 64 us per line.
+    return ticks << 6;
+#else // _PAL_MODE_
+    // 63.56 us per line. Divided first, so ticks * 1589 cannot overflow.
+    return ((ticks / 25) * 1589) + (((ticks % 25) * 1589) / 25);
+#endif // _PAL_MODE_
+}
+
 /* *******************************************************************
  *
  * @name: void SystemSetRandSeed(void)
@@ -239,6 +368,8 @@ void ISR_SystemDefaultVBlank(void)
     }
 
     refresh_needed = true;
+
+    TRACE_DRAIN();
 }
 
 /* *******************************************************************
@@ -487,13 +618,18 @@ bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffe
     int32_t size = 0;
 
     // Wait for possible previous operation from the GPU before entering this section.
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_WAIT);
     while ( (SystemIsBusy()) || (GfxIsGPUBusy()) );
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_WAIT);
 
     SystemDisableRCnt2Interrupt();
 
+    // Frame times measured by the profiler are not reliable from now on.
+    PROFILER_EVENT(PROFILER_EVENT_FILE_ACCESS);
+
     if (fname == NULL)
     {
-        Serial_printf("SystemLoadFile: NULL fname!\n");
+        LOG_ERROR("SystemLoadFile: NULL fname!\n");
         return false;
     }
 
@@ -515,6 +651,9 @@ bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffe
 
     SerialWrite(ACK_BYTE_STRING, 1);
 
+    // Serial transfers have no seek time.
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_READ);
+
     for (i = 0; i < size; i += SERIAL_DATA_PACKET_SIZE)
     {
         uint32_t bytes_to_read;
@@ -534,19 +673,23 @@ bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffe
 
         SerialWrite(ACK_BYTE_STRING, sizeof (uint8_t)); // Write ACK
     }
+
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_READ);
 #else // SERIAL_INTERFACE
 
     system_busy = true;
 
     SystemDisableVBlankInterrupt();
 
-    Serial_printf("Opening %s...\n", completeFileName);
+    LOG_DEBUG("Opening %s...\n", completeFileName);
+
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_SEEK);
 
     f = fopen((char*)completeFileName, "r");
 
     if (f == NULL)
     {
-        Serial_printf("SystemLoadFile: file could not be found!\n");
+        LOG_ERROR("SystemLoadFile: file could not be found!\n");
         //File couldn't be found
         return false;
     }
@@ -557,17 +700,22 @@ bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffe
 
     if (size > szBuffer)
     {
-        Serial_printf("SystemLoadFile: Exceeds file buffer size (%d bytes)\n",size);
+        LOG_ERROR("SystemLoadFile: Exceeds file buffer size (%d bytes)\n",size);
         //Bigger than 128 kB (buffer's max size)
         return false;
     }
 
     fseek(f, 0, SEEK_SET); //f->pos = 0;
 
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_SEEK);
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_READ);
+
     fread(buffer, sizeof (char), size, f);
 
     fclose(f);
 
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_READ);
+
     SystemEnableVBlankInterrupt();
     SystemEnableRCnt2Interrupt();
 
@@ -575,7 +723,16 @@ bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffe
 
 #endif // SERIAL_INTERFACE
 
-    Serial_printf("File \"%s\" loaded successfully!\n",completeFileName);
+    LOG_INFO("File \"%s\" loaded successfully!\n",completeFileName);
+
+    LOAD_MENU_BYTES(size);
+
+    if (buffer == file_buffer)
+    {
+        MEMORY_USAGE(file_buffer, size);
+    }
+
+    TRACE_INSTANT(TRACE_EVENT_FILE_LOADED, size);
 
     return true;
 }
@@ -596,6 +753,226 @@ bool SystemLoadFile(const char* fname)
     return SystemLoadFileToBuffer(fname,file_buffer,sizeof (file_buffer));
 }
 
+/* ****************************************************************************************
+ *
+ * @name    bool SystemOpenFile(const char* fname, uint32_t* const ptrSize)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:  Opens a file from CD-ROM so it can be read in small chunks
+ *          by calling SystemReadFileChunk(), instead of loading it
+ *          completely into a buffer.
+ *
+ * @param:  const char* fname:
+ *              File path, relative to CD-ROM root.
+ *          uint32_t* const ptrSize:
+ *              Total file size is written here if not NULL.
+ *
+ * @return: true if file has been opened successfully, false otherwise.
+ *
+ * @remarks: only one file can be opened at a time. Critical section is
+ *           kept until SystemCloseFile() is called.
+ *
+ * ****************************************************************************************/
+bool SystemOpenFile(const char* fname, uint32_t* const ptrSize)
+{
+    static char completeFileName[256];
+#ifdef SERIAL_INTERFACE
+    uint8_t fileSizeBuffer[sizeof (uint32_t)] = {0};
+    uint32_t i;
+#endif // SERIAL_INTERFACE
+    uint32_t size = 0;
+
+    if (fname == NULL)
+    {
+        LOG_ERROR("SystemOpenFile: NULL fname!\n");
+        return false;
+    }
+
+    // Wait for possible previous operation from the GPU before entering this section.
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_WAIT);
+    while ( (SystemIsBusy()) || (GfxIsGPUBusy()) );
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_WAIT);
+
+    SystemDisableRCnt2Interrupt();
+
+    // Frame times measured by the profiler are not reliable from now on.
+    PROFILER_EVENT(PROFILER_EVENT_FILE_ACCESS);
+
+    snprintf(completeFileName, sizeof (completeFileName), "cdrom:\\%s;1", fname);
+
+    system_busy = true;
+
+#ifdef SERIAL_INTERFACE
+    Serial_printf("#%s@", completeFileName);
+
+    SerialRead(fileSizeBuffer, sizeof (uint32_t) );
+
+    for (i = 0; i < sizeof (uint32_t); i++)
+    {
+        size |= fileSizeBuffer[i] << (i << 3); // (i << 3) == (i * 8)
+    }
+
+    SerialWrite(ACK_BYTE_STRING, 1);
+#else // SERIAL_INTERFACE
+    SystemDisableVBlankInterrupt();
+
+    LOG_DEBUG("Opening %s...\n", completeFileName);
+
+    LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_SEEK);
+
+    stream_file = fopen((char*)completeFileName, "r");
+
+    if (stream_file == NULL)
+    {
+        LOG_ERROR("SystemOpenFile: file could not be found!\n");
+        LOAD_MENU_TIME_END(LOAD_MENU_TIME_SEEK);
+        SystemEndFileAccess();
+        return false;
+    }
+
+    fseek(stream_file, 0, SEEK_END);
+
+    size = ftell(stream_file);
+
+    fseek(stream_file, 0, SEEK_SET);
+
+    LOAD_MENU_TIME_END(LOAD_MENU_TIME_SEEK);
+#endif // SERIAL_INTERFACE
+
+    stream_remaining = size;
+
+    if (ptrSize != NULL)
+    {
+        *ptrSize = size;
+    }
+
+    return true;
+}
+
+/* ****************************************************************************************
+ *
+ * @name    uint32_t SystemReadFileChunk(uint8_t* const buffer, const uint32_t szBuffer)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:  Reads next chunk from file opened by SystemOpenFile().
+ *
+ * @param:  uint8_t* const buffer:
+ *              Destination buffer.
+ *          const uint32_t szBuffer:
+ *              Maximum number of bytes to read. CD_SECTOR_SIZE is preferred
+ *              so that each call translates into a single sector read.
+ *
+ * @return: Number of bytes read. 0 means end of file has been reached. On a short read,
+ *          bytes actually read are returned and any further calls return 0.
+ *
+ * ****************************************************************************************/
+uint32_t SystemReadFileChunk(uint8_t* const buffer, const uint32_t szBuffer)
+{
+    uint32_t bytes_to_read = stream_remaining;
+
+    if (bytes_to_read > szBuffer)
+    {
+        bytes_to_read = szBuffer;
+    }
+
+    if (bytes_to_read != 0)
+    {
+#ifdef SERIAL_INTERFACE
+        uint32_t i;
+
+        LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_READ);
+
+        for (i = 0; i < bytes_to_read; i += SERIAL_DATA_PACKET_SIZE)
+        {
+            uint32_t packet_size = bytes_to_read - i;
+
+            if (packet_size > SERIAL_DATA_PACKET_SIZE)
+            {
+                packet_size = SERIAL_DATA_PACKET_SIZE;
+            }
+
+            SerialRead(buffer + i, packet_size);
+
+            SerialWrite(ACK_BYTE_STRING, sizeof (uint8_t)); // Write ACK
+        }
+#else // SERIAL_INTERFACE
+        size_t bytes_read;
+
+        if (stream_file == NULL)
+        {
+            LOG_ERROR("SystemReadFileChunk: no file opened!\n");
+            return 0;
+        }
+
+        LOAD_MENU_TIME_BEGIN(LOAD_MENU_TIME_READ);
+
+        bytes_read = fread(buffer, sizeof (char), bytes_to_read, stream_file);
+
+        if (bytes_read != bytes_to_read)
+        {
+            LOG_ERROR("SystemReadFileChunk: only %d out of %d bytes were read!\n",
+                        (int)bytes_read,
+                        (int)bytes_to_read  );
+
+            // Rest of the file cannot be trusted, so end of file is reported from now on.
+            bytes_to_read = bytes_read;
+            stream_remaining = bytes_read;
+        }
+#endif // SERIAL_INTERFACE
+        LOAD_MENU_TIME_END(LOAD_MENU_TIME_READ);
+        LOAD_MENU_BYTES(bytes_to_read);
+
+        stream_remaining -= bytes_to_read;
+    }
+
+    return bytes_to_read;
+}
+
+/* ****************************************************************************************
+ *
+ * @name    void SystemCloseFile(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:  Closes file opened by SystemOpenFile() and leaves critical section.
+ *
+ * ****************************************************************************************/
+void SystemCloseFile(void)
+{
+#ifndef SERIAL_INTERFACE
+    if (stream_file != NULL)
+    {
+        fclose(stream_file);
+        stream_file = NULL;
+    }
+#endif // SERIAL_INTERFACE
+
+    stream_remaining = 0;
+
+    SystemEndFileAccess();
+}
+
+/* ****************************************************************************************
+ *
+ * @name    void SystemEndFileAccess(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:  Restores interrupts disabled on file access and leaves critical section.
+ *
+ * ****************************************************************************************/
+static void SystemEndFileAccess(void)
+{
+#ifndef SERIAL_INTERFACE
+    SystemEnableVBlankInterrupt();
+#endif // SERIAL_INTERFACE
+    SystemEnableRCnt2Interrupt();
+
+    system_busy = false;
+}
+
 /* ******************************************************************
  *
  * @name    uint8_t* SystemGetBufferAddress(void)
@@ -797,6 +1174,10 @@ void SystemPrintStackPointerAddress(void)
             (void*)&ptr,
             fix16_to_int(stackPercent),
             fix16_to_int(used_bytes)    );
+
+    Serial_printf("High-water mark: %d/%d bytes\n",
+            SystemGetStackHighWaterMark(),
+            STACK_SIZE  );
 #endif // PSXSDK_DEBUG
 
 }
@@ -813,7 +1194,7 @@ void SystemPrintStackPointerAddress(void)
  * ****************************************************************************************/
 void SystemCheckStack(void)
 {
-    const uint32_t* const ptrStack = BEGIN_STACK_ADDRESS - STACK_SIZE;
+    const uint32_t* const ptrStack = END_STACK_ADDRESS;
     const uint32_t data = *ptrStack;
 
     if (data != END_STACK_PATTERN)
@@ -834,12 +1215,58 @@ void SystemCheckStack(void)
  * @brief:  Sets a determined byte pattern on stack top to detect possible stack
  *          overflow during execution.
  *
+ * @remarks: the whole unused area of the stack is filled with the same pattern,
+ *          so SystemGetStackHighWaterMark() can tell how deep it has been used.
+ *
  * ****************************************************************************************/
 void SystemSetStackPattern(void)
 {
-    uint32_t* const ptrStack = BEGIN_STACK_ADDRESS - STACK_SIZE;
+    uint32_t* ptrStack = END_STACK_ADDRESS;
+    // Address of a local variable is used as an approximation of stack pointer.
+    const uint32_t* const ptrLimit = (uint32_t*)&ptrStack - STACK_PATTERN_MARGIN_WORDS;
+
+    for (; ptrStack < ptrLimit; ptrStack++)
+    {
+        *ptrStack = END_STACK_PATTERN;
+    }
+}
+
+/* ****************************************************************************************
+ *
+ * @name    uint32_t SystemGetStackHighWaterMark(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:  Looks for the lowest stack address whose pattern, set by
+ *          SystemSetStackPattern(), has been overwritten.
+ *
+ * @return: Highest number of stack bytes used since SystemInit() was called.
+ *
+ * ****************************************************************************************/
+uint32_t SystemGetStackHighWaterMark(void)
+{
+    const uint32_t* ptrStack = END_STACK_ADDRESS;
 
-    *ptrStack = END_STACK_PATTERN;
+    while ((ptrStack < BEGIN_STACK_ADDRESS) && (*ptrStack == END_STACK_PATTERN))
+    {
+        ptrStack++;
+    }
+
+    return (uint32_t)((uint8_t*)BEGIN_STACK_ADDRESS - (uint8_t*)ptrStack);
+}
+
+/* ****************************************************************************************
+ *
+ * @name    uint32_t SystemGetStackSize(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @return: Number of bytes reserved for the stack.
+ *
+ * ****************************************************************************************/
+uint32_t SystemGetStackSize(void)
+{
+    return STACK_SIZE;
 }
 
 /* ****************************************************************************************
@@ -1036,6 +1463,11 @@ void SystemDevMenuToggle(void)
     devmenu_flag = devmenu_flag? false: true;
 }
 
+bool SystemIsDevMenuEnabled(void)
+{
+    return devmenu_flag;
+}
+
 /* ****************************************************************************************
  *
  * @name    void SystemEnableRCnt2Interrupt(void)
@@ -1081,7 +1513,7 @@ void SystemDevMenu(void)
         DEVMENU_BG_W = 256,
         DEVMENU_BG_X = (X_SCREEN_RESOLUTION >> 1) - (DEVMENU_BG_W >> 1),
         DEVMENU_BG_Y = 32,
-        DEVMENU_BG_H = 128,
+        DEVMENU_BG_H = 128 + PROFILER_DEV_MENU_H + LOAD_MENU_DEV_MENU_H,
 
         DEVMENU_BG_R = 0,
         DEVMENU_BG_G = 128,
@@ -1118,8 +1550,31 @@ void SystemDevMenu(void)
 
         DEVMENU_ROOTCNT2_TEXT_X = DEVMENU_PAD2_RAW_DATA_TEXT_X,
         DEVMENU_ROOTCNT2_TEXT_Y = DEVMENU_PAD2_RAW_DATA_TEXT_Y + DEVMENU_TEXT_GAP,
+
+        DEVMENU_PRIM_LIST_TEXT_X = DEVMENU_ROOTCNT2_TEXT_X,
+        DEVMENU_PRIM_LIST_TEXT_Y = DEVMENU_ROOTCNT2_TEXT_Y + DEVMENU_TEXT_GAP,
+
+        DEVMENU_PRIM_LAYERS_TEXT_X = DEVMENU_PRIM_LIST_TEXT_X,
+        DEVMENU_PRIM_LAYERS_TEXT_Y = DEVMENU_PRIM_LIST_TEXT_Y + DEVMENU_TEXT_GAP,
+
+        DEVMENU_MEMORY_TEXT_X = DEVMENU_PRIM_LAYERS_TEXT_X,
+        DEVMENU_MEMORY_TEXT_Y = DEVMENU_PRIM_LAYERS_TEXT_Y + DEVMENU_TEXT_GAP,
+
+        DEVMENU_LOAD_MENU_X = DEVMENU_MEMORY_TEXT_X,
+        DEVMENU_LOAD_MENU_Y = DEVMENU_MEMORY_TEXT_Y + (DEVMENU_TEXT_GAP << 1),
+
+        DEVMENU_PROFILER_X = DEVMENU_LOAD_MENU_X,
+        DEVMENU_PROFILER_Y = DEVMENU_LOAD_MENU_Y + LOAD_MENU_DEV_MENU_H,
+
+        // Drawn on the right of pad data.
+        DEVMENU_PROFILER_FRAMES_X = DEVMENU_BG_X + DEVMENU_BG_W - PROFILER_FRAMES_DEV_MENU_W - DEVMENU_TEXT_GAP,
+        DEVMENU_PROFILER_FRAMES_Y = DEVMENU_PAD1_STATUS_TEXT_Y,
     };
 
+    // Called once per frame even if development menu is
+    // disabled, so emulator scripts can read GPU statistics.
+    EMU_HOOK(EMU_HOOK_FRAME, 0);
+
     if (devmenu_flag)
     {
         static const GsRectangle devMenuBg =
@@ -1195,6 +1650,34 @@ void SystemDevMenu(void)
                         DEVMENU_ROOTCNT2_TEXT_Y,
                         "Timer2 = 0x%04X, timer2 = 0x%04X",
                         u16_0_01seconds_cnt, GetRCnt(2) );
+
+        FontPrintText(  &SmallFont,
+                        DEVMENU_PRIM_LIST_TEXT_X,
+                        DEVMENU_PRIM_LIST_TEXT_Y,
+                        "Prims %d/%d pk %d drop %d",
+                        GfxGetPrimitiveListUsage(),
+                        GfxGetPrimitiveListSize(),
+                        GfxGetPrimitiveListPeak(),
+                        GfxGetDroppedSprites()  );
+
+        FontPrintText(  &SmallFont,
+                        DEVMENU_PRIM_LAYERS_TEXT_X,
+                        DEVMENU_PRIM_LAYERS_TEXT_Y,
+                        "T%d B%d A%d G%d F%d O%d",
+                        GfxGetLayerUsage(GFX_LAYER_TERRAIN),
+                        GfxGetLayerUsage(GFX_LAYER_BUILDINGS),
+                        GfxGetLayerUsage(GFX_LAYER_AIRCRAFT),
+                        GfxGetLayerUsage(GFX_LAYER_GUI),
+                        GfxGetLayerUsage(GFX_LAYER_FONTS),
+                        GfxGetLayerUsage(GFX_LAYER_OTHER)   );
+
+        MEMORY_DEV_MENU(DEVMENU_MEMORY_TEXT_X, DEVMENU_MEMORY_TEXT_Y);
+
+        LOAD_MENU_DEV_MENU(DEVMENU_LOAD_MENU_X, DEVMENU_LOAD_MENU_Y);
+
+        PROFILER_DEV_MENU(DEVMENU_PROFILER_X, DEVMENU_PROFILER_Y);
+
+        PROFILER_FRAMES_DEV_MENU(DEVMENU_PROFILER_FRAMES_X, DEVMENU_PROFILER_FRAMES_Y);
     }
 }
 
@@ -13,6 +13,9 @@
 #define TIMER_PRESCALER_1_SECOND    10
 #define TIMER_PRESCALER_1_MINUTE    (TIMER_PRESCALER_1_SECOND * 60)
 
+// Files are read from CD-ROM in units of this size
+#define CD_SECTOR_SIZE  2048
+
 #define ARRAY_SIZE(x)   (sizeof ((x)) / sizeof ((x[0])))
 
 /* **************************************
@@ -36,6 +39,16 @@ bool SystemLoadFile(const char*fname);
 // Loads a file into desired buffer
 bool SystemLoadFileToBuffer(const char* fname, uint8_t* buffer, uint32_t szBuffer);
 
+// Opens a file so it can be read in chunks. Total size is written into ptrSize.
+bool SystemOpenFile(const char* fname, uint32_t* const ptrSize);
+
+// Reads up to szBuffer bytes from file opened by SystemOpenFile().
+// Returns number of bytes read, 0 on end of file.
+uint32_t SystemReadFileChunk(uint8_t* const buffer, const uint32_t szBuffer);
+
+// Closes file opened by SystemOpenFile().
+void SystemCloseFile(void);
+
 // Clears VSync flag after each frame
 void SystemDisableScreenRefresh(void);
 
@@ -90,6 +103,12 @@ void SystemPrintStackPointerAddress(void);
 // accidentally modified by program flow.
 void SystemCheckStack(void);
 
+// Returns highest number of stack bytes used so far.
+uint32_t SystemGetStackHighWaterMark(void);
+
+// Returns number of bytes reserved for the stack.
+uint32_t SystemGetStackSize(void);
+
 // Looks for string "str" inside a string array pointed to by "array".
 // Returns index inside string array on success, -1 if not found.
 int32_t SystemIndexOfStringArray(const char* str, const char* const* array);
@@ -103,6 +122,23 @@ int32_t SystemIndexOf_U8(const uint8_t value, const uint8_t* const array, const
 // Returns frames per second.
 volatile uint8_t SystemGetFPS(void);
 
+// Returns RCnt2 ticks (system clock / 8) elapsed since SystemInit().
+uint32_t SystemGetRCnt2Ticks(void);
+
+// Returns RCnt2 ticks elapsed since a previous SystemGetRCnt2Ticks() call.
+uint32_t SystemGetRCnt2ElapsedTicks(const uint32_t since);
+
+// Converts RCnt2 ticks into microseconds.
+uint32_t SystemRCnt2TicksToUs(const uint32_t ticks);
+
+// Returns horizontal retraces counted by RCnt1. Unlike RCnt2 ticks,
+// it keeps counting while interrupts are disabled on file access.
+// Must be called at least once every 4 seconds.
+uint32_t SystemGetHblankTicks(void);
+
+// Converts RCnt1 ticks into microseconds.
+uint32_t SystemHblankTicksToUs(const uint32_t ticks);
+
 // Increase temp_fps in order to calculate frame rate.
 void SystemAcknowledgeFrame(void);
 
@@ -122,6 +158,8 @@ void SystemReturnToLoader(void);
 
 void SystemDevMenuToggle(void);
 
+bool SystemIsDevMenuEnabled(void);
+
 void SystemDevMenu(void);
 
 void SystemCalculateSine(void);
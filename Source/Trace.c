@@ -0,0 +1,158 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Trace.h"
+
+#ifdef TRACE_ENABLED
+
+#include "System.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Must be a power of two.
+#define TRACE_BUFFER_SIZE	(4 << 10)
+#define TRACE_BUFFER_MASK	(TRACE_BUFFER_SIZE - 1)
+#define TRACE_TX_NOT_READY	0
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static uint16_t TraceFreeBytes(void);
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static uint8_t TraceBuffer[TRACE_BUFFER_SIZE];
+// Only modified by TraceRecord().
+static volatile uint16_t TraceHead;
+// Only modified by TraceDrain().
+static volatile uint16_t TraceTail;
+// Set while TraceDrain() is being executed, so an interrupt
+// does not drain ring buffer at the same time.
+static volatile bool TraceDraining;
+static uint32_t TraceDropped;
+static bool TraceDroppedPending;
+
+static uint16_t TraceFreeBytes(void)
+{
+	// One byte is kept unused to tell full and empty buffer apart.
+	return (TraceTail - TraceHead - 1) & TRACE_BUFFER_MASK;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void TraceRecord(const TRACE_TYPE type, const TRACE_EVENT event, const uint32_t payload)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Serializes a record (see TraceFormat.h) into ring buffer. No SIO
+ *  access is done here, so timing of traced code is barely affected.
+ *
+ * @remarks:
+ *  If any record has been dropped, a TRACE_EVENT_DROPPED counter is
+ *  written first once there is enough space again.
+ *
+ * *******************************************************************************************/
+void TraceRecord(const TRACE_TYPE type, const TRACE_EVENT event, const uint32_t payload)
+{
+	uint8_t record[TRACE_RECORD_SIZE];
+	const uint32_t timestamp = SystemGetRCnt2Ticks();
+	uint16_t head = TraceHead;
+	uint8_t checksum = 0;
+	uint8_t i;
+
+	if (TraceDroppedPending)
+	{
+		if (TraceFreeBytes() < (TRACE_RECORD_SIZE << 1))
+		{
+			TraceDropped++;
+			return;
+		}
+
+		TraceDroppedPending = false;
+		TraceRecord(TRACE_TYPE_COUNTER, TRACE_EVENT_DROPPED, TraceDropped);
+		head = TraceHead;
+	}
+
+	if (TraceFreeBytes() < TRACE_RECORD_SIZE)
+	{
+		TraceDropped++;
+		TraceDroppedPending = true;
+		return;
+	}
+
+	record[0] = TRACE_SYNC_BYTE;
+	record[1] = (uint8_t)type;
+	record[2] = (uint8_t)event;
+	record[3] = 0;
+
+	for (i = 0; i < sizeof (uint32_t); i++)
+	{
+		record[4 + i] = (uint8_t)(timestamp >> (i << 3));
+		record[8 + i] = (uint8_t)(payload >> (i << 3));
+	}
+
+	for (i = 0; i < TRACE_RECORD_SIZE; i++)
+	{
+		checksum ^= record[i];
+	}
+
+	record[3] = checksum;
+
+	for (i = 0; i < TRACE_RECORD_SIZE; i++)
+	{
+		TraceBuffer[head] = record[i];
+		head = (head + 1) & TRACE_BUFFER_MASK;
+	}
+
+	// Record is only visible to TraceDrain() once completely written.
+	TraceHead = head;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void TraceDrain(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Sends pending bytes to SIO until its TX buffer is full.
+ *
+ * @remarks:
+ *  Called from VBlank and RCnt2 interrupts, as well as from GPU and
+ *  VBlank wait loops inside GfxDrawScene(), where CPU would be idle
+ *  anyway. Nothing is sent while SerialWrite() or a file access is
+ *  in progress.
+ *
+ * *******************************************************************************************/
+void TraceDrain(void)
+{
+	uint16_t tail;
+
+	if (TraceDraining || SerialIsBusy() || SystemIsBusy())
+	{
+		return;
+	}
+
+	TraceDraining = true;
+
+	tail = TraceTail;
+
+	while ((tail != TraceHead) && (SIOCheckOutBuffer() != TRACE_TX_NOT_READY))
+	{
+		SIOSendByte(TraceBuffer[tail]);
+		tail = (tail + 1) & TRACE_BUFFER_MASK;
+	}
+
+	TraceTail = tail;
+
+	TraceDraining = false;
+}
+
+#endif // TRACE_ENABLED
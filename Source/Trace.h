@@ -0,0 +1,55 @@
+#ifndef TRACE_HEADER__
+#define TRACE_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+#include "TraceFormat.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#ifdef TRACE_ENABLED
+
+#ifdef SERIAL_INTERFACE
+// Records would be mixed with file transfer protocol.
+#error "TRACE_ENABLED cannot be used along with SERIAL_INTERFACE"
+#endif // SERIAL_INTERFACE
+
+#define TRACE_BEGIN(event)				TraceRecord(TRACE_TYPE_BEGIN, event, 0)
+#define TRACE_END(event, payload)		TraceRecord(TRACE_TYPE_END, event, payload)
+#define TRACE_INSTANT(event, payload)	TraceRecord(TRACE_TYPE_INSTANT, event, payload)
+#define TRACE_COUNTER(event, value)		TraceRecord(TRACE_TYPE_COUNTER, event, value)
+#define TRACE_DRAIN()					TraceDrain()
+
+#else
+
+// Trace is compiled out unless TRACE_ENABLED is defined.
+#define TRACE_BEGIN(event)
+#define TRACE_END(event, payload)
+#define TRACE_INSTANT(event, payload)
+#define TRACE_COUNTER(event, value)
+#define TRACE_DRAIN()
+
+#endif // TRACE_ENABLED
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+#ifdef TRACE_ENABLED
+
+// Writes a record into RAM ring buffer. Record is dropped if ring
+// buffer is full. Must not be called from interrupt context.
+void TraceRecord(const TRACE_TYPE type, const TRACE_EVENT event, const uint32_t payload);
+
+// Sends as many bytes from ring buffer as SIO can accept without
+// waiting. Safe to call from both interrupt and normal context.
+void TraceDrain(void);
+
+#endif // TRACE_ENABLED
+
+#endif // TRACE_HEADER__
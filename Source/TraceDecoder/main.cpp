@@ -0,0 +1,166 @@
+/* *************************************************************************
+ *
+ * TraceDecoder: converts a raw SIO capture containing records written
+ * by Trace module (see TraceFormat.h) into a Chrome trace event JSON
+ * file, which can be opened with chrome://tracing or ui.perfetto.dev.
+ *
+ * Build:
+ *  g++ -O2 -Wall -o TraceDecoder main.cpp
+ *
+ * Usage:
+ *  TraceDecoder capture.bin trace.json
+ *
+ * Any bytes which do not belong to a valid record (e.g.: text written
+ * by Serial_printf()) are skipped.
+ *
+ * *************************************************************************/
+
+#define TRACE_EVENT_NAMES
+#include "../TraceFormat.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+static uint32_t ReadLE32(const uint8_t* const data)
+{
+    return  (uint32_t)data[0]
+            | ((uint32_t)data[1] << 8)
+            | ((uint32_t)data[2] << 16)
+            | ((uint32_t)data[3] << 24);
+}
+
+static bool IsValidRecord(const uint8_t* const record)
+{
+    uint8_t checksum = 0;
+
+    if (    (record[0] != TRACE_SYNC_BYTE)
+                ||
+            (record[1] >= MAX_TRACE_TYPES)
+                ||
+            (record[2] >= MAX_TRACE_EVENTS) )
+    {
+        return false;
+    }
+
+    for (size_t i = 0; i < TRACE_RECORD_SIZE; i++)
+    {
+        checksum ^= record[i];
+    }
+
+    // Checksum byte was calculated with itself set to 0,
+    // so XOR of a whole valid record is always 0.
+    return checksum == 0;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc != 3)
+    {
+        fprintf(stderr, "Usage: %s capture.bin trace.json\n", argv[0]);
+        return 1;
+    }
+
+    std::ifstream input(argv[1], std::ios::binary);
+
+    if (!input)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[1]);
+        return 1;
+    }
+
+    const std::vector<uint8_t> data((std::istreambuf_iterator<char>(input)),
+                                    std::istreambuf_iterator<char>());
+
+    FILE* const output = fopen(argv[2], "w");
+
+    if (output == NULL)
+    {
+        fprintf(stderr, "Could not open %s\n", argv[2]);
+        return 1;
+    }
+
+    // Timestamps are unwrapped into a 64-bit tick count.
+    uint64_t wrapOffset = 0;
+    uint32_t lastTimestamp = 0;
+    bool first = true;
+    size_t nRecords = 0;
+    size_t nSkipped = 0;
+
+    fprintf(output, "{\"traceEvents\":[\n");
+
+    for (size_t pos = 0; (pos + TRACE_RECORD_SIZE) <= data.size(); )
+    {
+        const uint8_t* const record = &data[pos];
+
+        if (!IsValidRecord(record))
+        {
+            nSkipped++;
+            pos++;
+            continue;
+        }
+
+        const TRACE_TYPE type = (TRACE_TYPE)record[1];
+        const TRACE_EVENT event = (TRACE_EVENT)record[2];
+        const uint32_t timestamp = ReadLE32(&record[4]);
+        const uint32_t payload = ReadLE32(&record[8]);
+
+        if (!first && (timestamp < lastTimestamp))
+        {
+            wrapOffset += TRACE_TICKS_WRAP;
+        }
+
+        lastTimestamp = timestamp;
+
+        const double us = ((double)(wrapOffset + timestamp) * 1000000.0) / TRACE_TICKS_PER_SECOND;
+        const char* const name = TraceEventNames[event];
+
+        fprintf(output, "%s", first ? "" : ",\n");
+
+        switch (type)
+        {
+            case TRACE_TYPE_BEGIN:
+                fprintf(output,
+                        "{\"name\":\"%s\",\"ph\":\"B\",\"ts\":%.3f,\"pid\":1,\"tid\":1}",
+                        name, us);
+            break;
+
+            case TRACE_TYPE_END:
+                fprintf(output,
+                        "{\"name\":\"%s\",\"ph\":\"E\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+                        "\"args\":{\"payload\":%u}}",
+                        name, us, payload);
+            break;
+
+            case TRACE_TYPE_INSTANT:
+                fprintf(output,
+                        "{\"name\":\"%s\",\"ph\":\"i\",\"s\":\"g\",\"ts\":%.3f,\"pid\":1,\"tid\":1,"
+                        "\"args\":{\"payload\":%u}}",
+                        name, us, payload);
+            break;
+
+            case TRACE_TYPE_COUNTER:
+                fprintf(output,
+                        "{\"name\":\"%s\",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,"
+                        "\"args\":{\"value\":%u}}",
+                        name, us, payload);
+            break;
+
+            default:
+            break;
+        }
+
+        first = false;
+        nRecords++;
+        pos += TRACE_RECORD_SIZE;
+    }
+
+    fprintf(output, "\n]}\n");
+    fclose(output);
+
+    printf("%zu records decoded, %zu bytes skipped\n", nRecords, nSkipped);
+
+    return 0;
+}
@@ -0,0 +1,87 @@
+#ifndef TRACE_FORMAT_HEADER__
+#define TRACE_FORMAT_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+// Shared by Trace module and host-side TraceDecoder,
+// so no PSXSDK headers can be included here.
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+// Each record is made of:
+//  [0]      TRACE_SYNC_BYTE
+//  [1]      Record type (TRACE_TYPE)
+//  [2]      Event ID (TRACE_EVENT)
+//  [3]      XOR of all other bytes in record
+//  [4..7]   Timestamp, little-endian, in RCnt2 ticks
+//  [8..11]  Payload, little-endian
+// Sync byte and checksum allow host to resynchronize
+// if text from Serial_printf() is mixed with records.
+#define TRACE_SYNC_BYTE			0xA5
+#define TRACE_RECORD_SIZE		12
+
+// RCnt2 runs at system clock (33.8688 MHz) / 8.
+#define TRACE_TICKS_PER_SECOND	4233600
+// Timestamps wrap around after 65536 * 10 ms.
+#define TRACE_TICKS_WRAP		(65536UL * 42336UL)
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef enum t_traceType
+{
+	TRACE_TYPE_BEGIN,
+	TRACE_TYPE_END,
+	TRACE_TYPE_INSTANT,
+	TRACE_TYPE_COUNTER,
+
+	MAX_TRACE_TYPES
+}TRACE_TYPE;
+
+// First entries must match PROFILER_SECTION, so profiler
+// sections can be traced without any conversion.
+typedef enum t_traceEvent
+{
+	TRACE_EVENT_FRAME,
+	TRACE_EVENT_GAME_CALCULATIONS,
+	TRACE_EVENT_AIRCRAFT_HANDLER,
+	TRACE_EVENT_TERRAIN_PRECALCULATIONS,
+	TRACE_EVENT_RENDER_TERRAIN,
+	TRACE_EVENT_RENDER_BUILDING_AIRCRAFT,
+	TRACE_EVENT_GUI,
+	TRACE_EVENT_GPU_WAIT,
+	TRACE_EVENT_VSYNC_WAIT,
+	// Payload: file size, in bytes.
+	TRACE_EVENT_FILE_LOADED,
+	// Payload: number of records dropped because ring buffer was full.
+	TRACE_EVENT_DROPPED,
+
+	MAX_TRACE_EVENTS
+}TRACE_EVENT;
+
+#ifdef TRACE_EVENT_NAMES
+
+// Only needed by host. Must follow TRACE_EVENT order.
+static const char* const TraceEventNames[MAX_TRACE_EVENTS] =
+{
+	"Frame",
+	"GameCalculations",
+	"AircraftHandler",
+	"TerrainPrecalculations",
+	"RenderTerrain",
+	"RenderBuildingAircraft",
+	"Gui",
+	"GpuWait",
+	"VSyncWait",
+	"FileLoaded",
+	"Dropped"
+};
+
+#endif // TRACE_EVENT_NAMES
+
+#endif // TRACE_FORMAT_HEADER__
@@ -0,0 +1,689 @@
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Vram.h"
+#include "Gfx.h"
+#include "AssetCache.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+#define VRAM_MAX_REGIONS 64
+#define VRAM_TPAGES_PER_ROW (VRAM_W / GFX_TPAGE_WIDTH)
+#define VRAM_TPAGE_ROWS (VRAM_H / GFX_TPAGE_HEIGHT)
+#define VRAM_MAX_TPAGES (VRAM_TPAGES_PER_ROW * VRAM_TPAGE_ROWS)
+#define VRAM_CLUT_ALIGNMENT 16
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef struct t_vramRegion
+{
+	bool used;
+	// Pinned regions (i.e.: framebuffers) are never evicted.
+	bool pinned;
+	VRAM_OWNER owner;
+	short x;
+	short y;
+	short w;
+	short h;
+}TYPE_VRAM_REGION;
+
+/* *************************************
+ * 	Local Prototypes
+ * *************************************/
+
+static bool VramRegionOverlap(const TYPE_VRAM_REGION* const ptrRegion, short x, short y, short w, short h);
+static bool VramIsInsideVRAM(short x, short y, short w, short h);
+static bool VramOverlapsPinned(short x, short y, short w, short h);
+static bool VramIsFree(short x, short y, short w, short h);
+static bool VramFitsInTPage(short x, short y, short w, short h, const VRAM_AREA area);
+static uint32_t VramGetUsedTPages(void);
+static uint32_t VramGetTPageMask(short x, short y, short w, short h);
+static void VramEvictRegion(TYPE_VRAM_REGION* const ptrRegion);
+static TYPE_VRAM_REGION* VramAddRegion(short x, short y, short w, short h, const VRAM_OWNER owner);
+static VRAM_AREA VramAreaFromPmode(const int pmode);
+
+/* *************************************
+ * 	Local Variables
+ * *************************************/
+
+static TYPE_VRAM_REGION VramRegions[VRAM_MAX_REGIONS];
+static VRAM_OWNER VramCurrentOwner;
+
+/* *******************************************************************************************
+ *
+ * @name: void VramInit(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Clears all regions and reserves both framebuffers (see GfxSwapBuffers()),
+ *  which are pinned so no texture can ever be placed on them.
+ *
+ * *******************************************************************************************/
+void VramInit(void)
+{
+	TYPE_VRAM_REGION* ptrRegion;
+
+	bzero(VramRegions, sizeof (VramRegions));
+
+	VramCurrentOwner = VRAM_OWNER_MENU;
+
+	ptrRegion = VramAddRegion(0, 0, X_SCREEN_RESOLUTION, Y_SCREEN_RESOLUTION, VRAM_OWNER_SYSTEM);
+
+	if (ptrRegion != NULL)
+	{
+		ptrRegion->pinned = true;
+	}
+
+	ptrRegion = VramAddRegion(0, GFX_TPAGE_HEIGHT, X_SCREEN_RESOLUTION, Y_SCREEN_RESOLUTION, VRAM_OWNER_SYSTEM);
+
+	if (ptrRegion != NULL)
+	{
+		ptrRegion->pinned = true;
+	}
+}
+
+VRAM_OWNER VramSetOwner(const VRAM_OWNER owner)
+{
+	const VRAM_OWNER prevOwner = VramCurrentOwner;
+
+	VramCurrentOwner = owner;
+
+	return prevOwner;
+}
+
+static bool VramRegionOverlap(const TYPE_VRAM_REGION* const ptrRegion, short x, short y, short w, short h)
+{
+	return !(	(ptrRegion->x >= (x + w))
+					||
+				(x >= (ptrRegion->x + ptrRegion->w))
+					||
+				(ptrRegion->y >= (y + h))
+					||
+				(y >= (ptrRegion->y + ptrRegion->h))	);
+}
+
+static bool VramIsInsideVRAM(short x, short y, short w, short h)
+{
+	return (	(x >= 0) && (y >= 0) && (w > 0) && (h > 0)
+					&&
+				((x + w) <= VRAM_W) && ((y + h) <= VRAM_H)	);
+}
+
+static bool VramOverlapsPinned(short x, short y, short w, short h)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (	(ptrRegion->used != false)
+					&&
+				(ptrRegion->pinned != false)
+					&&
+				(VramRegionOverlap(ptrRegion, x, y, w, h) != false)	)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static bool VramIsFree(short x, short y, short w, short h)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if ((ptrRegion->used != false) && VramRegionOverlap(ptrRegion, x, y, w, h))
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramFitsInTPage(short x, short y, short w, short h, const VRAM_AREA area)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Checks whether a rectangle can be addressed from a single texture page,
+ *  so GsSprite's u and v offsets do not need to wrap around.
+ *
+ * @remarks:
+ *  A texture page is 256x256 texels. On VRAM (16-bit) units, this means
+ *  64 units for 4bpp, 128 units for 8bpp and 256 units for 16bpp.
+ *  CLUT data only needs to be 16-unit aligned.
+ *
+ * *******************************************************************************************/
+static bool VramFitsInTPage(short x, short y, short w, short h, const VRAM_AREA area)
+{
+	short maxWidth;
+
+	switch (area)
+	{
+		case VRAM_AREA_CLUT:
+		return ((x % VRAM_CLUT_ALIGNMENT) == 0);
+
+		case VRAM_AREA_4BPP:
+			maxWidth = GFX_TPAGE_WIDTH;
+		break;
+
+		case VRAM_AREA_8BPP:
+			maxWidth = GFX_TPAGE_WIDTH << 1;
+		break;
+
+		case VRAM_AREA_16BPP:
+		// Fall through
+		default:
+			maxWidth = GFX_TPAGE_WIDTH << 2;
+		break;
+	}
+
+	if (w > maxWidth)
+	{
+		// Image cannot fit in a single texture page anyway.
+		// At least, make it start on a texture page boundary.
+		return ((x % GFX_TPAGE_WIDTH) == 0);
+	}
+
+	return (	(((x % GFX_TPAGE_WIDTH) + w) <= maxWidth)
+					&&
+				(((y % GFX_TPAGE_HEIGHT) + h) <= GFX_TPAGE_HEIGHT)	);
+}
+
+static uint32_t VramGetTPageMask(short x, short y, short w, short h)
+{
+	uint32_t mask = 0;
+	short tx;
+	short ty;
+
+	for (ty = y / GFX_TPAGE_HEIGHT; ty <= ((y + h - 1) / GFX_TPAGE_HEIGHT); ty++)
+	{
+		for (tx = x / GFX_TPAGE_WIDTH; tx <= ((x + w - 1) / GFX_TPAGE_WIDTH); tx++)
+		{
+			mask |= (uint32_t)1 << (tx + (ty * VRAM_TPAGES_PER_ROW));
+		}
+	}
+
+	return mask;
+}
+
+static uint32_t VramGetUsedTPages(void)
+{
+	uint32_t mask = 0;
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (ptrRegion->used != false)
+		{
+			mask |= VramGetTPageMask(ptrRegion->x, ptrRegion->y, ptrRegion->w, ptrRegion->h);
+		}
+	}
+
+	return mask;
+}
+
+static void VramEvictRegion(TYPE_VRAM_REGION* const ptrRegion)
+{
+	ptrRegion->used = false;
+
+	// Any asset loaded into this region is no longer resident.
+	AssetCacheEvictVRAM(ptrRegion->x, ptrRegion->y, ptrRegion->w, ptrRegion->h);
+}
+
+static TYPE_VRAM_REGION* VramAddRegion(short x, short y, short w, short h, const VRAM_OWNER owner)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (ptrRegion->used == false)
+		{
+			ptrRegion->used = true;
+			ptrRegion->pinned = false;
+			ptrRegion->owner = owner;
+			ptrRegion->x = x;
+			ptrRegion->y = y;
+			ptrRegion->w = w;
+			ptrRegion->h = h;
+
+			return ptrRegion;
+		}
+	}
+
+	Serial_printf("VRAM: no free regions left!\n");
+
+	return NULL;
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramReserve(short x, short y, short w, short h, const VRAM_OWNER owner)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Marks given rectangle as used by owner. Non-pinned regions overlapping it
+ *  are evicted, and so are assets loaded into them (see AssetCache).
+ *
+ * @return:
+ *  false if rectangle lies outside VRAM or overlaps a pinned region,
+ *  true otherwise.
+ *
+ * *******************************************************************************************/
+bool VramReserve(short x, short y, short w, short h, const VRAM_OWNER owner)
+{
+	uint8_t i;
+
+	if (VramIsInsideVRAM(x, y, w, h) == false)
+	{
+		Serial_printf("VRAM: invalid rectangle {%d, %d, %d, %d}\n", x, y, w, h);
+		return false;
+	}
+
+	if (VramOverlapsPinned(x, y, w, h) != false)
+	{
+		Serial_printf("VRAM: rectangle {%d, %d, %d, %d} overlaps a pinned region\n", x, y, w, h);
+		return false;
+	}
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if ((ptrRegion->used != false) && VramRegionOverlap(ptrRegion, x, y, w, h))
+		{
+			VramEvictRegion(ptrRegion);
+		}
+	}
+
+	// Rectangle contents are about to be overwritten.
+	AssetCacheEvictVRAM(x, y, w, h);
+
+	return (VramAddRegion(x, y, w, h, owner) != NULL);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramAlloc(short w, short h, const VRAM_AREA area, short* const x, short* const y)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Looks for a free rectangle of w x h VRAM units. Candidate positions are
+ *  texture page origins and the right and bottom edges from used regions,
+ *  so rectangles are packed next to each other.
+ *
+ * @remarks:
+ *  Candidates on texture pages which are already in use are preferred,
+ *  so fewer texture page changes are needed when drawing. Then, lower
+ *  and leftmost candidates are chosen.
+ *
+ * @return:
+ *  true if a free rectangle was found, false otherwise.
+ *
+ * *******************************************************************************************/
+bool VramAlloc(short w, short h, const VRAM_AREA area, short* const x, short* const y)
+{
+	const uint32_t usedTPages = VramGetUsedTPages();
+	uint8_t i;
+	uint8_t j;
+	bool found = false;
+	bool bestShared = false;
+	short bestX = 0;
+	short bestY = 0;
+
+	if ((w <= 0) || (h <= 0) || (w > VRAM_W) || (h > VRAM_H))
+	{
+		return false;
+	}
+
+	// Candidate x coordinates: texture page origins (i < VRAM_TPAGES_PER_ROW)
+	// and right edges from used regions.
+	for (i = 0; i < (VRAM_TPAGES_PER_ROW + VRAM_MAX_REGIONS); i++)
+	{
+		short cx;
+
+		if (i < VRAM_TPAGES_PER_ROW)
+		{
+			cx = i * GFX_TPAGE_WIDTH;
+		}
+		else
+		{
+			const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i - VRAM_TPAGES_PER_ROW];
+
+			if (ptrRegion->used == false)
+			{
+				continue;
+			}
+
+			cx = ptrRegion->x + ptrRegion->w;
+
+			if (area == VRAM_AREA_CLUT)
+			{
+				cx = (cx + VRAM_CLUT_ALIGNMENT - 1) & ~(VRAM_CLUT_ALIGNMENT - 1);
+			}
+		}
+
+		// Candidate y coordinates: texture page row origins (j < VRAM_TPAGE_ROWS)
+		// and bottom edges from used regions.
+		for (j = 0; j < (VRAM_TPAGE_ROWS + VRAM_MAX_REGIONS); j++)
+		{
+			short cy;
+			bool shared;
+
+			if (j < VRAM_TPAGE_ROWS)
+			{
+				cy = j * GFX_TPAGE_HEIGHT;
+			}
+			else
+			{
+				const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[j - VRAM_TPAGE_ROWS];
+
+				if (ptrRegion->used == false)
+				{
+					continue;
+				}
+
+				cy = ptrRegion->y + ptrRegion->h;
+			}
+
+			if (	(bestShared != false)
+						&&
+					((cy > bestY) || ((cy == bestY) && (cx >= bestX)))	)
+			{
+				// Candidate cannot improve current best result.
+				// Discard it before running expensive checks.
+				continue;
+			}
+
+			if (	(VramIsInsideVRAM(cx, cy, w, h) == false)
+						||
+					(VramFitsInTPage(cx, cy, w, h, area) == false)
+						||
+					(VramIsFree(cx, cy, w, h) == false)	)
+			{
+				continue;
+			}
+
+			shared = ((usedTPages & VramGetTPageMask(cx, cy, w, h)) != 0);
+
+			if (	(found == false)
+						||
+					((shared != false) && (bestShared == false))
+						||
+					(	(shared == bestShared)
+							&&
+						((cy < bestY) || ((cy == bestY) && (cx < bestX)))	)	)
+			{
+				found = true;
+				bestShared = shared;
+				bestX = cx;
+				bestY = cy;
+			}
+		}
+	}
+
+	if (found != false)
+	{
+		*x = bestX;
+		*y = bestY;
+	}
+
+	return found;
+}
+
+void VramFree(short x, short y)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (	(ptrRegion->used != false)
+					&&
+				(ptrRegion->pinned == false)
+					&&
+				(ptrRegion->x == x)
+					&&
+				(ptrRegion->y == y)	)
+		{
+			VramEvictRegion(ptrRegion);
+		}
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramIsResident(short x, short y, short w, short h)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Tells whether a region previously reserved by VramReserve() is still
+ *  in use, i.e.: it has not been evicted by any other reservation.
+ *
+ * *******************************************************************************************/
+bool VramIsResident(short x, short y, short w, short h)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (	(ptrRegion->used != false)
+					&&
+				(ptrRegion->x == x)
+					&&
+				(ptrRegion->y == y)
+					&&
+				(ptrRegion->w == w)
+					&&
+				(ptrRegion->h == h)	)
+		{
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void VramFreeOwner(const VRAM_OWNER owner)
+{
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (	(ptrRegion->used != false)
+					&&
+				(ptrRegion->pinned == false)
+					&&
+				(ptrRegion->owner == owner)	)
+		{
+			VramEvictRegion(ptrRegion);
+		}
+	}
+}
+
+static VRAM_AREA VramAreaFromPmode(const int pmode)
+{
+	switch (pmode)
+	{
+		case COLORMODE_4BPP:
+		return VRAM_AREA_4BPP;
+
+		case COLORMODE_8BPP:
+		return VRAM_AREA_8BPP;
+
+		default:
+		return VRAM_AREA_16BPP;
+	}
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramPlaceCLUT(GsImage* const gsi)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Reserves VRAM for CLUT data from a GsImage instance.
+ *
+ * @remarks:
+ *  CLUT position defined on TIM file is kept if possible. Otherwise,
+ *  (i.e.: it lies on a framebuffer) a new position is allocated.
+ *
+ * *******************************************************************************************/
+bool VramPlaceCLUT(GsImage* const gsi)
+{
+	if (gsi->has_clut == false)
+	{
+		return true;
+	}
+
+	if (	(VramIsInsideVRAM(gsi->clut_x, gsi->clut_y, gsi->clut_w, gsi->clut_h) == false)
+				||
+			(VramOverlapsPinned(gsi->clut_x, gsi->clut_y, gsi->clut_w, gsi->clut_h) != false)	)
+	{
+		short x;
+		short y;
+
+		if (VramAlloc(gsi->clut_w, gsi->clut_h, VRAM_AREA_CLUT, &x, &y) == false)
+		{
+			Serial_printf("VRAM: could not allocate %dx%d CLUT\n", gsi->clut_w, gsi->clut_h);
+			return false;
+		}
+
+		Serial_printf("VRAM: CLUT moved from {%d, %d} to {%d, %d}\n", gsi->clut_x, gsi->clut_y, x, y);
+
+		gsi->clut_x = x;
+		gsi->clut_y = y;
+	}
+
+	return VramReserve(gsi->clut_x, gsi->clut_y, gsi->clut_w, gsi->clut_h, VramCurrentOwner);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: bool VramPlaceImage(GsImage* const gsi)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Reserves VRAM for image and CLUT data from a GsImage instance.
+ *  Must be called before GsSpriteFromImage(), so tpage, u and v
+ *  are calculated from final image position.
+ *
+ * @remarks:
+ *  Image position defined on TIM file is kept if possible, since some
+ *  modules rely on it (see GfxTPageOffsetFromVRAMPosition()). TIM files
+ *  placed on a framebuffer (e.g.: origin left as 0, 0) are relocated.
+ *
+ * *******************************************************************************************/
+bool VramPlaceImage(GsImage* const gsi)
+{
+	if (	(VramIsInsideVRAM(gsi->x, gsi->y, gsi->w, gsi->h) == false)
+				||
+			(VramOverlapsPinned(gsi->x, gsi->y, gsi->w, gsi->h) != false)	)
+	{
+		short x;
+		short y;
+
+		if (VramAlloc(gsi->w, gsi->h, VramAreaFromPmode(gsi->pmode), &x, &y) == false)
+		{
+			Serial_printf("VRAM: could not allocate %dx%d image\n", gsi->w, gsi->h);
+			return false;
+		}
+
+		Serial_printf("VRAM: image moved from {%d, %d} to {%d, %d}\n", gsi->x, gsi->y, x, y);
+
+		gsi->x = x;
+		gsi->y = y;
+	}
+
+	if (VramReserve(gsi->x, gsi->y, gsi->w, gsi->h, VramCurrentOwner) == false)
+	{
+		return false;
+	}
+
+	return VramPlaceCLUT(gsi);
+}
+
+/* *******************************************************************************************
+ *
+ * @name: void VramPrintStats(void)
+ *
+ * @author: Xavier Del Campo
+ *
+ * @brief:
+ *  Prints VRAM usage through serial interface.
+ *
+ * @remarks:
+ *  Fragmentation is calculated as the percentage of free VRAM which
+ *  does not belong to a completely free texture page.
+ *
+ * *******************************************************************************************/
+void VramPrintStats(void)
+{
+	const uint32_t usedTPages = VramGetUsedTPages();
+	uint32_t usedArea = 0;
+	uint32_t freeArea;
+	uint32_t freeTPageArea;
+	uint8_t nRegions = 0;
+	uint8_t nUsedTPages = 0;
+	uint8_t i;
+
+	for (i = 0; i < VRAM_MAX_REGIONS; i++)
+	{
+		const TYPE_VRAM_REGION* const ptrRegion = &VramRegions[i];
+
+		if (ptrRegion->used != false)
+		{
+			// Regions never overlap each other.
+			usedArea += ptrRegion->w * ptrRegion->h;
+			nRegions++;
+		}
+	}
+
+	for (i = 0; i < VRAM_MAX_TPAGES; i++)
+	{
+		if (usedTPages & ((uint32_t)1 << i))
+		{
+			nUsedTPages++;
+		}
+	}
+
+	freeArea = (VRAM_W * VRAM_H) - usedArea;
+	freeTPageArea = (VRAM_MAX_TPAGES - nUsedTPages) * GFX_TPAGE_WIDTH * GFX_TPAGE_HEIGHT;
+
+	Serial_printf("VRAM: %d used, %d free, %d regions\n", usedArea, freeArea, nRegions);
+	Serial_printf("VRAM: %d/%d texture pages in use\n", nUsedTPages, VRAM_MAX_TPAGES);
+
+	if (freeArea != 0)
+	{
+		Serial_printf("VRAM: fragmentation %d%%\n", 100 - ((freeTPageArea * 100) / freeArea));
+	}
+}
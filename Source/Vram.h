@@ -0,0 +1,73 @@
+#ifndef VRAM_HEADER__
+#define VRAM_HEADER__
+
+/* *************************************
+ * 	Includes
+ * *************************************/
+
+#include "Global_Inc.h"
+
+/* *************************************
+ * 	Defines
+ * *************************************/
+
+/* *************************************
+ * 	Structs and enums
+ * *************************************/
+
+typedef enum t_vramOwner
+{
+	VRAM_OWNER_SYSTEM,
+	VRAM_OWNER_MENU,
+	// PSXSDK intro assets, released once it has been played.
+	VRAM_OWNER_INTRO,
+	VRAM_OWNER_GAME,
+
+	MAX_VRAM_OWNERS
+}VRAM_OWNER;
+
+typedef enum t_vramArea
+{
+	VRAM_AREA_4BPP,
+	VRAM_AREA_8BPP,
+	VRAM_AREA_16BPP,
+	VRAM_AREA_CLUT
+}VRAM_AREA;
+
+/* *************************************
+ * 	Global prototypes
+ * *************************************/
+
+// Clears all regions and reserves framebuffer areas, which can never be evicted.
+void VramInit(void);
+
+// Sets owner for regions allocated by VramPlaceImage() and VramPlaceCLUT().
+// Returns previous owner.
+VRAM_OWNER VramSetOwner(const VRAM_OWNER owner);
+
+// Marks given rectangle as used, evicting any other region overlapping it.
+bool VramReserve(short x, short y, short w, short h, const VRAM_OWNER owner);
+
+// Finds a free rectangle for an image or CLUT. Coordinates are written into x and y.
+bool VramAlloc(short w, short h, const VRAM_AREA area, short* const x, short* const y);
+
+// Releases region whose origin matches given coordinates.
+void VramFree(short x, short y);
+
+// Returns true if given region has not been evicted since it was reserved.
+bool VramIsResident(short x, short y, short w, short h);
+
+// Releases all regions belonging to a given owner.
+void VramFreeOwner(const VRAM_OWNER owner);
+
+// Reserves VRAM for image and CLUT data from a GsImage instance,
+// relocating them only if authored position is not available.
+bool VramPlaceImage(GsImage* const gsi);
+
+// Same as VramPlaceImage(), but image data is discarded (*.CLT files).
+bool VramPlaceCLUT(GsImage* const gsi);
+
+// Prints used and free VRAM, texture pages in use and fragmentation.
+void VramPrintStats(void);
+
+#endif // VRAM_HEADER__